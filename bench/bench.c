@@ -0,0 +1,1208 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <getopt.h>
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "canvas.h"
+#include "canvas-paint.h"
+#include "canvas-fillStyle.h"
+#include "canvas-strokeStyle.h"
+#include "canvas-beginPath.h"
+#include "canvas-moveTo.h"
+#include "canvas-lineTo.h"
+#include "canvas-bezierCurveTo.h"
+#include "canvas-quadraticCurveTo.h"
+#include "canvas-arc.h"
+#include "canvas-ellipse.h"
+#include "canvas-drawCircles.h"
+#include "canvas-rect.h"
+#include "canvas-polyline.h"
+#include "canvas-strokeSeries.h"
+#include "canvas-closePath.h"
+#include "canvas-fill.h"
+#include "canvas-stroke.h"
+#include "canvas-fillRect.h"
+#include "canvas-strokeRect.h"
+#include "canvas-clearRect.h"
+#include "canvas-clip.h"
+#include "cull-util.h"
+#include "path-util.h"
+#include "hit-util.h"
+#include "canvas-save.h"
+#include "canvas-restore.h"
+#include "canvas-translate.h"
+#include "canvas-rotate.h"
+#include "canvas-scale.h"
+#include "canvas-setLineDash.h"
+#include "canvas-font.h"
+#include "canvas-fillText.h"
+#include "canvas-strokeText.h"
+#include "canvas-measureText.h"
+#include "canvas-fillTextBlob.h"
+#include "canvas-strokeTextBlob.h"
+#include "textblob-util.h"
+#include "canvas-drawImage.h"
+#include "context-util.h"
+#include "layer-util.h"
+#include "displaylist-util.h"
+#include "tile-util.h"
+#include "color-util.h"
+#include "egl-util.h"
+#include "font-util.h"
+#include "image-util.h"
+#include "encode-util.h"
+#include "readback-util.h"
+#include "present-util.h"
+#include "log-util.h"
+#include "record-vg.h"
+
+/*
+ * Microbenchmarks of the canvas_* functions against the recording OpenVG
+ * implementation (record-vg.c). Each benchmark is repeated until it ran for
+ * at least the minimum time, the result is written as JSON to stdout.
+ *
+ * Allocations are counted by wrapping malloc, calloc and realloc at link time
+ * (-Wl,--wrap=...), so only allocations of the canvas code itself are seen,
+ * not the ones inside FreeType, FreeImage or zlib.
+ */
+
+typedef struct bench_t
+{
+	const char *name;
+	void (*setup)(void);
+	void (*run)(void);
+	void (*teardown)(void);
+	int needs_font;
+} bench_t;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t amount, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+static unsigned long bench_allocs = 0;
+static unsigned long bench_alloc_bytes = 0;
+
+static int bench_index = 0;
+static paint_t bench_paint;
+static image_t *bench_image = NULL;
+static char *bench_pixels = NULL;
+static VGint bench_pixels_size = 256;
+static char bench_text[257];
+static textblob_t *bench_blob = NULL;
+static const char *bench_font = "test/Lato-Regular.ttf";
+
+void *__wrap_malloc(size_t size)
+{
+	// the encoder and binning benchmarks allocate on pool threads as well
+	__sync_fetch_and_add(&bench_allocs, 1);
+	__sync_fetch_and_add(&bench_alloc_bytes, size);
+	
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t amount, size_t size)
+{
+	__sync_fetch_and_add(&bench_allocs, 1);
+	__sync_fetch_and_add(&bench_alloc_bytes, amount * size);
+	
+	return __real_calloc(amount, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+	__sync_fetch_and_add(&bench_allocs, 1);
+	__sync_fetch_and_add(&bench_alloc_bytes, size);
+	
+	return __real_realloc(pointer, size);
+}
+
+static uint64_t bench_now(void)
+{
+	struct timespec time;
+	
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	
+	return (uint64_t)time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+/* setup and teardown */
+
+static void bench_text_setup(int length)
+{
+	int i = 0;
+	
+	for(i = 0; i < length; i++)
+	{
+		bench_text[i] = 'a' + (i * 7) % 26;
+		if(i % 6 == 5)
+		{
+			bench_text[i] = ' ';
+		}
+	}
+	
+	bench_text[length] = '\0';
+}
+
+static void bench_text_8(void) { bench_text_setup(8); }
+static void bench_text_64(void) { bench_text_setup(64); }
+static void bench_text_256(void) { bench_text_setup(256); }
+
+static void bench_atlas_setup(void)
+{
+	bench_text_setup(64);
+	font_util_atlas_set_size(canvas_font_get_size());
+}
+
+static void bench_atlas_teardown(void)
+{
+	font_util_atlas_set_size(0);
+}
+
+static void bench_blob_setup(void)
+{
+	bench_text_setup(64);
+	bench_blob = textblob_util_create(bench_text, canvas_font_get_index(), canvas_font_get_size(), VG_TRUE, canvas_textAlign_get_internal(), canvas_textBaseline_get_internal());
+}
+
+static void bench_blob_teardown(void)
+{
+	textblob_util_destroy(bench_blob);
+	bench_blob = NULL;
+}
+
+static void bench_font_cache_setup(void)
+{
+	font_util_cache_set_dir("/tmp/vgcanvas-bench-fonts");
+	
+	// the first load writes the cache file
+	font_util_new((char *)bench_font, "bench-load");
+	font_util_remove("bench-load");
+}
+
+static void bench_font_cache_teardown(void)
+{
+	font_util_cache_set_dir(NULL);
+}
+
+static void bench_image_setup(void)
+{
+	bench_pixels = calloc(bench_pixels_size * bench_pixels_size, 4);
+	bench_image = image_create(VG_sRGBA_8888, bench_pixels_size, bench_pixels_size, bench_pixels);
+}
+
+static void bench_image_teardown(void)
+{
+	image_cleanup(bench_image);
+	free(bench_pixels);
+	bench_image = NULL;
+	bench_pixels = NULL;
+}
+
+static void bench_pixels_setup(void)
+{
+	int i = 0;
+	
+	bench_pixels = malloc(bench_pixels_size * bench_pixels_size * 4);
+	
+	// smooth gradient with some noise, roughly like a rendered frame
+	for(i = 0; i < bench_pixels_size * bench_pixels_size * 4; i++)
+	{
+		bench_pixels[i] = (char)((i / 4) % bench_pixels_size + (i * 2654435761u >> 28));
+	}
+}
+
+static void bench_pixels_teardown(void)
+{
+	free(bench_pixels);
+	bench_pixels = NULL;
+}
+
+/* rects */
+
+static void bench_fillRect(void)
+{
+	canvas_fillRect(bench_index % 100, 20, 100, 100);
+}
+
+static void bench_strokeRect(void)
+{
+	canvas_strokeRect(bench_index % 100, 20, 100, 100);
+}
+
+static void bench_clearRect(void)
+{
+	canvas_clearRect(bench_index % 100, 20, 100, 100);
+}
+
+/* paths */
+
+static void bench_lines(int count)
+{
+	int i = 0;
+	
+	canvas_beginPath();
+	canvas_moveTo(0, 0);
+	
+	for(i = 1; i <= count; i++)
+	{
+		canvas_lineTo(i * 3 % 800, (i * 37) % 600);
+	}
+	
+	canvas_stroke();
+}
+
+static void bench_lines_8(void) { bench_lines(8); }
+static void bench_lines_64(void) { bench_lines(64); }
+static void bench_lines_512(void) { bench_lines(512); }
+static void bench_lines_1m(void) { bench_lines(1000000); }
+
+static VGfloat *bench_points = NULL;
+static int bench_points_count = 0;
+
+// the same points as bench_lines, x and y interleaved
+static void bench_points_setup(int count)
+{
+	int i = 0;
+	
+	bench_points = malloc((count + 1) * 2 * sizeof(VGfloat));
+	bench_points_count = count + 1;
+	
+	for(i = 0; i <= count; i++)
+	{
+		bench_points[2 * i] = i * 3 % 800;
+		bench_points[2 * i + 1] = (i * 37) % 600;
+	}
+}
+
+static void bench_points_512_setup(void) { bench_points_setup(512); }
+static void bench_points_1m_setup(void) { bench_points_setup(1000000); }
+
+static void bench_points_teardown(void)
+{
+	free(bench_points);
+	bench_points = NULL;
+}
+
+static void bench_polyline(void)
+{
+	canvas_beginPath();
+	canvas_polyline(bench_points, bench_points_count, 0);
+	canvas_stroke();
+}
+
+static void bench_bezier_64(void)
+{
+	int i = 0;
+	
+	canvas_beginPath();
+	canvas_moveTo(0, 300);
+	
+	for(i = 1; i <= 64; i++)
+	{
+		canvas_bezierCurveTo(i * 10 - 7, 200, i * 10 - 3, 400, i * 10, 300);
+	}
+	
+	canvas_closePath();
+	canvas_fill();
+}
+
+static void bench_quadratic_64(void)
+{
+	int i = 0;
+	
+	canvas_beginPath();
+	canvas_moveTo(0, 300);
+	
+	for(i = 1; i <= 64; i++)
+	{
+		canvas_quadraticCurveTo(i * 10 - 5, i % 2 ? 200 : 400, i * 10, 300);
+	}
+	
+	canvas_stroke();
+}
+
+static void bench_arc(void)
+{
+	canvas_beginPath();
+	canvas_arc(400, 300, 50, 0, 2 * M_PI, VG_FALSE);
+	canvas_fill();
+}
+
+static VGfloat *bench_scatter = NULL;
+
+// 10k dots of a scatter plot, x, y and radius in separate arrays
+static void bench_scatter_setup(void)
+{
+	int i = 0;
+	
+	bench_scatter = malloc(3 * 10000 * sizeof(VGfloat));
+	
+	for(i = 0; i < 10000; i++)
+	{
+		bench_scatter[i] = (i * 7919) % 800;
+		bench_scatter[10000 + i] = (i * 104729) % 600;
+		bench_scatter[20000 + i] = 2 + i % 4;
+	}
+}
+
+static void bench_scatter_teardown(void)
+{
+	free(bench_scatter);
+	bench_scatter = NULL;
+}
+
+// the usual way: one path per dot
+static void bench_scatter_arcs(void)
+{
+	int i = 0;
+	
+	for(i = 0; i < 10000; i++)
+	{
+		canvas_beginPath();
+		canvas_arc(bench_scatter[i], bench_scatter[10000 + i], bench_scatter[20000 + i], 0, 2 * M_PI, VG_FALSE);
+		canvas_fill();
+	}
+}
+
+// all dots in one path
+static void bench_scatter_path(void)
+{
+	int i = 0;
+	
+	canvas_beginPath();
+	
+	for(i = 0; i < 10000; i++)
+	{
+		canvas_moveTo(bench_scatter[i] + bench_scatter[20000 + i], bench_scatter[10000 + i]);
+		canvas_arc(bench_scatter[i], bench_scatter[10000 + i], bench_scatter[20000 + i], 0, 2 * M_PI, VG_FALSE);
+	}
+	
+	canvas_fill();
+}
+
+static void bench_scatter_circles(void)
+{
+	canvas_drawCircles(bench_scatter, bench_scatter + 10000, bench_scatter + 20000, 10000, 1);
+}
+
+static void bench_rects_64(void)
+{
+	int i = 0;
+	
+	canvas_beginPath();
+	
+	for(i = 0; i < 64; i++)
+	{
+		canvas_rect(i * 12, (i * 37) % 600, 10, 10);
+	}
+	
+	canvas_fill();
+}
+
+// a scrolled list of 1000 rows of which 20 are inside the surface
+static void bench_list(int cull)
+{
+	int i = 0;
+	
+	cull_util_set_enabled(cull);
+	
+	for(i = 0; i < 1000; i++)
+	{
+		canvas_fillRect(10, i * 54 - 20000, 600, 50);
+		canvas_strokeRect(10, i * 54 - 20000, 600, 50);
+	}
+	
+	cull_util_set_enabled(1);
+}
+
+static void bench_list_culled(void) { bench_list(1); }
+static void bench_list_unculled(void) { bench_list(0); }
+
+// hit tests against a circle and a star shaped polygon of 256 points, the
+// first test after the setup flattens and indexes the path
+static void bench_hit_circle_setup(void)
+{
+	canvas_beginPath();
+	canvas_arc(200, 200, 100, 0, 2 * M_PI, VG_FALSE);
+}
+
+static void bench_hit_polygon_setup(void)
+{
+	VGfloat points[512];
+	int i = 0;
+	
+	for(i = 0; i < 256; i++)
+	{
+		points[2 * i] = 400 + (i % 2 ? 100 : 250) * cosf(i * 2 * M_PI / 256);
+		points[2 * i + 1] = 300 + (i % 2 ? 100 : 250) * sinf(i * 2 * M_PI / 256);
+	}
+	
+	canvas_beginPath();
+	canvas_polyline(points, 256, 1);
+}
+
+static void bench_hit_path(void)
+{
+	int i = 0;
+	
+	for(i = 0; i < 64; i++)
+	{
+		path_util_is_point_in_path(100 + (i * 37) % 300, 100 + (i * 53) % 300, VG_NON_ZERO);
+	}
+}
+
+static void bench_hit_stroke(void)
+{
+	int i = 0;
+	
+	for(i = 0; i < 64; i++)
+	{
+		path_util_is_point_in_stroke(100 + (i * 37) % 300, 100 + (i * 53) % 300);
+	}
+}
+
+// 5000 widgets of a kiosk UI as hit regions, a pointer move tests 64 points
+static void bench_region(int i)
+{
+	char id[16];
+	
+	snprintf(id, sizeof(id), "widget-%d", i);
+	canvas_beginPath();
+	canvas_rect((i * 97) % 1800, (i * 61) % 1000, 40 + i % 80, 20 + i % 40);
+	hit_util_add(id, VG_NON_ZERO);
+}
+
+static void bench_regions_setup(void)
+{
+	int i = 0;
+	
+	for(i = 0; i < 5000; i++)
+	{
+		bench_region(i);
+	}
+}
+
+static void bench_regions_teardown(void)
+{
+	hit_util_clear();
+}
+
+static void bench_regions_add(void)
+{
+	hit_util_clear();
+	bench_regions_setup();
+}
+
+static void bench_regions_update(void)
+{
+	static int next = 0;
+	int i = 0;
+	
+	for(i = 0; i < 64; i++)
+	{
+		bench_region(next++ % 5000);
+	}
+}
+
+static void bench_regions_test(void)
+{
+	int i = 0;
+	
+	for(i = 0; i < 64; i++)
+	{
+		hit_util_test((i * 293) % 1920, (i * 181) % 1080);
+	}
+}
+
+static void bench_dashed_64(void)
+{
+	VGfloat dash[2] = { 5, 3 };
+	
+	canvas_setLineDash(2, dash);
+	bench_lines(64);
+	canvas_setLineDash(0, NULL);
+}
+
+// 500k noisy samples over 800 pixel columns
+static VGfloat *bench_series_xs = NULL;
+static VGfloat *bench_series_ys = NULL;
+
+static void bench_series_setup(void)
+{
+	int i = 0;
+	
+	bench_series_xs = malloc(500000 * sizeof(VGfloat));
+	bench_series_ys = malloc(500000 * sizeof(VGfloat));
+	
+	for(i = 0; i < 500000; i++)
+	{
+		bench_series_xs[i] = i * 800.0f / 500000;
+		bench_series_ys[i] = 300 + 200 * sinf(i / 5000.0f) + (i * 2654435761u >> 26) - 32;
+	}
+}
+
+static void bench_series_teardown(void)
+{
+	free(bench_series_xs);
+	free(bench_series_ys);
+	bench_series_xs = NULL;
+	bench_series_ys = NULL;
+}
+
+static void bench_series(void)
+{
+	canvas_strokeSeries(bench_series_xs, bench_series_ys, 500000, 1, NULL);
+}
+
+static void bench_series_raw(void)
+{
+	canvas_strokeSeries(bench_series_xs, bench_series_ys, 500000, 0, NULL);
+}
+
+/* state */
+
+static void bench_save_restore(int depth)
+{
+	int i = 0;
+	
+	for(i = 0; i < depth; i++)
+	{
+		canvas_save();
+	}
+	
+	for(i = 0; i < depth; i++)
+	{
+		canvas_restore();
+	}
+}
+
+static void bench_save_restore_1(void) { bench_save_restore(1); }
+static void bench_save_restore_8(void) { bench_save_restore(8); }
+static void bench_save_restore_32(void) { bench_save_restore(32); }
+
+static void bench_transform(void)
+{
+	canvas_save();
+	canvas_translate(100, 100);
+	canvas_rotate(0.5);
+	canvas_scale(2, 2);
+	canvas_restore();
+}
+
+static void bench_clip(void)
+{
+	canvas_save();
+	canvas_beginPath();
+	canvas_rect(10, 10, 200, 200);
+	canvas_clip();
+	canvas_fillRect(0, 0, 300, 300);
+	canvas_restore();
+}
+
+/* paints */
+
+static void bench_color(void)
+{
+	paint_t *previous = canvas_fillStyle_get();
+	
+	paint_createColor(&bench_paint, (bench_index % 255) / 255.0f, 0.5f, 0.25f, 1);
+	canvas_fillStyle(&bench_paint);
+	canvas_fillRect(0, 0, 100, 100);
+	canvas_fillStyle(previous);
+	paint_cleanup(&bench_paint);
+}
+
+static void bench_gradient(int radial)
+{
+	paint_t *previous = canvas_fillStyle_get();
+	
+	if(radial)
+	{
+		paint_createRadialGradient(&bench_paint, 100, 100, 80, 120, 120);
+	}
+	else
+	{
+		paint_createLinearGradient(&bench_paint, 0, 0, 200, 200);
+	}
+	
+	paint_addColorStop(&bench_paint, 0, 1, 0, 0, 1);
+	paint_addColorStop(&bench_paint, 0.5, 0, 1, 0, 1);
+	paint_addColorStop(&bench_paint, 1, 0, 0, 1, 1);
+	
+	canvas_fillStyle(&bench_paint);
+	canvas_fillRect(0, 0, 200, 200);
+	canvas_fillStyle(previous);
+	paint_cleanup(&bench_paint);
+}
+
+static void bench_gradient_linear(void) { bench_gradient(0); }
+static void bench_gradient_radial(void) { bench_gradient(1); }
+
+static void bench_style_switch_setup(void)
+{
+	paint_createLinearGradient(&bench_paint, 0, 0, 200, 200);
+	paint_addColorStop(&bench_paint, 0, 1, 0, 0, 1);
+	paint_addColorStop(&bench_paint, 1, 0, 0, 1, 1);
+}
+
+static void bench_style_switch(void)
+{
+	canvas__set_style_paint(0, &bench_paint);
+	canvas_fillRect(0, 0, 100, 100);
+	canvas__set_style_color(0, (bench_index % 255) / 255.0f, 0.5f, 0.25f, 1);
+	canvas_fillRect(0, 0, 100, 100);
+}
+
+static void bench_style_switch_teardown(void)
+{
+	canvas__set_style_color(0, 0, 0, 0, 1);
+	paint_cleanup(&bench_paint);
+}
+
+/* text */
+
+static void bench_fillText(void)
+{
+	canvas_fillText(bench_text, 10, 100);
+}
+
+static void bench_strokeText(void)
+{
+	canvas_strokeText(bench_text, 10, 100);
+}
+
+static void bench_fillTextBlob(void)
+{
+	canvas_fillTextBlob(bench_blob, 10, 100);
+}
+
+static void bench_strokeTextBlob(void)
+{
+	canvas_strokeTextBlob(bench_blob, 10, 100);
+}
+
+static void bench_measureText(void)
+{
+	canvas_measure_text_metrics_t metrics;
+	
+	canvas_measureText(&metrics, bench_text);
+}
+
+/* fonts */
+
+static void bench_font_load(void)
+{
+	font_util_new((char *)bench_font, "bench-load");
+	font_util_remove("bench-load");
+}
+
+/* colors */
+
+static void bench_color_parse(void)
+{
+	VGfloat rgba[4];
+	
+	color_util_parse("rgba(255, 128, 0, 0.5)", rgba);
+}
+
+static void bench_color_cached(void)
+{
+	VGfloat rgba[4];
+	
+	color_util_get("rgba(255, 128, 0, 0.5)", rgba);
+}
+
+/* images */
+
+static void bench_drawImage(void)
+{
+	canvas_drawImage(bench_image, 10, 10, bench_pixels_size, bench_pixels_size, 0, 0, bench_pixels_size, bench_pixels_size);
+}
+
+static void bench_drawImage_scaled(void)
+{
+	canvas_drawImage(bench_image, 10, 10, 100, 50, 16, 16, 128, 64);
+}
+
+static void bench_image_upload(void)
+{
+	image_cleanup(image_create(VG_sRGBA_8888, bench_pixels_size, bench_pixels_size, bench_pixels));
+}
+
+/* contexts */
+
+static canvas_context_t *bench_offscreen = NULL;
+
+static void bench_offscreen_setup(void)
+{
+	bench_offscreen = canvas__create_context(bench_pixels_size, bench_pixels_size);
+}
+
+static void bench_offscreen_teardown(void)
+{
+	canvas__destroy_context(bench_offscreen);
+	bench_offscreen = NULL;
+}
+
+// draw into the offscreen canvas and composite it onto the window
+static void bench_offscreen_draw(void)
+{
+	canvas_context_t *window = context_util_get_window();
+	
+	context_util_make_current(bench_offscreen);
+	canvas_fillRect(bench_index % 100, 20, 100, 100);
+	context_util_make_current(window);
+	canvas_drawImage(bench_offscreen->image, 10, 10, bench_pixels_size, bench_pixels_size, 0, 0, bench_pixels_size, bench_pixels_size);
+}
+
+/* layers */
+
+static void bench_layer_rects(void)
+{
+	if(layer_util_begin("rects", 0, 0, 800, 620))
+	{
+		bench_rects_64();
+	}
+	layer_util_end();
+}
+
+static void bench_layer_setup(void)
+{
+	bench_layer_rects();
+}
+
+static void bench_layer_teardown(void)
+{
+	layer_util_clear();
+}
+
+// composite the cached layer, moved every iteration
+static void bench_layer_replay(void)
+{
+	canvas_save();
+	canvas_translate(bench_index % 16, 0);
+	bench_layer_rects();
+	canvas_restore();
+}
+
+// record the layer every iteration
+static void bench_layer_record(void)
+{
+	layer_util_invalidate(NULL);
+	bench_layer_rects();
+}
+
+/* display lists */
+
+static displaylist_t *bench_displaylist = NULL;
+
+// records the calls of bench_rects_64 like the entry points do
+static void bench_displaylist_setup(void)
+{
+	VGfloat values[4] = { 0, 0, 10, 10 };
+	int i = 0;
+	
+	bench_displaylist = displaylist_util_create();
+	displaylist_util_begin(bench_displaylist);
+	displaylist_util_record(DISPLAYLIST_BEGIN_PATH, 0, NULL);
+	
+	for(i = 0; i < 64; i++)
+	{
+		values[0] = i * 12;
+		values[1] = (i * 37) % 600;
+		displaylist_util_record(DISPLAYLIST_RECT, 4, values);
+	}
+	
+	displaylist_util_record(DISPLAYLIST_FILL, 0, NULL);
+	displaylist_util_end();
+}
+
+static void bench_displaylist_teardown(void)
+{
+	displaylist_util_destroy(bench_displaylist);
+	bench_displaylist = NULL;
+}
+
+static void bench_displaylist_replay(void)
+{
+	displaylist_util_replay(bench_displaylist, NULL);
+}
+
+static void bench_displaylist_serialize(void)
+{
+	size_t size = 0;
+	char *data = displaylist_util_serialize(bench_displaylist, &size);
+	
+	displaylist_util_destroy(displaylist_util_deserialize(data, size));
+	free(data);
+}
+
+/* tiles */
+
+#define BENCH_FRAME_WIDTH 3840
+#define BENCH_FRAME_HEIGHT 2160
+
+static char *bench_frame = NULL;
+
+static void bench_frame_setup(void)
+{
+	size_t i = 0;
+	
+	bench_frame = malloc((size_t)BENCH_FRAME_WIDTH * BENCH_FRAME_HEIGHT * 4);
+	
+	for(i = 0; i < (size_t)BENCH_FRAME_WIDTH * BENCH_FRAME_HEIGHT * 4; i++)
+	{
+		bench_frame[i] = (char)((i / 4) % BENCH_FRAME_WIDTH / 16 + (i * 2654435761u >> 28));
+	}
+}
+
+static void bench_frame_teardown(void)
+{
+	free(bench_frame);
+	bench_frame = NULL;
+}
+
+// 4096 small paths spread over the whole frame
+static void bench_tiles_setup(void)
+{
+	VGfloat values[4] = { 0, 0, 24, 24 };
+	int i = 0;
+	
+	bench_displaylist = displaylist_util_create();
+	displaylist_util_begin(bench_displaylist);
+	
+	for(i = 0; i < 4096; i++)
+	{
+		values[0] = (i * 97) % (BENCH_FRAME_WIDTH - 24);
+		values[1] = (i * 53) % (BENCH_FRAME_HEIGHT - 24);
+		displaylist_util_record(DISPLAYLIST_BEGIN_PATH, 0, NULL);
+		displaylist_util_record(DISPLAYLIST_RECT, 4, values);
+		displaylist_util_record(DISPLAYLIST_FILL, 0, NULL);
+	}
+	
+	displaylist_util_end();
+}
+
+static void bench_tile_bin(int threads)
+{
+	tile_util_free(tile_util_bin(bench_displaylist, BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT, 0, threads));
+}
+
+static void bench_tile_bin_1(void) { bench_tile_bin(1); }
+static void bench_tile_bin_4(void) { bench_tile_bin(4); }
+static void bench_tile_bin_16(void) { bench_tile_bin(16); }
+
+static void bench_tile_render(void)
+{
+	free(tile_util_render(bench_displaylist, BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT, 0, 4));
+}
+
+/* readback */
+
+static void bench_readback_done(void *user, char *data, VGint width, VGint height)
+{
+	free(data);
+}
+
+static void bench_readback_full(void)
+{
+	readback_util_request(0, 0, egl_get_width(), egl_get_height(), bench_readback_done, NULL);
+	readback_util_flush();
+}
+
+static void bench_readback_region(void)
+{
+	readback_util_request(0, 0, 256, 256, bench_readback_done, NULL);
+	readback_util_flush();
+}
+
+/* encoding */
+
+static void bench_encode(const char *type, int compression)
+{
+	image_encoder_t encoder;
+	size_t size = 0;
+	
+	image_encoder_defaults(&encoder);
+	if(compression >= 0)
+	{
+		encoder.compression = compression;
+	}
+	
+	free(image_to_blob(bench_pixels, bench_pixels_size, bench_pixels_size, type, &encoder, &size));
+}
+
+// PNG of a 4K frame, encoded in strips on up to threads threads
+static void bench_encode_frame(int threads)
+{
+	size_t size = 0;
+	
+	free(encode_png(bench_frame, BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT, 1, ENCODE_FILTER_UP, threads, &size));
+}
+
+static void bench_encode_png(void) { bench_encode("image/png", -1); }
+static void bench_encode_png_fast(void) { bench_encode("image/png", 1); }
+static void bench_encode_jpeg(void) { bench_encode("image/jpeg", -1); }
+static void bench_encode_qoi(void) { bench_encode("image/x-qoi", -1); }
+static void bench_encode_frame_1(void) { bench_encode_frame(1); }
+static void bench_encode_frame_2(void) { bench_encode_frame(2); }
+static void bench_encode_frame_4(void) { bench_encode_frame(4); }
+static void bench_encode_frame_8(void) { bench_encode_frame(8); }
+static void bench_encode_frame_16(void) { bench_encode_frame(16); }
+
+static const bench_t benchmarks[] = {
+	{ "rect/fillRect", NULL, bench_fillRect, NULL, 0 },
+	{ "rect/strokeRect", NULL, bench_strokeRect, NULL, 0 },
+	{ "rect/clearRect", NULL, bench_clearRect, NULL, 0 },
+	{ "path/lines-8", NULL, bench_lines_8, NULL, 0 },
+	{ "path/lines-64", NULL, bench_lines_64, NULL, 0 },
+	{ "path/lines-512", NULL, bench_lines_512, NULL, 0 },
+	{ "path/lines-1m", NULL, bench_lines_1m, NULL, 0 },
+	{ "path/polyline-512", bench_points_512_setup, bench_polyline, bench_points_teardown, 0 },
+	{ "path/polyline-1m", bench_points_1m_setup, bench_polyline, bench_points_teardown, 0 },
+	{ "path/series-500k", bench_series_setup, bench_series, bench_series_teardown, 0 },
+	{ "path/series-500k-raw", bench_series_setup, bench_series_raw, bench_series_teardown, 0 },
+	{ "cull/list-1000", NULL, bench_list_culled, NULL, 0 },
+	{ "cull/list-1000-off", NULL, bench_list_unculled, NULL, 0 },
+	{ "hit/path-circle-64", bench_hit_circle_setup, bench_hit_path, NULL, 0 },
+	{ "hit/stroke-circle-64", bench_hit_circle_setup, bench_hit_stroke, NULL, 0 },
+	{ "hit/path-polygon-64", bench_hit_polygon_setup, bench_hit_path, NULL, 0 },
+	{ "hit/regions-5000-add", NULL, bench_regions_add, bench_regions_teardown, 0 },
+	{ "hit/regions-5000-update-64", bench_regions_setup, bench_regions_update, bench_regions_teardown, 0 },
+	{ "hit/regions-5000-test-64", bench_regions_setup, bench_regions_test, bench_regions_teardown, 0 },
+	{ "path/dashed-64", NULL, bench_dashed_64, NULL, 0 },
+	{ "path/bezier-64", NULL, bench_bezier_64, NULL, 0 },
+	{ "path/quadratic-64", NULL, bench_quadratic_64, NULL, 0 },
+	{ "path/arc", NULL, bench_arc, NULL, 0 },
+	{ "scatter/arcs-10k", bench_scatter_setup, bench_scatter_arcs, bench_scatter_teardown, 0 },
+	{ "scatter/path-10k", bench_scatter_setup, bench_scatter_path, bench_scatter_teardown, 0 },
+	{ "scatter/circles-10k", bench_scatter_setup, bench_scatter_circles, bench_scatter_teardown, 0 },
+	{ "path/rects-64", NULL, bench_rects_64, NULL, 0 },
+	{ "state/save-restore-1", NULL, bench_save_restore_1, NULL, 0 },
+	{ "state/save-restore-8", NULL, bench_save_restore_8, NULL, 0 },
+	{ "state/save-restore-32", NULL, bench_save_restore_32, NULL, 0 },
+	{ "state/transform", NULL, bench_transform, NULL, 0 },
+	{ "state/clip", NULL, bench_clip, NULL, 0 },
+	{ "paint/color", NULL, bench_color, NULL, 0 },
+	{ "paint/linear-gradient", NULL, bench_gradient_linear, NULL, 0 },
+	{ "paint/radial-gradient", NULL, bench_gradient_radial, NULL, 0 },
+	{ "paint/style-switch", bench_style_switch_setup, bench_style_switch, bench_style_switch_teardown, 0 },
+	{ "paint/color-parse", NULL, bench_color_parse, NULL, 0 },
+	{ "paint/color-cached", NULL, bench_color_cached, NULL, 0 },
+	{ "text/fillText-8", bench_text_8, bench_fillText, NULL, 1 },
+	{ "text/fillText-64", bench_text_64, bench_fillText, NULL, 1 },
+	{ "text/fillText-256", bench_text_256, bench_fillText, NULL, 1 },
+	{ "text/fillText-atlas-64", bench_atlas_setup, bench_fillText, bench_atlas_teardown, 1 },
+	{ "text/strokeText-64", bench_text_64, bench_strokeText, NULL, 1 },
+	{ "text/fillTextBlob-64", bench_blob_setup, bench_fillTextBlob, bench_blob_teardown, 1 },
+	{ "text/strokeTextBlob-64", bench_blob_setup, bench_strokeTextBlob, bench_blob_teardown, 1 },
+	{ "text/measureText-64", bench_text_64, bench_measureText, NULL, 1 },
+	{ "text/loadFont", NULL, bench_font_load, NULL, 1 },
+	{ "text/loadFont-cached", bench_font_cache_setup, bench_font_load, bench_font_cache_teardown, 1 },
+	{ "image/drawImage", bench_image_setup, bench_drawImage, bench_image_teardown, 0 },
+	{ "image/drawImage-scaled", bench_image_setup, bench_drawImage_scaled, bench_image_teardown, 0 },
+	{ "image/upload", bench_pixels_setup, bench_image_upload, bench_pixels_teardown, 0 },
+	{ "context/offscreen-draw", bench_offscreen_setup, bench_offscreen_draw, bench_offscreen_teardown, 0 },
+	{ "layer/replay-64", bench_layer_setup, bench_layer_replay, bench_layer_teardown, 0 },
+	{ "layer/record-64", bench_layer_setup, bench_layer_record, bench_layer_teardown, 0 },
+	{ "displaylist/replay-64", bench_displaylist_setup, bench_displaylist_replay, bench_displaylist_teardown, 0 },
+	{ "displaylist/serialize-64", bench_displaylist_setup, bench_displaylist_serialize, bench_displaylist_teardown, 0 },
+	{ "tile/bin-4k-t1", bench_tiles_setup, bench_tile_bin_1, bench_displaylist_teardown, 0 },
+	{ "tile/bin-4k-t4", bench_tiles_setup, bench_tile_bin_4, bench_displaylist_teardown, 0 },
+	{ "tile/bin-4k-t16", bench_tiles_setup, bench_tile_bin_16, bench_displaylist_teardown, 0 },
+	{ "tile/render-4k", bench_tiles_setup, bench_tile_render, bench_displaylist_teardown, 0 },
+	{ "readback/full", NULL, bench_readback_full, NULL, 0 },
+	{ "readback/region", NULL, bench_readback_region, NULL, 0 },
+	{ "encode/png", bench_pixels_setup, bench_encode_png, bench_pixels_teardown, 0 },
+	{ "encode/png-fast", bench_pixels_setup, bench_encode_png_fast, bench_pixels_teardown, 0 },
+	{ "encode/jpeg", bench_pixels_setup, bench_encode_jpeg, bench_pixels_teardown, 0 },
+	{ "encode/qoi", bench_pixels_setup, bench_encode_qoi, bench_pixels_teardown, 0 },
+	{ "encode/png-4k-t1", bench_frame_setup, bench_encode_frame_1, bench_frame_teardown, 0 },
+	{ "encode/png-4k-t2", bench_frame_setup, bench_encode_frame_2, bench_frame_teardown, 0 },
+	{ "encode/png-4k-t4", bench_frame_setup, bench_encode_frame_4, bench_frame_teardown, 0 },
+	{ "encode/png-4k-t8", bench_frame_setup, bench_encode_frame_8, bench_frame_teardown, 0 },
+	{ "encode/png-4k-t16", bench_frame_setup, bench_encode_frame_16, bench_frame_teardown, 0 }
+};
+
+#define BENCH_AMOUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+/**
+ * Runs a benchmark until it took at least min_time and prints the result.
+ *
+ * @param bench The benchmark
+ * @param min_time Minimum time in ns
+ * @param first Whether this is the first result
+ */
+static void bench_run(const bench_t *bench, uint64_t min_time, int first)
+{
+	record_vg_stats_t vg;
+	unsigned long iterations = 1;
+	unsigned long allocs = 0;
+	unsigned long alloc_bytes = 0;
+	uint64_t start = 0;
+	uint64_t elapsed = 0;
+	unsigned long i = 0;
+	
+	if(bench->setup)
+	{
+		bench->setup();
+	}
+	
+	// warm up caches (glyph paths, staging images)
+	bench->run();
+	
+	for(;;)
+	{
+		record_vg_reset();
+		allocs = bench_allocs;
+		alloc_bytes = bench_alloc_bytes;
+		
+		start = bench_now();
+		
+		for(i = 0; i < iterations; i++)
+		{
+			bench_index = i;
+			bench->run();
+		}
+		
+		elapsed = bench_now() - start;
+		
+		if(elapsed >= min_time || iterations >= 1UL << 30)
+		{
+			break;
+		}
+		
+		// aim a bit above the minimum time to avoid another round
+		iterations = elapsed > 0 ? iterations * 1.2 * min_time / elapsed + 1 : iterations * 100;
+	}
+	
+	allocs = bench_allocs - allocs;
+	alloc_bytes = bench_alloc_bytes - alloc_bytes;
+	record_vg_get_stats(&vg);
+	
+	if(bench->teardown)
+	{
+		bench->teardown();
+	}
+	
+	printf("%s\n\t\t{\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f, \"vg_calls_per_op\": %.2f, \"draws_per_op\": %.2f, \"state_changes_per_op\": %.2f, \"path_segments_per_op\": %.2f, \"pixels_per_op\": %.1f}",
+		first ? "" : ",",
+		bench->name,
+		iterations,
+		(double)elapsed / iterations,
+		(double)allocs / iterations,
+		(double)alloc_bytes / iterations,
+		(double)vg.calls / iterations,
+		(double)vg.draws / iterations,
+		(double)vg.state_changes / iterations,
+		(double)vg.path_segments / iterations,
+		(double)vg.pixels / iterations);
+	fflush(stdout);
+}
+
+static void bench_usage(const char *name)
+{
+	eprintf("Usage: %s [-t min_time_ms] [-f filter] [-F font] [-s WIDTHxHEIGHT] [-l]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	const char *filter = NULL;
+	double min_time = 200;
+	unsigned int width = 1920;
+	unsigned int height = 1080;
+	int has_font = 0;
+	int first = 1;
+	int option = 0;
+	unsigned int i = 0;
+	
+	while((option = getopt(argc, argv, "t:f:F:s:lh")) != -1)
+	{
+		switch(option)
+		{
+			case 't':
+				min_time = atof(optarg);
+				break;
+			case 'f':
+				filter = optarg;
+				break;
+			case 'F':
+				bench_font = optarg;
+				break;
+			case 's':
+				if(sscanf(optarg, "%ux%u", &width, &height) != 2)
+				{
+					bench_usage(argv[0]);
+					return 1;
+				}
+				break;
+			case 'l':
+				for(i = 0; i < BENCH_AMOUNT; i++)
+				{
+					printf("%s\n", benchmarks[i].name);
+				}
+				return 0;
+			default:
+				bench_usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+	
+	record_vg_set_size(width, height);
+	canvas__init();
+	
+	// swaps are not measured, keep everything on this thread
+	present_util_set_threaded(0);
+	
+	if(font_util_new((char *)bench_font, "bench") >= 0)
+	{
+		canvas_font("bench", 20);
+		has_font = 1;
+	}
+	else
+	{
+		eprintf("Failed to load font %s, skipping text benchmarks.\n", bench_font);
+	}
+	
+	printf("{\n\t\"width\": %u,\n\t\"height\": %u,\n\t\"min_time_ms\": %g,\n\t\"benchmarks\": [", width, height, min_time);
+	
+	for(i = 0; i < BENCH_AMOUNT; i++)
+	{
+		if(filter && !strstr(benchmarks[i].name, filter))
+		{
+			continue;
+		}
+		
+		if(benchmarks[i].needs_font && !has_font)
+		{
+			continue;
+		}
+		
+		bench_run(&benchmarks[i], min_time * 1e6, first);
+		first = 0;
+	}
+	
+	printf("\n\t]\n}\n");
+	
+	canvas__cleanup();
+	
+	return 0;
+}
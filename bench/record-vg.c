@@ -0,0 +1,622 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "record-vg.h"
+
+/*
+ * Recording implementation of the OpenVG, VGU, EGL, GLES and dispmanx
+ * functions used by the canvas. Nothing is rendered: calls are counted, the
+ * matrix state is kept (the dirty region tracking depends on it) and pixel
+ * transfers touch the client memory, so the benchmarks measure the cost of the
+ * canvas layer itself without a Raspberry Pi.
+ */
+
+#define RECORD_MATRIX_MODES 5
+
+static record_vg_stats_t stats;
+static uint32_t screen_width = 1920;
+static uint32_t screen_height = 1080;
+static VGHandle next_handle = 1;
+static VGint matrix_mode = VG_MATRIX_PATH_USER_TO_SURFACE;
+static VGfloat matrices[RECORD_MATRIX_MODES][9];
+
+/**
+ * Sets the size returned by graphics_get_display_size(). Must be called before
+ * the canvas is initialized.
+ *
+ * @param width The width
+ * @param height The height
+ */
+void record_vg_set_size(uint32_t width, uint32_t height)
+{
+	screen_width = width;
+	screen_height = height;
+}
+
+/**
+ * Copies the counters.
+ *
+ * @param out Pointer where to write the counters to
+ */
+void record_vg_get_stats(record_vg_stats_t *out)
+{
+	*out = stats;
+}
+
+/**
+ * Resets all counters except the amount of live handles.
+ */
+void record_vg_reset(void)
+{
+	unsigned long handles = stats.handles;
+	
+	memset(&stats, 0, sizeof(stats));
+	stats.handles = handles;
+}
+
+static VGHandle record_vg_create(void)
+{
+	stats.calls++;
+	stats.handles++;
+	
+	return next_handle++;
+}
+
+static void record_vg_destroy(VGHandle handle)
+{
+	stats.calls++;
+	
+	if(handle != VG_INVALID_HANDLE)
+	{
+		stats.handles--;
+	}
+}
+
+static VGfloat *record_vg_matrix(void)
+{
+	return matrices[matrix_mode - VG_MATRIX_PATH_USER_TO_SURFACE];
+}
+
+/**
+ * Multiplies the current matrix by the given one (column-major like OpenVG).
+ */
+static void record_vg_multiply(const VGfloat *m)
+{
+	VGfloat *current = record_vg_matrix();
+	VGfloat result[9];
+	int column = 0;
+	int row = 0;
+	
+	for(column = 0; column < 3; column++)
+	{
+		for(row = 0; row < 3; row++)
+		{
+			result[column * 3 + row] = current[row] * m[column * 3] + current[3 + row] * m[column * 3 + 1] + current[6 + row] * m[column * 3 + 2];
+		}
+	}
+	
+	memcpy(current, result, sizeof(result));
+}
+
+/* OpenVG */
+
+VGErrorCode vgGetError(void)
+{
+	stats.calls++;
+	
+	return VG_NO_ERROR;
+}
+
+void vgFlush(void)
+{
+	stats.calls++;
+}
+
+void vgFinish(void)
+{
+	stats.calls++;
+}
+
+void vgSeti(VGParamType type, VGint value)
+{
+	stats.calls++;
+	stats.state_changes++;
+	
+	if(type == VG_MATRIX_MODE && value >= VG_MATRIX_PATH_USER_TO_SURFACE && value < VG_MATRIX_PATH_USER_TO_SURFACE + RECORD_MATRIX_MODES)
+	{
+		matrix_mode = value;
+	}
+}
+
+void vgSetf(VGParamType type, VGfloat value)
+{
+	stats.calls++;
+	stats.state_changes++;
+}
+
+void vgSetfv(VGParamType type, VGint count, const VGfloat *values)
+{
+	stats.calls++;
+	stats.state_changes++;
+}
+
+VGint vgGeti(VGParamType type)
+{
+	stats.calls++;
+	
+	switch(type)
+	{
+		case VG_MATRIX_MODE:
+			return matrix_mode;
+		case VG_MAX_IMAGE_WIDTH:
+		case VG_MAX_IMAGE_HEIGHT:
+			return 2048;
+		case VG_MAX_IMAGE_PIXELS:
+			return 2048 * 2048;
+		default:
+			return 0;
+	}
+}
+
+void vgSetParameteri(VGHandle object, VGint type, VGint value)
+{
+	stats.calls++;
+	stats.state_changes++;
+}
+
+void vgSetParameterfv(VGHandle object, VGint type, VGint count, const VGfloat *values)
+{
+	stats.calls++;
+	stats.state_changes++;
+}
+
+VGint vgGetParameteri(VGHandle object, VGint type)
+{
+	stats.calls++;
+	
+	return 0;
+}
+
+void vgGetParameterfv(VGHandle object, VGint type, VGint count, VGfloat *values)
+{
+	stats.calls++;
+	
+	memset(values, 0, count * sizeof(VGfloat));
+}
+
+void vgLoadIdentity(void)
+{
+	VGfloat *current = record_vg_matrix();
+	
+	stats.calls++;
+	stats.state_changes++;
+	
+	memset(current, 0, 9 * sizeof(VGfloat));
+	current[0] = current[4] = current[8] = 1;
+}
+
+void vgLoadMatrix(const VGfloat *m)
+{
+	stats.calls++;
+	stats.state_changes++;
+	
+	memcpy(record_vg_matrix(), m, 9 * sizeof(VGfloat));
+}
+
+void vgGetMatrix(VGfloat *m)
+{
+	stats.calls++;
+	
+	memcpy(m, record_vg_matrix(), 9 * sizeof(VGfloat));
+}
+
+void vgMultMatrix(const VGfloat *m)
+{
+	stats.calls++;
+	stats.state_changes++;
+	
+	record_vg_multiply(m);
+}
+
+void vgTranslate(VGfloat tx, VGfloat ty)
+{
+	VGfloat m[9] = { 1, 0, 0, 0, 1, 0, tx, ty, 1 };
+	
+	vgMultMatrix(m);
+}
+
+void vgScale(VGfloat sx, VGfloat sy)
+{
+	VGfloat m[9] = { sx, 0, 0, 0, sy, 0, 0, 0, 1 };
+	
+	vgMultMatrix(m);
+}
+
+void vgShear(VGfloat shx, VGfloat shy)
+{
+	VGfloat m[9] = { 1, shy, 0, shx, 1, 0, 0, 0, 1 };
+	
+	vgMultMatrix(m);
+}
+
+void vgRotate(VGfloat angle)
+{
+	VGfloat c = cosf(angle * M_PI / 180);
+	VGfloat s = sinf(angle * M_PI / 180);
+	VGfloat m[9] = { c, s, 0, -s, c, 0, 0, 0, 1 };
+	
+	vgMultMatrix(m);
+}
+
+void vgMask(VGHandle mask, VGMaskOperation operation, VGint x, VGint y, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.draws++;
+}
+
+void vgRenderToMask(VGPath path, VGbitfield paintModes, VGMaskOperation operation)
+{
+	stats.calls++;
+	stats.draws++;
+}
+
+VGMaskLayer vgCreateMaskLayer(VGint width, VGint height)
+{
+	return record_vg_create();
+}
+
+void vgDestroyMaskLayer(VGMaskLayer maskLayer)
+{
+	record_vg_destroy(maskLayer);
+}
+
+void vgCopyMask(VGMaskLayer maskLayer, VGint dx, VGint dy, VGint sx, VGint sy, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.pixels += width * height;
+}
+
+void vgClear(VGint x, VGint y, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.draws++;
+}
+
+VGPath vgCreatePath(VGint pathFormat, VGPathDatatype datatype, VGfloat scale, VGfloat bias, VGint segmentCapacityHint, VGint coordCapacityHint, VGbitfield capabilities)
+{
+	return record_vg_create();
+}
+
+void vgClearPath(VGPath path, VGbitfield capabilities)
+{
+	stats.calls++;
+}
+
+void vgDestroyPath(VGPath path)
+{
+	record_vg_destroy(path);
+}
+
+void vgAppendPathData(VGPath dstPath, VGint numSegments, const VGubyte *pathSegments, const void *pathData)
+{
+	stats.calls++;
+	stats.path_segments += numSegments;
+}
+
+void vgTransformPath(VGPath dstPath, VGPath srcPath)
+{
+	stats.calls++;
+}
+
+void vgDrawPath(VGPath path, VGbitfield paintModes)
+{
+	stats.calls++;
+	stats.draws++;
+}
+
+VGPaint vgCreatePaint(void)
+{
+	return record_vg_create();
+}
+
+void vgDestroyPaint(VGPaint paint)
+{
+	record_vg_destroy(paint);
+}
+
+void vgSetPaint(VGPaint paint, VGbitfield paintModes)
+{
+	stats.calls++;
+	stats.state_changes++;
+}
+
+void vgPaintPattern(VGPaint paint, VGImage pattern)
+{
+	stats.calls++;
+	stats.state_changes++;
+}
+
+VGImage vgCreateImage(VGImageFormat format, VGint width, VGint height, VGbitfield allowedQuality)
+{
+	return record_vg_create();
+}
+
+void vgDestroyImage(VGImage image)
+{
+	record_vg_destroy(image);
+}
+
+VGImage vgChildImage(VGImage parent, VGint x, VGint y, VGint width, VGint height)
+{
+	return record_vg_create();
+}
+
+void vgClearImage(VGImage image, VGint x, VGint y, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.draws++;
+	stats.pixels += width * height;
+}
+
+void vgImageSubData(VGImage image, const void *data, VGint dataStride, VGImageFormat dataFormat, VGint x, VGint y, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.pixels += width * height;
+}
+
+void vgGetImageSubData(VGImage image, void *data, VGint dataStride, VGImageFormat dataFormat, VGint x, VGint y, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.pixels += width * height;
+	
+	// only width pixels of each row are written
+	for(; height > 0; height--)
+	{
+		memset((char *)data + (height - 1) * dataStride, 0x80, width * 4);
+	}
+}
+
+void vgDrawImage(VGImage image)
+{
+	stats.calls++;
+	stats.draws++;
+}
+
+void vgGetPixels(VGImage dst, VGint dx, VGint dy, VGint sx, VGint sy, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.pixels += width * height;
+}
+
+void vgReadPixels(void *data, VGint dataStride, VGImageFormat dataFormat, VGint sx, VGint sy, VGint width, VGint height)
+{
+	stats.calls++;
+	stats.pixels += width * height;
+	
+	// only width pixels of each row are written
+	for(; height > 0; height--)
+	{
+		memset((char *)data + (height - 1) * dataStride, 0x80, width * 4);
+	}
+}
+
+const VGubyte *vgGetString(VGStringID name)
+{
+	stats.calls++;
+	
+	return (const VGubyte *)"recording";
+}
+
+/* VGU */
+
+VGUErrorCode vguRect(VGPath path, VGfloat x, VGfloat y, VGfloat width, VGfloat height)
+{
+	stats.calls++;
+	stats.path_segments += 5;
+	
+	return VGU_NO_ERROR;
+}
+
+VGUErrorCode vguArc(VGPath path, VGfloat x, VGfloat y, VGfloat width, VGfloat height, VGfloat startAngle, VGfloat angleExtent, VGUArcType arcType)
+{
+	stats.calls++;
+	stats.path_segments += 5;
+	
+	return VGU_NO_ERROR;
+}
+
+/* EGL */
+
+EGLDisplay eglGetDisplay(EGLNativeDisplayType display_id)
+{
+	stats.calls++;
+	
+	return (EGLDisplay)1;
+}
+
+EGLBoolean eglInitialize(EGLDisplay dpy, EGLint *major, EGLint *minor)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLBoolean eglTerminate(EGLDisplay dpy)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLBoolean eglBindAPI(EGLenum api)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLBoolean eglChooseConfig(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig *configs, EGLint config_size, EGLint *num_config)
+{
+	stats.calls++;
+	
+	*configs = (EGLConfig)1;
+	*num_config = 1;
+	
+	return EGL_TRUE;
+}
+
+EGLContext eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint *attrib_list)
+{
+	stats.calls++;
+	
+	return (EGLContext)1;
+}
+
+EGLBoolean eglDestroyContext(EGLDisplay dpy, EGLContext ctx)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLSurface eglCreateWindowSurface(EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint *attrib_list)
+{
+	stats.calls++;
+	
+	return (EGLSurface)1;
+}
+
+EGLSurface eglCreatePbufferFromClientBuffer(EGLDisplay dpy, EGLenum buftype, EGLClientBuffer buffer, EGLConfig config, const EGLint *attrib_list)
+{
+	stats.calls++;
+	
+	return (EGLSurface)2;
+}
+
+EGLBoolean eglDestroySurface(EGLDisplay dpy, EGLSurface surface)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLBoolean eglSurfaceAttrib(EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint value)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLBoolean eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+EGLBoolean eglSwapBuffers(EGLDisplay dpy, EGLSurface surface)
+{
+	stats.calls++;
+	
+	return EGL_TRUE;
+}
+
+const char *eglQueryString(EGLDisplay dpy, EGLint name)
+{
+	stats.calls++;
+	
+	return "";
+}
+
+__eglMustCastToProperFunctionPointerType eglGetProcAddress(const char *procname)
+{
+	stats.calls++;
+	
+	return NULL;
+}
+
+/* GLES */
+
+void glClear(GLbitfield mask)
+{
+	stats.calls++;
+}
+
+GLenum glGetError(void)
+{
+	stats.calls++;
+	
+	return 0;
+}
+
+/* bcm_host and dispmanx */
+
+void bcm_host_init(void)
+{
+	int i = 0;
+	
+	// all matrices start as identity
+	for(i = 0; i < RECORD_MATRIX_MODES; i++)
+	{
+		memset(matrices[i], 0, sizeof(matrices[i]));
+		matrices[i][0] = matrices[i][4] = matrices[i][8] = 1;
+	}
+	
+	matrix_mode = VG_MATRIX_PATH_USER_TO_SURFACE;
+}
+
+void bcm_host_deinit(void)
+{
+}
+
+int32_t graphics_get_display_size(const uint16_t display_number, uint32_t *width, uint32_t *height)
+{
+	*width = screen_width;
+	*height = screen_height;
+	
+	return 0;
+}
+
+DISPMANX_DISPLAY_HANDLE_T vc_dispmanx_display_open(uint32_t device)
+{
+	return 1;
+}
+
+DISPMANX_UPDATE_HANDLE_T vc_dispmanx_update_start(int32_t priority)
+{
+	return 1;
+}
+
+DISPMANX_ELEMENT_HANDLE_T vc_dispmanx_element_add(DISPMANX_UPDATE_HANDLE_T update, DISPMANX_DISPLAY_HANDLE_T display, int32_t layer, const VC_RECT_T *dest_rect, DISPMANX_RESOURCE_HANDLE_T src, const VC_RECT_T *src_rect, DISPMANX_PROTECTION_T protection, VC_DISPMANX_ALPHA_T *alpha, DISPMANX_CLAMP_T *clamp, DISPMANX_TRANSFORM_T transform)
+{
+	return 1;
+}
+
+int vc_dispmanx_update_submit_sync(DISPMANX_UPDATE_HANDLE_T update)
+{
+	return 0;
+}
+
+int vc_dispmanx_vsync_callback(DISPMANX_DISPLAY_HANDLE_T display, DISPMANX_CALLBACK_FUNC_T cb_func, void *cb_arg)
+{
+	// no vsync without a display
+	return cb_func ? -1 : 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RECORD_VG_H__
+#define __RECORD_VG_H__
+
+#include <stdint.h>
+
+typedef struct record_vg_stats_t
+{
+	unsigned long calls; // all OpenVG, VGU, EGL and GL calls
+	unsigned long draws; // vgDrawPath, vgDrawImage, vgClear and vgMask
+	unsigned long state_changes; // vgSet*, vgSetParameter*, vgSetPaint and matrix loads
+	unsigned long path_segments; // segments appended to paths
+	unsigned long pixels; // pixels uploaded, read back or copied
+	unsigned long handles; // live paths, paints, images and mask layers
+} record_vg_stats_t;
+
+void record_vg_set_size(uint32_t width, uint32_t height);
+void record_vg_get_stats(record_vg_stats_t *stats);
+void record_vg_reset(void);
+
+#endif /* __RECORD_VG_H__ */
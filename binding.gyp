@@ -1,59 +1,92 @@
 {
+  "variables": {
+    "canvas_sources": [
+      "src/canvas-arc.c",
+      "src/canvas-arcTo.c",
+      "src/canvas-beginPath.c",
+      "src/canvas-bezierCurveTo.c",
+      "src/canvas-clearRect.c",
+      "src/canvas-clip.c",
+      "src/canvas-closePath.c",
+      "src/canvas-drawCircles.c",
+      "src/canvas-drawImage.c",
+      "src/canvas-ellipse.c",
+      "src/canvas-fill.c",
+      "src/canvas-fillRect.c",
+      "src/canvas-fillStyle.c",
+      "src/canvas-fillText.c",
+      "src/canvas-fillTextBlob.c",
+      "src/canvas-font.c",
+      "src/canvas-globalAlpha.c",
+      "src/canvas-globalCompositeOperation.c",
+      "src/canvas-imageSmoothingEnabled.c",
+      "src/canvas-kerning.c",
+      "src/canvas-lineCap.c",
+      "src/canvas-lineDashOffset.c",
+      "src/canvas-lineJoin.c",
+      "src/canvas-lineTo.c",
+      "src/canvas-lineWidth.c",
+      "src/canvas-measureText.c",
+      "src/canvas-miterLimit.c",
+      "src/canvas-moveTo.c",
+      "src/canvas-paint.c",
+      "src/canvas-polyline.c",
+      "src/canvas-quadraticCurveTo.c",
+      "src/canvas-rect.c",
+      "src/canvas-resetTransform.c",
+      "src/canvas-restore.c",
+      "src/canvas-rotate.c",
+      "src/canvas-save.c",
+      "src/canvas-scale.c",
+      "src/canvas-setLineDash.c",
+      "src/canvas-setTransform.c",
+      "src/canvas-stroke.c",
+      "src/canvas-strokeRect.c",
+      "src/canvas-strokeSeries.c",
+      "src/canvas-strokeStyle.c",
+      "src/canvas-strokeText.c",
+      "src/canvas-strokeTextBlob.c",
+      "src/canvas-textAlign.c",
+      "src/canvas-textBaseline.c",
+      "src/canvas-transform.c",
+      "src/canvas-translate.c",
+      "src/canvas.c",
+      "src/color-util.c",
+      "src/context-util.c",
+      "src/cull-util.c",
+      "src/path-util.c",
+      "src/hit-util.c",
+      "src/dirty-util.c",
+      "src/displaylist-util.c",
+      "src/egl-util.c",
+      "src/encode-util.c",
+      "src/font-util.c",
+      "src/image-util.c",
+      "src/layer-util.c",
+      "src/memory-util.c",
+      "src/pool-util.c",
+      "src/present-util.c",
+      "src/profile-util.c",
+      "src/readback-util.c",
+      "src/textblob-util.c",
+      "src/tile-util.c",
+      "src/trace-util.c",
+      "src/version.c"
+    ]
+  },
   "targets": [
     {
       "target_name": "vgcanvas",
       "sources": [
         "src/vgcanvas.cc",
+        "src/context.cc",
+        "src/displaylist.cc",
         "src/gradient.cc",
         "src/image.cc",
         "src/pattern.cc",
-        "src/canvas-arc.c",
-        "src/canvas-beginPath.c",
-        "src/canvas-bezierCurveTo.c",
-        "src/canvas-clearRect.c",
-        "src/canvas-clip.c",
-        "src/canvas-closePath.c",
-        "src/canvas-drawImage.c",
-        "src/canvas-fill.c",
-        "src/canvas-fillRect.c",
-        "src/canvas-fillStyle.c",
-        "src/canvas-fillText.c",
-        "src/canvas-font.c",
-        "src/canvas-globalAlpha.c",
-        "src/canvas-globalCompositeOperation.c",
-        "src/canvas-imageSmoothingEnabled.c",
-        "src/canvas-kerning.c",
-        "src/canvas-lineCap.c",
-        "src/canvas-lineDashOffset.c",
-        "src/canvas-lineJoin.c",
-        "src/canvas-lineTo.c",
-        "src/canvas-lineWidth.c",
-        "src/canvas-measureText.c",
-        "src/canvas-miterLimit.c",
-        "src/canvas-moveTo.c",
-        "src/canvas-paint.c",
-        "src/canvas-quadraticCurveTo.c",
-        "src/canvas-rect.c",
-        "src/canvas-resetTransform.c",
-        "src/canvas-restore.c",
-        "src/canvas-rotate.c",
-        "src/canvas-save.c",
-        "src/canvas-scale.c",
-        "src/canvas-setLineDash.c",
-        "src/canvas-setTransform.c",
-        "src/canvas-stroke.c",
-        "src/canvas-strokeRect.c",
-        "src/canvas-strokeStyle.c",
-        "src/canvas-strokeText.c",
-        "src/canvas-textAlign.c",
-        "src/canvas-textBaseline.c",
-        "src/canvas-transform.c",
-        "src/canvas-translate.c",
-        "src/canvas.c",
-        "src/egl-util.c",
-        "src/font-util.c",
-        "src/image-util.c",
-        "src/version.c"
+        "src/scheduler.cc",
+        "src/textblob.cc",
+        "<@(canvas_sources)"
       ],
       "include_dirs": [
         "<!(node -e \"require('nan')\")",
@@ -74,13 +107,47 @@
           "-lpthread",
           "-lrt",
           "-lfreetype",
-          "-lfreeimage"
+          "-lfreeimage",
+          "-lz"
         ],
         "library_dirs": [
           "/opt/vc/lib"
         ]
       },
       "cflags_c": [ "-fgnu89-inline" ] # fix for vcos compiler warnings
+    },
+    {
+      # headless benchmarks against a recording OpenVG implementation, see bench/
+      "target_name": "vgcanvas-bench",
+      "type": "executable",
+      "sources": [
+        "bench/bench.c",
+        "bench/record-vg.c",
+        "<@(canvas_sources)"
+      ],
+      "include_dirs": [
+        "src",
+        "/opt/vc/include",
+        "/opt/vc/include/interface/vmcs_host/linux",
+        "/opt/vc/include/interface/vcos/pthreads",
+        "/usr/include/freetype2"
+      ],
+      "ldflags": [
+        "-Wl,--wrap=malloc",
+        "-Wl,--wrap=calloc",
+        "-Wl,--wrap=realloc"
+      ],
+      "link_settings": {
+        "libraries": [
+          "-lm",
+          "-lpthread",
+          "-lrt",
+          "-lfreetype",
+          "-lfreeimage",
+          "-lz"
+        ]
+      },
+      "cflags_c": [ "-fgnu89-inline" ]
     }
   ]
 }
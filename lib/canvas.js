@@ -5,13 +5,20 @@ module.exports.Canvas = function() {
 	this.width = 0;
 	this.height = 0;
 	this.funcs = {};
+	this.frameId = 0;
+	this._nextHandle = 1;
 };
 
 module.exports.Canvas.prototype.getContext = function(type) {
 	switch(type) {
 		case '2d':
+			if(this._ctx) {
+				return this._ctx;
+			}
+			
 			var ctx = new VGContext(this);
 			this._ctx = ctx;
+			vgcanvas.setFrameCallback(ctx._loop.bind(ctx));
 			this.width = ctx.getScreenWidth();
 			this.height = ctx.getScreenHeight();
 			return ctx;
@@ -20,43 +27,223 @@ module.exports.Canvas.prototype.getContext = function(type) {
 	}
 };
 
+var filters = {
+	'none': 0,
+	'sub': 1,
+	'up': 2,
+	'average': 3,
+	'paeth': 4,
+	'adaptive': 5
+};
+
+// encoder is either the quality (0 - 1) or an object { quality, compression, filter, threads }
+var encoderArgs = function(encoder) {
+	var options = typeof encoder == 'object' && encoder !== null ? encoder : { quality: encoder };
+	var quality = typeof options.quality == 'number' ? options.quality : -1;
+	var compression = typeof options.compression == 'number' ? options.compression : -1;
+	var filter = options.filter in filters ? filters[options.filter] : -1;
+	var threads = typeof options.threads == 'number' ? options.threads : 1;
+	
+	return [quality, compression, filter, threads];
+};
+
 module.exports.Canvas.prototype.toBlob = function(cb, type, encoder) {
-	if(type === undefined || encoder === undefined) {
-		type = "image/png";
-		encoder = 1;
-	}
+	var args = encoderArgs(encoder);
 	
-	this._ctx.toBlob(cb, type, encoder);
+	this._ctx.toBlob(cb, type || "image/png", args[0], args[1], args[2], args[3]);
+	this._flushReadback();
 };
 
-module.exports.Canvas.prototype.toDataURL = function(type, encoder) {
-	if(type === undefined || encoder === undefined) {
-		type = "image/png";
-		encoder = 1;
+// encodes only the area drawn since the last swap, cb receives the blob and the area
+module.exports.Canvas.prototype.captureDirty = function(cb, type, encoder) {
+	var rect = vgcanvas.getDirtyRect();
+	var args = encoderArgs(encoder);
+	
+	if(!rect) {
+		setImmediate(cb, null, null);
+		return;
 	}
 	
-	return this._ctx.toDataURL(type, encoder);
+	this._ctx.toBlob(function(blob) {
+		cb(blob, rect);
+	}, type || "image/png", args[0], args[1], args[2], args[3], rect.x, rect.y, rect.width, rect.height);
+	this._flushReadback();
 };
 
-module.exports.Canvas.prototype.requestAnimationFrame = function(cb) {
-	var empty = true;
+module.exports.Canvas.prototype._flushReadback = function() {
+	// no frame is going to be swapped, collect the pixels on the next tick
 	for(var key in this.funcs) {
-		empty = false;
+		return;
 	}
 	
-	if(empty) {
-		setTimeout(this._ctx._loop.bind(this._ctx), 0);
-	}
+	setImmediate(vgcanvas.flushReadback);
+};
+
+// fences: wait for the GPU (vgFinish) before each measurement
+module.exports.Canvas.prototype.setProfiling = function(enabled, fences) {
+	vgcanvas.setProfiling(!!enabled, !!fences);
+};
+
+module.exports.Canvas.prototype.getFrameStats = function() {
+	return vgcanvas.getFrameStats();
+};
+
+module.exports.Canvas.prototype.getFrameHistogram = function(bucket) {
+	return vgcanvas.getFrameHistogram(bucket || 1);
+};
+
+module.exports.Canvas.prototype.getMemoryStats = function() {
+	return vgcanvas.getMemoryStats();
+};
+
+// callback(stats) is called once each time the estimated video memory exceeds the limit (bytes, 0 disables)
+module.exports.Canvas.prototype.setMemoryLimit = function(limit, callback) {
+	vgcanvas.setMemoryLimit(limit || 0, callback || function() {});
+};
+
+module.exports.Canvas.prototype.startTrace = function() {
+	vgcanvas.startTrace();
+};
+
+module.exports.Canvas.prototype.stopTrace = function() {
+	vgcanvas.stopTrace();
+};
+
+// returns the trace as JSON string in the Chrome trace event format
+module.exports.Canvas.prototype.dumpTrace = function() {
+	return vgcanvas.dumpTrace();
+};
+
+module.exports.Canvas.prototype.getDirtyRect = function() {
+	return vgcanvas.getDirtyRect();
+};
+
+module.exports.Canvas.prototype.getDirtyStats = function() {
+	return vgcanvas.getDirtyStats();
+};
+
+module.exports.Canvas.prototype.getCullStats = function() {
+	return vgcanvas.getCullStats();
+};
+
+// false sends every draw to the driver, e.g. to compare frame times
+module.exports.Canvas.prototype.setCulling = function(enabled) {
+	vgcanvas.setCulling(!!enabled);
+};
+
+module.exports.Canvas.prototype.getColorStats = function() {
+	return vgcanvas.getColorStats();
+};
+
+module.exports.Canvas.prototype.getLayerStats = function() {
+	return vgcanvas.getLayerStats();
+};
+
+// fillText draws text up to maxSize pixels from cached glyph bitmaps (0 disables)
+module.exports.Canvas.prototype.setGlyphAtlas = function(maxSize) {
+	vgcanvas.setGlyphAtlas(+maxSize || 0);
+};
+
+module.exports.Canvas.prototype.getGlyphAtlasStats = function() {
+	return vgcanvas.getGlyphAtlasStats();
+};
+
+module.exports.Canvas.prototype.setFontCache = function(dir) {
+	vgcanvas.setFontCache(dir ? String(dir) : null);
+};
+
+module.exports.Canvas.prototype.getFontCacheStats = function() {
+	return vgcanvas.getFontCacheStats();
+};
+
+module.exports.Canvas.prototype.getTileStats = function() {
+	return vgcanvas.getTileStats();
+};
+
+module.exports.Canvas.prototype.getReadbackStats = function() {
+	return vgcanvas.getReadbackStats();
+};
+
+module.exports.Canvas.prototype.setReadbackLatency = function(latency) {
+	vgcanvas.setReadbackLatency(latency);
+};
+
+module.exports.Canvas.prototype.toDataURL = function(type, encoder) {
+	var args = encoderArgs(encoder);
 	
-	var id = Math.floor(Math.random() * 1e9);
+	return this._ctx.toDataURL(type || "image/png", args[0], args[1], args[2], args[3]);
+};
+
+module.exports.Canvas.prototype.requestAnimationFrame = function(cb) {
+	var id = this._nextHandle++;
 	this.funcs[id] = cb;
+	vgcanvas.requestFrame();
 	return id;
 };
 
 module.exports.Canvas.prototype.cancelAnimationFrame = function(id) {
 	delete this.funcs[id];
+	
+	for(var key in this.funcs) {
+		return;
+	}
+	
+	vgcanvas.cancelFrame();
 };
 
+// 0 paces frames by the display vsync, any other value is the target interval in ms
+module.exports.Canvas.prototype.setFrameInterval = function(interval) {
+	vgcanvas.setFrameInterval(interval);
+};
+
+module.exports.Canvas.prototype.getSchedulerStats = function() {
+	return vgcanvas.getSchedulerStats();
+};
+
+// false swaps the buffers synchronously on the JS thread
+module.exports.Canvas.prototype.setPresentThread = function(enabled) {
+	vgcanvas.setPresentThread(!!enabled);
+};
+
+module.exports.Canvas.prototype.getPresentStats = function() {
+	return vgcanvas.getPresentStats();
+};
+
+// canvas rendering into an image instead of the screen, it can be drawn with drawImage on any context
+module.exports.OffscreenCanvas = function(width, height) {
+	this.width = width;
+	this.height = height;
+	this.funcs = {};
+	this._context = new vgcanvas.Context(width, height);
+	this._ctx = null;
+};
+
+module.exports.OffscreenCanvas.prototype.getContext = function(type) {
+	if(type != '2d') {
+		return null;
+	}
+	
+	if(!this._ctx) {
+		this._ctx = new VGContext(this, this._context);
+	}
+	
+	return this._ctx;
+};
+
+module.exports.OffscreenCanvas.prototype.toBlob = module.exports.Canvas.prototype.toBlob;
+module.exports.OffscreenCanvas.prototype.toDataURL = module.exports.Canvas.prototype.toDataURL;
+module.exports.OffscreenCanvas.prototype._flushReadback = module.exports.Canvas.prototype._flushReadback;
 
 module.exports.Image = vgcanvas.Image;
+module.exports.Font = require('./font');
+module.exports.DisplayList = vgcanvas.DisplayList;
+
+// renders the list into a width x height frame tile by tile, the frame may exceed the screen
+// options are the encoder options and tileSize (pixels), threads also bins the list in parallel
+vgcanvas.DisplayList.prototype.toBlob = function(cb, width, height, type, options) {
+	var args = encoderArgs(options);
+	var tileSize = options && typeof options.tileSize == 'number' ? options.tileSize : 0;
+	
+	vgcanvas.renderDisplayList.call(this, cb, type || "image/png", args[0], args[1], args[2], args[3], this, width, height, tileSize);
+};
 module.exports.ImageData = require('./imageData');
@@ -1,27 +1,34 @@
 var vgcanvas = require('../build/Release/vgcanvas');
-var color = require('./color').decode;
 var ImageData = require('./imageData');
 
-var states = [];
 var ctxUsed = false;
 
-var VGContext = function(canvas) {
-	if(ctxUsed) {
-		throw new Error('Failed to initialize context: Only one context can be initialized at the same time');
-	}
-	
+// context is the native vgcanvas.Context of an offscreen canvas, the screen is used without it
+var VGContext = function(canvas, context) {
 	var self = this;
 	this.canvas = canvas;
+	this._states = [];
+	this._offscreen = !!context;
+
+	if(context) {
+		// every native call made on this object renders into _context
+		this._context = context;
+	} else {
+		if(ctxUsed) {
+			throw new Error('Failed to initialize context: Only one context can be initialized at the same time');
+		}
 
-	vgcanvas.init();
+		this._context = vgcanvas.init();
 
-	function cleanup() {
-		vgcanvas.cleanup();
-		process.exit(0);
-	}
+		var cleanup = function() {
+			vgcanvas.cleanup();
+			process.exit(0);
+		};
 
-	process.on('SIGTERM', cleanup);
-	process.on('SIGINT', cleanup);
+		process.on('SIGTERM', cleanup);
+		process.on('SIGINT', cleanup);
+		ctxUsed = true;
+	}
 
 	self.fillStyleValue = '#000';
 	self.strokeStyleValue = '#000';
@@ -29,8 +36,10 @@ var VGContext = function(canvas) {
 
 	Object.defineProperty(this, "fillStyle", {
 		set: function(value) {
-			self.setStyle(false, value);
-			self.fillStyleValue = value;
+			// invalid colors are ignored
+			if(self.setStyle(false, value) !== false) {
+				self.fillStyleValue = value;
+			}
 		},
 		get: function() {
 			return self.fillStyleValue;
@@ -39,8 +48,9 @@ var VGContext = function(canvas) {
 
 	Object.defineProperty(this, "strokeStyle", {
 		set: function(value) {
-			self.setStyle(true, value);
-			self.strokeStyleValue = value;
+			if(self.setStyle(true, value) !== false) {
+				self.strokeStyleValue = value;
+			}
 		},
 		get: function() {
 			return self.strokeStyleValue;
@@ -78,7 +88,7 @@ var VGContext = function(canvas) {
 			var size = parseInt(parts[0].substring(0, parts[0].length - 2));
 
 			self.fontValue = font;
-			vgcanvas.setFont(size, font.substring(parts[0].length + 1));
+			vgcanvas.setFont.call(self, size, font.substring(parts[0].length + 1));
 		},
 		get: function() {
 			return self.fontValue;
@@ -87,55 +97,69 @@ var VGContext = function(canvas) {
 	
 	Object.defineProperty(this, 'imageSmootingEnabled', {
 		set: function(value) {
-			vgcanvas.setImageSmoothing(value);
+			vgcanvas.setImageSmoothing.call(self, value);
 		},
 		get: function() {
-			return vgcanvas.getImageSmoothing();
+			return vgcanvas.getImageSmoothing.call(self);
 		}
 	});
 	
 	Object.defineProperty(this, 'globalCompositeOperation', {
 		set: function(value) {
-			vgcanvas.setGlobalCompositeOperation(value);
+			vgcanvas.setGlobalCompositeOperation.call(self, value);
 		},
 		get: function() {
-			return vgcanvas.getGlobalCompositeOperation();
+			return vgcanvas.getGlobalCompositeOperation.call(self);
 		}
 	});
 	
 	Object.defineProperty(this, 'miterLimit', {
 		set: function(value) {
-			vgcanvas.setMiterLimit(value);
+			vgcanvas.setMiterLimit.call(self, value);
 		},
 		get: function() {
-			return vgcanvas.getMiterLimit();
+			return vgcanvas.getMiterLimit.call(self);
 		}
 	});
 	
 	Object.defineProperty(this, 'textAlign', {
 		set: function(value) {
-			vgcanvas.setTextAlign(value);
+			vgcanvas.setTextAlign.call(self, value);
 		},
 		get: function() {
-			return vgcanvas.getTextAlign();
+			return vgcanvas.getTextAlign.call(self);
 		}
 	});
 	
 	Object.defineProperty(this, 'textBaseline', {
 		set: function(value) {
-			vgcanvas.setTextBaseline(value);
+			vgcanvas.setTextBaseline.call(self, value);
 		},
 		get: function() {
-			return vgcanvas.getTextBaseline();
+			return vgcanvas.getTextBaseline.call(self);
 		}
 	});
 	
-	ctxUsed = true;
-	
+};
+
+// transformation a, b, c, d, e, f (like transform) is optional
+vgcanvas.DisplayList.prototype.replay = function(ctx, a, b, c, d, e, f) {
+	if(f === undefined) {
+		return vgcanvas.replayDisplayList.call(ctx, this);
+	}
+
+	return vgcanvas.replayDisplayList.call(ctx, this, a, b, c, d, e, f);
+};
+
+vgcanvas.DisplayList.deserialize = function(buffer) {
+	return new vgcanvas.DisplayList(buffer);
 };
 
 vgcanvas.Gradient.prototype.addColorStop = function(pos, c) {
-	c = color(c);
+	c = vgcanvas.parseColor(String(c));
+	if(c === null) {
+		throw new SyntaxError('invalid color');
+	}
 	this.addColorStopRGBA(pos, c[0], c[1], c[2], c[3]);
 };
 
@@ -151,13 +175,27 @@ VGContext.prototype.createPattern = function(image, repetition) {
 	return new vgcanvas.Pattern(image, repetition);
 };
 
+// prepared paints are color handles which can be assigned to fillStyle and
+// strokeStyle without parsing the color again, null for invalid colors
+VGContext.prototype.preparePaint = function(color) {
+	if(color instanceof String) {
+		color = String(color);
+	}
+
+	return vgcanvas.preparePaint.call(this, color);
+};
+
+VGContext.prototype.releasePaint = function(handle) {
+	return vgcanvas.releasePaint.call(this, handle);
+};
+
+// colors are parsed natively, returns false for invalid colors
 VGContext.prototype.setStyle = function(type, obj) {
-	if(typeof obj === 'string' || obj instanceof String) {
-		obj = color(obj);
-		vgcanvas.setStyle(type, [obj[0], obj[1], obj[2], obj[3]]);
-	} else {
-		vgcanvas.setStyle(type, obj);
+	if(obj instanceof String) {
+		obj = String(obj);
 	}
+
+	return vgcanvas.setStyle.call(this, type, obj);
 };
 
 VGContext.prototype.setLineWidth = vgcanvas.setLineWidth;
@@ -169,7 +207,7 @@ VGContext.prototype.setLineDash = function(data) {
 
 	this.lineDash = data;
 
-	vgcanvas.setLineDash(data);
+	vgcanvas.setLineDash.call(this, data);
 }
 VGContext.prototype.setLineDashOffset = vgcanvas.setLineDashOffset;
 VGContext.prototype.getLineDash = vgcanvas.getLineDash;
@@ -188,14 +226,63 @@ VGContext.prototype.stroke = vgcanvas.stroke;
 VGContext.prototype.quadraticCurveTo = vgcanvas.quadraticCurveTo;
 VGContext.prototype.bezierCurveTo = vgcanvas.bezierCurveTo;
 VGContext.prototype.arc = vgcanvas.arc;
+VGContext.prototype.arcTo = vgcanvas.arcTo;
+VGContext.prototype.ellipse = vgcanvas.ellipse;
 VGContext.prototype.rect = vgcanvas.rect;
+VGContext.prototype.polyline = vgcanvas.polyline;
+
+VGContext.prototype.polygon = function(points) {
+	return vgcanvas.polyline.call(this, points, true);
+};
+
+// options: { decimate } (default true), returns the amount of stroked samples
+VGContext.prototype.strokeSeries = function(xs, ys, options) {
+	return vgcanvas.strokeSeries.call(this, xs, ys, !options || options.decimate !== false);
+};
+
+VGContext.prototype.drawCircles = vgcanvas.drawCircles;
 
-VGContext.prototype.loadFont = vgcanvas.loadFont;
+VGContext.prototype.isPointInPath = vgcanvas.isPointInPath;
+VGContext.prototype.isPointInStroke = vgcanvas.isPointInStroke;
+
+// options: { id, fillRule }, adds the current path as hit region on top of the others
+VGContext.prototype.addHitRegion = function(options) {
+	if(!options || options.id === undefined || options.id === null) {
+		throw new TypeError('addHitRegion() needs an id');
+	}
+
+	vgcanvas.addHitRegion.call(this, String(options.id), options.fillRule || 'nonzero');
+};
+
+VGContext.prototype.removeHitRegion = function(id) {
+	vgcanvas.removeHitRegion.call(this, String(id));
+};
+
+VGContext.prototype.clearHitRegions = vgcanvas.clearHitRegions;
+// returns the id of the topmost hit region at the point or null
+VGContext.prototype.hitTest = vgcanvas.hitTest;
+
+// loads synchronously, with callback(error) the file is parsed on the thread pool
+VGContext.prototype.loadFont = function(path, name, callback) {
+	if(typeof callback != 'function') {
+		return vgcanvas.loadFont.call(this, path, name);
+	}
+	
+	vgcanvas.loadFontAsync.call(this, String(path), String(name), callback);
+};
 VGContext.prototype.setFont = vgcanvas.setFont;
 VGContext.prototype.fillText = vgcanvas.fillText;
 VGContext.prototype.strokeText = vgcanvas.strokeText;
 VGContext.prototype.measureText = vgcanvas.measureText;
 
+// options: { kerning } (default true), lays out the text once with the current font, textAlign and textBaseline
+VGContext.prototype.createTextBlob = function(text, options) {
+	return vgcanvas.createTextBlob.call(this, String(text), !options || options.kerning !== false);
+};
+
+VGContext.prototype.fillTextBlob = vgcanvas.fillTextBlob;
+VGContext.prototype.strokeTextBlob = vgcanvas.strokeTextBlob;
+
 VGContext.prototype.resetTransform = vgcanvas.resetTransform;
 VGContext.prototype.scale = vgcanvas.scale;
 VGContext.prototype.rotate = vgcanvas.rotate;
@@ -204,7 +291,13 @@ VGContext.prototype.setTransform = vgcanvas.setTransform;
 VGContext.prototype.transform = vgcanvas.transform;
 
 VGContext.prototype.drawImage = function(image, dx, dy, dw, dh, sx, sy, sw, sh) {
-		
+	var source = image;
+	
+	// offscreen canvases are drawn through their native context
+	if(image._context instanceof vgcanvas.Context) {
+		source = image._context;
+	}
+	
 	if(dh === undefined || dw === undefined) {
 		dw = image.width;
 		dh = image.height;
@@ -217,10 +310,10 @@ VGContext.prototype.drawImage = function(image, dx, dy, dw, dh, sx, sy, sw, sh)
 		sh = image.height;
 	} else {
 		// Swap destination and source
-		return vgcanvas.drawImage(image, sx, sy, sw, sh, dx, dy, dw, dh);
+		return vgcanvas.drawImage.call(this, source, sx, sy, sw, sh, dx, dy, dw, dh);
 	}
 	
-	vgcanvas.drawImage(image, dx, dy, dw, dh, sx, sy, sw, sh);
+	vgcanvas.drawImage.call(this, source, dx, dy, dw, dh, sx, sy, sw, sh);
 };
 
 VGContext.prototype.getScreenWidth = vgcanvas.getScreenWidth;
@@ -228,23 +321,57 @@ VGContext.prototype.getScreenHeight = vgcanvas.getScreenHeight;
 
 VGContext.prototype.clip = vgcanvas.clip;
 VGContext.prototype.save = function() {
-	states.push({ stroke: this.strokeStyleValue, fill: this.fillStyleValue, font: this.fontValue });
-	return vgcanvas.save();
+	this._states.push({ stroke: this.strokeStyleValue, fill: this.fillStyleValue, font: this.fontValue });
+	return vgcanvas.save.call(this);
 }
 VGContext.prototype.restore = function() {
-	if(states.length == 0) {
+	if(this._states.length == 0) {
 		throw new TypeError("states.length is 0");
 	}
-	var state = states.pop();
+	var state = this._states.pop();
 	this.strokeStyleValue = state.stroke;
 	this.fillStyleValue = state.fill;
 	this.fontValue = state.font;
 
-	return vgcanvas.restore();
+	return vgcanvas.restore.call(this);
 };
 
+// returns true if the content of the layer has to be drawn until endLayer, false if the cached image is used
+VGContext.prototype.beginLayer = function(key, x, y, width, height) {
+	this._states.push({ stroke: this.strokeStyleValue, fill: this.fillStyleValue, font: this.fontValue });
+	if(width === undefined || height === undefined) {
+		return vgcanvas.beginLayer.call(this, String(key));
+	}
+
+	return vgcanvas.beginLayer.call(this, String(key), x, y, width, height);
+};
+VGContext.prototype.endLayer = function() {
+	if(this._states.length == 0) {
+		throw new TypeError("states.length is 0");
+	}
+	var state = this._states.pop();
+	this.strokeStyleValue = state.stroke;
+	this.fillStyleValue = state.fill;
+	this.fontValue = state.font;
+
+	return vgcanvas.endLayer.call(this);
+};
+// without key all layers are invalidated
+VGContext.prototype.invalidateLayer = function(key) {
+	if(key === undefined) {
+		return vgcanvas.invalidateLayer.call(this);
+	}
+
+	return vgcanvas.invalidateLayer.call(this, String(key));
+};
+VGContext.prototype.clearLayers = vgcanvas.clearLayers;
+
+// records the following calls of all contexts until endRecording, which returns the display list
+VGContext.prototype.beginRecording = vgcanvas.beginRecording;
+VGContext.prototype.endRecording = vgcanvas.endRecording;
+
 VGContext.prototype.getImageData = function(sx, sy, sw, sh) {
-	var data = vgcanvas.getImageData(sx, sy, sw, sh);
+	var data = vgcanvas.getImageData.call(this, sx, sy, sw, sh);
 	return new ImageData(data, sw, sh);
 };
 
@@ -280,6 +407,10 @@ VGContext.prototype.toDataURL = vgcanvas.toDataURL;
 
 VGContext.prototype.swapBuffers = vgcanvas.swapBuffers;
 VGContext.prototype.cleanup = function() {
+	if(this._offscreen) {
+		return;
+	}
+
 	vgcanvas.cleanup();
 	ctxUsed = false;
 	/*if(gc) {
@@ -287,12 +418,11 @@ VGContext.prototype.cleanup = function() {
 	}*/
 };
 
-VGContext.prototype._loop = function() {
+VGContext.prototype._loop = function(time, frameId) {
 	var swap = false;
-	var time = process.hrtime();
-	time = time[0] * 1e3 + time[1] / 1e6;
 	var funcs = this.canvas.funcs;
 	this.canvas.funcs = {};
+	this.canvas.frameId = frameId;
 	
 	for(var key in funcs) {
 		swap = true;
@@ -0,0 +1,55 @@
+var vgcanvas = require('../build/Release/vgcanvas');
+
+// a font file loaded on the thread pool like an Image: set onload/onerror, then src,
+// afterwards it is used with ctx.font = '<size>px <name>'
+var Font = module.exports = function(name, src) {
+	this.name = String(name);
+	this.onload = null;
+	this.onerror = null;
+	this.complete = false;
+	this._src = '';
+	this._promise = null;
+	
+	if(src) {
+		this.src = src;
+	}
+};
+
+Object.defineProperty(Font.prototype, 'src', {
+	get: function() {
+		return this._src;
+	},
+	set: function(src) {
+		var self = this;
+		
+		this._src = String(src);
+		this.complete = false;
+		this._promise = new Promise(function(resolve, reject) {
+			vgcanvas.loadFontAsync(self._src, self.name, function(error) {
+				self.complete = !error;
+				
+				if(error) {
+					if(self.onerror) {
+						self.onerror(error);
+					}
+					
+					return reject(error);
+				}
+				
+				if(self.onload) {
+					self.onload();
+				}
+				
+				resolve(self);
+			});
+		});
+		
+		// unhandled rejections are reported through onerror
+		this._promise.catch(function() {});
+	}
+});
+
+// resolves with the font once it can be used
+Font.prototype.load = function() {
+	return this._promise || Promise.reject(new Error('no src set'));
+};
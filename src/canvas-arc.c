@@ -20,14 +20,14 @@
 #include "include-openvg.h"
 // #include "include-freetype.h"
 
-#include "egl-util.h"
-#include "canvas-beginPath.h"
+#include "canvas-ellipse.h"
 #include "canvas-arc.h"
 
 /**
  * The arc() method adds an arc to the path which is centered at (x, y) position
  * with radius r starting at startAngle and ending at endAngle going in the
- * given direction by anticlockwise (defaulting to clockwise).
+ * given direction by anticlockwise (defaulting to clockwise). Like ellipse()
+ * it connects the current point with the start of the arc.
  * @param x The x coordinate of the arc's center.
  * @param y The y coordinate of the arc's center.
  * @param radius The arc's radius.
@@ -40,23 +40,5 @@
  */
 void canvas_arc(VGfloat x, VGfloat y, VGfloat radius, VGfloat start_angle, VGfloat end_angle, VGboolean anticlockwise)
 {
-	VGfloat angle_extent = 0;
-	
-	// dprintf("arc: { x: %i, y: %i, radius: %i, start_angle: %i, end_angle: %i, anticlockwise: %s }\n", x, y, radius, start_angle, end_angle, log_util_booleanToString(anticlockwise));
-	
-	// radian to degrees
-	start_angle *= 180 / M_PI;
-	end_angle *= 180 / M_PI;
-	
-	// calculate angle extent
-	if(anticlockwise == VG_TRUE)
-	{
-		angle_extent = 360 - (end_angle - start_angle);
-	}
-	else
-	{
-		angle_extent = 0 - (end_angle - start_angle);
-	}
-	
-	vguArc(canvas_beginPath_get(), x, egl_get_height() - y, radius * 2, radius * 2, start_angle, angle_extent, VGU_ARC_OPEN);
+	canvas_ellipse(x, y, radius, radius, 0, start_angle, end_angle, anticlockwise);
 }
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "canvas-moveTo.h"
+#include "canvas-lineTo.h"
+#include "canvas-ellipse.h"
+#include "canvas-arcTo.h"
+#include "path-util.h"
+
+/**
+ * The arcTo() method adds an arc to the path with the given control points and
+ * radius, connected to the previous point by a straight line. The arc touches
+ * the line from the current point to (x1, y1) and the line from (x1, y1) to
+ * (x2, y2).
+ * @param x1 The x axis of the coordinate for the first control point.
+ * @param y1 The y axis of the coordinate for the first control point.
+ * @param x2 The x axis of the coordinate for the second control point.
+ * @param y2 The y axis of the coordinate for the second control point.
+ * @param radius The arc's radius.
+ */
+void canvas_arcTo(VGfloat x1, VGfloat y1, VGfloat x2, VGfloat y2, VGfloat radius)
+{
+	VGfloat x0 = 0;
+	VGfloat y0 = 0;
+	VGfloat dx0 = 0;
+	VGfloat dy0 = 0;
+	VGfloat dx2 = 0;
+	VGfloat dy2 = 0;
+	VGfloat length0 = 0;
+	VGfloat length2 = 0;
+	VGfloat angle = 0;
+	VGfloat tangent = 0;
+	VGfloat center_x = 0;
+	VGfloat center_y = 0;
+	VGfloat start_angle = 0;
+	VGfloat sweep = 0;
+	
+	if(!path_util_get_current_point(&x0, &y0))
+	{
+		canvas_moveTo(x1, y1);
+		
+		return;
+	}
+	
+	// the current point is stored flipped
+	y0 = egl_get_height() - y0;
+	
+	dx0 = x0 - x1;
+	dy0 = y0 - y1;
+	dx2 = x2 - x1;
+	dy2 = y2 - y1;
+	length0 = hypotf(dx0, dy0);
+	length2 = hypotf(dx2, dy2);
+	
+	// coinciding or collinear points and a zero radius give a straight line
+	if(length0 == 0 || length2 == 0 || radius == 0 || fabsf(dx0 * dy2 - dy0 * dx2) <= 1e-6f * length0 * length2)
+	{
+		canvas_lineTo(x1, y1);
+		
+		return;
+	}
+	
+	dx0 /= length0;
+	dy0 /= length0;
+	dx2 /= length2;
+	dy2 /= length2;
+	
+	// angle between both lines at (x1, y1), the tangent points are at the same distance
+	angle = acosf(fmaxf(-1, fminf(1, dx0 * dx2 + dy0 * dy2)));
+	tangent = radius / tanf(angle / 2);
+	
+	// the center lies on the bisector
+	center_x = dx0 + dx2;
+	center_y = dy0 + dy2;
+	length0 = hypotf(center_x, center_y);
+	center_x = x1 + center_x / length0 * radius / sinf(angle / 2);
+	center_y = y1 + center_y / length0 * radius / sinf(angle / 2);
+	
+	start_angle = atan2f(y1 + dy0 * tangent - center_y, x1 + dx0 * tangent - center_x);
+	sweep = atan2f(y1 + dy2 * tangent - center_y, x1 + dx2 * tangent - center_x) - start_angle;
+	
+	// the short way around
+	if(sweep > M_PI)
+	{
+		sweep -= 2 * M_PI;
+	}
+	else if(sweep < -M_PI)
+	{
+		sweep += 2 * M_PI;
+	}
+	
+	canvas_ellipse_append(center_x, center_y, radius, radius, 0, start_angle, sweep);
+}
@@ -21,8 +21,18 @@
 // #include "include-freetype.h"
 
 #include "canvas-beginPath.h"
+#include "canvas-lineWidth.h"
+#include "canvas-miterLimit.h"
+#include "canvas-ellipse.h"
+#include "cull-util.h"
+#include "path-util.h"
+#include "memory-util.h"
+#include "context-util.h"
 
-static VGPath canvas_beginPath_immediate_path = 0;
+/*
+ * The immediate path, the bounds of all its points (including control points)
+ * and the estimated size of its data are kept in the current context.
+ */
 
 /**
  * Initializes beginPath(). Generates a new immediate path for drawing rects,
@@ -30,7 +40,13 @@ static VGPath canvas_beginPath_immediate_path = 0;
  */
 void canvas_beginPath_init(void)
 {
-	canvas_beginPath_immediate_path = vgCreatePath(VG_PATH_FORMAT_STANDARD, VG_PATH_DATATYPE_F, 1.0f, 0.0f, 0, 0, VG_PATH_CAPABILITY_ALL);
+	canvas_context_t *context = context_util_get();
+	
+	context->path = vgCreatePath(VG_PATH_FORMAT_STANDARD, VG_PATH_DATATYPE_F, 1.0f, 0.0f, 0, 0, VG_PATH_CAPABILITY_ALL);
+	context->path_empty = 1;
+	context->path_bytes = 0;
+	
+	memory_util_alloc(MEMORY_UTIL_PATH, 0, 1);
 }
 
 /**
@@ -38,7 +54,16 @@ void canvas_beginPath_init(void)
  */
 void canvas_beginPath_cleanup(void)
 {
-	vgDestroyPath(canvas_beginPath_immediate_path);
+	canvas_context_t *context = context_util_get();
+	
+	vgDestroyPath(context->path);
+	context->path = VG_INVALID_HANDLE;
+	context->path_ellipse_pending = 0;
+	path_util_cleanup();
+	canvas_ellipse_cleanup();
+	
+	memory_util_free(MEMORY_UTIL_PATH, context->path_bytes, 1);
+	context->path_bytes = 0;
 }
 
 /**
@@ -47,14 +72,114 @@ void canvas_beginPath_cleanup(void)
  */
 void canvas_beginPath(void)
 {
-	vgClearPath(canvas_beginPath_immediate_path, VG_PATH_CAPABILITY_ALL);
+	canvas_context_t *context = context_util_get();
+	
+	vgClearPath(context->path, VG_PATH_CAPABILITY_ALL);
+	path_util_clear();
+	
+	context->path_empty = 1;
+	context->path_ellipse_pending = 0;
+	
+	memory_util_free(MEMORY_UTIL_PATH, context->path_bytes, 0);
+	context->path_bytes = 0;
 }
 
 /**
- * Returns the immediate path for drawing.
+ * Returns the immediate path for drawing. A pending full ellipse is appended
+ * first.
  * @return The immediate path for drawing rects, paths, text, etc.
  */
 VGPath canvas_beginPath_get(void)
 {
-	return canvas_beginPath_immediate_path;
+	canvas_context_t *context = context_util_get();
+	
+	if(context->path_ellipse_pending)
+	{
+		canvas_ellipse_flush();
+	}
+	
+	return context->path;
+}
+
+/**
+ * Extends the bounds of the immediate path. Must be called for every point
+ * appended to the immediate path.
+ * @param x The x axis of the point (surface orientation).
+ * @param y The y axis of the point (surface orientation).
+ */
+void canvas_beginPath_extend(VGfloat x, VGfloat y)
+{
+	canvas_context_t *context = context_util_get();
+	
+	if(context->path_empty)
+	{
+		context->path_min_x = context->path_max_x = x;
+		context->path_min_y = context->path_max_y = y;
+		context->path_empty = 0;
+		
+		return;
+	}
+	
+	context->path_min_x = fminf(context->path_min_x, x);
+	context->path_min_y = fminf(context->path_min_y, y);
+	context->path_max_x = fmaxf(context->path_max_x, x);
+	context->path_max_y = fmaxf(context->path_max_y, y);
+}
+
+/**
+ * Accounts data appended to the immediate path. Must be called for every
+ * append.
+ * @param segments The amount of appended segments.
+ * @param coords The amount of appended coordinates.
+ */
+void canvas_beginPath_grow(VGint segments, VGint coords)
+{
+	long long bytes = segments + coords * sizeof(VGfloat);
+	
+	context_util_get()->path_bytes += bytes;
+	
+	memory_util_alloc(MEMORY_UTIL_PATH, bytes, 0);
+}
+
+/**
+ * Returns the bounds of the immediate path in user coordinates. Curves are
+ * contained in the hull of their control points, so the bounds are conservative.
+ * @return 0 if the path is empty, 1 otherwise
+ */
+int canvas_beginPath_get_bounds(VGfloat *min_x, VGfloat *min_y, VGfloat *max_x, VGfloat *max_y)
+{
+	canvas_context_t *context = context_util_get();
+	
+	*min_x = context->path_min_x;
+	*min_y = context->path_min_y;
+	*max_x = context->path_max_x;
+	*max_y = context->path_max_y;
+	
+	return !context->path_empty;
+}
+
+/**
+ * Tests whether drawing the immediate path can be visible and adds the covered
+ * area to the dirty region if so.
+ * @param mode VG_FILL_PATH or VG_STROKE_PATH
+ * @return 1 if the path has to be drawn, 0 if it is empty or can not touch the
+ *         surface or clipping region.
+ */
+int canvas_beginPath_visible(VGPaintMode mode)
+{
+	canvas_context_t *context = context_util_get();
+	VGfloat expand = 0;
+	
+	if(context->path_empty)
+	{
+		return 0;
+	}
+	
+	if(mode == VG_STROKE_PATH)
+	{
+		// miter joins may reach up to miterLimit * lineWidth / 2, square caps sqrt(2) * lineWidth / 2
+		expand = canvas_lineWidth_get() * 0.5f * fmaxf(canvas_miterLimit_get(), M_SQRT2);
+	}
+	
+	return cull_util_user(context->path_min_x, context->path_min_y, context->path_max_x, context->path_max_y, expand);
 }
@@ -25,5 +25,9 @@ void canvas_beginPath_init(void);
 void canvas_beginPath_cleanup(void);
 void canvas_beginPath(void);
 VGPath canvas_beginPath_get(void);
+void canvas_beginPath_extend(VGfloat x, VGfloat y);
+void canvas_beginPath_grow(VGint segments, VGint coords);
+int canvas_beginPath_get_bounds(VGfloat *min_x, VGfloat *min_y, VGfloat *max_x, VGfloat *max_y);
+int canvas_beginPath_visible(VGPaintMode mode);
 
 #endif /* __CANVAS_BEGINPATH_H__ */
@@ -22,7 +22,9 @@
 
 #include "egl-util.h"
 #include "canvas-beginPath.h"
+#include "path-util.h"
 #include "canvas-quadraticCurveTo.h"
+#include "profile-util.h"
 
 /**
  * The bezierCurveTo() method of the Canvas 2D API adds a cubic Bézier curve to
@@ -49,5 +51,12 @@ void canvas_bezierCurveTo(VGfloat cp1x, VGfloat cp1y, VGfloat cp2x, VGfloat cp2y
 	data[4] = x;
 	data[5] = egl_get_height() - y;
 	
-	vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data);
+	canvas_beginPath_extend(data[0], data[1]);
+	canvas_beginPath_extend(data[2], data[3]);
+	canvas_beginPath_extend(data[4], data[5]);
+	
+	PROFILE_UPLOAD(sizeof(data));
+	canvas_beginPath_grow(1, 6);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data));
+	path_util_append(1, segment, data);
 }
@@ -21,7 +21,10 @@
 // #include "include-freetype.h"
 
 #include "egl-util.h"
+#include "dirty-util.h"
 #include "canvas-clearRect.h"
+#include "profile-util.h"
+#include "context-util.h"
 
 /**
  * Initializes clearRect(). Sets the clear color and disables scissoring.
@@ -47,5 +50,12 @@ void canvas_clearRect_init(void)
  */
 void canvas_clearRect(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
 {
-	vgClear(x, egl_get_height() - y - height, width, height);
+	canvas_context_t *context = context_util_get();
+	
+	x += context->offset_x;
+	y -= context->offset_y;
+	
+	dirty_util_add(x, egl_get_height() - y - height, width, height);
+	
+	PROFILE_CALL(PROFILE_CLEAR, vgClear(x, egl_get_height() - y - height, width, height));
 }
@@ -23,8 +23,9 @@
 #include "egl-util.h"
 #include "canvas-beginPath.h"
 #include "canvas-clip.h"
-
-static VGboolean canvas_clip_clipping = VG_FALSE;
+#include "context-util.h"
+#include "cull-util.h"
+#include "memory-util.h"
 
 /**
  * Initializes clip(). Disables masking by default.
@@ -43,16 +44,39 @@ void canvas_clip_init(void)
  */
 void canvas_clip(void)
 {
-	if(!canvas_clip_clipping)
+	canvas_context_t *context = context_util_get();
+	VGfloat min_x = 0;
+	VGfloat min_y = 0;
+	VGfloat max_x = 0;
+	VGfloat max_y = 0;
+	VGfloat bounds[4] = { 1, 1, 0, 0 };
+	
+	if(!context->clipping)
+	{
+		vgMask(VG_INVALID_HANDLE, VG_FILL_MASK, 0, 0, context->surface_width, context->surface_height);
+		
+		context->clip_bounds[0] = 0;
+		context->clip_bounds[1] = 0;
+		context->clip_bounds[2] = context->surface_width;
+		context->clip_bounds[3] = context->surface_height;
+	}
+	
+	// the region only shrinks, an empty path clips everything
+	if(canvas_beginPath_get_bounds(&min_x, &min_y, &max_x, &max_y))
 	{
-		vgMask(VG_INVALID_HANDLE, VG_FILL_MASK, 0, 0, egl_get_width(), egl_get_height());
+		cull_util_transform(min_x, min_y, max_x, max_y, 1, bounds);
 	}
 	
+	context->clip_bounds[0] = fmaxf(context->clip_bounds[0], bounds[0]);
+	context->clip_bounds[1] = fmaxf(context->clip_bounds[1], bounds[1]);
+	context->clip_bounds[2] = fminf(context->clip_bounds[2], bounds[2]);
+	context->clip_bounds[3] = fminf(context->clip_bounds[3], bounds[3]);
+	
 	vgRenderToMask(canvas_beginPath_get(), VG_FILL_PATH, VG_INTERSECT_MASK);
 	
 	vgSeti(VG_MASKING, VG_TRUE);
 	
-	canvas_clip_clipping = VG_TRUE;
+	context->clipping = VG_TRUE;
 }
 
 /**
@@ -61,7 +85,7 @@ void canvas_clip(void)
  */
 VGboolean canvas_clip_get_clipping(void)
 {
-	return canvas_clip_clipping;
+	return context_util_get()->clipping;
 }
 
 /**
@@ -72,7 +96,25 @@ void canvas_clip_set_clipping(VGboolean clipping)
 {
 	vgSeti(VG_MASKING, clipping);
 	
-	canvas_clip_clipping = clipping;
+	context_util_get()->clipping = clipping;
+}
+
+/**
+ * Returns the surface bounds of the clipping region.
+ * @param bounds Where to write the bounds to (min x, min y, max x, max y).
+ */
+void canvas_clip_get_bounds(VGfloat *bounds)
+{
+	memcpy(bounds, context_util_get()->clip_bounds, 4 * sizeof(VGfloat));
+}
+
+/**
+ * Sets the surface bounds of the clipping region, e.g. when restoring a state.
+ * @param bounds The bounds (min x, min y, max x, max y).
+ */
+void canvas_clip_set_bounds(const VGfloat *bounds)
+{
+	memcpy(context_util_get()->clip_bounds, bounds, 4 * sizeof(VGfloat));
 }
 
 /**
@@ -83,8 +125,12 @@ void canvas_clip_set_clipping(VGboolean clipping)
  */
 VGMaskLayer canvas_clip_get_mask(void)
 {
-	VGMaskLayer mask = vgCreateMaskLayer(egl_get_width(), egl_get_height());
-	vgCopyMask(mask, 0, 0, 0, 0, egl_get_width(), egl_get_height());
+	canvas_context_t *context = context_util_get();
+	VGMaskLayer mask = vgCreateMaskLayer(context->surface_width, context->surface_height);
+	vgCopyMask(mask, 0, 0, 0, 0, context->surface_width, context->surface_height);
+	
+	// 8 bit alpha mask
+	memory_util_alloc(MEMORY_UTIL_MASK, (long long)context->surface_width * context->surface_height, 1);
 	
 	return mask;
 }
@@ -95,7 +141,7 @@ VGMaskLayer canvas_clip_get_mask(void)
  */
 void canvas_clip_set_mask(VGMaskLayer mask)
 {
-	vgMask(mask, VG_SET_MASK, 0, 0, egl_get_width(), egl_get_height());
+	vgMask(mask, VG_SET_MASK, 0, 0, context_util_get()->surface_width, context_util_get()->surface_height);
 }
 
 /**
@@ -105,4 +151,6 @@ void canvas_clip_set_mask(VGMaskLayer mask)
 void canvas_clip_cleanup_mask(VGMaskLayer mask)
 {
 	vgDestroyMaskLayer(mask);
+	
+	memory_util_free(MEMORY_UTIL_MASK, (long long)context_util_get()->surface_width * context_util_get()->surface_height, 1);
 }
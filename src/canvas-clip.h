@@ -25,6 +25,8 @@ void canvas_clip_init(void);
 void canvas_clip(void);
 VGboolean canvas_clip_get_clipping(void);
 void canvas_clip_set_clipping(VGboolean clipping);
+void canvas_clip_get_bounds(VGfloat *bounds);
+void canvas_clip_set_bounds(const VGfloat *bounds);
 VGMaskLayer canvas_clip_get_mask(void);
 void canvas_clip_set_mask(VGMaskLayer mask);
 void canvas_clip_cleanup_mask(VGMaskLayer mask);
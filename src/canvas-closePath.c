@@ -21,7 +21,9 @@
 // #include "include-freetype.h"
 
 #include "canvas-beginPath.h"
+#include "path-util.h"
 #include "canvas-closePath.h"
+#include "profile-util.h"
 
 /**
  * The closePath() method causes the point of the pen to move back to the start
@@ -37,5 +39,8 @@ void canvas_closePath(void)
 	data[0] = 0;
 	data[1] = 0;
 	
-	vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data);
+	PROFILE_UPLOAD(sizeof(data));
+	canvas_beginPath_grow(1, 0);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data));
+	path_util_append(1, segment, data);
 }
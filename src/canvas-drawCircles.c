@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "canvas-paint.h"
+#include "canvas-fillStyle.h"
+#include "canvas-beginPath.h"
+#include "canvas-ellipse.h"
+#include "canvas-fill.h"
+#include "canvas-drawCircles.h"
+#include "cull-util.h"
+#include "profile-util.h"
+#include "trace-util.h"
+
+/**
+ * Fills circles with the current fill style. Each circle is drawn on its own
+ * (overlapping circles do not cancel out). With a color fill the circles are
+ * drawn with the unit circle and do not touch the path data, other fills go
+ * through the path one circle at a time. The immediate path is empty
+ * afterwards.
+ * @param xs The x axis of the centers.
+ * @param ys The y axis of the centers.
+ * @param radii The radii, circles with a radius that is not positive are
+ *        skipped.
+ * @param count The amount of circles.
+ * @param stride The distance between consecutive values in each array.
+ */
+void canvas_drawCircles(const VGfloat *xs, const VGfloat *ys, const VGfloat *radii, VGint count, VGint stride)
+{
+	paint_t *paint = canvas_fillStyle_get();
+	VGfloat height = egl_get_height();
+	VGfloat matrix[9];
+	VGint matrix_mode = 0;
+	VGint activated = 0;
+	VGfloat x = 0;
+	VGfloat y = 0;
+	VGfloat r = 0;
+	VGint i = 0;
+	TRACE_DECLARE(trace_begin);
+	
+	canvas_beginPath();
+	
+	TRACE_BEGIN(trace_begin);
+	
+	if(paint->paint_type == PAINT_TYPE_COLOR)
+	{
+		matrix_mode = vgGeti(VG_MATRIX_MODE);
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+		vgGetMatrix(matrix);
+		
+		for(i = 0; i < count; i++)
+		{
+			x = xs[i * stride];
+			y = height - ys[i * stride];
+			r = radii[i * stride];
+			
+			// also skips NaN
+			if(!(r > 0) || !cull_util_matrix(matrix, x - r, y - r, x + r, y + r))
+			{
+				continue;
+			}
+			
+			if(!activated)
+			{
+				paint_activate(paint, VG_FILL_PATH);
+				activated = 1;
+			}
+			
+			canvas_ellipse_draw_circle(matrix, x, y, r);
+		}
+		
+		vgLoadMatrix(matrix);
+		vgSeti(VG_MATRIX_MODE, matrix_mode);
+	}
+	else
+	{
+		// gradients and patterns are mapped by the path matrix, use the path
+		for(i = 0; i < count; i++)
+		{
+			r = radii[i * stride];
+			
+			if(!(r > 0))
+			{
+				continue;
+			}
+			
+			canvas_beginPath();
+			canvas_ellipse(xs[i * stride], ys[i * stride], r, r, 0, 0, 2 * M_PI, VG_FALSE);
+			canvas_fill();
+		}
+	}
+	
+	TRACE_END("path", "drawCircles", trace_begin);
+	
+	canvas_beginPath();
+}
@@ -19,19 +19,34 @@
 #include "egl-util.h"
 #include "include-openvg.h"
 #include "image-util.h"
+#include "cull-util.h"
+#include "profile-util.h"
+#include "memory-util.h"
+#include "context-util.h"
 
 void canvas_drawImage(image_t *image, VGfloat dx, VGfloat dy, VGfloat dw, VGfloat dh, VGfloat sx, VGfloat sy, VGfloat sw, VGfloat sh)
 {
-  VGint matrix = vgGeti(VG_MATRIX_MODE);
+  canvas_context_t *context = context_util_get();
+  VGint matrix = 0;
+  
+  if(!cull_util_surface(dx + context->offset_x, egl_get_height() - dy - dh + context->offset_y, dw, dh))
+  {
+    return;
+  }
+  
+  matrix = vgGeti(VG_MATRIX_MODE);
   vgSeti(VG_MATRIX_MODE, VG_MATRIX_IMAGE_USER_TO_SURFACE);
   
   vgLoadIdentity();
-  vgTranslate(dx, egl_get_height() - dy - dh);
+  vgTranslate(dx + context->offset_x, egl_get_height() - dy - dh + context->offset_y);
   vgScale(dw / sw, dh / sh);
   
+  // child images share the pixels of their parent
   VGImage child = vgChildImage(image->image, sx, image->height - sy - sh, sw, sh);
-  vgDrawImage(child);
+  memory_util_alloc(MEMORY_UTIL_IMAGE, 0, 1);
+  PROFILE_CALL(PROFILE_DRAW_IMAGE, vgDrawImage(child));
   vgDestroyImage(child);
+  memory_util_free(MEMORY_UTIL_IMAGE, 0, 1);
   
   vgSeti(VG_MATRIX_MODE, matrix);
 }
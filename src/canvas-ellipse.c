@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "log-util.h"
+#include "canvas-beginPath.h"
+#include "canvas-paint.h"
+#include "canvas-fillStyle.h"
+#include "canvas-ellipse.h"
+#include "context-util.h"
+#include "memory-util.h"
+#include "path-util.h"
+#include "profile-util.h"
+
+/*
+ * Ellipses are appended as up to four cubic Bézier curves of at most a quarter
+ * turn each. A full ellipse which starts the immediate path is kept as
+ * parameters of the context instead: fill() with a color draws it with a unit
+ * circle path created once per context, scaled and rotated by the path matrix,
+ * so dots of scatter plots do not upload any path data. Everything else that
+ * needs the immediate path appends the ellipse first (canvas_beginPath_get()).
+ */
+
+// a move or line to the start and four curves
+#define CANVAS_ELLIPSE_SEGMENTS 5
+#define CANVAS_ELLIPSE_COORDS 26
+
+/**
+ * Maps a point of the unit circle onto an ellipse.
+ * @param e The ellipse: x, y, radius x, radius y, rotation, start angle, sweep.
+ * @param height The height the y axis is flipped with.
+ * @param point Where to write the point to.
+ */
+static void canvas_ellipse__map(const VGfloat *e, VGfloat cos_r, VGfloat sin_r, VGfloat height, VGfloat ux, VGfloat uy, VGfloat *point)
+{
+	point[0] = e[0] + e[2] * ux * cos_r - e[3] * uy * sin_r;
+	point[1] = height - (e[1] + e[2] * ux * sin_r + e[3] * uy * cos_r);
+}
+
+/**
+ * Builds the segments of an ellipse.
+ * @param e The ellipse: x, y, radius x, radius y, rotation, start angle, sweep
+ *          (canvas coordinates, radians).
+ * @param height The height the y axis is flipped with.
+ * @param connect Whether a line connects the current point with the start
+ *                instead of a move.
+ * @param segments Where to write the segments to (CANVAS_ELLIPSE_SEGMENTS).
+ * @param data Where to write the coordinates to (CANVAS_ELLIPSE_COORDS).
+ * @return The amount of segments.
+ */
+static VGint canvas_ellipse__build(const VGfloat *e, VGfloat height, int connect, VGubyte *segments, VGfloat *data)
+{
+	VGfloat cos_r = cosf(e[4]);
+	VGfloat sin_r = sinf(e[4]);
+	VGfloat cos_a = cosf(e[5]);
+	VGfloat sin_a = sinf(e[5]);
+	VGfloat cos_n = 0;
+	VGfloat sin_n = 0;
+	VGfloat step = 0;
+	VGfloat k = 0;
+	// a small margin keeps a full turn at four curves
+	VGint steps = (VGint)ceilf(fabsf(e[6]) / (VGfloat)M_PI_2 - 1e-4f);
+	VGint i = 0;
+	
+	steps = !(steps >= 0) ? 0 : (steps > CANVAS_ELLIPSE_SEGMENTS - 1 ? CANVAS_ELLIPSE_SEGMENTS - 1 : steps);
+	step = steps > 0 ? e[6] / steps : 0;
+	// distance of the control points along the tangent of a curve of angle step
+	k = 4.0f / 3.0f * tanf(step / 4);
+	
+	segments[0] = connect ? VG_LINE_TO_ABS : VG_MOVE_TO_ABS;
+	canvas_ellipse__map(e, cos_r, sin_r, height, cos_a, sin_a, data);
+	
+	for(i = 0; i < steps; i++)
+	{
+		cos_n = cosf(e[5] + step * (i + 1));
+		sin_n = sinf(e[5] + step * (i + 1));
+		
+		segments[i + 1] = VG_CUBIC_TO_ABS;
+		canvas_ellipse__map(e, cos_r, sin_r, height, cos_a - k * sin_a, sin_a + k * cos_a, &data[2 + i * 6]);
+		canvas_ellipse__map(e, cos_r, sin_r, height, cos_n + k * sin_n, sin_n - k * cos_n, &data[4 + i * 6]);
+		canvas_ellipse__map(e, cos_r, sin_r, height, cos_n, sin_n, &data[6 + i * 6]);
+		
+		cos_a = cos_n;
+		sin_a = sin_n;
+	}
+	
+	return steps + 1;
+}
+
+/**
+ * Appends an elliptical arc to the immediate path. If the path is not empty,
+ * the current point is connected with the start of the arc by a straight line.
+ * @param x The x axis of the center.
+ * @param y The y axis of the center.
+ * @param radius_x The radius of the major axis.
+ * @param radius_y The radius of the minor axis.
+ * @param rotation The rotation of the ellipse in radians, clockwise.
+ * @param start_angle The start angle in radians, clockwise from the major axis.
+ * @param sweep The angle covered by the arc in radians, negative for
+ *              anticlockwise arcs. At most a full turn.
+ */
+void canvas_ellipse_append(VGfloat x, VGfloat y, VGfloat radius_x, VGfloat radius_y, VGfloat rotation, VGfloat start_angle, VGfloat sweep)
+{
+	canvas_context_t *context = context_util_get();
+	VGubyte segments[CANVAS_ELLIPSE_SEGMENTS];
+	VGfloat data[CANVAS_ELLIPSE_COORDS];
+	VGfloat e[7];
+	int connect = !context->path_empty;
+	VGint count = 0;
+	VGint coords = 0;
+	VGint i = 0;
+	
+	e[0] = x;
+	e[1] = y;
+	e[2] = radius_x;
+	e[3] = radius_y;
+	e[4] = rotation;
+	e[5] = start_angle;
+	e[6] = sweep;
+	
+	count = canvas_ellipse__build(e, egl_get_height(), connect, segments, data);
+	coords = 2 + (count - 1) * 6;
+	
+	// curves stay within the hull of their control points
+	for(i = 0; i < coords; i += 2)
+	{
+		canvas_beginPath_extend(data[i], data[i + 1]);
+	}
+	
+	path_util_append(count, segments, data);
+	
+	if(!connect && fabsf(sweep) >= 2 * (VGfloat)M_PI)
+	{
+		memcpy(context->path_ellipse, e, sizeof(e));
+		context->path_ellipse_pending = 1;
+		
+		return;
+	}
+	
+	PROFILE_UPLOAD(coords * sizeof(VGfloat));
+	canvas_beginPath_grow(count, coords);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), count, segments, (const void *)data));
+}
+
+/**
+ * The ellipse() method adds an elliptical arc to the path which is centered at
+ * (x, y) position with the radii radiusX and radiusY starting at startAngle and
+ * ending at endAngle going in the given direction by anticlockwise
+ * (defaulting to clockwise).
+ * @param x The x axis of the coordinate for the ellipse's center.
+ * @param y The y axis of the coordinate for the ellipse's center.
+ * @param radius_x The ellipse's major-axis radius.
+ * @param radius_y The ellipse's minor-axis radius.
+ * @param rotation The rotation for this ellipse, expressed in radians.
+ * @param start_angle The starting point, measured from the x axis, from which
+ *                    it will be drawn, expressed in radians.
+ * @param end_angle The end ellipse's angle to which it will be drawn, expressed
+ *                  in radians.
+ * @param anticlockwise A Boolean which, if true, draws the ellipse
+ *                      anticlockwise (counter-clockwise).
+ */
+void canvas_ellipse(VGfloat x, VGfloat y, VGfloat radius_x, VGfloat radius_y, VGfloat rotation, VGfloat start_angle, VGfloat end_angle, VGboolean anticlockwise)
+{
+	VGfloat sweep = 0;
+	
+	if(anticlockwise == VG_FALSE && end_angle - start_angle >= 2 * M_PI)
+	{
+		sweep = 2 * M_PI;
+	}
+	else if(anticlockwise == VG_TRUE && start_angle - end_angle >= 2 * M_PI)
+	{
+		sweep = -2 * M_PI;
+	}
+	else
+	{
+		sweep = fmodf(end_angle - start_angle, 2 * M_PI);
+		
+		if(sweep < 0)
+		{
+			sweep += 2 * M_PI;
+		}
+		
+		if(anticlockwise == VG_TRUE && sweep != 0)
+		{
+			sweep -= 2 * M_PI;
+		}
+	}
+	
+	canvas_ellipse_append(x, y, radius_x, radius_y, rotation, start_angle, sweep);
+}
+
+/**
+ * Appends a pending full ellipse to the immediate path.
+ */
+void canvas_ellipse_flush(void)
+{
+	canvas_context_t *context = context_util_get();
+	VGubyte segments[CANVAS_ELLIPSE_SEGMENTS];
+	VGfloat data[CANVAS_ELLIPSE_COORDS];
+	VGint count = 0;
+	
+	if(!context->path_ellipse_pending)
+	{
+		return;
+	}
+	
+	context->path_ellipse_pending = 0;
+	count = canvas_ellipse__build(context->path_ellipse, egl_get_height(), 0, segments, data);
+	
+	PROFILE_UPLOAD((2 + (count - 1) * 6) * sizeof(VGfloat));
+	canvas_beginPath_grow(count, 2 + (count - 1) * 6);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(context->path, count, segments, (const void *)data));
+}
+
+/**
+ * Returns the unit circle of the current context, creates it on first use.
+ * @return The path or VG_INVALID_HANDLE on failure.
+ */
+static VGPath canvas_ellipse__unit(void)
+{
+	canvas_context_t *context = context_util_get();
+	const VGfloat unit[7] = { 0, 0, 1, 1, 0, 0, 2 * M_PI };
+	VGubyte segments[CANVAS_ELLIPSE_SEGMENTS];
+	VGfloat data[CANVAS_ELLIPSE_COORDS];
+	VGint count = 0;
+	
+	if(context->unit_circle != VG_INVALID_HANDLE)
+	{
+		return context->unit_circle;
+	}
+	
+	// flipped at 0, which does not change a circle
+	count = canvas_ellipse__build(unit, 0, 0, segments, data);
+	context->unit_circle = vgCreatePath(VG_PATH_FORMAT_STANDARD, VG_PATH_DATATYPE_F, 1.0f, 0.0f, count, 2 + (count - 1) * 6, VG_PATH_CAPABILITY_APPEND_TO);
+	
+	if(context->unit_circle == VG_INVALID_HANDLE)
+	{
+		eprintf("Failed to create unit circle.\n");
+		
+		return VG_INVALID_HANDLE;
+	}
+	
+	vgAppendPathData(context->unit_circle, count, segments, (const void *)data);
+	memory_util_alloc(MEMORY_UTIL_PATH, CANVAS_ELLIPSE_SEGMENTS + CANVAS_ELLIPSE_COORDS * sizeof(VGfloat), 1);
+	
+	return context->unit_circle;
+}
+
+/**
+ * Fills the unit circle mapped by a matrix and an affine transformation.
+ * @param matrix The path matrix.
+ * @param x, y The center (surface orientation).
+ * @param a, b, c, d The linear part of the transformation of the circle.
+ */
+static void canvas_ellipse__fill(const VGfloat *matrix, VGPath unit, VGfloat x, VGfloat y, VGfloat a, VGfloat b, VGfloat c, VGfloat d)
+{
+	VGfloat product[9];
+	
+	// column major: [ sx shy w0 shx sy w1 tx ty w2 ]
+	product[0] = matrix[0] * a + matrix[3] * b;
+	product[1] = matrix[1] * a + matrix[4] * b;
+	product[2] = matrix[2];
+	product[3] = matrix[0] * c + matrix[3] * d;
+	product[4] = matrix[1] * c + matrix[4] * d;
+	product[5] = matrix[5];
+	product[6] = matrix[0] * x + matrix[3] * y + matrix[6];
+	product[7] = matrix[1] * x + matrix[4] * y + matrix[7];
+	product[8] = matrix[8];
+	
+	vgLoadMatrix(product);
+	PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(unit, VG_FILL_PATH));
+}
+
+/**
+ * Draws the immediate path if it is a pending full ellipse and can be drawn
+ * with the unit circle: filled with a color.
+ * @param mode VG_FILL_PATH or VG_STROKE_PATH
+ * @return 1 if the path was drawn, 0 if it has to be drawn as path.
+ */
+int canvas_ellipse_draw(VGPaintMode mode)
+{
+	canvas_context_t *context = context_util_get();
+	const VGfloat *e = context->path_ellipse;
+	VGfloat matrix[9];
+	VGPath unit = VG_INVALID_HANDLE;
+	VGint matrix_mode = 0;
+	
+	// the paint of gradients and patterns is mapped by the path matrix
+	if(!context->path_ellipse_pending || mode != VG_FILL_PATH || canvas_fillStyle_get()->paint_type != PAINT_TYPE_COLOR)
+	{
+		return 0;
+	}
+	
+	unit = canvas_ellipse__unit();
+	
+	if(unit == VG_INVALID_HANDLE)
+	{
+		return 0;
+	}
+	
+	matrix_mode = vgGeti(VG_MATRIX_MODE);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	vgGetMatrix(matrix);
+	
+	// the rotation is clockwise on the canvas, anticlockwise in the flipped path
+	canvas_ellipse__fill(matrix, unit, e[0], egl_get_height() - e[1], e[2] * cosf(e[4]), -e[2] * sinf(e[4]), e[3] * sinf(e[4]), e[3] * cosf(e[4]));
+	
+	vgLoadMatrix(matrix);
+	vgSeti(VG_MATRIX_MODE, matrix_mode);
+	
+	return 1;
+}
+
+/**
+ * Fills a circle with the unit circle. The matrix mode must be
+ * VG_MATRIX_PATH_USER_TO_SURFACE and the caller restores the matrix.
+ * @param matrix The path matrix.
+ * @param x The x axis of the center (surface orientation).
+ * @param y The y axis of the center (surface orientation).
+ * @param radius The radius.
+ */
+void canvas_ellipse_draw_circle(const VGfloat *matrix, VGfloat x, VGfloat y, VGfloat radius)
+{
+	VGPath unit = canvas_ellipse__unit();
+	
+	if(unit != VG_INVALID_HANDLE)
+	{
+		canvas_ellipse__fill(matrix, unit, x, y, radius, 0, 0, radius);
+	}
+}
+
+/**
+ * Destroys the unit circle of the current context.
+ */
+void canvas_ellipse_cleanup(void)
+{
+	canvas_context_t *context = context_util_get();
+	
+	if(context->unit_circle == VG_INVALID_HANDLE)
+	{
+		return;
+	}
+	
+	vgDestroyPath(context->unit_circle);
+	context->unit_circle = VG_INVALID_HANDLE;
+	
+	memory_util_free(MEMORY_UTIL_PATH, CANVAS_ELLIPSE_SEGMENTS + CANVAS_ELLIPSE_COORDS * sizeof(VGfloat), 1);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CANVAS_ELLIPSE_H__
+#define __CANVAS_ELLIPSE_H__
+
+#include <VG/openvg.h>
+
+void canvas_ellipse(VGfloat x, VGfloat y, VGfloat radius_x, VGfloat radius_y, VGfloat rotation, VGfloat start_angle, VGfloat end_angle, VGboolean anticlockwise);
+void canvas_ellipse_append(VGfloat x, VGfloat y, VGfloat radius_x, VGfloat radius_y, VGfloat rotation, VGfloat start_angle, VGfloat sweep);
+void canvas_ellipse_flush(void);
+int canvas_ellipse_draw(VGPaintMode mode);
+void canvas_ellipse_draw_circle(const VGfloat *matrix, VGfloat x, VGfloat y, VGfloat radius);
+void canvas_ellipse_cleanup(void);
+
+#endif /* __CANVAS_ELLIPSE_H__ */
@@ -25,6 +25,9 @@
 #include "canvas-paint.h"
 #include "canvas-fillStyle.h"
 #include "canvas-fill.h"
+#include "canvas-ellipse.h"
+#include "profile-util.h"
+#include "trace-util.h"
 
 /**
  * The fill() method fills the current or given path with the current fill style
@@ -32,7 +35,21 @@
  */
 void canvas_fill(void)
 {
+	TRACE_DECLARE(trace_begin);
+	
+	if(!canvas_beginPath_visible(VG_FILL_PATH))
+	{
+		return;
+	}
+	
 	paint_activate(canvas_fillStyle_get(), VG_FILL_PATH);
 	
-	vgDrawPath(canvas_beginPath_get(), VG_FILL_PATH);
+	TRACE_BEGIN(trace_begin);
+	
+	if(!canvas_ellipse_draw(VG_FILL_PATH))
+	{
+		PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(canvas_beginPath_get(), VG_FILL_PATH));
+	}
+	
+	TRACE_END("path", "fill", trace_begin);
 }
@@ -28,6 +28,8 @@
 #include "canvas-moveTo.h"
 #include "canvas-lineTo.h"
 #include "canvas-closePath.h"
+#include "profile-util.h"
+#include "trace-util.h"
 
 /**
  * The fillRect() method draws a filled rectangle at (x, y) position whose size
@@ -40,7 +42,7 @@
  */
 void canvas_fillRect(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
 {
-	paint_activate(canvas_fillStyle_get(), VG_FILL_PATH);
+	TRACE_DECLARE(trace_begin);
 	
 	canvas_beginPath();
 	
@@ -51,5 +53,17 @@ void canvas_fillRect(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
 	canvas_lineTo(x, y + height);
 	canvas_closePath();
 	
-	vgDrawPath(canvas_beginPath_get(), VG_FILL_PATH);
+	// the rectangle stays the immediate path even if it is not drawn
+	if(!canvas_beginPath_visible(VG_FILL_PATH))
+	{
+		return;
+	}
+	
+	paint_activate(canvas_fillStyle_get(), VG_FILL_PATH);
+	
+	TRACE_BEGIN(trace_begin);
+	
+	PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(canvas_beginPath_get(), VG_FILL_PATH));
+	
+	TRACE_END("path", "fillRect", trace_begin);
 }
@@ -22,8 +22,7 @@
 
 #include "canvas-paint.h"
 #include "canvas-fillStyle.h"
-
-static paint_t *canvas_fillStyle_paint = NULL;
+#include "context-util.h"
 
 /**
  * The fillStyle property specifies the color or style to use inside shapes.
@@ -31,7 +30,7 @@ static paint_t *canvas_fillStyle_paint = NULL;
  */
 void canvas_fillStyle(paint_t *paint)
 {
-	canvas_fillStyle_paint = paint;
+	context_util_get()->fill_style = paint;
 }
 
 /**
@@ -40,5 +39,5 @@ void canvas_fillStyle(paint_t *paint)
  */
 paint_t *canvas_fillStyle_get(void)
 {
-	return canvas_fillStyle_paint;
+	return context_util_get()->fill_style;
 }
@@ -22,6 +22,7 @@
 
 #include "log-util.h"
 #include "egl-util.h"
+#include "cull-util.h"
 #include "canvas-beginPath.h"
 #include "canvas-paint.h"
 #include "canvas-fillStyle.h"
@@ -31,6 +32,113 @@
 #include "canvas-textAlign.h"
 #include "canvas-textBaseline.h"
 #include "canvas-kerning.h"
+#include "profile-util.h"
+#include "trace-util.h"
+
+/**
+ * Fills a text with glyph bitmaps from the font atlas in stencil mode, so the
+ * fill paint still applies. The pen position is rounded to whole pixels.
+ * Glyphs the atlas can't hold are filled as paths.
+ * @param text The text.
+ * @param fonts_index The font.
+ * @param size The font size.
+ * @param x The x axis of the pen position of the first character.
+ * @param y The y axis of the baseline.
+ * @return 1 if the text was filled, 0 if the current transformation is not a
+ *         translation and the text has to be filled with paths.
+ */
+static int canvas_fillText_atlas(char *text, int fonts_index, VGfloat size, VGfloat x, VGfloat y)
+{
+	paint_t *paint = canvas_fillStyle_get();
+	size_t length = strlen(text);
+	size_t text_index = 0;
+	VGfloat offset_x = 0;
+	int char_index = 0;
+	VGImage image = VG_INVALID_HANDLE;
+	VGint left = 0;
+	VGint bottom = 0;
+	VGfloat pen_x = 0;
+	VGfloat pen_y = 0;
+	VGfloat matrix_path[9];
+	VGfloat matrix_backup_image[9];
+	VGfloat matrix_backup_fill_paint[9];
+	
+	vgGetMatrix(matrix_path);
+	
+	// scaled or rotated bitmaps would be blurry
+	if(matrix_path[0] != 1 || matrix_path[1] != 0 || matrix_path[2] != 0 || matrix_path[3] != 0 || matrix_path[4] != 1 || matrix_path[5] != 0 || matrix_path[8] != 1)
+	{
+		return 0;
+	}
+	
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+	vgGetMatrix(matrix_backup_fill_paint);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_IMAGE_USER_TO_SURFACE);
+	vgGetMatrix(matrix_backup_image);
+	vgSeti(VG_IMAGE_MODE, VG_DRAW_IMAGE_STENCIL);
+	
+	pen_y = floorf(egl_get_height() - y + matrix_path[7] + 0.5f);
+	
+	for(text_index = 0; text_index < length; text_index++)
+	{
+		char_index = font_util_get_char_index(fonts_index, text[text_index]);
+		pen_x = floorf(x + offset_x * size + matrix_path[6] + 0.5f);
+		
+		if(font_util_atlas_get_glyph(fonts_index, char_index, size, &image, &left, &bottom) == 0)
+		{
+			if(image != VG_INVALID_HANDLE)
+			{
+				// gradients and patterns stay in canvas coordinates
+				if(paint->paint_type != PAINT_TYPE_COLOR)
+				{
+					vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+					vgLoadMatrix(matrix_backup_fill_paint);
+					vgTranslate(-(pen_x + left - matrix_path[6]), -(pen_y + bottom - matrix_path[7]));
+					vgSeti(VG_MATRIX_MODE, VG_MATRIX_IMAGE_USER_TO_SURFACE);
+				}
+				
+				vgLoadIdentity();
+				vgTranslate(pen_x + left, pen_y + bottom);
+				
+				PROFILE_CALL(PROFILE_DRAW_IMAGE, vgDrawImage(image));
+			}
+		}
+		else if(char_index != -1)
+		{
+			vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+			vgLoadMatrix(matrix_backup_fill_paint);
+			vgScale(1 / size, 1 / size);
+			vgTranslate(-(x + offset_x * size), -(egl_get_height() - y));
+			
+			vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+			vgTranslate(x + offset_x * size, egl_get_height() - y);
+			vgScale(size, size);
+			
+			PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(font_util_get_path(fonts_index, char_index), VG_FILL_PATH));
+			
+			vgLoadMatrix(matrix_path);
+			vgSeti(VG_MATRIX_MODE, VG_MATRIX_IMAGE_USER_TO_SURFACE);
+		}
+		
+		if(text_index < length - 1)
+		{
+			if(canvas_kerning_get() && font_util_get_kerning_availability(fonts_index) == VG_TRUE)
+			{
+				offset_x += font_util_get_kerning_x(fonts_index, text[text_index], text[text_index + 1]);
+			}
+			
+			offset_x += font_util_get_advance_x(fonts_index, char_index);
+		}
+	}
+	
+	vgSeti(VG_IMAGE_MODE, VG_DRAW_IMAGE_NORMAL);
+	vgLoadMatrix(matrix_backup_image);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+	vgLoadMatrix(matrix_backup_fill_paint);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	
+	return 1;
+}
 
 /**
  * The fillText() method fills a given text at the given (x, y) position. If the
@@ -57,12 +165,15 @@ void canvas_fillText(char *text, VGfloat x, VGfloat y)
 	VGfloat end_y_temp = 0;
 	VGfloat matrix_backup_fill_paint[9];
 	VGfloat matrix_backup_path[9];
+	TRACE_DECLARE(trace_begin);
 	
 	if(fonts_index < 0 || text == NULL)
 	{
 		return;
 	}
 	
+	TRACE_BEGIN(trace_begin);
+	
 	for(text_index = 0; text_index < strlen(text); text_index++)
 	{
 		char_index = font_util_get_char_index(fonts_index, text[text_index]);
@@ -168,8 +279,20 @@ void canvas_fillText(char *text, VGfloat x, VGfloat y)
 	
 	offset_x = 0;
 	
+	if(!cull_util_user(x + start_x * size, egl_get_height() - y - end_y * size, x + end_x * size, egl_get_height() - y + start_y * size, 0))
+	{
+		TRACE_END_ARG("text", "fillText", trace_begin, strlen(text));
+		return;
+	}
+	
 	paint_activate(canvas_fillStyle_get(), VG_FILL_PATH);
 	
+	if(size <= font_util_atlas_get_size() && canvas_fillText_atlas(text, fonts_index, size, x, y))
+	{
+		TRACE_END_ARG("text", "fillText", trace_begin, strlen(text));
+		return;
+	}
+	
 	vgGetMatrix(matrix_backup_path);
 	
 	vgTranslate(x, egl_get_height() - y);
@@ -188,7 +311,7 @@ void canvas_fillText(char *text, VGfloat x, VGfloat y)
 		
 		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
 		
-		vgDrawPath(font_util_get_path(fonts_index, char_index), VG_FILL_PATH);
+		PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(font_util_get_path(fonts_index, char_index), VG_FILL_PATH));
 		
 		vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
 		
@@ -213,4 +336,6 @@ void canvas_fillText(char *text, VGfloat x, VGfloat y)
 	}
 	
 	vgLoadMatrix(matrix_backup_path);
+	
+	TRACE_END_ARG("text", "fillText", trace_begin, strlen(text));
 }
@@ -23,9 +23,7 @@
 #include "log-util.h"
 #include "font-util.h"
 #include "canvas-font.h"
-
-static int canvas_font_index = -1; // no font
-static float canvas_font_size = 0;
+#include "context-util.h"
 
 /**
  * The font property specifies the current text style being used when drawing
@@ -36,16 +34,18 @@ static float canvas_font_size = 0;
  */
 void canvas_font(char *name, VGfloat size)
 {
-	canvas_font_index = font_util_get(name);
+	canvas_context_t *context = context_util_get();
+	
+	context->font_index = font_util_get(name);
 	
-	if(canvas_font_index < 0)
+	if(context->font_index < 0)
 	{
 		eprintf("Failed to find font face: %s\n", name);
 		
 		return;
 	}
 	
-	canvas_font_size = size;
+	context->font_size = size;
 }
 
 /**
@@ -54,7 +54,7 @@ void canvas_font(char *name, VGfloat size)
  */
 int canvas_font_get_index(void)
 {
-	return canvas_font_index;
+	return context_util_get()->font_index;
 }
 
 /**
@@ -63,5 +63,5 @@ int canvas_font_get_index(void)
  */
 VGfloat canvas_font_get_size(void)
 {
-	return canvas_font_size;
+	return context_util_get()->font_size;
 }
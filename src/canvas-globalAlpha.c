@@ -20,8 +20,7 @@
 #include "include-openvg.h"
 // #include "include-freetype.h"
 #include "canvas-globalAlpha.h"
-
-static VGfloat canvas_globalAlpha_value = 1;
+#include "context-util.h"
 
 /**
  * The globalAlpha property specifies the alpha value that is applied to shapes
@@ -36,7 +35,7 @@ void canvas_globalAlpha(VGfloat global_alpha)
 {
 	if(global_alpha >= 0 && global_alpha <= 1)
 	{
-		canvas_globalAlpha_value = global_alpha;
+		context_util_get()->global_alpha = global_alpha;
 	}
 }
 
@@ -46,5 +45,5 @@ void canvas_globalAlpha(VGfloat global_alpha)
  */
 VGfloat canvas_globalAlpha_get(void)
 {
-	return canvas_globalAlpha_value;
+	return context_util_get()->global_alpha;
 }
@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-globalCompositeOperation.h"
-
-static VGBlendMode canvas_globalCompositeOperation_value = VG_BLEND_SRC;
+#include "context-util.h"
 
 /**
  * The globalCompositeOperation property sets the type of compositing operation
@@ -35,61 +34,61 @@ void canvas_globalCompositeOperation(char *global_composite_operation)
 {
 	if(!strcmp(global_composite_operation, "source-atop") || !strcmp(global_composite_operation, "source-out") || !strcmp(global_composite_operation, "copy") || !strcmp(global_composite_operation, "xor"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_SRC;
+		context_util_get()->composite_operation = VG_BLEND_SRC;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_SRC);
 	}
 	else if(!strcmp(global_composite_operation, "source-in"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_SRC_IN;
+		context_util_get()->composite_operation = VG_BLEND_SRC_IN;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_SRC_IN);
 	}
 	else if(!strcmp(global_composite_operation, "source-over"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_SRC_OVER;
+		context_util_get()->composite_operation = VG_BLEND_SRC_OVER;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_SRC_OVER);
 	}
 	else if(!strcmp(global_composite_operation, "destination-in") || !strcmp(global_composite_operation, "destination-atop") || !strcmp(global_composite_operation, "destination-out"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_DST_IN;
+		context_util_get()->composite_operation = VG_BLEND_DST_IN;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_DST_IN);
 	}
 	else if(!strcmp(global_composite_operation, "destination-over"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_DST_OVER;
+		context_util_get()->composite_operation = VG_BLEND_DST_OVER;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_DST_OVER);
 	}
 	else if(!strcmp(global_composite_operation, "lighter"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_LIGHTEN;
+		context_util_get()->composite_operation = VG_BLEND_LIGHTEN;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_LIGHTEN);
 	}
 	else if(!strcmp(global_composite_operation, "vg-multiply"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_MULTIPLY;
+		context_util_get()->composite_operation = VG_BLEND_MULTIPLY;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_MULTIPLY);
 	}
 	else if(!strcmp(global_composite_operation, "vg-screen"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_SCREEN;
+		context_util_get()->composite_operation = VG_BLEND_SCREEN;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_SCREEN);
 	}
 	else if(!strcmp(global_composite_operation, "vg-darker"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_DARKEN;
+		context_util_get()->composite_operation = VG_BLEND_DARKEN;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_DARKEN);
 	}
 	else if(!strcmp(global_composite_operation, "vg-additive"))
 	{
-		canvas_globalCompositeOperation_value = VG_BLEND_ADDITIVE;
+		context_util_get()->composite_operation = VG_BLEND_ADDITIVE;
 		
 		vgSeti(VG_BLEND_MODE, VG_BLEND_ADDITIVE);
 	}
@@ -101,7 +100,7 @@ void canvas_globalCompositeOperation(char *global_composite_operation)
  */
 char *canvas_globalCompositeOperation_get(void)
 {
-	switch(canvas_globalCompositeOperation_value)
+	switch(context_util_get()->composite_operation)
 	{
 		case VG_BLEND_SRC:
 		{
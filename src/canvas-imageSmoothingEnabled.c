@@ -20,8 +20,7 @@
 #include "include-openvg.h"
 
 #include "canvas-imageSmoothingEnabled.h"
-
-static VGboolean canvas_imageSmoothingEnabled_value = VG_TRUE;
+#include "context-util.h"
 
 /**
  * The imageSmoothingEnabled property can be set to change if images are
@@ -31,6 +30,8 @@ static VGboolean canvas_imageSmoothingEnabled_value = VG_TRUE;
  */
 void canvas_imageSmoothingEnabled(VGboolean image_smoothing_enabled)
 {
+	context_util_get()->image_smoothing = image_smoothing_enabled;
+	
 	vgSeti(VG_IMAGE_QUALITY, image_smoothing_enabled ? VG_IMAGE_QUALITY_BETTER : VG_IMAGE_QUALITY_NONANTIALIASED);
 }
 
@@ -40,5 +41,5 @@ void canvas_imageSmoothingEnabled(VGboolean image_smoothing_enabled)
  */
 VGboolean canvas_imageSmoothingEnabled_get(void)
 {
-	return canvas_imageSmoothingEnabled_value;
+	return context_util_get()->image_smoothing;
 }
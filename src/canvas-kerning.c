@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-kerning.h"
-
-static VGboolean canvas_kerning_value = VG_TRUE;
+#include "context-util.h"
 
 /**
  * The kerning property specifies whether all following text renderings should
@@ -32,7 +31,7 @@ static VGboolean canvas_kerning_value = VG_TRUE;
  */
 void canvas_kerning(VGboolean kerning)
 {
-	canvas_kerning_value = kerning;
+	context_util_get()->kerning = kerning;
 }
 
 /**
@@ -41,5 +40,5 @@ void canvas_kerning(VGboolean kerning)
  */
 VGboolean canvas_kerning_get(void)
 {
-	return canvas_kerning_value;
+	return context_util_get()->kerning;
 }
@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-lineCap.h"
-
-static VGCapStyle canvas_lineCap_value = VG_CAP_BUTT;
+#include "context-util.h"
 
 /**
  * The lineCap property determines how the end points of every line are drawn.
@@ -34,19 +33,19 @@ void canvas_lineCap(char *line_cap)
 {
 	if(!strcmp(line_cap, "butt"))
 	{
-		canvas_lineCap_value = VG_CAP_BUTT;
+		context_util_get()->line_cap = VG_CAP_BUTT;
 		
 		vgSeti(VG_STROKE_CAP_STYLE, VG_CAP_BUTT);
 	}
 	else if(!strcmp(line_cap, "round"))
 	{
-		canvas_lineCap_value = VG_CAP_ROUND;
+		context_util_get()->line_cap = VG_CAP_ROUND;
 		
 		vgSeti(VG_STROKE_CAP_STYLE, VG_CAP_ROUND);
 	}
 	else if(!strcmp(line_cap, "square"))
 	{
-		canvas_lineCap_value = VG_CAP_SQUARE;
+		context_util_get()->line_cap = VG_CAP_SQUARE;
 		
 		vgSeti(VG_STROKE_CAP_STYLE, VG_CAP_SQUARE);
 	}
@@ -58,7 +57,7 @@ void canvas_lineCap(char *line_cap)
  */
 char *canvas_lineCap_get(void)
 {
-	switch(canvas_lineCap_value)
+	switch(context_util_get()->line_cap)
 	{
 		case VG_CAP_BUTT:
 		{
@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-lineDashOffset.h"
-
-static VGfloat canvas_lineDashOffset_value = 0;
+#include "context-util.h"
 
 /**
  * The lineDashOffset property sets the line dash pattern offset or "phase" to
@@ -31,7 +30,7 @@ static VGfloat canvas_lineDashOffset_value = 0;
  */
 void canvas_lineDashOffset(VGfloat line_dash_offset)
 {
-	canvas_lineDashOffset_value = line_dash_offset;
+	context_util_get()->line_dash_offset = line_dash_offset;
 	
 	vgSetf(VG_STROKE_DASH_PHASE, line_dash_offset);
 }
@@ -42,5 +41,5 @@ void canvas_lineDashOffset(VGfloat line_dash_offset)
  */
 VGfloat canvas_lineDashOffset_get(void)
 {
-	return canvas_lineDashOffset_value;
+	return context_util_get()->line_dash_offset;
 }
@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-lineJoin.h"
-
-static VGJoinStyle canvas_lineJoin_value = VG_JOIN_MITER;
+#include "context-util.h"
 
 /**
  * The lineJoin property determines how two connecting segments (of lines, arcs
@@ -35,19 +34,19 @@ void canvas_lineJoin(char *line_join)
 {
 	if(!strcmp(line_join, "miter"))
 	{
-		canvas_lineJoin_value = VG_JOIN_MITER;
+		context_util_get()->line_join = VG_JOIN_MITER;
 		
 		vgSeti(VG_STROKE_JOIN_STYLE, VG_JOIN_MITER);
 	}
 	else if(!strcmp(line_join, "round"))
 	{
-		canvas_lineJoin_value = VG_JOIN_ROUND;
+		context_util_get()->line_join = VG_JOIN_ROUND;
 		
 		vgSeti(VG_STROKE_JOIN_STYLE, VG_JOIN_ROUND);
 	}
 	else if(!strcmp(line_join, "bevel"))
 	{
-		canvas_lineJoin_value = VG_JOIN_BEVEL;
+		context_util_get()->line_join = VG_JOIN_BEVEL;
 		
 		vgSeti(VG_STROKE_JOIN_STYLE, VG_JOIN_BEVEL);
 	}
@@ -59,7 +58,7 @@ void canvas_lineJoin(char *line_join)
  */
 char *canvas_lineJoin_get(void)
 {
-	switch(canvas_lineJoin_value)
+	switch(context_util_get()->line_join)
 	{
 		case VG_JOIN_MITER:
 		{
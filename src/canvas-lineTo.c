@@ -22,7 +22,9 @@
 
 #include "egl-util.h"
 #include "canvas-beginPath.h"
+#include "path-util.h"
 #include "canvas-lineTo.h"
+#include "profile-util.h"
 
 /**
  * The lineTo() method connects the last point in the sub-path to the x, y
@@ -38,5 +40,10 @@ void canvas_lineTo(VGfloat x, VGfloat y)
 	data[0] = x;
 	data[1] = egl_get_height() - y;
 	
-	vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data);
+	canvas_beginPath_extend(data[0], data[1]);
+	
+	PROFILE_UPLOAD(sizeof(data));
+	canvas_beginPath_grow(1, 2);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data));
+	path_util_append(1, segment, data);
 }
@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-lineWidth.h"
-
-static VGfloat canvas_lineWidth_value = 1;
+#include "context-util.h"
 
 /**
  * The lineWidth property sets the thickness of lines in space units. Setting
@@ -35,7 +34,7 @@ void canvas_lineWidth(VGfloat line_width)
 {
 	if(line_width > 0)
 	{
-		canvas_lineWidth_value = line_width;
+		context_util_get()->line_width = line_width;
 		
 		vgSetf(VG_STROKE_LINE_WIDTH, line_width);
 	}
@@ -47,5 +46,5 @@ void canvas_lineWidth(VGfloat line_width)
  */
 VGfloat canvas_lineWidth_get(void)
 {
-	return canvas_lineWidth_value;
+	return context_util_get()->line_width;
 }
@@ -33,17 +33,18 @@
 #include "canvas-textBaseline.h"
 
 /**
- * The measureText() method returns an object that contains information about
- * the measured text (such as its width for example).
+ * Measures a text with the given font and text properties.
  * @param metrics The metrics structure where the measured informations are
  *                stored.
- * @param text The text to measure using the current font, textAlign,
- *             textBaseline, and direction values.
+ * @param text The text to measure.
+ * @param fonts_index The font.
+ * @param size The font size.
+ * @param kerning Whether kerning is applied (if the font supports it).
+ * @param align The text alignment.
+ * @param baseline The text baseline.
  */
-void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text)
+void canvas_measureText_layout(canvas_measure_text_metrics_t *metrics, char *text, int fonts_index, VGfloat size, VGboolean kerning, canvas_text_align_t align, canvas_text_baseline_t baseline)
 {
-	int fonts_index = canvas_font_get_index();
-	VGfloat size = canvas_font_get_size();
 	unsigned int text_index = 0;
 	VGfloat offset_x = 0;
 	VGfloat offset_kerning_x = 0;
@@ -87,7 +88,7 @@ void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text)
 		if(text_index < strlen(text) - 1)
 		{
 			// apply kerning if kerning should be used and if kerning is available
-			if(canvas_kerning_get() && font_util_get_kerning_availability(fonts_index) == VG_TRUE)
+			if(kerning && font_util_get_kerning_availability(fonts_index) == VG_TRUE)
 			{
 				offset_kerning_x = font_util_get_kerning_x(fonts_index, text[text_index], text[text_index + 1]);
 				
@@ -106,7 +107,7 @@ void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text)
 	metrics->width = (end_x - start_x) * size;
 	metrics->height = (start_y + end_y) * size;
 	
-	switch(canvas_textAlign_get_internal())
+	switch(align)
 	{
 		case CANVAS_TEXT_ALIGN_LEFT:
 		{
@@ -131,7 +132,7 @@ void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text)
 		}
 	}
 	
-	switch(canvas_textBaseline_get_internal())
+	switch(baseline)
 	{
 		case CANVAS_TEXT_BASELINE_TOP: case CANVAS_TEXT_BASELINE_HANGING:
 		{
@@ -180,3 +181,16 @@ void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text)
 	metrics->rendering_offset_x = start_x * size;
 	metrics->rendering_offset_y = start_y * size;
 }
+
+/**
+ * The measureText() method returns an object that contains information about
+ * the measured text (such as its width for example).
+ * @param metrics The metrics structure where the measured informations are
+ *                stored.
+ * @param text The text to measure using the current font, textAlign,
+ *             textBaseline, and direction values.
+ */
+void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text)
+{
+	canvas_measureText_layout(metrics, text, canvas_font_get_index(), canvas_font_get_size(), canvas_kerning_get(), canvas_textAlign_get_internal(), canvas_textBaseline_get_internal());
+}
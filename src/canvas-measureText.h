@@ -20,6 +20,8 @@
 #define __CANVAS_MEASURETEXT_H__
 
 #include <VG/openvg.h>
+#include "canvas-textAlign.h"
+#include "canvas-textBaseline.h"
 
 typedef struct canvas_measure_text_metrics_t
 {
@@ -41,6 +43,7 @@ typedef struct canvas_measure_text_metrics_t
 	VGfloat rendering_offset_y;
 } canvas_measure_text_metrics_t;
 
+void canvas_measureText_layout(canvas_measure_text_metrics_t *metrics, char *text, int fonts_index, VGfloat size, VGboolean kerning, canvas_text_align_t align, canvas_text_baseline_t baseline);
 void canvas_measureText(canvas_measure_text_metrics_t *metrics, char *text);
 
 #endif /* __CANVAS_MEASURETEXT_H__ */
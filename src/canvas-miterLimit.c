@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-miterLimit.h"
-
-static VGfloat canvas_miterLimit_value = 10;
+#include "context-util.h"
 
 /**
  * The miterLimit property of the Canvas 2D API sets the miter limit ratio in
@@ -35,7 +34,7 @@ void canvas_miterLimit(VGfloat miter_limit)
 {
 	if(miter_limit > 0)
 	{
-		canvas_miterLimit_value = miter_limit;
+		context_util_get()->miter_limit = miter_limit;
 		
 		vgSetf(VG_STROKE_MITER_LIMIT, miter_limit);
 	}
@@ -47,5 +46,5 @@ void canvas_miterLimit(VGfloat miter_limit)
  */
 VGfloat canvas_miterLimit_get(void)
 {
-	return canvas_miterLimit_value;
+	return context_util_get()->miter_limit;
 }
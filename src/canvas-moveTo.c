@@ -22,7 +22,9 @@
 
 #include "egl-util.h"
 #include "canvas-beginPath.h"
+#include "path-util.h"
 #include "canvas-moveTo.h"
+#include "profile-util.h"
 
 /**
  * The moveTo() method moves the starting point of a new sub-path to the (x, y)
@@ -38,8 +40,13 @@ void canvas_moveTo(VGfloat x, VGfloat y)
 	data[0] = x;
 	data[1] = egl_get_height() - y;
 	
+	canvas_beginPath_extend(data[0], data[1]);
+	
 	// currentPath_sx = x;
 	// currentPath_sy = y;
 	
-	vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data);
+	PROFILE_UPLOAD(sizeof(data));
+	canvas_beginPath_grow(1, 2);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data));
+	path_util_append(1, segment, data);
 }
@@ -23,6 +23,9 @@
 #include "egl-util.h"
 #include "canvas-paint.h"
 #include "canvas-globalAlpha.h"
+#include "profile-util.h"
+#include "trace-util.h"
+#include "memory-util.h"
 
 /**
  * Creates a new RGBA color paint
@@ -38,8 +41,10 @@ void paint_createColor(paint_t *paint, VGfloat red, VGfloat green, VGfloat blue,
 	paint->paint_type = PAINT_TYPE_COLOR;
 	paint->count = 0;
 	paint->data = NULL;
+	paint->image = NULL;
 	
 	paint->paint = vgCreatePaint();
+	memory_util_alloc(MEMORY_UTIL_PAINT, MEMORY_UTIL_PAINT_SIZE, 1);
 	vgSetParameteri(paint->paint, VG_PAINT_TYPE, VG_PAINT_TYPE_COLOR);
 	
 	paint_setRGBA(paint, red, green, blue, alpha);
@@ -61,6 +66,7 @@ void paint_createLinearGradient(paint_t *paint, VGfloat x1, VGfloat y1, VGfloat
 	paint->paint_type = PAINT_TYPE_LINEAR_GRADIENT;
 	paint->count = 0;
 	paint->data = NULL;
+	paint->image = NULL;
 	
 	data[0] = x1;
 	data[1] = egl_get_height() - y1;
@@ -68,9 +74,10 @@ void paint_createLinearGradient(paint_t *paint, VGfloat x1, VGfloat y1, VGfloat
 	data[3] = egl_get_height() - y2;
 	
 	paint->paint = vgCreatePaint();
+	memory_util_alloc(MEMORY_UTIL_PAINT, MEMORY_UTIL_PAINT_SIZE, 1);
 	
 	vgSetParameteri(paint->paint, VG_PAINT_TYPE, VG_PAINT_TYPE_LINEAR_GRADIENT);
-	vgSetParameterfv(paint->paint, VG_PAINT_LINEAR_GRADIENT, 4, data);
+	PROFILE_CALL(PROFILE_SET_PARAMETER, vgSetParameterfv(paint->paint, VG_PAINT_LINEAR_GRADIENT, 4, data));
 }
 
 /**
@@ -90,6 +97,7 @@ void paint_createRadialGradient(paint_t *paint, VGfloat cx, VGfloat cy, VGfloat
 	paint->paint_type = PAINT_TYPE_RADIAL_GRADIENT;
 	paint->count = 0;
 	paint->data = NULL;
+	paint->image = NULL;
 	
 	data[0] = cx;
 	data[1] = egl_get_height() - cy;
@@ -98,9 +106,10 @@ void paint_createRadialGradient(paint_t *paint, VGfloat cx, VGfloat cy, VGfloat
 	data[4] = r;
 	
 	paint->paint = vgCreatePaint();
+	memory_util_alloc(MEMORY_UTIL_PAINT, MEMORY_UTIL_PAINT_SIZE, 1);
 	
 	vgSetParameteri(paint->paint, VG_PAINT_TYPE, VG_PAINT_TYPE_RADIAL_GRADIENT);
-	vgSetParameterfv(paint->paint, VG_PAINT_RADIAL_GRADIENT, 5, data);
+	PROFILE_CALL(PROFILE_SET_PARAMETER, vgSetParameterfv(paint->paint, VG_PAINT_RADIAL_GRADIENT, 5, data));
 }
 
 /**
@@ -115,8 +124,10 @@ void paint_createPattern(paint_t *paint, image_t *img, VGTilingMode mode)
 	paint->paint_type = PAINT_TYPE_PATTERN;
 	paint->count = 0;
 	paint->data = NULL;
+	paint->image = img;
 	
 	paint->paint = vgCreatePaint();
+	memory_util_alloc(MEMORY_UTIL_PAINT, MEMORY_UTIL_PAINT_SIZE, 1);
 	vgSetParameteri(paint->paint, VG_PAINT_TYPE, VG_PAINT_TYPE_PATTERN);
 	vgSetParameteri(paint->paint, VG_PAINT_PATTERN_TILING_MODE, mode);
 	vgPaintPattern(paint->paint, img->image);
@@ -136,6 +147,7 @@ void paint_cleanup(paint_t *paint)
 	}
 	
 	vgDestroyPaint(paint->paint);
+	memory_util_free(MEMORY_UTIL_PAINT, MEMORY_UTIL_PAINT_SIZE + paint->count * sizeof(VGfloat), 1);
 }
 
 /**
@@ -159,17 +171,24 @@ void paint_setRGBA(paint_t *paint, VGfloat red, VGfloat green, VGfloat blue, VGf
 		return;
 	}
 	
-	paint->count = 4;
-	paint_data_backup = paint->data;
-	paint->data = realloc(paint->data, 4 * sizeof(VGfloat));
-	
-	if(paint->data == NULL)
+	// color paints are set very often, the data is only allocated once
+	if(paint->count != 4 || paint->data == NULL)
 	{
-		eprintf("Failed to reallocate color data of paint.\n");
+		paint_data_backup = paint->data;
+		PROFILE_ALLOC(4 * sizeof(VGfloat));
+		paint->data = realloc(paint->data, 4 * sizeof(VGfloat));
 		
-		paint->data = paint_data_backup;
+		if(paint->data == NULL)
+		{
+			eprintf("Failed to reallocate color data of paint.\n");
+			
+			paint->data = paint_data_backup;
+			
+			return;
+		}
 		
-		return;
+		memory_util_alloc(MEMORY_UTIL_PAINT, (4 - paint->count) * sizeof(VGfloat), 0);
+		paint->count = 4;
 	}
 	
 	paint->data[0] = red;
@@ -200,8 +219,11 @@ void paint_addColorStop(paint_t *paint, VGfloat position, VGfloat red, VGfloat g
 		return;
 	}
 	
+	memory_util_alloc(MEMORY_UTIL_PAINT, 5 * sizeof(VGfloat), 0);
+	
 	paint->count += 5;
 	paint_data_backup = paint->data;
+	PROFILE_ALLOC(paint->count * sizeof(VGfloat));
 	paint->data = realloc(paint->data, paint->count * sizeof(VGfloat));
 	
 	if(paint->data == NULL)
@@ -232,6 +254,9 @@ void paint_activate(paint_t *paint, VGbitfield mode)
 	VGfloat data_paint[4];
 	VGfloat *data_gradient = NULL;
 	int i = 0;
+	TRACE_DECLARE(trace_begin);
+	
+	TRACE_BEGIN(trace_begin);
 	
 	switch(paint->paint_type)
 	{
@@ -241,7 +266,7 @@ void paint_activate(paint_t *paint, VGbitfield mode)
 			
 			data_paint[3] *= canvas_globalAlpha_get();
 			
-			vgSetParameterfv(paint->paint, VG_PAINT_COLOR, 4, data_paint);
+			PROFILE_CALL(PROFILE_SET_PARAMETER, vgSetParameterfv(paint->paint, VG_PAINT_COLOR, 4, data_paint));
 			
 			break;
 		}
@@ -255,6 +280,7 @@ void paint_activate(paint_t *paint, VGbitfield mode)
 				return;
 			}
 			
+			PROFILE_ALLOC(paint->count * sizeof(VGfloat));
 			data_gradient = malloc(paint->count * sizeof(VGfloat));
 			if(data_gradient == NULL)
 			{
@@ -270,7 +296,7 @@ void paint_activate(paint_t *paint, VGbitfield mode)
 				data_gradient[i] *= canvas_globalAlpha_get();
 			}
 			
-			vgSetParameterfv(paint->paint, VG_PAINT_COLOR_RAMP_STOPS, paint->count, data_gradient);
+			PROFILE_CALL(PROFILE_SET_PARAMETER, vgSetParameterfv(paint->paint, VG_PAINT_COLOR_RAMP_STOPS, paint->count, data_gradient));
 			vgSetParameteri(paint->paint, VG_PAINT_COLOR_RAMP_SPREAD_MODE, VG_COLOR_RAMP_SPREAD_PAD);
 			vgSetParameteri(paint->paint, VG_PAINT_COLOR_RAMP_PREMULTIPLIED, VG_FALSE);
 			
@@ -284,4 +310,6 @@ void paint_activate(paint_t *paint, VGbitfield mode)
 	}
 	
 	vgSetPaint(paint->paint, mode);
+	
+	TRACE_END_ARG("paint", "activate", trace_begin, paint->paint_type);
 }
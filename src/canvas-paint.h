@@ -36,6 +36,7 @@ typedef struct paint_t
 	VGPaint paint;
 	VGint count;
 	VGfloat *data;
+	image_t *image; // image of a pattern, NULL otherwise
 } paint_t;
 
 void paint_createColor(paint_t *paint, VGfloat red, VGfloat green, VGfloat blue, VGfloat alpha);
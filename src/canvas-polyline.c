@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "log-util.h"
+#include "canvas-beginPath.h"
+#include "path-util.h"
+#include "canvas-polyline.h"
+#include "profile-util.h"
+
+/*
+ * Appending a whole series at once instead of calling lineTo() per point. The
+ * segments and flipped coordinates are built in scratch buffers that are kept
+ * for the next call.
+ */
+
+static VGubyte *polyline_segments = NULL;
+static VGfloat *polyline_coords = NULL;
+static VGint polyline_capacity = 0;
+
+/**
+ * Makes sure the scratch buffers can hold an amount of points and a closing
+ * segment.
+ * @param count The amount of points.
+ * @return 0 on success, -1 if the memory could not be allocated.
+ */
+static int canvas_polyline__reserve(VGint count)
+{
+	VGubyte *segments = NULL;
+	VGfloat *coords = NULL;
+	VGint capacity = polyline_capacity > 0 ? polyline_capacity : 256;
+	
+	if(count < polyline_capacity)
+	{
+		return 0;
+	}
+	
+	while(capacity <= count)
+	{
+		capacity *= 2;
+	}
+	
+	segments = realloc(polyline_segments, capacity);
+	if(segments == NULL)
+	{
+		eprintf("Failed to allocate polyline segments.\n");
+		return -1;
+	}
+	polyline_segments = segments;
+	
+	coords = realloc(polyline_coords, capacity * 2 * sizeof(VGfloat));
+	if(coords == NULL)
+	{
+		eprintf("Failed to allocate polyline coordinates.\n");
+		return -1;
+	}
+	polyline_coords = coords;
+	
+	// only the first segment ever changes
+	memset(polyline_segments + polyline_capacity, VG_LINE_TO_ABS, capacity - polyline_capacity);
+	polyline_capacity = capacity;
+	
+	return 0;
+}
+
+/**
+ * Appends points to the immediate path.
+ * @param points The x and y axis of every point.
+ * @param count The amount of points.
+ * @param move Whether the first point starts a new sub-path.
+ * @param closed Whether the sub-path is closed after the last point.
+ */
+static void canvas_polyline__append(const VGfloat *points, VGint count, int move, int closed)
+{
+	VGfloat height = egl_get_height();
+	VGfloat min_x = 0;
+	VGfloat min_y = 0;
+	VGfloat max_x = 0;
+	VGfloat max_y = 0;
+	VGfloat x = 0;
+	VGfloat y = 0;
+	VGint segments = count;
+	VGint i = 0;
+	
+	if(count <= 0 || canvas_polyline__reserve(count) == -1)
+	{
+		return;
+	}
+	
+	min_x = max_x = points[0];
+	min_y = max_y = height - points[1];
+	
+	// flip and measure in one pass, the loop has no dependencies besides min/max
+	for(i = 0; i < count; i++)
+	{
+		x = points[2 * i];
+		y = height - points[2 * i + 1];
+		
+		polyline_coords[2 * i] = x;
+		polyline_coords[2 * i + 1] = y;
+		
+		min_x = x < min_x ? x : min_x;
+		min_y = y < min_y ? y : min_y;
+		max_x = x > max_x ? x : max_x;
+		max_y = y > max_y ? y : max_y;
+	}
+	
+	canvas_beginPath_extend(min_x, min_y);
+	canvas_beginPath_extend(max_x, max_y);
+	
+	polyline_segments[0] = move ? VG_MOVE_TO_ABS : VG_LINE_TO_ABS;
+	
+	if(closed)
+	{
+		polyline_segments[segments++] = VG_CLOSE_PATH;
+	}
+	
+	PROFILE_UPLOAD(count * 2 * sizeof(VGfloat));
+	canvas_beginPath_grow(segments, count * 2);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), segments, polyline_segments, (const void *)polyline_coords));
+	path_util_append(segments, polyline_segments, polyline_coords);
+	
+	if(closed)
+	{
+		polyline_segments[count] = VG_LINE_TO_ABS;
+	}
+}
+
+/**
+ * Starts a new sub-path at the first point and connects the other points with
+ * straight lines, like moveTo() followed by lineTo() for every other point.
+ * @param points The x and y axis of every point.
+ * @param count The amount of points.
+ * @param closed Whether the sub-path is closed like with closePath().
+ */
+void canvas_polyline(const VGfloat *points, VGint count, int closed)
+{
+	canvas_polyline__append(points, count, 1, closed);
+}
+
+/**
+ * Connects the points to the current sub-path with straight lines, like
+ * lineTo() for every point.
+ * @param points The x and y axis of every point.
+ * @param count The amount of points.
+ */
+void canvas_polyline_lines(const VGfloat *points, VGint count)
+{
+	canvas_polyline__append(points, count, 0, 0);
+}
+
+/**
+ * Frees the scratch buffers.
+ */
+void canvas_polyline_cleanup(void)
+{
+	free(polyline_segments);
+	free(polyline_coords);
+	
+	polyline_segments = NULL;
+	polyline_coords = NULL;
+	polyline_capacity = 0;
+}
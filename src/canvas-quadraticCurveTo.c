@@ -22,7 +22,9 @@
 
 #include "egl-util.h"
 #include "canvas-beginPath.h"
+#include "path-util.h"
 #include "canvas-quadraticCurveTo.h"
+#include "profile-util.h"
 
 /**
  * The quadraticCurveTo() method adds a quadratic Bézier curve to the path. It
@@ -45,5 +47,11 @@ void canvas_quadraticCurveTo(VGfloat cpx, VGfloat cpy, VGfloat x, VGfloat y)
 	data[2] = x;
 	data[3] = egl_get_height() - y;
 	
-	vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data);
+	canvas_beginPath_extend(data[0], data[1]);
+	canvas_beginPath_extend(data[2], data[3]);
+	
+	PROFILE_UPLOAD(sizeof(data));
+	canvas_beginPath_grow(1, 4);
+	PROFILE_CALL(PROFILE_APPEND_PATH_DATA, vgAppendPathData(canvas_beginPath_get(), 1, segment, (const void *)data));
+	path_util_append(1, segment, data);
 }
@@ -38,6 +38,7 @@
 #include "canvas-font.h"
 #include "canvas-textAlign.h"
 #include "canvas-textBaseline.h"
+#include "canvas.h"
 #include "canvas-imageSmoothingEnabled.h"
 
 /**
@@ -78,20 +79,27 @@ void canvas_restore(void)
 		canvas_clip_set_mask(state_top->clip_mask);
 	}
 	canvas_clip_set_clipping(state_top->clip_clipping);
+	canvas_clip_set_bounds(state_top->clip_bounds);
 	
 	canvas_setLineDash(state_top->lineDash_count, state_top->lineDash_data);
 	
-	canvas_fillStyle(state_top->fillStyle);
+	// the color paints of the context are reused for every color set after
+	// saving, colors are restored from their values
 	if(state_top->fillStyle_count != 0 && state_top->fillStyle_data != NULL)
 	{
-		memcpy(canvas_fillStyle_get()->data, state_top->fillStyle_data, state_top->fillStyle_count * sizeof(VGfloat));
-		canvas_fillStyle_get()->count = state_top->fillStyle_count;
+		canvas__set_style_color(0, state_top->fillStyle_data[0], state_top->fillStyle_data[1], state_top->fillStyle_data[2], state_top->fillStyle_data[3]);
+	}
+	else
+	{
+		canvas__set_style_paint(0, state_top->fillStyle);
 	}
-	canvas_strokeStyle(state_top->strokeStyle);
 	if(state_top->strokeStyle_count != 0 && state_top->strokeStyle_data != NULL)
 	{
-		memcpy(canvas_strokeStyle_get()->data, state_top->strokeStyle_data, state_top->strokeStyle_count * sizeof(VGfloat));
-		canvas_strokeStyle_get()->count = state_top->strokeStyle_count;
+		canvas__set_style_color(1, state_top->strokeStyle_data[0], state_top->strokeStyle_data[1], state_top->strokeStyle_data[2], state_top->strokeStyle_data[3]);
+	}
+	else
+	{
+		canvas__set_style_paint(1, state_top->strokeStyle);
 	}
 	canvas_globalAlpha(state_top->globalAlpha);
 	
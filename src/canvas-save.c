@@ -39,8 +39,9 @@
 #include "canvas-textAlign.h"
 #include "canvas-textBaseline.h"
 #include "canvas-imageSmoothingEnabled.h"
-
-static canvas_save_stack_t *canvas_save_stack_top = NULL;
+#include "profile-util.h"
+#include "memory-util.h"
+#include "context-util.h"
 
 /**
  * The save() method saves the entire state of the canvas by pushing the current
@@ -48,8 +49,10 @@ static canvas_save_stack_t *canvas_save_stack_top = NULL;
  */
 void canvas_save(void)
 {
+	canvas_context_t *context = context_util_get();
 	canvas_save_stack_t *state = NULL;
 	
+	PROFILE_ALLOC(sizeof(canvas_save_stack_t));
 	state = malloc(sizeof(canvas_save_stack_t));
 	
 	if(state == NULL)
@@ -59,120 +62,127 @@ void canvas_save(void)
 		return;
 	}
 	
-	if(canvas_save_stack_top == NULL) // state is first element in stack
+	if(context->save_stack == NULL) // state is first element in stack
 	{
-		canvas_save_stack_top = state;
+		context->save_stack = state;
 		state->next = NULL;
 	}
 	else
 	{
-		state->next = canvas_save_stack_top;
-		canvas_save_stack_top = state;
+		state->next = context->save_stack;
+		context->save_stack = state;
 	}
 	
 	// save properties to top state of stack
 	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
-	vgGetMatrix(canvas_save_stack_top->matrix_path);
+	vgGetMatrix(state->matrix_path);
 	vgSeti(VG_MATRIX_MODE, VG_MATRIX_IMAGE_USER_TO_SURFACE);
-	vgGetMatrix(canvas_save_stack_top->matrix_image);
+	vgGetMatrix(state->matrix_image);
 	vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
-	vgGetMatrix(canvas_save_stack_top->matrix_fill);
+	vgGetMatrix(state->matrix_fill);
 	vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
-	vgGetMatrix(canvas_save_stack_top->matrix_stroke);
+	vgGetMatrix(state->matrix_stroke);
 	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
 	
-	canvas_save_stack_top->clip_clipping = canvas_clip_get_clipping();
-	if(canvas_save_stack_top->clip_clipping == VG_TRUE)
+	state->clip_clipping = canvas_clip_get_clipping();
+	canvas_clip_get_bounds(state->clip_bounds);
+	if(state->clip_clipping == VG_TRUE)
 	{
-		canvas_save_stack_top->clip_mask = canvas_clip_get_mask();
+		state->clip_mask = canvas_clip_get_mask();
 	}
 	else
 	{
-		canvas_save_stack_top->clip_mask = 0;
+		state->clip_mask = 0;
 	}
 	
-	canvas_save_stack_top->lineDash_count = canvas_setLineDash_get_count();
-	if(canvas_save_stack_top->lineDash_count > 0)
+	state->lineDash_count = canvas_setLineDash_get_count();
+	if(state->lineDash_count > 0)
 	{
-		canvas_save_stack_top->lineDash_data = malloc(canvas_save_stack_top->lineDash_count * sizeof(VGfloat));
+		PROFILE_ALLOC(state->lineDash_count * sizeof(VGfloat));
+		state->lineDash_data = malloc(state->lineDash_count * sizeof(VGfloat));
 		
-		if(canvas_save_stack_top->lineDash_data == NULL)
+		if(state->lineDash_data == NULL)
 		{
 			eprintf("Failed to add stack element: Copying lineDash data failed.\n");
 			
-			canvas_save_stack_top->lineDash_count = 0;
+			state->lineDash_count = 0;
 		}
 		else
 		{
-			memcpy(canvas_save_stack_top->lineDash_data, canvas_setLineDash_get_data(), canvas_save_stack_top->lineDash_count * sizeof(VGfloat));
+			memcpy(state->lineDash_data, canvas_setLineDash_get_data(), state->lineDash_count * sizeof(VGfloat));
 		}
 	}
 	else
 	{
-		canvas_save_stack_top->lineDash_data = NULL;
+		state->lineDash_data = NULL;
 	}
 	
-	canvas_save_stack_top->fillStyle = canvas_fillStyle_get();
-	if(canvas_save_stack_top->fillStyle->paint_type == PAINT_TYPE_COLOR)
+	state->fillStyle = canvas_fillStyle_get();
+	if(state->fillStyle->paint_type == PAINT_TYPE_COLOR)
 	{
-		canvas_save_stack_top->fillStyle_data = malloc(canvas_save_stack_top->fillStyle->count * sizeof(VGfloat));
+		PROFILE_ALLOC(state->fillStyle->count * sizeof(VGfloat));
+		state->fillStyle_data = malloc(state->fillStyle->count * sizeof(VGfloat));
 		
-		if(canvas_save_stack_top->fillStyle_data == NULL)
+		if(state->fillStyle_data == NULL)
 		{
 			eprintf("Failed to add stack element: Failed to save fillStyle.\n");
 			
-			canvas_save_stack_top->fillStyle_count = 0;
+			state->fillStyle_count = 0;
 		}
 		else
 		{
-			memcpy(canvas_save_stack_top->fillStyle_data, canvas_save_stack_top->fillStyle->data, canvas_save_stack_top->fillStyle->count * sizeof(VGfloat));
-			canvas_save_stack_top->fillStyle_count = canvas_save_stack_top->fillStyle->count;
+			memcpy(state->fillStyle_data, state->fillStyle->data, state->fillStyle->count * sizeof(VGfloat));
+			state->fillStyle_count = state->fillStyle->count;
 		}
 	}
 	else
 	{
-		canvas_save_stack_top->fillStyle_data = NULL;
-		canvas_save_stack_top->fillStyle_count = 0;
+		state->fillStyle_data = NULL;
+		state->fillStyle_count = 0;
 	}
-	canvas_save_stack_top->strokeStyle = canvas_strokeStyle_get();
-	if(canvas_save_stack_top->strokeStyle->paint_type == PAINT_TYPE_COLOR)
+	state->strokeStyle = canvas_strokeStyle_get();
+	if(state->strokeStyle->paint_type == PAINT_TYPE_COLOR)
 	{
-		canvas_save_stack_top->strokeStyle_data = malloc(canvas_save_stack_top->strokeStyle->count * sizeof(VGfloat));
+		PROFILE_ALLOC(state->strokeStyle->count * sizeof(VGfloat));
+		state->strokeStyle_data = malloc(state->strokeStyle->count * sizeof(VGfloat));
 		
-		if(canvas_save_stack_top->strokeStyle_data == NULL)
+		if(state->strokeStyle_data == NULL)
 		{
 			eprintf("Failed to add stack element: Failed to save strokeStyle.\n");
 			
-			canvas_save_stack_top->strokeStyle_count = 0;
+			state->strokeStyle_count = 0;
 		}
 		else
 		{
-			memcpy(canvas_save_stack_top->strokeStyle_data, canvas_save_stack_top->strokeStyle->data, canvas_save_stack_top->strokeStyle->count * sizeof(VGfloat));
-			canvas_save_stack_top->strokeStyle_count = canvas_save_stack_top->strokeStyle->count;
+			memcpy(state->strokeStyle_data, state->strokeStyle->data, state->strokeStyle->count * sizeof(VGfloat));
+			state->strokeStyle_count = state->strokeStyle->count;
 		}
 	}
 	else
 	{
-		canvas_save_stack_top->strokeStyle_data = NULL;
-		canvas_save_stack_top->strokeStyle_count = 0;
+		state->strokeStyle_data = NULL;
+		state->strokeStyle_count = 0;
 	}
-	canvas_save_stack_top->globalAlpha = canvas_globalAlpha_get();
+	state->globalAlpha = canvas_globalAlpha_get();
+	
+	state->lineWidth = canvas_lineWidth_get();
+	state->lineCap = canvas_lineCap_get();
+	state->lineJoin = canvas_lineJoin_get();
+	state->miterLimit = canvas_miterLimit_get();
+	state->lineDash_offset = canvas_lineDashOffset_get();
 	
-	canvas_save_stack_top->lineWidth = canvas_lineWidth_get();
-	canvas_save_stack_top->lineCap = canvas_lineCap_get();
-	canvas_save_stack_top->lineJoin = canvas_lineJoin_get();
-	canvas_save_stack_top->miterLimit = canvas_miterLimit_get();
-	canvas_save_stack_top->lineDash_offset = canvas_lineDashOffset_get();
+	state->globalCompositeOperation = canvas_globalCompositeOperation_get();
 	
-	canvas_save_stack_top->globalCompositeOperation = canvas_globalCompositeOperation_get();
+	state->font_name = strdup(font_util_get_name(canvas_font_get_index()));
+	state->font_size = canvas_font_get_size();
 	
-	canvas_save_stack_top->font_name = strdup(font_util_get_name(canvas_font_get_index()));
-	canvas_save_stack_top->font_size = canvas_font_get_size();
+	state->textAlign = canvas_textAlign_get();
+	state->textBaseline = canvas_textBaseline_get();
 	
-	canvas_save_stack_top->textAlign = canvas_textAlign_get();
-	canvas_save_stack_top->textBaseline = canvas_textBaseline_get();
+	state->imageSmoothingEnabled = canvas_imageSmoothingEnabled_get();
 	
-	canvas_save_stack_top->imageSmoothingEnabled = canvas_imageSmoothingEnabled_get();
+	state->memory = sizeof(canvas_save_stack_t) + (state->lineDash_data ? state->lineDash_count * sizeof(VGfloat) : 0) + (state->fillStyle_count + state->strokeStyle_count) * sizeof(VGfloat) + (state->font_name ? strlen(state->font_name) + 1 : 0);
+	memory_util_alloc(MEMORY_UTIL_STATE, state->memory, 1);
 }
 
 /**
@@ -216,6 +226,8 @@ void canvas_save_cleanup_state(canvas_save_stack_t *state)
 		state->font_name = NULL;
 	}
 	
+	memory_util_free(MEMORY_UTIL_STATE, state->memory, 1);
+	
 	free(state);
 	state = NULL;
 }
@@ -225,9 +237,12 @@ void canvas_save_cleanup_state(canvas_save_stack_t *state)
  */
 void canvas_save_cleanup(void)
 {
-	if(canvas_save_stack_top != NULL)
+	canvas_context_t *context = context_util_get();
+	
+	if(context->save_stack != NULL)
 	{
-		canvas_save_cleanup_state(canvas_save_stack_top);
+		canvas_save_cleanup_state(context->save_stack);
+		context->save_stack = NULL;
 	}
 }
 
@@ -237,7 +252,7 @@ void canvas_save_cleanup(void)
  */
 canvas_save_stack_t *canvas_save_get(void)
 {
-	return canvas_save_stack_top;
+	return context_util_get()->save_stack;
 }
 
 /**
@@ -246,5 +261,5 @@ canvas_save_stack_t *canvas_save_get(void)
  */
 void canvas_save_set(canvas_save_stack_t *stack)
 {
-	canvas_save_stack_top = stack;
+	context_util_get()->save_stack = stack;
 }
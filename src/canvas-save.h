@@ -28,6 +28,7 @@ typedef struct canvas_save_stack_t
 	
 	VGboolean clip_clipping;
 	VGMaskLayer clip_mask;
+	VGfloat clip_bounds[4];
 	
 	VGint lineDash_count;
 	VGfloat *lineDash_data;
@@ -56,6 +57,9 @@ typedef struct canvas_save_stack_t
 	
 	VGboolean imageSmoothingEnabled;
 	
+	// accounted heap memory of this state
+	long long memory;
+	
 	struct canvas_save_stack_t *next;
 } canvas_save_stack_t;
 
@@ -23,9 +23,8 @@
 #include "log-util.h"
 #include "canvas-beginPath.h"
 #include "canvas-setLineDash.h"
-
-static VGfloat *canvas_setLineDash_data = NULL;
-static VGint canvas_setLineDash_count = 0;
+#include "profile-util.h"
+#include "context-util.h"
 
 /**
  * The setLineDash() method sets the line dash pattern.
@@ -39,17 +38,19 @@ static VGint canvas_setLineDash_count = 0;
  */
 void canvas_setLineDash(VGint count, VGfloat *data)
 {
-	VGfloat *canvas_setLineDash_data_backup = canvas_setLineDash_data;
+	canvas_context_t *context = context_util_get();
+	VGfloat *canvas_setLineDash_data_backup = context->line_dash_data;
 	
 	if(count > 0)
 	{
-		if(canvas_setLineDash_data == NULL)
+		if(context->line_dash_data == NULL)
 		{
-			canvas_setLineDash_data = malloc(count * sizeof(VGfloat));
+			PROFILE_ALLOC(count * sizeof(VGfloat));
+			context->line_dash_data = malloc(count * sizeof(VGfloat));
 			
-			if(canvas_setLineDash_data == NULL)
+			if(context->line_dash_data == NULL)
 			{
-				canvas_setLineDash_count = 0;
+				context->line_dash_count = 0;
 				
 				eprintf("Failed to save lineDash data.\n");
 				
@@ -58,11 +59,12 @@ void canvas_setLineDash(VGint count, VGfloat *data)
 		}
 		else
 		{
-			canvas_setLineDash_data = realloc(canvas_setLineDash_data, count * sizeof(VGfloat));
+			PROFILE_ALLOC(count * sizeof(VGfloat));
+			context->line_dash_data = realloc(context->line_dash_data, count * sizeof(VGfloat));
 			
-			if(canvas_setLineDash_data == NULL)
+			if(context->line_dash_data == NULL)
 			{
-				canvas_setLineDash_data = canvas_setLineDash_data_backup;
+				context->line_dash_data = canvas_setLineDash_data_backup;
 				
 				eprintf("Failed to save lineDash data.\n");
 				
@@ -70,22 +72,22 @@ void canvas_setLineDash(VGint count, VGfloat *data)
 			}
 		}
 		
-		memcpy(canvas_setLineDash_data, data, count * sizeof(VGfloat));
+		memcpy(context->line_dash_data, data, count * sizeof(VGfloat));
 		
 		vgSetfv(VG_STROKE_DASH_PATTERN, count, (const VGfloat *)data);
 	}
 	else
 	{
-		if(canvas_setLineDash_data != NULL)
+		if(context->line_dash_data != NULL)
 		{
-			free(canvas_setLineDash_data);
-			canvas_setLineDash_data = NULL;
+			free(context->line_dash_data);
+			context->line_dash_data = NULL;
 		}
 		
 		vgSetfv(VG_STROKE_DASH_PATTERN, count, NULL);
 	}
 	
-	canvas_setLineDash_count = count;
+	context->line_dash_count = count;
 }
 
 /**
@@ -93,13 +95,15 @@ void canvas_setLineDash(VGint count, VGfloat *data)
  */
 void canvas_setLineDash_cleanup(void)
 {
-	if(canvas_setLineDash_data != NULL)
+	canvas_context_t *context = context_util_get();
+	
+	if(context->line_dash_data != NULL)
 	{
-		free(canvas_setLineDash_data);
-		canvas_setLineDash_data = NULL;
+		free(context->line_dash_data);
+		context->line_dash_data = NULL;
 	}
 	
-	canvas_setLineDash_count = 0;
+	context->line_dash_count = 0;
 }
 
 /**
@@ -108,7 +112,7 @@ void canvas_setLineDash_cleanup(void)
  */
 VGfloat *canvas_setLineDash_get_data(void)
 {
-	return canvas_setLineDash_data;
+	return context_util_get()->line_dash_data;
 }
 
 /**
@@ -117,5 +121,5 @@ VGfloat *canvas_setLineDash_get_data(void)
  */
 VGint canvas_setLineDash_get_count(void)
 {
-	return canvas_setLineDash_count;
+	return context_util_get()->line_dash_count;
 }
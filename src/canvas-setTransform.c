@@ -21,6 +21,7 @@
 // #include "include-freetype.h"
 
 #include "egl-util.h"
+#include "context-util.h"
 #include "canvas-setTransform.h"
 
 /**
@@ -39,6 +40,7 @@
  */
 void canvas_setTransform(VGfloat a, VGfloat b, VGfloat c, VGfloat d, VGfloat e, VGfloat f)
 {
+	canvas_context_t *context = context_util_get();
 	VGfloat matrix[9];
 	
 	// a (m11): Horizontal scaling.
@@ -60,8 +62,9 @@ void canvas_setTransform(VGfloat a, VGfloat b, VGfloat c, VGfloat d, VGfloat e,
 	matrix[3] = -c;
 	matrix[4] = d;
 	matrix[5] = 0;
-	matrix[6] = e;
-	matrix[7] = -f;
+	// the offset of the context (layers, tiles) applies like to drawImage
+	matrix[6] = e + context->offset_x;
+	matrix[7] = -f + context->offset_y;
 	matrix[8] = 1;
 	
 	vgTranslate(0, egl_get_height());
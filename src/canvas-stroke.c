@@ -25,6 +25,8 @@
 #include "canvas-paint.h"
 #include "canvas-strokeStyle.h"
 #include "canvas-stroke.h"
+#include "profile-util.h"
+#include "trace-util.h"
 
 /**
  * The stroke() method fills the current or given path with the current stroke
@@ -32,7 +34,18 @@
  */
 void canvas_stroke(void)
 {
+	TRACE_DECLARE(trace_begin);
+	
+	if(!canvas_beginPath_visible(VG_STROKE_PATH))
+	{
+		return;
+	}
+	
 	paint_activate(canvas_strokeStyle_get(), VG_STROKE_PATH);
 	
-	vgDrawPath(canvas_beginPath_get(), VG_STROKE_PATH);
+	TRACE_BEGIN(trace_begin);
+	
+	PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(canvas_beginPath_get(), VG_STROKE_PATH));
+	
+	TRACE_END("path", "stroke", trace_begin);
 }
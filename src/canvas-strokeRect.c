@@ -28,6 +28,8 @@
 #include "canvas-moveTo.h"
 #include "canvas-lineTo.h"
 #include "canvas-closePath.h"
+#include "profile-util.h"
+#include "trace-util.h"
 
 /**
  * The strokeRect() method paints a rectangle which has a starting point at (x,
@@ -40,7 +42,7 @@
  */
 void canvas_strokeRect(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
 {
-	paint_activate(canvas_strokeStyle_get(), VG_STROKE_PATH);
+	TRACE_DECLARE(trace_begin);
 	
 	canvas_beginPath();
 	
@@ -51,5 +53,17 @@ void canvas_strokeRect(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
 	canvas_lineTo(x, y + height);
 	canvas_closePath();
 	
-	vgDrawPath(canvas_beginPath_get(), VG_STROKE_PATH);
+	// the rectangle stays the immediate path even if it is not drawn
+	if(!canvas_beginPath_visible(VG_STROKE_PATH))
+	{
+		return;
+	}
+	
+	paint_activate(canvas_strokeStyle_get(), VG_STROKE_PATH);
+	
+	TRACE_BEGIN(trace_begin);
+	
+	PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(canvas_beginPath_get(), VG_STROKE_PATH));
+	
+	TRACE_END("path", "strokeRect", trace_begin);
 }
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "log-util.h"
+#include "canvas-beginPath.h"
+#include "canvas-polyline.h"
+#include "canvas-stroke.h"
+#include "canvas-strokeSeries.h"
+
+/*
+ * Dense series are decimated with min/max per pixel column (M4): of the
+ * consecutive samples that fall into the same column on the surface only the
+ * first, the last and the ones with the lowest and highest position are kept.
+ * The lines in between stay within the column and the kept extent, so the
+ * stroke covers the same pixels.
+ */
+
+static VGfloat *series_points = NULL;
+static VGint series_capacity = 0;
+
+/**
+ * Appends a sample to the points.
+ * @param points The points.
+ * @param count The amount of points, incremented.
+ * @param x, y The sample in canvas coordinates.
+ */
+static inline void canvas_strokeSeries__add(VGfloat *points, VGint *count, VGfloat x, VGfloat y)
+{
+	points[2 * *count] = x;
+	points[2 * *count + 1] = y;
+	(*count)++;
+}
+
+/**
+ * Reduces a series to at most four samples per pixel column on the surface
+ * under the current transformation. Samples with non-finite coordinates are
+ * skipped like lineTo() ignores them.
+ * @param xs The x axis of the samples.
+ * @param ys The y axis of the samples.
+ * @param count The amount of samples.
+ * @param points Where to write the kept samples (x and y interleaved), must
+ *        hold count points.
+ * @return The amount of kept samples.
+ */
+VGint canvas_strokeSeries_decimate(const VGfloat *xs, const VGfloat *ys, VGint count, VGfloat *points)
+{
+	VGfloat m[9];
+	VGfloat height = egl_get_height();
+	VGfloat column = 0;
+	VGfloat current = 0;
+	VGfloat position = 0;
+	VGfloat min = 0;
+	VGfloat max = 0;
+	VGint first = -1;
+	VGint last = -1;
+	VGint lowest = -1;
+	VGint highest = -1;
+	VGint kept = 0;
+	VGint i = 0;
+	
+	vgGetMatrix(m);
+	
+	for(i = 0; i <= count; i++)
+	{
+		if(i < count)
+		{
+			// surface position of the sample, see canvas_lineTo()
+			column = m[0] * xs[i] + m[3] * (height - ys[i]) + m[6];
+			position = m[1] * xs[i] + m[4] * (height - ys[i]) + m[7];
+			
+			if(!isfinite(column) || !isfinite(position))
+			{
+				continue;
+			}
+			
+			// most samples stay in the column of the previous one
+			if(first != -1 && column >= current && column < current + 1)
+			{
+				if(position < min)
+				{
+					min = position;
+					lowest = i;
+				}
+				
+				if(position > max)
+				{
+					max = position;
+					highest = i;
+				}
+				
+				last = i;
+				continue;
+			}
+			
+			column = floorf(column);
+		}
+		
+		// the column is complete, keep its samples in their order
+		if(first != -1)
+		{
+			canvas_strokeSeries__add(points, &kept, xs[first], ys[first]);
+			
+			if(lowest != first && lowest < highest)
+			{
+				canvas_strokeSeries__add(points, &kept, xs[lowest], ys[lowest]);
+			}
+			
+			if(highest != first && highest != last)
+			{
+				canvas_strokeSeries__add(points, &kept, xs[highest], ys[highest]);
+			}
+			
+			if(lowest != first && lowest != last && lowest > highest)
+			{
+				canvas_strokeSeries__add(points, &kept, xs[lowest], ys[lowest]);
+			}
+			
+			if(last != first)
+			{
+				canvas_strokeSeries__add(points, &kept, xs[last], ys[last]);
+			}
+		}
+		
+		if(i < count)
+		{
+			first = last = lowest = highest = i;
+			current = column;
+			min = max = position;
+		}
+	}
+	
+	return kept;
+}
+
+/**
+ * Strokes a series of samples as one sub-path with the current stroke style,
+ * like beginPath(), moveTo() and lineTo() for every sample and stroke(). The
+ * immediate path is replaced.
+ * @param xs The x axis of the samples.
+ * @param ys The y axis of the samples.
+ * @param count The amount of samples.
+ * @param decimate Whether samples are decimated per pixel column.
+ * @param points Set to the stroked samples (x and y interleaved), valid until
+ *        the next call. Can be NULL.
+ * @return The amount of stroked samples or -1 on failure.
+ */
+VGint canvas_strokeSeries(const VGfloat *xs, const VGfloat *ys, VGint count, int decimate, const VGfloat **points)
+{
+	VGfloat *resized = NULL;
+	VGint kept = 0;
+	VGint i = 0;
+	
+	if(count > series_capacity)
+	{
+		resized = realloc(series_points, count * 2 * sizeof(VGfloat));
+		if(resized == NULL)
+		{
+			eprintf("Failed to allocate series points.\n");
+			return -1;
+		}
+		
+		series_points = resized;
+		series_capacity = count;
+	}
+	
+	if(decimate)
+	{
+		kept = canvas_strokeSeries_decimate(xs, ys, count, series_points);
+	}
+	else
+	{
+		for(i = 0; i < count; i++)
+		{
+			if(isfinite(xs[i]) && isfinite(ys[i]))
+			{
+				canvas_strokeSeries__add(series_points, &kept, xs[i], ys[i]);
+			}
+		}
+	}
+	
+	canvas_beginPath();
+	canvas_polyline(series_points, kept, 0);
+	canvas_stroke();
+	
+	if(points != NULL)
+	{
+		*points = series_points;
+	}
+	
+	return kept;
+}
+
+/**
+ * Frees the buffer of the kept samples.
+ */
+void canvas_strokeSeries_cleanup(void)
+{
+	free(series_points);
+	
+	series_points = NULL;
+	series_capacity = 0;
+}
@@ -22,8 +22,7 @@
 
 #include "canvas-paint.h"
 #include "canvas-strokeStyle.h"
-
-static paint_t *canvas_strokeStyle_paint = NULL;
+#include "context-util.h"
 
 /**
  * The strokeStyle property specifies the color or style to use inside shapes.
@@ -31,7 +30,7 @@ static paint_t *canvas_strokeStyle_paint = NULL;
  */
 void canvas_strokeStyle(paint_t *paint)
 {
-	canvas_strokeStyle_paint = paint;
+	context_util_get()->stroke_style = paint;
 }
 
 /**
@@ -40,5 +39,5 @@ void canvas_strokeStyle(paint_t *paint)
  */
 paint_t *canvas_strokeStyle_get(void)
 {
-	return canvas_strokeStyle_paint;
+	return context_util_get()->stroke_style;
 }
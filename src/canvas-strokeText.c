@@ -21,6 +21,7 @@
 #include "include-freetype.h"
 
 #include "egl-util.h"
+#include "cull-util.h"
 #include "log-util.h"
 #include "canvas-beginPath.h"
 #include "canvas-paint.h"
@@ -35,6 +36,8 @@
 #include "canvas-kerning.h"
 #include "canvas-textAlign.h"
 #include "canvas-textBaseline.h"
+#include "profile-util.h"
+#include "trace-util.h"
 
 /**
  * The strokeText() method strokes a given text at the given (x, y) position. If
@@ -68,12 +71,15 @@ void canvas_strokeText(char *text, VGfloat x, VGfloat y)
 	VGfloat end_y_temp = 0;
 	VGfloat matrix_backup_stroke_paint[9];
 	VGfloat matrix_backup_path[9];
+	TRACE_DECLARE(trace_begin);
 	
 	if(fonts_index < 0 || text == NULL)
 	{
 		return;
 	}
 	
+	TRACE_BEGIN(trace_begin);
+	
 	for(text_index = 0; text_index < strlen(text); text_index++)
 	{
 		char_index = font_util_get_char_index(fonts_index, text[text_index]);
@@ -179,7 +185,15 @@ void canvas_strokeText(char *text, VGfloat x, VGfloat y)
 	
 	offset_x = 0;
 	
+	if(!cull_util_user(x + start_x * size, egl_get_height() - y - end_y * size, x + end_x * size, egl_get_height() - y + start_y * size, lineWidth * 0.5f * fmaxf(miterLimit, M_SQRT2)))
+	{
+		TRACE_END_ARG("text", "strokeText", trace_begin, strlen(text));
+		return;
+	}
+	
+	PROFILE_ALLOC(canvas_setLineDash_get_count() * sizeof(VGfloat));
 	lineDashPattern = malloc(canvas_setLineDash_get_count() * sizeof(VGfloat));
+	PROFILE_ALLOC(canvas_setLineDash_get_count() * sizeof(VGfloat));
 	lineDashPattern2 = malloc(canvas_setLineDash_get_count() * sizeof(VGfloat));
 	if(lineDashPattern == NULL || lineDashPattern2 == NULL)
 	{
@@ -220,7 +234,7 @@ void canvas_strokeText(char *text, VGfloat x, VGfloat y)
 		
 		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
 		
-		vgDrawPath(font_util_get_path(fonts_index, char_index), VG_STROKE_PATH);
+		PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(font_util_get_path(fonts_index, char_index), VG_STROKE_PATH));
 		
 		vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
 		
@@ -253,4 +267,6 @@ void canvas_strokeText(char *text, VGfloat x, VGfloat y)
 	
 	free(lineDashPattern);
 	free(lineDashPattern2);
+	
+	TRACE_END_ARG("text", "strokeText", trace_begin, strlen(text));
 }
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "cull-util.h"
+#include "canvas-paint.h"
+#include "canvas-lineWidth.h"
+#include "canvas-miterLimit.h"
+#include "canvas-strokeStyle.h"
+#include "canvas-strokeTextBlob.h"
+#include "profile-util.h"
+#include "trace-util.h"
+
+/**
+ * Strokes a text blob at the given (x, y) position with the current stroke
+ * style. The font, alignment and baseline of the blob are used instead of the
+ * current ones.
+ * @param blob The text blob.
+ * @param x The x axis of the coordinate for the text starting point.
+ * @param y The y axis of the coordinate for the text starting point.
+ */
+void canvas_strokeTextBlob(textblob_t *blob, VGfloat x, VGfloat y)
+{
+	paint_t *paint = canvas_strokeStyle_get();
+	VGfloat height = egl_get_height();
+	VGfloat expand = canvas_lineWidth_get() * 0.5f * fmaxf(canvas_miterLimit_get(), M_SQRT2);
+	VGfloat matrix_backup_stroke_paint[9];
+	VGfloat matrix_backup_path[9];
+	TRACE_DECLARE(trace_begin);
+	
+	if(blob == NULL || blob->glyphs == 0)
+	{
+		return;
+	}
+	
+	if(!cull_util_user(x + blob->bounds[0], height - y - blob->bounds[3], x + blob->bounds[2], height - y - blob->bounds[1], expand))
+	{
+		return;
+	}
+	
+	TRACE_BEGIN(trace_begin);
+	
+	paint_activate(paint, VG_STROKE_PATH);
+	
+	vgGetMatrix(matrix_backup_path);
+	vgTranslate(x, height - y);
+	
+	// gradients and patterns stay in canvas coordinates
+	if(paint->paint_type != PAINT_TYPE_COLOR)
+	{
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
+		vgGetMatrix(matrix_backup_stroke_paint);
+		vgTranslate(-x, -(height - y));
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	}
+	
+	PROFILE_CALL(PROFILE_DRAW_PATH, vgDrawPath(blob->path, VG_STROKE_PATH));
+	
+	if(paint->paint_type != PAINT_TYPE_COLOR)
+	{
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
+		vgLoadMatrix(matrix_backup_stroke_paint);
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	}
+	
+	vgLoadMatrix(matrix_backup_path);
+	
+	TRACE_END_ARG("text", "strokeTextBlob", trace_begin, blob->glyphs);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CANVAS_STROKETEXTBLOB_H__
+#define __CANVAS_STROKETEXTBLOB_H__
+
+#include <VG/openvg.h>
+#include "textblob-util.h"
+
+void canvas_strokeTextBlob(textblob_t *blob, VGfloat x, VGfloat y);
+
+#endif /* __CANVAS_STROKETEXTBLOB_H__ */
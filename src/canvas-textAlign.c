@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-textAlign.h"
-
-static canvas_text_align_t canvas_textAlign_value = CANVAS_TEXT_ALIGN_LEFT;
+#include "context-util.h"
 
 /**
  * The textAlign property specifies the current text alignment being used when
@@ -35,15 +34,15 @@ void canvas_textAlign(char *text_align)
 {
 	if(!strcmp(text_align, "left") || !strcmp(text_align, "start"))
 	{
-		canvas_textAlign_value = CANVAS_TEXT_ALIGN_LEFT;
+		context_util_get()->text_align = CANVAS_TEXT_ALIGN_LEFT;
 	}
 	else if(!strcmp(text_align, "right") || !strcmp(text_align, "end"))
 	{
-		canvas_textAlign_value = CANVAS_TEXT_ALIGN_RIGHT;
+		context_util_get()->text_align = CANVAS_TEXT_ALIGN_RIGHT;
 	}
 	else if(!strcmp(text_align, "center"))
 	{
-		canvas_textAlign_value = CANVAS_TEXT_ALIGN_CENTER;
+		context_util_get()->text_align = CANVAS_TEXT_ALIGN_CENTER;
 	}
 }
 
@@ -53,7 +52,7 @@ void canvas_textAlign(char *text_align)
  */
 char *canvas_textAlign_get(void)
 {
-	switch(canvas_textAlign_value)
+	switch(context_util_get()->text_align)
 	{
 		case CANVAS_TEXT_ALIGN_LEFT:
 		{
@@ -90,5 +89,5 @@ char *canvas_textAlign_get(void)
  */
 canvas_text_align_t canvas_textAlign_get_internal(void)
 {
-	return canvas_textAlign_value;
+	return context_util_get()->text_align;
 }
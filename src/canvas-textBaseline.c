@@ -21,8 +21,7 @@
 // #include "include-freetype.h"
 
 #include "canvas-textBaseline.h"
-
-static canvas_text_baseline_t canvas_textBaseline_value = CANVAS_TEXT_BASELINE_ALPHABETIC;
+#include "context-util.h"
 
 /**
  * The textBaseline property specifies the current text baseline being used when
@@ -33,27 +32,27 @@ void canvas_textBaseline(char *text_baseline)
 {
 	if(!strcmp(text_baseline, "top"))
 	{
-		canvas_textBaseline_value = CANVAS_TEXT_BASELINE_TOP;
+		context_util_get()->text_baseline = CANVAS_TEXT_BASELINE_TOP;
 	}
 	else if(!strcmp(text_baseline, "hanging"))
 	{
-		canvas_textBaseline_value = CANVAS_TEXT_BASELINE_HANGING;
+		context_util_get()->text_baseline = CANVAS_TEXT_BASELINE_HANGING;
 	}
 	else if(!strcmp(text_baseline, "middle"))
 	{
-		canvas_textBaseline_value = CANVAS_TEXT_BASELINE_MIDDLE;
+		context_util_get()->text_baseline = CANVAS_TEXT_BASELINE_MIDDLE;
 	}
 	else if(!strcmp(text_baseline, "alphabetic"))
 	{
-		canvas_textBaseline_value = CANVAS_TEXT_BASELINE_ALPHABETIC;
+		context_util_get()->text_baseline = CANVAS_TEXT_BASELINE_ALPHABETIC;
 	}
 	else if(!strcmp(text_baseline, "ideographic"))
 	{
-		canvas_textBaseline_value = CANVAS_TEXT_BASELINE_IDEOGRAPHIC;
+		context_util_get()->text_baseline = CANVAS_TEXT_BASELINE_IDEOGRAPHIC;
 	}
 	else if(!strcmp(text_baseline, "bottom"))
 	{
-		canvas_textBaseline_value = CANVAS_TEXT_BASELINE_BOTTOM;
+		context_util_get()->text_baseline = CANVAS_TEXT_BASELINE_BOTTOM;
 	}
 }
 
@@ -63,7 +62,7 @@ void canvas_textBaseline(char *text_baseline)
  */
 char *canvas_textBaseline_get(void)
 {
-	switch(canvas_textBaseline_value)
+	switch(context_util_get()->text_baseline)
 	{
 		case CANVAS_TEXT_BASELINE_TOP:
 		{
@@ -118,5 +117,5 @@ char *canvas_textBaseline_get(void)
  */
 canvas_text_baseline_t canvas_textBaseline_get_internal(void)
 {
-	return canvas_textBaseline_value;
+	return context_util_get()->text_baseline;
 }
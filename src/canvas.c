@@ -33,26 +33,36 @@
 #include "canvas-setLineDash.h"
 #include "canvas-save.h"
 #include "canvas-beginPath.h"
+#include "canvas-polyline.h"
+#include "canvas-strokeSeries.h"
 #include "canvas-clip.h"
 #include "canvas-fillStyle.h"
 #include "canvas-strokeStyle.h"
 #include "canvas-kerning.h"
 #include "canvas-imageSmoothingEnabled.h"
 #include "font-util.h"
+#include "readback-util.h"
+#include "present-util.h"
+#include "dirty-util.h"
 #include "version.h"
+#include "profile-util.h"
+#include "pool-util.h"
+#include "context-util.h"
+#include "layer-util.h"
+#include "hit-util.h"
 
-void canvas__init(void)
+/**
+ * Initializes the canvas state of the current context: default styles, the
+ * immediate path, clipping and line settings. The surface is cleared.
+ */
+static void canvas__init_context(void)
 {
-	font_util_init();
-	egl_init();
-	version_init();
+	canvas_context_t *context = context_util_get();
 	
-	paint_t *fill = malloc(sizeof(paint_t));
-	paint_t *stroke = malloc(sizeof(paint_t));
-	paint_createColor(fill, 0, 0, 0, 1);
-	canvas_fillStyle(fill);
-	paint_createColor(stroke, 0, 0, 0, 1);
-	canvas_strokeStyle(stroke);
+	paint_createColor(&context->fill_color, 0, 0, 0, 1);
+	canvas_fillStyle(&context->fill_color);
+	paint_createColor(&context->stroke_color, 0, 0, 0, 1);
+	canvas_strokeStyle(&context->stroke_color);
 	
 	// initialize immediate path, clipping mask and clearing rectangle
 	canvas_beginPath_init();
@@ -71,13 +81,260 @@ void canvas__init(void)
 	canvas_imageSmoothingEnabled(VG_TRUE);
 }
 
-void canvas__cleanup(void)
+/**
+ * Cleans up the canvas state of the current context.
+ */
+static void canvas__cleanup_context(void)
 {
+	canvas_context_t *context = context_util_get();
+	
 	canvas_beginPath_cleanup();
 	canvas_setLineDash_cleanup();
 	canvas_save_cleanup();
+	hit_util_cleanup();
+	
+	// gradients, patterns and prepared paints are owned by their JS objects
+	paint_cleanup(&context->fill_color);
+	paint_cleanup(&context->stroke_color);
+	
+	context->fill_style = NULL;
+	context->stroke_style = NULL;
+}
+
+/**
+ * Sets a style of a context to a color. The color paint of the style is reused.
+ * @param context The context.
+ * @param stroke Whether to set the stroke style instead of the fill style.
+ * @param red Red component (0..1)
+ * @param green Green component (0..1)
+ * @param blue Blue component (0..1)
+ * @param alpha Alpha component (0..1)
+ */
+static void canvas__set_color(canvas_context_t *context, int stroke, VGfloat red, VGfloat green, VGfloat blue, VGfloat alpha)
+{
+	paint_t *color = stroke ? &context->stroke_color : &context->fill_color;
+	
+	paint_setRGBA(color, red, green, blue, alpha);
+	
+	if(stroke)
+	{
+		context->stroke_style = color;
+	}
+	else
+	{
+		context->fill_style = color;
+	}
+}
+
+/**
+ * Sets a style of a context to the style of another context. Colors are
+ * copied, gradients, patterns and prepared paints are shared.
+ * @param context The context.
+ * @param stroke Whether to set the stroke style instead of the fill style.
+ * @param source The style to copy.
+ */
+static void canvas__copy_paint(canvas_context_t *context, int stroke, paint_t *source)
+{
+	if(source->paint_type == PAINT_TYPE_COLOR)
+	{
+		canvas__set_color(context, stroke, source->data[0], source->data[1], source->data[2], source->data[3]);
+	}
+	else if(stroke)
+	{
+		context->stroke_style = source;
+	}
+	else
+	{
+		context->fill_style = source;
+	}
+}
+
+void canvas__init(void)
+{
+	font_util_init();
+	egl_init();
+	version_init();
+	
+	context_util_create_window();
+	dirty_util_init();
+	canvas__init_context();
+	
+	readback_util_init(READBACK_UTIL_SLOTS, READBACK_UTIL_LATENCY);
+	
+	present_util_init();
+}
+
+void canvas__cleanup(void)
+{
+	canvas_context_t *context = NULL;
+	canvas_context_t *next = NULL;
+	
+	// wait for the last swap and take the context back
+	present_util_cleanup();
+	
+	layer_util_cleanup();
+	
+	// offscreen contexts first, they share the objects of the window context
+	context = context_util_get_first();
+	while(context != NULL)
+	{
+		next = context->next;
+		
+		if(context != context_util_get_window())
+		{
+			canvas__destroy_context(context);
+		}
+		
+		context = next;
+	}
 	
+	context_util_make_current(context_util_get_window());
+	canvas__cleanup_context();
+	readback_util_cleanup();
+	font_util_atlas_clear();
+	
+	context_util_destroy(context_util_get_window());
 	egl_cleanup();
 	
 	font_util_cleanup();
+	canvas_polyline_cleanup();
+	canvas_strokeSeries_cleanup();
+	pool_util_cleanup();
+}
+
+/**
+ * Creates an offscreen canvas. Its canvas state is initialized like the one of
+ * the window; the current context stays current.
+ * @param width The width in pixels.
+ * @param height The height in pixels.
+ * @return The new context or NULL on failure.
+ */
+canvas_context_t *canvas__create_context(int32_t width, int32_t height)
+{
+	canvas_context_t *previous = context_util_get();
+	canvas_context_t *context = context_util_create_offscreen(width, height);
+	
+	if(context == NULL)
+	{
+		return NULL;
+	}
+	
+	context_util_make_current(context);
+	vgLoadIdentity();
+	canvas__init_context();
+	context_util_make_current(previous);
+	
+	return context;
+}
+
+/**
+ * Destroys an offscreen canvas created by canvas__create_context.
+ * @param context The context.
+ */
+void canvas__destroy_context(canvas_context_t *context)
+{
+	canvas_context_t *previous = NULL;
+	
+	// layers drawn on the context can not be composited anymore
+	layer_util_remove_context(context);
+	previous = context_util_get();
+	
+	context_util_make_current(context);
+	canvas__cleanup_context();
+	
+	if(previous != context)
+	{
+		context_util_make_current(previous);
+	}
+	
+	context_util_destroy(context);
+}
+
+/**
+ * Copies the canvas state of another context to the current context: styles,
+ * line and text settings. Transformations, clipping, the immediate path and
+ * the save stack are not copied.
+ * @param source The context to copy from.
+ */
+void canvas__copy_state(canvas_context_t *source)
+{
+	canvas_context_t *context = context_util_get();
+	
+	canvas__copy_paint(context, 0, source->fill_style);
+	canvas__copy_paint(context, 1, source->stroke_style);
+	canvas_globalAlpha(source->global_alpha);
+	context->composite_operation = source->composite_operation;
+	vgSeti(VG_BLEND_MODE, source->composite_operation);
+	canvas_imageSmoothingEnabled(source->image_smoothing);
+	
+	canvas_lineWidth(source->line_width);
+	context->line_cap = source->line_cap;
+	vgSeti(VG_STROKE_CAP_STYLE, source->line_cap);
+	context->line_join = source->line_join;
+	vgSeti(VG_STROKE_JOIN_STYLE, source->line_join);
+	canvas_miterLimit(source->miter_limit);
+	canvas_lineDashOffset(source->line_dash_offset);
+	canvas_setLineDash(source->line_dash_count, source->line_dash_data);
+	
+	context->font_index = source->font_index;
+	context->font_size = source->font_size;
+	canvas_kerning(source->kerning);
+	context->text_align = source->text_align;
+	context->text_baseline = source->text_baseline;
+}
+
+/**
+ * Sets the fill or stroke style of the current context to a color.
+ * @param stroke Whether to set the stroke style instead of the fill style.
+ * @param red Red component (0..1)
+ * @param green Green component (0..1)
+ * @param blue Blue component (0..1)
+ * @param alpha Alpha component (0..1)
+ */
+void canvas__set_style_color(int stroke, VGfloat red, VGfloat green, VGfloat blue, VGfloat alpha)
+{
+	canvas__set_color(context_util_get(), stroke, red, green, blue, alpha);
+}
+
+/**
+ * Sets the fill or stroke style of the current context to a gradient, pattern
+ * or prepared paint. The paint is not copied.
+ * @param stroke Whether to set the stroke style instead of the fill style.
+ * @param paint The paint.
+ */
+void canvas__set_style_paint(int stroke, paint_t *paint)
+{
+	if(stroke)
+	{
+		canvas_strokeStyle(paint);
+	}
+	else
+	{
+		canvas_fillStyle(paint);
+	}
+}
+
+/**
+ * Stops using a paint that is about to be destroyed. Styles of all contexts
+ * using it are set to its color (for color paints) or to black.
+ * @param paint The paint.
+ */
+void canvas__release_paint(paint_t *paint)
+{
+	canvas_context_t *context = NULL;
+	VGfloat black[4] = { 0, 0, 0, 1 };
+	VGfloat *color = paint->paint_type == PAINT_TYPE_COLOR ? paint->data : black;
+	
+	for(context = context_util_get_first(); context != NULL; context = context->next)
+	{
+		if(context->fill_style == paint)
+		{
+			canvas__set_color(context, 0, color[0], color[1], color[2], color[3]);
+		}
+		
+		if(context->stroke_style == paint)
+		{
+			canvas__set_color(context, 1, color[0], color[1], color[2], color[3]);
+		}
+	}
 }
@@ -19,7 +19,15 @@
 #ifndef __CANVAS_H__
 #define __CANVAS_H__
 
+#include "context-util.h"
+
 void canvas__init(void);
 void canvas__cleanup(void);
+canvas_context_t *canvas__create_context(int32_t width, int32_t height);
+void canvas__destroy_context(canvas_context_t *context);
+void canvas__copy_state(canvas_context_t *source);
+void canvas__set_style_color(int stroke, VGfloat red, VGfloat green, VGfloat blue, VGfloat alpha);
+void canvas__set_style_paint(int stroke, paint_t *paint);
+void canvas__release_paint(paint_t *paint);
 
 #endif /* __CANVAS_H__ */
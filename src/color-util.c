@@ -0,0 +1,645 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "color-util.h"
+
+typedef struct color_util_name_t
+{
+	const char *name;
+	uint32_t rgba;
+} color_util_name_t;
+
+typedef struct color_util_entry_t
+{
+	char string[COLOR_UTIL_CACHE_LENGTH];
+	uint32_t hash;
+	uint32_t rgba;
+	int used;
+	int valid;
+} color_util_entry_t;
+
+// CSS color keywords, sorted for bsearch
+static const color_util_name_t color_util__names[] = {
+	{ "aliceblue", 0xf0f8ffff },
+	{ "antiquewhite", 0xfaebd7ff },
+	{ "aqua", 0x00ffffff },
+	{ "aquamarine", 0x7fffd4ff },
+	{ "azure", 0xf0ffffff },
+	{ "beige", 0xf5f5dcff },
+	{ "bisque", 0xffe4c4ff },
+	{ "black", 0x000000ff },
+	{ "blanchedalmond", 0xffebcdff },
+	{ "blue", 0x0000ffff },
+	{ "blueviolet", 0x8a2be2ff },
+	{ "brown", 0xa52a2aff },
+	{ "burlywood", 0xdeb887ff },
+	{ "cadetblue", 0x5f9ea0ff },
+	{ "chartreuse", 0x7fff00ff },
+	{ "chocolate", 0xd2691eff },
+	{ "coral", 0xff7f50ff },
+	{ "cornflowerblue", 0x6495edff },
+	{ "cornsilk", 0xfff8dcff },
+	{ "crimson", 0xdc143cff },
+	{ "cyan", 0x00ffffff },
+	{ "darkblue", 0x00008bff },
+	{ "darkcyan", 0x008b8bff },
+	{ "darkgoldenrod", 0xb8860bff },
+	{ "darkgray", 0xa9a9a9ff },
+	{ "darkgreen", 0x006400ff },
+	{ "darkgrey", 0xa9a9a9ff },
+	{ "darkkhaki", 0xbdb76bff },
+	{ "darkmagenta", 0x8b008bff },
+	{ "darkolivegreen", 0x556b2fff },
+	{ "darkorange", 0xff8c00ff },
+	{ "darkorchid", 0x9932ccff },
+	{ "darkred", 0x8b0000ff },
+	{ "darksalmon", 0xe9967aff },
+	{ "darkseagreen", 0x8fbc8fff },
+	{ "darkslateblue", 0x483d8bff },
+	{ "darkslategray", 0x2f4f4fff },
+	{ "darkslategrey", 0x2f4f4fff },
+	{ "darkturquoise", 0x00ced1ff },
+	{ "darkviolet", 0x9400d3ff },
+	{ "deeppink", 0xff1493ff },
+	{ "deepskyblue", 0x00bfffff },
+	{ "dimgray", 0x696969ff },
+	{ "dimgrey", 0x696969ff },
+	{ "dodgerblue", 0x1e90ffff },
+	{ "firebrick", 0xb22222ff },
+	{ "floralwhite", 0xfffaf0ff },
+	{ "forestgreen", 0x228b22ff },
+	{ "fuchsia", 0xff00ffff },
+	{ "gainsboro", 0xdcdcdcff },
+	{ "ghostwhite", 0xf8f8ffff },
+	{ "gold", 0xffd700ff },
+	{ "goldenrod", 0xdaa520ff },
+	{ "gray", 0x808080ff },
+	{ "green", 0x008000ff },
+	{ "greenyellow", 0xadff2fff },
+	{ "grey", 0x808080ff },
+	{ "honeydew", 0xf0fff0ff },
+	{ "hotpink", 0xff69b4ff },
+	{ "indianred", 0xcd5c5cff },
+	{ "indigo", 0x4b0082ff },
+	{ "ivory", 0xfffff0ff },
+	{ "khaki", 0xf0e68cff },
+	{ "lavender", 0xe6e6faff },
+	{ "lavenderblush", 0xfff0f5ff },
+	{ "lawngreen", 0x7cfc00ff },
+	{ "lemonchiffon", 0xfffacdff },
+	{ "lightblue", 0xadd8e6ff },
+	{ "lightcoral", 0xf08080ff },
+	{ "lightcyan", 0xe0ffffff },
+	{ "lightgoldenrodyellow", 0xfafad2ff },
+	{ "lightgray", 0xd3d3d3ff },
+	{ "lightgreen", 0x90ee90ff },
+	{ "lightgrey", 0xd3d3d3ff },
+	{ "lightpink", 0xffb6c1ff },
+	{ "lightsalmon", 0xffa07aff },
+	{ "lightseagreen", 0x20b2aaff },
+	{ "lightskyblue", 0x87cefaff },
+	{ "lightslategray", 0x778899ff },
+	{ "lightslategrey", 0x778899ff },
+	{ "lightsteelblue", 0xb0c4deff },
+	{ "lightyellow", 0xffffe0ff },
+	{ "lime", 0x00ff00ff },
+	{ "limegreen", 0x32cd32ff },
+	{ "linen", 0xfaf0e6ff },
+	{ "magenta", 0xff00ffff },
+	{ "maroon", 0x800000ff },
+	{ "mediumaquamarine", 0x66cdaaff },
+	{ "mediumblue", 0x0000cdff },
+	{ "mediumorchid", 0xba55d3ff },
+	{ "mediumpurple", 0x9370dbff },
+	{ "mediumseagreen", 0x3cb371ff },
+	{ "mediumslateblue", 0x7b68eeff },
+	{ "mediumspringgreen", 0x00fa9aff },
+	{ "mediumturquoise", 0x48d1ccff },
+	{ "mediumvioletred", 0xc71585ff },
+	{ "midnightblue", 0x191970ff },
+	{ "mintcream", 0xf5fffaff },
+	{ "mistyrose", 0xffe4e1ff },
+	{ "moccasin", 0xffe4b5ff },
+	{ "navajowhite", 0xffdeadff },
+	{ "navy", 0x000080ff },
+	{ "oldlace", 0xfdf5e6ff },
+	{ "olive", 0x808000ff },
+	{ "olivedrab", 0x6b8e23ff },
+	{ "orange", 0xffa500ff },
+	{ "orangered", 0xff4500ff },
+	{ "orchid", 0xda70d6ff },
+	{ "palegoldenrod", 0xeee8aaff },
+	{ "palegreen", 0x98fb98ff },
+	{ "paleturquoise", 0xafeeeeff },
+	{ "palevioletred", 0xdb7093ff },
+	{ "papayawhip", 0xffefd5ff },
+	{ "peachpuff", 0xffdab9ff },
+	{ "peru", 0xcd853fff },
+	{ "pink", 0xffc0cbff },
+	{ "plum", 0xdda0ddff },
+	{ "powderblue", 0xb0e0e6ff },
+	{ "purple", 0x800080ff },
+	{ "rebeccapurple", 0x663399ff },
+	{ "red", 0xff0000ff },
+	{ "rosybrown", 0xbc8f8fff },
+	{ "royalblue", 0x4169e1ff },
+	{ "saddlebrown", 0x8b4513ff },
+	{ "salmon", 0xfa8072ff },
+	{ "sandybrown", 0xf4a460ff },
+	{ "seagreen", 0x2e8b57ff },
+	{ "seashell", 0xfff5eeff },
+	{ "sienna", 0xa0522dff },
+	{ "silver", 0xc0c0c0ff },
+	{ "skyblue", 0x87ceebff },
+	{ "slateblue", 0x6a5acdff },
+	{ "slategray", 0x708090ff },
+	{ "slategrey", 0x708090ff },
+	{ "snow", 0xfffafaff },
+	{ "springgreen", 0x00ff7fff },
+	{ "steelblue", 0x4682b4ff },
+	{ "tan", 0xd2b48cff },
+	{ "teal", 0x008080ff },
+	{ "thistle", 0xd8bfd8ff },
+	{ "tomato", 0xff6347ff },
+	{ "transparent", 0x00000000 },
+	{ "turquoise", 0x40e0d0ff },
+	{ "violet", 0xee82eeff },
+	{ "wheat", 0xf5deb3ff },
+	{ "white", 0xffffffff },
+	{ "whitesmoke", 0xf5f5f5ff },
+	{ "yellow", 0xffff00ff },
+	{ "yellowgreen", 0x9acd32ff }
+};
+
+static color_util_entry_t color_util__cache[COLOR_UTIL_CACHE_SIZE];
+static color_util_stats_t color_util__stats;
+
+static int color_util__compare_name(const void *key, const void *element)
+{
+	return strcmp((const char *)key, ((const color_util_name_t *)element)->name);
+}
+
+/**
+ * Skips spaces.
+ * @param string The current position.
+ * @return The position of the next non-space character.
+ */
+static const char *color_util__skip(const char *string)
+{
+	while(*string == ' ' || *string == '\t' || *string == '\n' || *string == '\r' || *string == '\f')
+	{
+		string++;
+	}
+	
+	return string;
+}
+
+/**
+ * Returns the value of a hex digit.
+ * @param c The character.
+ * @return The value or -1 if it is not a hex digit.
+ */
+static int color_util__hex(char c)
+{
+	if(c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	
+	if(c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	
+	if(c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	
+	return -1;
+}
+
+/**
+ * Parses a CSS number (optional sign, digits, fraction and exponent).
+ * @param string The current position, advanced behind the number.
+ * @param value Where to write the number to.
+ * @return 1 if a number has been parsed, 0 otherwise.
+ */
+static int color_util__number(const char **string, VGfloat *value)
+{
+	const char *s = *string;
+	double result = 0;
+	double scale = 1;
+	int sign = 1;
+	int exponent = 0;
+	int exponent_sign = 1;
+	int digits = 0;
+	
+	if(*s == '+' || *s == '-')
+	{
+		sign = *s == '-' ? -1 : 1;
+		s++;
+	}
+	
+	while(*s >= '0' && *s <= '9')
+	{
+		result = result * 10 + (*s++ - '0');
+		digits++;
+	}
+	
+	if(*s == '.')
+	{
+		s++;
+		
+		while(*s >= '0' && *s <= '9')
+		{
+			scale /= 10;
+			result += (*s++ - '0') * scale;
+			digits++;
+		}
+	}
+	
+	if(digits == 0)
+	{
+		return 0;
+	}
+	
+	if((*s == 'e' || *s == 'E') && ((s[1] >= '0' && s[1] <= '9') || ((s[1] == '+' || s[1] == '-') && s[2] >= '0' && s[2] <= '9')))
+	{
+		s++;
+		
+		if(*s == '+' || *s == '-')
+		{
+			exponent_sign = *s == '-' ? -1 : 1;
+			s++;
+		}
+		
+		while(*s >= '0' && *s <= '9' && exponent < 100)
+		{
+			exponent = exponent * 10 + (*s++ - '0');
+		}
+		
+		while(exponent-- > 0)
+		{
+			result = exponent_sign > 0 ? result * 10 : result / 10;
+		}
+	}
+	
+	*value = sign * result;
+	*string = s;
+	
+	return 1;
+}
+
+static VGfloat color_util__clamp(VGfloat value)
+{
+	return value < 0 ? 0 : (value > 1 ? 1 : value);
+}
+
+/**
+ * Parses the arguments of a color function: three components and an optional
+ * alpha value, separated by commas or by spaces and a slash.
+ * @param string Position behind the opening parenthesis.
+ * @param values Where to write the components to, alpha defaults to 1.
+ * @param percent Where to write whether each component has been a percentage.
+ * @return 1 on success, 0 if the arguments are invalid.
+ */
+static int color_util__arguments(const char *string, VGfloat *values, int *percent)
+{
+	int commas = 0;
+	int i;
+	
+	values[3] = 1;
+	percent[3] = 0;
+	
+	for(i = 0; i < 4; i++)
+	{
+		string = color_util__skip(string);
+		
+		if(i > 0)
+		{
+			if(*string == ')' && i == 3)
+			{
+				break;
+			}
+			
+			// the first separator decides between the comma and the space syntax
+			if(*string == ',' && (i == 1 || commas))
+			{
+				commas = 1;
+				string = color_util__skip(string + 1);
+			}
+			else if(*string == '/' && i == 3 && !commas)
+			{
+				string = color_util__skip(string + 1);
+			}
+			else if(commas || i == 3)
+			{
+				return 0;
+			}
+		}
+		
+		if(!color_util__number(&string, &values[i]))
+		{
+			return 0;
+		}
+		
+		percent[i] = *string == '%';
+		
+		if(percent[i])
+		{
+			string++;
+		}
+		else if(i == 0 && strncmp(string, "deg", 3) == 0)
+		{
+			string += 3;
+		}
+	}
+	
+	string = color_util__skip(string);
+	
+	if(*string != ')')
+	{
+		return 0;
+	}
+	
+	return *color_util__skip(string + 1) == '\0';
+}
+
+static VGfloat color_util__hue(VGfloat p, VGfloat q, VGfloat t)
+{
+	if(t < 0)
+	{
+		t += 1;
+	}
+	
+	if(t > 1)
+	{
+		t -= 1;
+	}
+	
+	if(t < 1.0f / 6)
+	{
+		return p + (q - p) * 6 * t;
+	}
+	
+	if(t < 1.0f / 2)
+	{
+		return q;
+	}
+	
+	if(t < 2.0f / 3)
+	{
+		return p + (q - p) * (2.0f / 3 - t) * 6;
+	}
+	
+	return p;
+}
+
+/**
+ * Parses a CSS color: #rgb, #rgba, #rrggbb, #rrggbbaa, rgb(), rgba(), hsl(),
+ * hsla() and color keywords (case-insensitive, surrounding spaces are
+ * ignored).
+ * @param string The color string.
+ * @param rgba Where to write the red, green, blue and alpha component (0..1).
+ * @return 0 on success, -1 if the string is not a valid color.
+ */
+int color_util_parse(const char *string, VGfloat *rgba)
+{
+	char name[32];
+	const color_util_name_t *named = NULL;
+	VGfloat values[4];
+	int percent[4];
+	int digits[8];
+	size_t length = 0;
+	int i;
+	
+	string = color_util__skip(string);
+	
+	if(*string == '#')
+	{
+		string++;
+		
+		for(length = 0; length < 8 && (digits[length] = color_util__hex(string[length])) != -1; length++);
+		
+		if(*color_util__skip(string + length) != '\0')
+		{
+			return -1;
+		}
+		
+		switch(length)
+		{
+			case 3:
+			case 4:
+				for(i = 0; i < 4; i++)
+				{
+					rgba[i] = i < (int)length ? digits[i] * 0x11 / 255.0f : 1;
+				}
+				return 0;
+			case 6:
+			case 8:
+				for(i = 0; i < 4; i++)
+				{
+					rgba[i] = i * 2 < (int)length ? (digits[i * 2] * 16 + digits[i * 2 + 1]) / 255.0f : 1;
+				}
+				return 0;
+			default:
+				return -1;
+		}
+	}
+	
+	// function name or keyword, lower case
+	while(length < sizeof(name) - 1 && ((string[length] >= 'a' && string[length] <= 'z') || (string[length] >= 'A' && string[length] <= 'Z')))
+	{
+		name[length] = string[length] | 0x20;
+		length++;
+	}
+	
+	name[length] = '\0';
+	string = color_util__skip(string + length);
+	
+	if(*string == '(')
+	{
+		if(!color_util__arguments(string + 1, values, percent))
+		{
+			return -1;
+		}
+		
+		rgba[3] = color_util__clamp(percent[3] ? values[3] / 100 : values[3]);
+		
+		if(strcmp(name, "rgb") == 0 || strcmp(name, "rgba") == 0)
+		{
+			for(i = 0; i < 3; i++)
+			{
+				rgba[i] = color_util__clamp(percent[i] ? values[i] / 100 : values[i] / 255);
+			}
+			
+			return 0;
+		}
+		
+		if(strcmp(name, "hsl") == 0 || strcmp(name, "hsla") == 0)
+		{
+			VGfloat h = values[0] / 360 - floorf(values[0] / 360);
+			VGfloat s = color_util__clamp(values[1] / 100);
+			VGfloat l = color_util__clamp(values[2] / 100);
+			VGfloat q = l < 0.5f ? l * (1 + s) : l + s - l * s;
+			VGfloat p = 2 * l - q;
+			
+			rgba[0] = color_util__hue(p, q, h + 1.0f / 3);
+			rgba[1] = color_util__hue(p, q, h);
+			rgba[2] = color_util__hue(p, q, h - 1.0f / 3);
+			
+			return 0;
+		}
+		
+		return -1;
+	}
+	
+	if(*string != '\0' || length == 0)
+	{
+		return -1;
+	}
+	
+	named = bsearch(name, color_util__names, sizeof(color_util__names) / sizeof(color_util__names[0]), sizeof(color_util_name_t), color_util__compare_name);
+	
+	if(named == NULL)
+	{
+		return -1;
+	}
+	
+	for(i = 0; i < 4; i++)
+	{
+		rgba[i] = ((named->rgba >> (24 - i * 8)) & 0xff) / 255.0f;
+	}
+	
+	return 0;
+}
+
+/**
+ * Parses a CSS color like color_util_parse(). Results (including invalid
+ * strings) are cached as packed RGBA, so setting the same color again costs a
+ * hash lookup. The cache is flushed when it is three quarters full.
+ * @param string The color string.
+ * @param rgba Where to write the red, green, blue and alpha component (0..1),
+ *             quantized to 8 bits.
+ * @return 0 on success, -1 if the string is not a valid color.
+ */
+int color_util_get(const char *string, VGfloat *rgba)
+{
+	color_util_entry_t *entry = NULL;
+	uint32_t hash = 2166136261u;
+	uint32_t packed = 0;
+	size_t length = 0;
+	int valid = 0;
+	int i;
+	
+	// FNV-1a
+	for(length = 0; string[length] != '\0'; length++)
+	{
+		hash = (hash ^ (unsigned char)string[length]) * 16777619u;
+	}
+	
+	if(length >= COLOR_UTIL_CACHE_LENGTH)
+	{
+		color_util__stats.misses++;
+		
+		return color_util_parse(string, rgba);
+	}
+	
+	for(i = hash & (COLOR_UTIL_CACHE_SIZE - 1); color_util__cache[i].used; i = (i + 1) & (COLOR_UTIL_CACHE_SIZE - 1))
+	{
+		entry = &color_util__cache[i];
+		
+		if(entry->hash == hash && strcmp(entry->string, string) == 0)
+		{
+			color_util__stats.hits++;
+			
+			if(!entry->valid)
+			{
+				return -1;
+			}
+			
+			for(i = 0; i < 4; i++)
+			{
+				rgba[i] = ((entry->rgba >> (24 - i * 8)) & 0xff) / 255.0f;
+			}
+			
+			return 0;
+		}
+	}
+	
+	color_util__stats.misses++;
+	valid = color_util_parse(string, rgba) == 0;
+	
+	if(!valid)
+	{
+		color_util__stats.invalid++;
+	}
+	else
+	{
+		for(i = 0; i < 4; i++)
+		{
+			rgba[i] = (VGint)(rgba[i] * 255 + 0.5f) / 255.0f;
+			packed |= (uint32_t)(rgba[i] * 255 + 0.5f) << (24 - i * 8);
+		}
+	}
+	
+	if(color_util__stats.entries >= COLOR_UTIL_CACHE_SIZE * 3 / 4)
+	{
+		// generated strings would fill the table, start over
+		color_util_clear();
+		color_util__stats.flushes++;
+	}
+	
+	for(i = hash & (COLOR_UTIL_CACHE_SIZE - 1); color_util__cache[i].used; i = (i + 1) & (COLOR_UTIL_CACHE_SIZE - 1));
+	
+	entry = &color_util__cache[i];
+	memcpy(entry->string, string, length + 1);
+	entry->hash = hash;
+	entry->rgba = packed;
+	entry->used = 1;
+	entry->valid = valid;
+	color_util__stats.entries++;
+	
+	return valid ? 0 : -1;
+}
+
+/**
+ * Removes all cached colors.
+ */
+void color_util_clear(void)
+{
+	memset(color_util__cache, 0, sizeof(color_util__cache));
+	color_util__stats.entries = 0;
+}
+
+/**
+ * Copies the cache statistics.
+ * @param stats Where to write the statistics to.
+ */
+void color_util_get_stats(color_util_stats_t *stats)
+{
+	*stats = color_util__stats;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __COLOR_UTIL_H__
+#define __COLOR_UTIL_H__
+
+#include <VG/openvg.h>
+
+// cached strings, a power of two
+#define COLOR_UTIL_CACHE_SIZE 1024
+// longer strings are parsed every time
+#define COLOR_UTIL_CACHE_LENGTH 56
+
+typedef struct color_util_stats_t
+{
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long invalid;
+	unsigned long flushes;
+	long entries;
+} color_util_stats_t;
+
+int color_util_parse(const char *string, VGfloat *rgba);
+int color_util_get(const char *string, VGfloat *rgba);
+void color_util_clear(void);
+void color_util_get_stats(color_util_stats_t *stats);
+
+#endif /* __COLOR_UTIL_H__ */
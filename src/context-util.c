@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "log-util.h"
+#include "memory-util.h"
+#include "context-util.h"
+
+/*
+ * A context holds everything a canvas renders with: the target surface, the
+ * immediate path, styles, line and text settings, the save stack and the
+ * dirty region. The canvas functions operate on the current context, the
+ * same way OpenVG calls operate on the current EGL context; switching the
+ * context switches both. Offscreen contexts render into a VGImage through a
+ * pbuffer surface and have their own EGL context sharing all objects with
+ * the window, so the image can be drawn on any other context.
+ *
+ * All functions must be called from the JS thread while it owns EGL (see
+ * present-util).
+ */
+
+static canvas_context_t *context_util_contexts = NULL;
+static canvas_context_t *context_util_window = NULL;
+static canvas_context_t *context_util_current = NULL;
+static unsigned long context_util_next_id = 1;
+
+/**
+ * Allocates a context with the default canvas state and adds it to the list.
+ * @return The new context or NULL on failure.
+ */
+static canvas_context_t *context_util_new(int32_t width, int32_t height)
+{
+	canvas_context_t *context = calloc(1, sizeof(canvas_context_t));
+	
+	if(context == NULL)
+	{
+		eprintf("Failed to allocate context.\n");
+		
+		return NULL;
+	}
+	
+	context->id = context_util_next_id++;
+	context->width = width;
+	context->height = height;
+	context->surface_width = width;
+	context->surface_height = height;
+	
+	context->path_empty = 1;
+	context->dirty_empty = 1;
+	
+	context->global_alpha = 1;
+	context->composite_operation = VG_BLEND_SRC;
+	context->image_smoothing = VG_TRUE;
+	
+	context->line_width = 1;
+	context->line_cap = VG_CAP_BUTT;
+	context->line_join = VG_JOIN_MITER;
+	context->miter_limit = 10;
+	
+	context->font_index = -1; // no font
+	context->kerning = VG_TRUE;
+	context->text_align = CANVAS_TEXT_ALIGN_LEFT;
+	context->text_baseline = CANVAS_TEXT_BASELINE_ALPHABETIC;
+	
+	context->clipping = VG_FALSE;
+	
+	context->next = context_util_contexts;
+	context_util_contexts = context;
+	
+	return context;
+}
+
+/**
+ * Removes a context from the list.
+ */
+static void context_util_unlink(canvas_context_t *context)
+{
+	canvas_context_t **link = &context_util_contexts;
+	
+	while(*link != NULL)
+	{
+		if(*link == context)
+		{
+			*link = context->next;
+			
+			return;
+		}
+		
+		link = &(*link)->next;
+	}
+}
+
+/**
+ * Creates the context of the window surface. egl_init must have been called.
+ * @return The window context or NULL on failure.
+ */
+canvas_context_t *context_util_create_window(void)
+{
+	canvas_context_t *context = context_util_new(egl_get_screen_width(), egl_get_screen_height());
+	
+	if(context == NULL)
+	{
+		return NULL;
+	}
+	
+	egl_get_window(&context->surface, &context->context);
+	
+	context_util_window = context;
+	context_util_current = context;
+	
+	return context;
+}
+
+/**
+ * Creates an offscreen context rendering into a new transparent image. The
+ * current context stays current.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @return The new context or NULL on failure.
+ */
+canvas_context_t *context_util_create_offscreen(int32_t width, int32_t height)
+{
+	canvas_context_t *context = NULL;
+	image_t *image = NULL;
+	VGint max_width = vgGeti(VG_MAX_IMAGE_WIDTH);
+	VGint max_height = vgGeti(VG_MAX_IMAGE_HEIGHT);
+	
+	if(width <= 0 || height <= 0 || (max_width > 0 && width > max_width) || (max_height > 0 && height > max_height))
+	{
+		eprintf("Invalid offscreen size: %ix%i\n", width, height);
+		
+		return NULL;
+	}
+	
+	image = malloc(sizeof(image_t));
+	if(image == NULL)
+	{
+		eprintf("Failed to allocate offscreen image.\n");
+		
+		return NULL;
+	}
+	
+	image->width = width;
+	image->height = height;
+	image->image = vgCreateImage(VG_sRGBA_8888_PRE, width, height, VG_IMAGE_QUALITY_BETTER);
+	
+	if(image->image == VG_INVALID_HANDLE)
+	{
+		eprintf("Failed to create offscreen image.\n");
+		
+		free(image);
+		
+		return NULL;
+	}
+	
+	vgClearImage(image->image, 0, 0, width, height);
+	memory_util_alloc(MEMORY_UTIL_IMAGE, (long long)width * height * 4, 1);
+	
+	context = context_util_new(width, height);
+	
+	if(context == NULL || egl_create_image_target(image->image, &context->surface, &context->context) < 0)
+	{
+		if(context != NULL)
+		{
+			context_util_unlink(context);
+			free(context);
+		}
+		
+		image_cleanup(image);
+		
+		return NULL;
+	}
+	
+	context->image = image;
+	
+	return context;
+}
+
+/**
+ * Destroys a context. The canvas state (path, paints, save stack) must have
+ * been cleaned up before. If the context is current, the window becomes the
+ * current context.
+ * @param context The context.
+ */
+void context_util_destroy(canvas_context_t *context)
+{
+	if(context == context_util_current && context != context_util_window && context_util_window != NULL)
+	{
+		context_util_make_current(context_util_window);
+	}
+	
+	context_util_unlink(context);
+	
+	if(context == context_util_current)
+	{
+		context_util_current = NULL;
+	}
+	
+	if(context == context_util_window)
+	{
+		context_util_window = NULL;
+	}
+	
+	if(context->image != NULL)
+	{
+		egl_destroy_image_target(context->surface, context->context);
+		image_cleanup(context->image);
+	}
+	
+	free(context);
+}
+
+/**
+ * Makes a context current. Pending rendering into an offscreen image is
+ * finished before, so the image can be drawn on the next context. While a
+ * layer of the context is recorded, the layer is made current instead.
+ * @param context The context.
+ */
+void context_util_make_current(canvas_context_t *context)
+{
+	canvas_context_t *previous = context_util_current;
+	
+	while(context->redirect != NULL)
+	{
+		context = context->redirect;
+	}
+	
+	if(context == previous)
+	{
+		return;
+	}
+	
+	if(previous != NULL && previous->image != NULL && !previous->dirty_empty)
+	{
+		vgFinish();
+		previous->dirty_empty = 1;
+	}
+	
+	context_util_current = context;
+	egl_set_target(context->surface, context->context, context->width, context->height);
+}
+
+/**
+ * Returns the context the canvas functions operate on.
+ * @return The current context.
+ */
+canvas_context_t *context_util_get(void)
+{
+	return context_util_current;
+}
+
+/**
+ * Returns the context with the given id.
+ * @param id The id of the context.
+ * @return The context or NULL if it has been destroyed.
+ */
+canvas_context_t *context_util_find(unsigned long id)
+{
+	canvas_context_t *context = context_util_contexts;
+	
+	while(context != NULL && context->id != id)
+	{
+		context = context->next;
+	}
+	
+	return context;
+}
+
+/**
+ * @return The window context or NULL if the canvas is not initialized.
+ */
+canvas_context_t *context_util_get_window(void)
+{
+	return context_util_window;
+}
+
+/**
+ * Returns the first context of the list of all contexts (linked by next).
+ * @return The first context or NULL.
+ */
+canvas_context_t *context_util_get_first(void)
+{
+	return context_util_contexts;
+}
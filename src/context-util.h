@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CONTEXT_UTIL_H__
+#define __CONTEXT_UTIL_H__
+
+#include <stdint.h>
+#include <EGL/egl.h>
+#include <VG/openvg.h>
+
+#include "image-util.h"
+#include "canvas-paint.h"
+#include "canvas-textAlign.h"
+#include "canvas-textBaseline.h"
+
+struct canvas_save_stack_t;
+struct path_util_t;
+struct hit_util_t;
+
+typedef struct canvas_context_t
+{
+	unsigned long id;
+	
+	// rendering target, image is NULL for the window surface
+	EGLSurface surface;
+	EGLContext context;
+	int32_t width;
+	int32_t height;
+	// size of the surface, width and height describe a larger frame while
+	// it is rendered in tiles (see tile-util)
+	int32_t surface_width;
+	int32_t surface_height;
+	image_t *image;
+	
+	// offset of drawing that ignores the transformation (drawImage,
+	// clearRect), moves it to the place on the canvas a layer is drawn on
+	VGfloat offset_x;
+	VGfloat offset_y;
+	
+	// immediate path and the bounds of all its points
+	VGPath path;
+	VGfloat path_min_x;
+	VGfloat path_min_y;
+	VGfloat path_max_x;
+	VGfloat path_max_y;
+	int path_empty;
+	long long path_bytes;
+	// copy of the immediate path for hit testing (see path-util)
+	struct path_util_t *path_copy;
+	// a full ellipse which is the only sub-path of the immediate path is not
+	// appended until needed, fill() draws it with the unit circle (see canvas-ellipse)
+	int path_ellipse_pending;
+	VGfloat path_ellipse[7];
+	VGPath unit_circle;
+	
+	// area drawn since the last swap (surface coordinates)
+	VGfloat dirty_min_x;
+	VGfloat dirty_min_y;
+	VGfloat dirty_max_x;
+	VGfloat dirty_max_y;
+	int dirty_empty;
+	
+	paint_t *fill_style;
+	paint_t *stroke_style;
+	// color paints of the styles, reused for every color set on the context
+	paint_t fill_color;
+	paint_t stroke_color;
+	VGfloat global_alpha;
+	VGBlendMode composite_operation;
+	VGboolean image_smoothing;
+	
+	VGfloat line_width;
+	VGCapStyle line_cap;
+	VGJoinStyle line_join;
+	VGfloat miter_limit;
+	VGfloat line_dash_offset;
+	VGfloat *line_dash_data;
+	VGint line_dash_count;
+	
+	int font_index;
+	VGfloat font_size;
+	VGboolean kerning;
+	canvas_text_align_t text_align;
+	canvas_text_baseline_t text_baseline;
+	
+	VGboolean clipping;
+	// surface bounds of the clipping region while clipping (min x, min y, max x, max y)
+	VGfloat clip_bounds[4];
+	struct canvas_save_stack_t *save_stack;
+	
+	// hit regions added with addHitRegion() (see hit-util)
+	struct hit_util_t *hit_regions;
+	
+	// layer the drawing of this context is redirected to while it is recorded
+	struct canvas_context_t *redirect;
+	
+	struct canvas_context_t *next;
+} canvas_context_t;
+
+canvas_context_t *context_util_create_window(void);
+canvas_context_t *context_util_create_offscreen(int32_t width, int32_t height);
+void context_util_destroy(canvas_context_t *context);
+void context_util_make_current(canvas_context_t *context);
+canvas_context_t *context_util_find(unsigned long id);
+canvas_context_t *context_util_get_window(void);
+canvas_context_t *context_util_get_first(void);
+canvas_context_t *context_util_get(void);
+
+#endif /* __CONTEXT_UTIL_H__ */
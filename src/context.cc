@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "context.h"
+#include "vgcanvas.h"
+
+extern "C" {
+	#include "canvas.h"
+}
+
+using namespace v8;
+
+namespace vgcanvas {
+	
+	static Nan::Persistent<Function> contextConstructor;
+	
+	// last object an entry point has been called on and the context it renders to (NULL: none),
+	// the receiver is weak, the binding must not keep an offscreen context alive
+	static Nan::Persistent<Object> boundReceiver;
+	static canvas_context_t *boundContext = NULL;
+	
+	Context::Context() : id(0), offscreen(false) {
+		
+	}
+	
+	Context::~Context() {
+		canvas_context_t *context = GetContext();
+		
+		if(offscreen && context) {
+			if(context == boundContext) {
+				ResetContextBinding();
+			}
+			
+			present_util_acquire();
+			canvas__destroy_context(context);
+		}
+	}
+	
+	void Context::Init(Local<Object> exports) {
+		RegisterEntry<Context::New>("Context");
+		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Guard<Context::New>);
+		tpl->SetClassName(Nan::New("Context").ToLocalChecked());
+		
+		Local<ObjectTemplate> obj = tpl->InstanceTemplate();
+		obj->SetAccessor(Nan::New("width").ToLocalChecked(), Context::GetSize);
+		obj->SetAccessor(Nan::New("height").ToLocalChecked(), Context::GetSize);
+		obj->SetInternalFieldCount(1);
+		
+		contextConstructor.Reset(tpl->GetFunction());
+		exports->Set(Nan::New("Context").ToLocalChecked(), tpl->GetFunction());
+	}
+	
+	/**
+	 * Returns a new Context object for the window. The canvas must be initialized.
+	 */
+	Local<Object> Context::NewWindow() {
+		return Nan::New(contextConstructor)->NewInstance();
+	}
+	
+	// new Context(): the window, new Context(width, height): an offscreen canvas
+	void Context::New(const Nan::FunctionCallbackInfo<Value> &info) {
+		if (!info.IsConstructCall()) {
+			Nan::ThrowTypeError("not called as constructor");
+			return;
+		}
+		
+		if(!context_util_get_window()) {
+			Nan::ThrowError("Not initialized");
+			return;
+		}
+		
+		canvas_context_t *context = context_util_get_window();
+		
+		if(info.Length() > 0) {
+			if(!checkArgs(info, 2, 0) || info[0]->Int32Value() <= 0 || info[1]->Int32Value() <= 0) {
+				Nan::ThrowTypeError("wrong args");
+				return;
+			}
+			
+			context = canvas__create_context(info[0]->Int32Value(), info[1]->Int32Value());
+			
+			if(!context) {
+				Nan::ThrowError("Failed to create offscreen canvas");
+				return;
+			}
+		}
+		
+		Context *obj = new Context();
+		obj->id = context->id;
+		obj->offscreen = context->image != NULL;
+		obj->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+	}
+	
+	void Context::GetSize(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Context* obj = Context::Unwrap<Context>(info.Holder());
+		canvas_context_t *context = obj->GetContext();
+		std::string str(*Nan::Utf8String(property));
+		
+		if(!context) {
+			info.GetReturnValue().Set(Nan::New(0));
+			return;
+		}
+		
+		if(str == "width") {
+			info.GetReturnValue().Set(Nan::New(context->width));
+		} else if(str == "height") {
+			info.GetReturnValue().Set(Nan::New(context->height));
+		}
+	}
+	
+	/**
+	 * Returns the native context or NULL if it has been destroyed by cleanup().
+	 */
+	canvas_context_t* Context::GetContext() {
+		return context_util_find(id);
+	}
+	
+	/**
+	 * Forgets the binding when the bound object is garbage collected.
+	 */
+	static void BoundReceiverCollected(const Nan::WeakCallbackInfo<void> &data) {
+		ResetContextBinding();
+	}
+	
+	/**
+	 * Makes the context of the object an entry point is called on current.
+	 * Objects carry their context in the _context property (see lib/context.js),
+	 * calls on other objects keep the current context.
+	 */
+	void BindContext(Local<Object> receiver) {
+		if(boundReceiver.IsEmpty() || !(boundReceiver == receiver)) {
+			Local<Value> value = receiver->Get(Nan::New("_context").ToLocalChecked());
+			
+			boundReceiver.Reset(receiver);
+			boundReceiver.SetWeak<void>(NULL, BoundReceiverCollected, Nan::WeakCallbackType::kParameter);
+			boundContext = NULL;
+			
+			if(value->IsObject() && std::string(*Nan::Utf8String(Local<Object>::Cast(value)->GetConstructorName())) == "Context") {
+				boundContext = Context::Unwrap<Context>(Local<Object>::Cast(value))->GetContext();
+			}
+		}
+		
+		if(boundContext) {
+			context_util_make_current(boundContext);
+		}
+	}
+	
+	/**
+	 * Forgets the last binding. Must be called when contexts are destroyed.
+	 */
+	void ResetContextBinding() {
+		boundReceiver.Reset();
+		boundContext = NULL;
+	}
+	
+}
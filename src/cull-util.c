@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+#include "cull-util.h"
+#include "dirty-util.h"
+#include "context-util.h"
+
+/*
+ * Draws whose bounds can not touch the surface of the current context or the
+ * bounds of its clipping region are skipped before they reach the driver. The
+ * bounds are conservative: paths are measured by all of their points
+ * (including control points), strokes are grown by the line width and miter
+ * limit, text by the box of its glyphs. Every draw which is not culled is
+ * added to the dirty region.
+ */
+
+static int cull_enabled = 1;
+static unsigned long cull_frame_draws = 0;
+static unsigned long cull_frame_culled = 0;
+static cull_util_stats_t cull_stats;
+
+/**
+ * Enables or disables culling. Disabled culling still tracks the dirty region.
+ * @param enabled 1 to skip invisible draws
+ */
+void cull_util_set_enabled(int enabled)
+{
+	cull_enabled = enabled;
+}
+
+/**
+ * Returns whether culling is enabled.
+ * @return 1 if invisible draws are skipped
+ */
+int cull_util_get_enabled(void)
+{
+	return cull_enabled;
+}
+
+/**
+ * Transforms a bounding box in user coordinates by a path matrix.
+ *
+ * @param matrix The path-user-to-surface matrix
+ * @param min_x The left edge
+ * @param min_y The lower edge
+ * @param max_x The right edge
+ * @param max_y The upper edge
+ * @param expand Distance in user units the box is grown by on each side
+ * @param bounds Where to write the surface bounds to (min x, min y, max x, max y)
+ */
+static void cull_util_map(const VGfloat *matrix, VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y, VGfloat expand, VGfloat *bounds)
+{
+	VGfloat corners[8];
+	VGfloat x = 0;
+	VGfloat y = 0;
+	int i = 0;
+	
+	corners[0] = min_x - expand;
+	corners[1] = min_y - expand;
+	corners[2] = max_x + expand;
+	corners[3] = min_y - expand;
+	corners[4] = max_x + expand;
+	corners[5] = max_y + expand;
+	corners[6] = min_x - expand;
+	corners[7] = max_y + expand;
+	
+	for(i = 0; i < 4; i++)
+	{
+		// column major: [ sx shy w0 shx sy w1 tx ty w2 ]
+		x = matrix[0] * corners[i * 2] + matrix[3] * corners[i * 2 + 1] + matrix[6];
+		y = matrix[1] * corners[i * 2] + matrix[4] * corners[i * 2 + 1] + matrix[7];
+		
+		if(i == 0 || x < bounds[0])
+		{
+			bounds[0] = x;
+		}
+		
+		if(i == 0 || y < bounds[1])
+		{
+			bounds[1] = y;
+		}
+		
+		if(i == 0 || x > bounds[2])
+		{
+			bounds[2] = x;
+		}
+		
+		if(i == 0 || y > bounds[3])
+		{
+			bounds[3] = y;
+		}
+	}
+}
+
+/**
+ * Transforms a bounding box in user coordinates by the current
+ * path-user-to-surface matrix.
+ *
+ * @param min_x The left edge
+ * @param min_y The lower edge
+ * @param max_x The right edge
+ * @param max_y The upper edge
+ * @param expand Distance in user units the box is grown by on each side (e.g. half the line width)
+ * @param bounds Where to write the surface bounds to (min x, min y, max x, max y)
+ */
+void cull_util_transform(VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y, VGfloat expand, VGfloat *bounds)
+{
+	VGfloat matrix[9];
+	VGint mode = vgGeti(VG_MATRIX_MODE);
+	
+	if(mode != VG_MATRIX_PATH_USER_TO_SURFACE)
+	{
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+		vgGetMatrix(matrix);
+		vgSeti(VG_MATRIX_MODE, mode);
+	}
+	else
+	{
+		vgGetMatrix(matrix);
+	}
+	
+	cull_util_map(matrix, min_x, min_y, max_x, max_y, expand, bounds);
+}
+
+/**
+ * Tests surface bounds against the surface and the clipping region of the
+ * current context, counts the draw and adds it to the dirty region if it is
+ * visible.
+ * @param bounds The surface bounds (min x, min y, max x, max y).
+ * @return 1 if the draw can be visible, 0 if it can be skipped.
+ */
+static int cull_util_test(const VGfloat *bounds)
+{
+	canvas_context_t *context = context_util_get();
+	
+	cull_frame_draws++;
+	
+	// NaN bounds fail every comparison and are drawn
+	if(cull_enabled && (bounds[2] < 0 || bounds[3] < 0 || bounds[0] > context->surface_width || bounds[1] > context->surface_height ||
+		(context->clipping && (bounds[2] < context->clip_bounds[0] || bounds[3] < context->clip_bounds[1] || bounds[0] > context->clip_bounds[2] || bounds[1] > context->clip_bounds[3]))))
+	{
+		cull_frame_culled++;
+		
+		return 0;
+	}
+	
+	dirty_util_add(bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1]);
+	
+	return 1;
+}
+
+/**
+ * Tests whether a draw with a bounding box in user coordinates can be visible.
+ * The box is transformed by the current path-user-to-surface matrix and grown
+ * by one pixel for antialiasing. Visible draws are added to the dirty region.
+ *
+ * @param min_x The left edge
+ * @param min_y The lower edge
+ * @param max_x The right edge
+ * @param max_y The upper edge
+ * @param expand Distance in user units the box is grown by on each side (e.g. half the line width)
+ * @return 1 if the draw can be visible, 0 if it can be skipped.
+ */
+int cull_util_user(VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y, VGfloat expand)
+{
+	VGfloat bounds[4];
+	
+	cull_util_transform(min_x, min_y, max_x, max_y, expand, bounds);
+	
+	bounds[0] -= 1;
+	bounds[1] -= 1;
+	bounds[2] += 1;
+	bounds[3] += 1;
+	
+	return cull_util_test(bounds);
+}
+
+/**
+ * Tests whether a draw with a bounding box in user coordinates under a given
+ * path matrix can be visible, for draws that load their own matrices. Visible
+ * draws are added to the dirty region.
+ *
+ * @param matrix The path-user-to-surface matrix
+ * @param min_x The left edge
+ * @param min_y The lower edge
+ * @param max_x The right edge
+ * @param max_y The upper edge
+ * @return 1 if the draw can be visible, 0 if it can be skipped.
+ */
+int cull_util_matrix(const VGfloat *matrix, VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y)
+{
+	VGfloat bounds[4];
+	
+	cull_util_map(matrix, min_x, min_y, max_x, max_y, 0, bounds);
+	
+	bounds[0] -= 1;
+	bounds[1] -= 1;
+	bounds[2] += 1;
+	bounds[3] += 1;
+	
+	return cull_util_test(bounds);
+}
+
+/**
+ * Tests whether a draw covering a rectangle in surface coordinates can be
+ * visible. Visible draws are added to the dirty region.
+ *
+ * @param x The x axis of the lower left corner
+ * @param y The y axis of the lower left corner
+ * @param width The width
+ * @param height The height
+ * @return 1 if the draw can be visible, 0 if it can be skipped.
+ */
+int cull_util_surface(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
+{
+	VGfloat bounds[4];
+	
+	bounds[0] = width < 0 ? x + width : x;
+	bounds[1] = height < 0 ? y + height : y;
+	bounds[2] = width < 0 ? x : x + width;
+	bounds[3] = height < 0 ? y : y + height;
+	
+	return cull_util_test(bounds);
+}
+
+/**
+ * Completes the statistics of a frame.
+ */
+void cull_util_frame(void)
+{
+	cull_stats.frames++;
+	cull_stats.draws += cull_frame_draws;
+	cull_stats.culled += cull_frame_culled;
+	cull_stats.draws_last = cull_frame_draws;
+	cull_stats.culled_last = cull_frame_culled;
+	
+	cull_frame_draws = 0;
+	cull_frame_culled = 0;
+}
+
+/**
+ * Returns the culling statistics.
+ *
+ * @param stats Pointer where to write the statistics to
+ */
+void cull_util_get_stats(cull_util_stats_t *stats)
+{
+	*stats = cull_stats;
+}
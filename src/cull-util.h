@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CULL_UTIL_H__
+#define __CULL_UTIL_H__
+
+#include <VG/openvg.h>
+
+typedef struct cull_util_stats_t
+{
+	unsigned long frames;
+	unsigned long draws;
+	unsigned long culled;
+	unsigned long draws_last;
+	unsigned long culled_last;
+} cull_util_stats_t;
+
+void cull_util_set_enabled(int enabled);
+int cull_util_get_enabled(void);
+void cull_util_transform(VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y, VGfloat expand, VGfloat *bounds);
+int cull_util_user(VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y, VGfloat expand);
+int cull_util_matrix(const VGfloat *matrix, VGfloat min_x, VGfloat min_y, VGfloat max_x, VGfloat max_y);
+int cull_util_surface(VGfloat x, VGfloat y, VGfloat width, VGfloat height);
+void cull_util_frame(void);
+void cull_util_get_stats(cull_util_stats_t *stats);
+
+#endif /* __CULL_UTIL_H__ */
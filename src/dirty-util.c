@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+#include "dirty-util.h"
+#include "egl-util.h"
+#include "context-util.h"
+
+/*
+ * Tracks the union of the surface areas touched by draw calls since the last
+ * swap. All coordinates are surface coordinates (origin bottom left) like the
+ * rest of the OpenVG calls. The region belongs to the current context, the
+ * statistics count the frames of the window.
+ */
+
+static dirty_util_stats_t dirty_stats;
+
+/**
+ * Resets the statistics and marks the whole surface as dirty.
+ */
+void dirty_util_init(void)
+{
+	memset(&dirty_stats, 0, sizeof(dirty_stats));
+	
+	dirty_util_invalidate();
+}
+
+/**
+ * Extends the dirty region by a rectangle in surface coordinates.
+ *
+ * @param x The x axis of the lower left corner
+ * @param y The y axis of the lower left corner
+ * @param width The width
+ * @param height The height
+ */
+void dirty_util_add(VGfloat x, VGfloat y, VGfloat width, VGfloat height)
+{
+	canvas_context_t *context = context_util_get();
+	
+	if(width < 0)
+	{
+		x += width;
+		width = -width;
+	}
+	
+	if(height < 0)
+	{
+		y += height;
+		height = -height;
+	}
+	
+	if(context->dirty_empty)
+	{
+		context->dirty_min_x = x;
+		context->dirty_min_y = y;
+		context->dirty_max_x = x + width;
+		context->dirty_max_y = y + height;
+		context->dirty_empty = 0;
+		
+		return;
+	}
+	
+	context->dirty_min_x = fminf(context->dirty_min_x, x);
+	context->dirty_min_y = fminf(context->dirty_min_y, y);
+	context->dirty_max_x = fmaxf(context->dirty_max_x, x + width);
+	context->dirty_max_y = fmaxf(context->dirty_max_y, y + height);
+}
+
+/**
+ * Marks the whole surface as dirty.
+ */
+void dirty_util_invalidate(void)
+{
+	dirty_util_add(0, 0, egl_get_width(), egl_get_height());
+}
+
+/**
+ * Returns the dirty region rounded to whole pixels and clipped to the surface.
+ *
+ * @param x Pointer where to write the x axis of the lower left corner to
+ * @param y Pointer where to write the y axis of the lower left corner to
+ * @param width Pointer where to write the width to
+ * @param height Pointer where to write the height to
+ * @return 0 if nothing has been drawn since the last swap, 1 otherwise
+ */
+int dirty_util_get(VGint *x, VGint *y, VGint *width, VGint *height)
+{
+	canvas_context_t *context = context_util_get();
+	VGint min_x = 0;
+	VGint min_y = 0;
+	VGint max_x = 0;
+	VGint max_y = 0;
+	
+	*x = *y = *width = *height = 0;
+	
+	if(context->dirty_empty)
+	{
+		return 0;
+	}
+	
+	min_x = fmaxf(floorf(context->dirty_min_x), 0);
+	min_y = fmaxf(floorf(context->dirty_min_y), 0);
+	max_x = fminf(ceilf(context->dirty_max_x), egl_get_width());
+	max_y = fminf(ceilf(context->dirty_max_y), egl_get_height());
+	
+	if(max_x <= min_x || max_y <= min_y)
+	{
+		return 0;
+	}
+	
+	*x = min_x;
+	*y = min_y;
+	*width = max_x - min_x;
+	*height = max_y - min_y;
+	
+	return 1;
+}
+
+/**
+ * Records a presented frame and starts a new dirty region.
+ *
+ * @param partial 1 if only the dirty region has been presented
+ */
+void dirty_util_swapped(int partial)
+{
+	VGint x, y, width, height;
+	double coverage = 0;
+	
+	if(dirty_util_get(&x, &y, &width, &height))
+	{
+		coverage = (double)width * height / ((double)egl_get_width() * egl_get_height());
+	}
+	
+	dirty_stats.frames++;
+	dirty_stats.coverage_last = coverage;
+	dirty_stats.coverage_average += (coverage - dirty_stats.coverage_average) / dirty_stats.frames;
+	
+	if(partial)
+	{
+		dirty_stats.partial++;
+	}
+	
+	context_util_get()->dirty_empty = 1;
+}
+
+/**
+ * Records a swap which has been skipped because nothing has been drawn.
+ */
+void dirty_util_skipped(void)
+{
+	dirty_stats.skipped++;
+	context_util_get()->dirty_empty = 1;
+}
+
+/**
+ * Returns the dirty tracking statistics.
+ *
+ * @param stats Pointer where to write the statistics to
+ */
+void dirty_util_get_stats(dirty_util_stats_t *stats)
+{
+	*stats = dirty_stats;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DIRTY_UTIL_H__
+#define __DIRTY_UTIL_H__
+
+#include <VG/openvg.h>
+
+typedef struct dirty_util_stats_t
+{
+	unsigned long frames;
+	unsigned long skipped;
+	unsigned long partial;
+	double coverage_last;
+	double coverage_average;
+} dirty_util_stats_t;
+
+void dirty_util_init(void);
+void dirty_util_add(VGfloat x, VGfloat y, VGfloat width, VGfloat height);
+void dirty_util_invalidate(void);
+int dirty_util_get(VGint *x, VGint *y, VGint *width, VGint *height);
+void dirty_util_swapped(int partial);
+void dirty_util_skipped(void);
+void dirty_util_get_stats(dirty_util_stats_t *stats);
+
+#endif /* __DIRTY_UTIL_H__ */
@@ -0,0 +1,1065 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "log-util.h"
+#include "image-util.h"
+#include "memory-util.h"
+#include "profile-util.h"
+#include "canvas.h"
+#include "canvas-paint.h"
+#include "canvas-save.h"
+#include "canvas-restore.h"
+#include "canvas-beginPath.h"
+#include "canvas-closePath.h"
+#include "canvas-moveTo.h"
+#include "canvas-lineTo.h"
+#include "canvas-quadraticCurveTo.h"
+#include "canvas-bezierCurveTo.h"
+#include "canvas-arc.h"
+#include "canvas-arcTo.h"
+#include "canvas-ellipse.h"
+#include "canvas-drawCircles.h"
+#include "canvas-rect.h"
+#include "canvas-polyline.h"
+#include "canvas-fill.h"
+#include "canvas-stroke.h"
+#include "canvas-clip.h"
+#include "canvas-fillRect.h"
+#include "canvas-strokeRect.h"
+#include "canvas-clearRect.h"
+#include "canvas-translate.h"
+#include "canvas-scale.h"
+#include "canvas-rotate.h"
+#include "canvas-transform.h"
+#include "canvas-setTransform.h"
+#include "canvas-resetTransform.h"
+#include "canvas-lineWidth.h"
+#include "canvas-lineCap.h"
+#include "canvas-lineJoin.h"
+#include "canvas-miterLimit.h"
+#include "canvas-setLineDash.h"
+#include "canvas-lineDashOffset.h"
+#include "canvas-globalAlpha.h"
+#include "canvas-globalCompositeOperation.h"
+#include "canvas-imageSmoothingEnabled.h"
+#include "canvas-font.h"
+#include "canvas-textAlign.h"
+#include "canvas-textBaseline.h"
+#include "canvas-fillText.h"
+#include "canvas-strokeText.h"
+#include "canvas-drawImage.h"
+#include "displaylist-util.h"
+
+// strings are stored with terminator, padded to keep the floats aligned
+#define DISPLAYLIST_UTIL_PAD(bytes) (((bytes) + 3) & ~3)
+
+// kinds of serialized resources
+#define DISPLAYLIST_UTIL_IMAGE 0
+#define DISPLAYLIST_UTIL_LINEAR_GRADIENT 1
+#define DISPLAYLIST_UTIL_RADIAL_GRADIENT 2
+#define DISPLAYLIST_UTIL_PATTERN 3
+
+// every command starts with this header, followed by the index of its
+// resource (if any), its float arguments and its string argument (if any)
+typedef struct displaylist_command_t
+{
+	uint8_t op;
+	uint8_t count;
+	uint16_t length;
+} displaylist_command_t;
+
+typedef struct displaylist_header_t
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t resources;
+	uint32_t commands;
+	uint32_t size;
+} displaylist_header_t;
+
+displaylist_t *displaylist_util_recording = NULL;
+
+/**
+ * Checks if commands of an operation reference a resource.
+ * @param op The operation.
+ * @return 1 if the commands have a resource index, 0 otherwise.
+ */
+static int displaylist_util__has_resource(displaylist_op_t op)
+{
+	return op == DISPLAYLIST_FILL_PAINT || op == DISPLAYLIST_STROKE_PAINT || op == DISPLAYLIST_DRAW_IMAGE;
+}
+
+/**
+ * Checks if commands of an operation have a string argument.
+ * @param op The operation.
+ * @return 1 if the commands have a string, 0 otherwise.
+ */
+static int displaylist_util__has_string(displaylist_op_t op)
+{
+	switch(op)
+	{
+		case DISPLAYLIST_LINE_CAP:
+		case DISPLAYLIST_LINE_JOIN:
+		case DISPLAYLIST_GLOBAL_COMPOSITE_OPERATION:
+		case DISPLAYLIST_FONT:
+		case DISPLAYLIST_TEXT_ALIGN:
+		case DISPLAYLIST_TEXT_BASELINE:
+		case DISPLAYLIST_FILL_TEXT:
+		case DISPLAYLIST_STROKE_TEXT:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Reserves space at the end of the commands of a list.
+ * @param list The display list.
+ * @param bytes The amount of bytes.
+ * @return Pointer to the reserved space or NULL on failure.
+ */
+static char *displaylist_util__reserve(displaylist_t *list, size_t bytes)
+{
+	size_t capacity = list->capacity ? list->capacity : 4096;
+	char *data = NULL;
+	
+	if(list->size + bytes > list->capacity)
+	{
+		while(capacity < list->size + bytes)
+		{
+			capacity *= 2;
+		}
+		
+		PROFILE_ALLOC(capacity);
+		data = realloc(list->data, capacity);
+		
+		if(data == NULL)
+		{
+			eprintf("Failed to grow display list.\n");
+			
+			return NULL;
+		}
+		
+		memory_util_alloc(MEMORY_UTIL_STATE, capacity - list->capacity, 0);
+		list->data = data;
+		list->capacity = capacity;
+	}
+	
+	data = list->data + list->size;
+	list->size += bytes;
+	
+	return data;
+}
+
+/**
+ * Returns the index of a resource of a list, the resource is added if the
+ * list does not reference it yet.
+ * @param list The display list.
+ * @param paint The gradient or pattern, NULL for images.
+ * @param image The image.
+ * @return The index or -1 on failure.
+ */
+static VGint displaylist_util__resource(displaylist_t *list, paint_t *paint, image_t *image)
+{
+	displaylist_resource_t *resources = NULL;
+	VGint i;
+	
+	for(i = 0; i < list->resource_count; i++)
+	{
+		if(list->resources[i].paint == paint && list->resources[i].image == image)
+		{
+			return i;
+		}
+	}
+	
+	if(list->resource_count == list->resource_capacity)
+	{
+		resources = realloc(list->resources, (list->resource_capacity + 16) * sizeof(displaylist_resource_t));
+		
+		if(resources == NULL)
+		{
+			eprintf("Failed to add resource to display list.\n");
+			
+			return -1;
+		}
+		
+		memory_util_alloc(MEMORY_UTIL_STATE, 16 * sizeof(displaylist_resource_t), 0);
+		list->resources = resources;
+		list->resource_capacity += 16;
+	}
+	
+	list->resources[list->resource_count].paint = paint;
+	list->resources[list->resource_count].image = image;
+	list->resources[list->resource_count].owned = 0;
+	
+	return list->resource_count++;
+}
+
+/**
+ * Appends a command to a list.
+ * @param list The display list.
+ * @param op The operation.
+ * @param resource The resource index, ignored if the operation has none.
+ * @param text The string argument, ignored if the operation has none.
+ * @param count The number of float arguments.
+ * @param values The float arguments.
+ */
+static void displaylist_util__append(displaylist_t *list, displaylist_op_t op, VGint resource, const char *text, VGint count, const VGfloat *values)
+{
+	displaylist_command_t command;
+	uint32_t index = resource;
+	size_t length = 0;
+	size_t bytes = sizeof(displaylist_command_t);
+	char *data = NULL;
+	
+	if(count > 255)
+	{
+		eprintf("Display list: only 255 of %d arguments are recorded.\n", count);
+		
+		count = 255;
+	}
+	
+	if(displaylist_util__has_resource(op))
+	{
+		if(resource < 0)
+		{
+			return;
+		}
+		
+		bytes += sizeof(uint32_t);
+	}
+	
+	if(displaylist_util__has_string(op))
+	{
+		length = strlen(text);
+		
+		if(length > 65535)
+		{
+			eprintf("Display list: string truncated to 65535 bytes.\n");
+			
+			length = 65535;
+		}
+		
+		bytes += DISPLAYLIST_UTIL_PAD(length + 1);
+	}
+	
+	bytes += count * sizeof(VGfloat);
+	
+	data = displaylist_util__reserve(list, bytes);
+	
+	if(data == NULL)
+	{
+		return;
+	}
+	
+	command.op = op;
+	command.count = count;
+	command.length = length;
+	memcpy(data, &command, sizeof(displaylist_command_t));
+	data += sizeof(displaylist_command_t);
+	
+	if(displaylist_util__has_resource(op))
+	{
+		memcpy(data, &index, sizeof(uint32_t));
+		data += sizeof(uint32_t);
+	}
+	
+	memcpy(data, values, count * sizeof(VGfloat));
+	data += count * sizeof(VGfloat);
+	
+	if(displaylist_util__has_string(op))
+	{
+		memcpy(data, text, length);
+		memset(data + length, 0, DISPLAYLIST_UTIL_PAD(length + 1) - length);
+	}
+	
+	list->commands++;
+}
+
+/**
+ * Creates an empty display list.
+ * @return The display list or NULL on failure.
+ */
+displaylist_t *displaylist_util_create(void)
+{
+	displaylist_t *list = calloc(1, sizeof(displaylist_t));
+	
+	if(list == NULL)
+	{
+		eprintf("Failed to create display list.\n");
+		
+		return NULL;
+	}
+	
+	memory_util_alloc(MEMORY_UTIL_STATE, sizeof(displaylist_t), 1);
+	
+	return list;
+}
+
+/**
+ * Destroys a display list and the resources it owns.
+ * @param list The display list.
+ */
+void displaylist_util_destroy(displaylist_t *list)
+{
+	VGint i;
+	
+	if(list == displaylist_util_recording)
+	{
+		displaylist_util_recording = NULL;
+	}
+	
+	for(i = 0; i < list->resource_count; i++)
+	{
+		if(!list->resources[i].owned)
+		{
+			continue;
+		}
+		
+		if(list->resources[i].paint != NULL)
+		{
+			paint_cleanup(list->resources[i].paint);
+			free(list->resources[i].paint);
+		}
+		
+		if(list->resources[i].image != NULL)
+		{
+			image_cleanup(list->resources[i].image);
+		}
+	}
+	
+	memory_util_free(MEMORY_UTIL_STATE, sizeof(displaylist_t) + list->capacity + list->resource_capacity * sizeof(displaylist_resource_t), 1);
+	
+	free(list->resources);
+	free(list->data);
+	free(list);
+}
+
+/**
+ * Starts recording the calls of the entry points into a display list.
+ * @param list The display list.
+ */
+void displaylist_util_begin(displaylist_t *list)
+{
+	displaylist_util_recording = list;
+}
+
+/**
+ * Stops recording.
+ */
+void displaylist_util_end(void)
+{
+	displaylist_util_recording = NULL;
+}
+
+/**
+ * Records a command with float arguments.
+ * @param op The operation.
+ * @param count The number of arguments.
+ * @param values The arguments.
+ */
+void displaylist_util_record(displaylist_op_t op, VGint count, const VGfloat *values)
+{
+	displaylist_util__append(displaylist_util_recording, op, -1, NULL, count, values);
+}
+
+/**
+ * Records a command with a string and float arguments.
+ * @param op The operation.
+ * @param text The string argument.
+ * @param count The number of float arguments.
+ * @param values The float arguments.
+ */
+void displaylist_util_record_string(displaylist_op_t op, const char *text, VGint count, const VGfloat *values)
+{
+	displaylist_util__append(displaylist_util_recording, op, -1, text, count, values);
+}
+
+/**
+ * Records setting a gradient or pattern as fill or stroke style. The paint is
+ * referenced, it must live as long as the list.
+ * @param op DISPLAYLIST_FILL_PAINT or DISPLAYLIST_STROKE_PAINT.
+ * @param paint The gradient or pattern.
+ */
+void displaylist_util_record_paint(displaylist_op_t op, paint_t *paint)
+{
+	VGint resource = displaylist_util__resource(displaylist_util_recording, paint, NULL);
+	
+	displaylist_util__append(displaylist_util_recording, op, resource, NULL, 0, NULL);
+}
+
+/**
+ * Records drawing an image. The image is referenced, it must live as long as
+ * the list.
+ * @param image The image.
+ * @param values dx, dy, dw, dh, sx, sy, sw, sh like canvas_drawImage().
+ */
+void displaylist_util_record_image(image_t *image, const VGfloat *values)
+{
+	VGint resource = displaylist_util__resource(displaylist_util_recording, NULL, image);
+	
+	displaylist_util__append(displaylist_util_recording, DISPLAYLIST_DRAW_IMAGE, resource, NULL, 8, values);
+}
+
+/**
+ * Records a polyline. Commands hold at most 255 arguments, so long polylines
+ * are split into a DISPLAYLIST_POLYLINE and following DISPLAYLIST_LINES.
+ * @param points The x and y axis of every point.
+ * @param count The amount of points.
+ * @param closed Whether the sub-path is closed after the last point.
+ */
+void displaylist_util_record_polyline(const VGfloat *points, VGint count, int closed)
+{
+	displaylist_op_t op = DISPLAYLIST_POLYLINE;
+	VGint chunk = 0;
+	
+	while(count > 0)
+	{
+		chunk = count < 127 ? count : 127;
+		
+		displaylist_util__append(displaylist_util_recording, op, -1, NULL, chunk * 2, points);
+		
+		op = DISPLAYLIST_LINES;
+		points += chunk * 2;
+		count -= chunk;
+	}
+	
+	if(closed)
+	{
+		displaylist_util__append(displaylist_util_recording, DISPLAYLIST_CLOSE_PATH, -1, NULL, 0, NULL);
+	}
+}
+
+/**
+ * Records circles. Commands hold at most 255 arguments, so the circles are
+ * split into DISPLAYLIST_CIRCLES of at most 85 circles.
+ * @param xs The x axis of the centers.
+ * @param ys The y axis of the centers.
+ * @param radii The radii.
+ * @param count The amount of circles.
+ */
+void displaylist_util_record_circles(const VGfloat *xs, const VGfloat *ys, const VGfloat *radii, VGint count)
+{
+	VGfloat values[255];
+	VGint chunk = 0;
+	VGint i = 0;
+	
+	while(count > 0)
+	{
+		chunk = count < 85 ? count : 85;
+		
+		for(i = 0; i < chunk; i++)
+		{
+			values[3 * i] = xs[i];
+			values[3 * i + 1] = ys[i];
+			values[3 * i + 2] = radii[i];
+		}
+		
+		displaylist_util__append(displaylist_util_recording, DISPLAYLIST_CIRCLES, -1, NULL, chunk * 3, values);
+		
+		xs += chunk;
+		ys += chunk;
+		radii += chunk;
+		count -= chunk;
+	}
+}
+
+/**
+ * Executes a command on the current context. If a list is being recorded, the
+ * command is recorded as well.
+ * @param op The operation.
+ * @param resource The resource of the command or NULL.
+ * @param text The string argument or NULL.
+ * @param count The number of float arguments.
+ * @param v The float arguments.
+ */
+static void displaylist_util__execute(displaylist_op_t op, displaylist_resource_t *resource, char *text, VGint count, const VGfloat *v)
+{
+	switch(op)
+	{
+		case DISPLAYLIST_SAVE: canvas_save(); break;
+		case DISPLAYLIST_RESTORE: canvas_restore(); break;
+		case DISPLAYLIST_BEGIN_PATH: canvas_beginPath(); break;
+		case DISPLAYLIST_CLOSE_PATH: canvas_closePath(); break;
+		case DISPLAYLIST_MOVE_TO: canvas_moveTo(v[0], v[1]); break;
+		case DISPLAYLIST_LINE_TO: canvas_lineTo(v[0], v[1]); break;
+		case DISPLAYLIST_QUADRATIC_CURVE_TO: canvas_quadraticCurveTo(v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_BEZIER_CURVE_TO: canvas_bezierCurveTo(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+		case DISPLAYLIST_ARC: canvas_arc(v[0], v[1], v[2], v[3], v[4], v[5] != 0 ? VG_TRUE : VG_FALSE); break;
+		case DISPLAYLIST_RECT: canvas_rect(v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_FILL: canvas_fill(); break;
+		case DISPLAYLIST_STROKE: canvas_stroke(); break;
+		case DISPLAYLIST_CLIP: canvas_clip(); break;
+		case DISPLAYLIST_FILL_RECT: canvas_fillRect(v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_STROKE_RECT: canvas_strokeRect(v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_CLEAR_RECT: canvas_clearRect(v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_TRANSLATE: canvas_translate(v[0], v[1]); break;
+		case DISPLAYLIST_SCALE: canvas_scale(v[0], v[1]); break;
+		case DISPLAYLIST_ROTATE: canvas_rotate(v[0]); break;
+		case DISPLAYLIST_TRANSFORM: canvas_transform(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+		case DISPLAYLIST_SET_TRANSFORM: canvas_setTransform(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+		case DISPLAYLIST_RESET_TRANSFORM: canvas_resetTransform(); break;
+		case DISPLAYLIST_LINE_WIDTH: canvas_lineWidth(v[0]); break;
+		case DISPLAYLIST_LINE_CAP: canvas_lineCap(text); break;
+		case DISPLAYLIST_LINE_JOIN: canvas_lineJoin(text); break;
+		case DISPLAYLIST_MITER_LIMIT: canvas_miterLimit(v[0]); break;
+		case DISPLAYLIST_LINE_DASH: canvas_setLineDash(count, (VGfloat *)v); break;
+		case DISPLAYLIST_LINE_DASH_OFFSET: canvas_lineDashOffset(v[0]); break;
+		case DISPLAYLIST_GLOBAL_ALPHA: canvas_globalAlpha(v[0]); break;
+		case DISPLAYLIST_GLOBAL_COMPOSITE_OPERATION: canvas_globalCompositeOperation(text); break;
+		case DISPLAYLIST_IMAGE_SMOOTHING: canvas_imageSmoothingEnabled(v[0] != 0 ? VG_TRUE : VG_FALSE); break;
+		case DISPLAYLIST_FILL_COLOR: canvas__set_style_color(0, v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_STROKE_COLOR: canvas__set_style_color(1, v[0], v[1], v[2], v[3]); break;
+		case DISPLAYLIST_FILL_PAINT: canvas__set_style_paint(0, resource->paint); break;
+		case DISPLAYLIST_STROKE_PAINT: canvas__set_style_paint(1, resource->paint); break;
+		case DISPLAYLIST_FONT: canvas_font(text, v[0]); break;
+		case DISPLAYLIST_TEXT_ALIGN: canvas_textAlign(text); break;
+		case DISPLAYLIST_TEXT_BASELINE: canvas_textBaseline(text); break;
+		case DISPLAYLIST_FILL_TEXT: canvas_fillText(text, v[0], v[1]); break;
+		case DISPLAYLIST_STROKE_TEXT: canvas_strokeText(text, v[0], v[1]); break;
+		case DISPLAYLIST_DRAW_IMAGE: canvas_drawImage(resource->image, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]); break;
+		case DISPLAYLIST_POLYLINE: canvas_polyline(v, count / 2, 0); break;
+		case DISPLAYLIST_LINES: canvas_polyline_lines(v, count / 2); break;
+		case DISPLAYLIST_ELLIPSE: canvas_ellipse(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7] != 0 ? VG_TRUE : VG_FALSE); break;
+		case DISPLAYLIST_ARC_TO: canvas_arcTo(v[0], v[1], v[2], v[3], v[4]); break;
+		case DISPLAYLIST_CIRCLES: canvas_drawCircles(v, v + 1, v + 2, count / 3, 3); break;
+		default: break;
+	}
+	
+	// replaying into another recording copies the commands
+	if(displaylist_util_recording != NULL)
+	{
+		displaylist_util__append(displaylist_util_recording, op, resource ? displaylist_util__resource(displaylist_util_recording, resource->paint, resource->image) : -1, text, count, v);
+	}
+}
+
+/**
+ * Decodes the command of a list at an offset.
+ * @param list The display list.
+ * @param offset Offset of the command, set to the offset of the next command.
+ * @param item Where to write the command to.
+ * @return 1 if a command has been read, 0 at the end of the list.
+ */
+int displaylist_util_next(displaylist_t *list, size_t *offset, displaylist_item_t *item)
+{
+	const char *data = list->data + *offset;
+	displaylist_command_t command;
+	uint32_t index = 0;
+	
+	if(*offset >= list->size)
+	{
+		return 0;
+	}
+	
+	memcpy(&command, data, sizeof(displaylist_command_t));
+	data += sizeof(displaylist_command_t);
+	item->op = command.op;
+	item->count = command.count;
+	item->resource = NULL;
+	item->text = NULL;
+	
+	if(displaylist_util__has_resource(command.op))
+	{
+		memcpy(&index, data, sizeof(uint32_t));
+		data += sizeof(uint32_t);
+		item->resource = &list->resources[index];
+	}
+	
+	memcpy(item->values, data, command.count * sizeof(VGfloat));
+	data += command.count * sizeof(VGfloat);
+	
+	if(displaylist_util__has_string(command.op))
+	{
+		// commands are only read, the canvas functions take char *
+		item->text = (char *)data;
+		data += DISPLAYLIST_UTIL_PAD(command.length + 1);
+	}
+	
+	*offset = data - list->data;
+	
+	return 1;
+}
+
+/**
+ * Replays the commands of a display list at the given offsets (all commands
+ * if offsets is NULL), see displaylist_util_replay().
+ * @param list The display list.
+ * @param transform Transformation applied to the list or NULL.
+ * @param offsets Offsets of the commands in ascending order or NULL.
+ * @param count The number of offsets.
+ */
+void displaylist_util_replay_offsets(displaylist_t *list, const VGfloat *transform, const uint32_t *offsets, size_t count)
+{
+	canvas_save_stack_t *state = NULL;
+	displaylist_item_t item;
+	size_t offset = 0;
+	size_t i = 0;
+	
+	displaylist_util__execute(DISPLAYLIST_SAVE, NULL, NULL, 0, NULL);
+	state = canvas_save_get();
+	
+	if(transform != NULL)
+	{
+		displaylist_util__execute(DISPLAYLIST_TRANSFORM, NULL, NULL, 6, transform);
+	}
+	
+	while(1)
+	{
+		if(offsets != NULL)
+		{
+			if(i == count)
+			{
+				break;
+			}
+			
+			offset = offsets[i++];
+		}
+		
+		if(!displaylist_util_next(list, &offset, &item))
+		{
+			break;
+		}
+		
+		// restores without save of the list would pop the state of the replay
+		if(item.op == DISPLAYLIST_RESTORE && canvas_save_get() == state)
+		{
+			continue;
+		}
+		
+		displaylist_util__execute(item.op, item.resource, item.text, item.count, item.values);
+	}
+	
+	while(canvas_save_get() != state && canvas_save_get() != NULL)
+	{
+		displaylist_util__execute(DISPLAYLIST_RESTORE, NULL, NULL, 0, NULL);
+	}
+	
+	displaylist_util__execute(DISPLAYLIST_RESTORE, NULL, NULL, 0, NULL);
+}
+
+/**
+ * Replays a display list on the current context. The list runs between save
+ * and restore, so its state changes do not leak out.
+ * @param list The display list.
+ * @param transform Transformation (a, b, c, d, e, f like canvas_transform())
+ *                  applied to the list or NULL.
+ */
+void displaylist_util_replay(displaylist_t *list, const VGfloat *transform)
+{
+	displaylist_util_replay_offsets(list, transform, NULL, 0);
+}
+
+/**
+ * Returns the amount of pixel data of a serialized image.
+ * @param image The image.
+ * @return The amount of bytes.
+ */
+static size_t displaylist_util__image_size(image_t *image)
+{
+	return 2 * sizeof(uint32_t) + (size_t)image->width * image->height * 4;
+}
+
+/**
+ * Writes the size and the pixels of an image.
+ * @param data Where to write to.
+ * @param image The image.
+ * @return Pointer behind the written data.
+ */
+static char *displaylist_util__write_image(char *data, image_t *image)
+{
+	uint32_t size[2] = { image->width, image->height };
+	
+	memcpy(data, size, sizeof(size));
+	data += sizeof(size);
+	
+	vgGetImageSubData(image->image, data, image->width * 4, VG_sRGBA_8888, 0, 0, image->width, image->height);
+	
+	return data + (size_t)image->width * image->height * 4;
+}
+
+/**
+ * Serializes a display list: a header, the resources (gradient parameters and
+ * color stops, image pixels) and the commands as they are stored in memory.
+ * Images are read back from the GPU.
+ * @param list The display list.
+ * @param size Pointer where to write the amount of bytes to.
+ * @return The serialized list (free with free()) or NULL on failure.
+ */
+char *displaylist_util_serialize(displaylist_t *list, size_t *size)
+{
+	displaylist_header_t header;
+	displaylist_resource_t *resource = NULL;
+	size_t bytes = sizeof(displaylist_header_t) + list->size;
+	char *result = NULL;
+	char *data = NULL;
+	uint32_t kind = 0;
+	uint32_t count = 0;
+	VGfloat params[5];
+	VGint i;
+	
+	for(i = 0; i < list->resource_count; i++)
+	{
+		resource = &list->resources[i];
+		bytes += sizeof(uint32_t);
+		
+		if(resource->paint == NULL)
+		{
+			bytes += displaylist_util__image_size(resource->image);
+		}
+		else if(resource->paint->paint_type == PAINT_TYPE_PATTERN)
+		{
+			bytes += sizeof(uint32_t) + displaylist_util__image_size(resource->paint->image);
+		}
+		else
+		{
+			bytes += 2 * sizeof(uint32_t) + (5 + resource->paint->count) * sizeof(VGfloat);
+		}
+	}
+	
+	result = malloc(bytes);
+	
+	if(result == NULL)
+	{
+		eprintf("Failed to serialize display list.\n");
+		
+		return NULL;
+	}
+	
+	memcpy(header.magic, "VGDL", 4);
+	header.version = DISPLAYLIST_UTIL_VERSION;
+	header.resources = list->resource_count;
+	header.commands = list->commands;
+	header.size = list->size;
+	memcpy(result, &header, sizeof(displaylist_header_t));
+	data = result + sizeof(displaylist_header_t);
+	
+	for(i = 0; i < list->resource_count; i++)
+	{
+		resource = &list->resources[i];
+		
+		if(resource->paint == NULL)
+		{
+			kind = DISPLAYLIST_UTIL_IMAGE;
+		}
+		else if(resource->paint->paint_type == PAINT_TYPE_PATTERN)
+		{
+			kind = DISPLAYLIST_UTIL_PATTERN;
+		}
+		else if(resource->paint->paint_type == PAINT_TYPE_LINEAR_GRADIENT)
+		{
+			kind = DISPLAYLIST_UTIL_LINEAR_GRADIENT;
+		}
+		else
+		{
+			kind = DISPLAYLIST_UTIL_RADIAL_GRADIENT;
+		}
+		
+		memcpy(data, &kind, sizeof(uint32_t));
+		data += sizeof(uint32_t);
+		
+		if(kind == DISPLAYLIST_UTIL_IMAGE)
+		{
+			data = displaylist_util__write_image(data, resource->image);
+		}
+		else if(kind == DISPLAYLIST_UTIL_PATTERN)
+		{
+			count = vgGetParameteri(resource->paint->paint, VG_PAINT_PATTERN_TILING_MODE);
+			memcpy(data, &count, sizeof(uint32_t));
+			data = displaylist_util__write_image(data + sizeof(uint32_t), resource->paint->image);
+		}
+		else
+		{
+			// gradient parameters are stored in surface coordinates
+			memset(params, 0, sizeof(params));
+			vgGetParameterfv(resource->paint->paint, kind == DISPLAYLIST_UTIL_LINEAR_GRADIENT ? VG_PAINT_LINEAR_GRADIENT : VG_PAINT_RADIAL_GRADIENT, kind == DISPLAYLIST_UTIL_LINEAR_GRADIENT ? 4 : 5, params);
+			
+			count = resource->paint->count;
+			memcpy(data, &count, sizeof(uint32_t));
+			data += sizeof(uint32_t);
+			memcpy(data, params, sizeof(params));
+			data += sizeof(params);
+			memcpy(data, resource->paint->data, count * sizeof(VGfloat));
+			data += count * sizeof(VGfloat);
+			
+			// padding, keeps all resources the same layout
+			memset(data, 0, sizeof(uint32_t));
+			data += sizeof(uint32_t);
+		}
+	}
+	
+	memcpy(data, list->data, list->size);
+	*size = bytes;
+	
+	return result;
+}
+
+/**
+ * Copies bytes out of serialized data.
+ * @param data Pointer to the read position, advanced by the amount of bytes.
+ * @param end End of the serialized data.
+ * @param destination Where to copy to, NULL to skip the bytes.
+ * @param bytes The amount of bytes.
+ * @return 1 on success, 0 if the data is too short.
+ */
+static int displaylist_util__read(const char **data, const char *end, void *destination, size_t bytes)
+{
+	if((size_t)(end - *data) < bytes)
+	{
+		return 0;
+	}
+	
+	if(destination != NULL)
+	{
+		memcpy(destination, *data, bytes);
+	}
+	
+	*data += bytes;
+	
+	return 1;
+}
+
+/**
+ * Reads a serialized image and uploads it.
+ * @param data Pointer to the read position.
+ * @param end End of the serialized data.
+ * @return The image or NULL if the data is invalid.
+ */
+static image_t *displaylist_util__read_image(const char **data, const char *end)
+{
+	uint32_t size[2];
+	const char *pixels = NULL;
+	image_t *image = NULL;
+	
+	if(!displaylist_util__read(data, end, size, sizeof(size)) || size[0] == 0 || size[1] == 0)
+	{
+		return NULL;
+	}
+	
+	// size_t has 32 bits on the Raspberry Pi, the pixel bytes must not wrap
+	if(size[0] > (uint32_t)vgGeti(VG_MAX_IMAGE_WIDTH) || size[1] > (uint32_t)vgGeti(VG_MAX_IMAGE_HEIGHT) || (uint64_t)size[0] * size[1] > (uint64_t)vgGeti(VG_MAX_IMAGE_PIXELS) || (uint64_t)size[0] * size[1] * 4 > (uint64_t)(end - *data))
+	{
+		return NULL;
+	}
+	
+	pixels = *data;
+	*data += (size_t)size[0] * size[1] * 4;
+	
+	image = image_create(VG_sRGBA_8888, size[0], size[1], pixels);
+	if(image == NULL)
+	{
+		return NULL;
+	}
+	
+	if(image->image == VG_INVALID_HANDLE)
+	{
+		eprintf("Failed to deserialize display list: Failed to create %ux%u image.\n", size[0], size[1]);
+		
+		image_cleanup(image);
+		
+		return NULL;
+	}
+	
+	return image;
+}
+
+/**
+ * Checks the commands of a deserialized list.
+ * @param list The display list.
+ * @return 1 if all commands are valid, 0 otherwise.
+ */
+static int displaylist_util__validate(displaylist_t *list)
+{
+	const char *data = list->data;
+	const char *end = list->data + list->size;
+	displaylist_command_t command;
+	uint32_t index = 0;
+	unsigned long commands = 0;
+	
+	while(data < end)
+	{
+		if(!displaylist_util__read(&data, end, &command, sizeof(displaylist_command_t)) || command.op >= DISPLAYLIST_OPS)
+		{
+			return 0;
+		}
+		
+		if(displaylist_util__has_resource(command.op))
+		{
+			if(!displaylist_util__read(&data, end, &index, sizeof(uint32_t)) || index >= (uint32_t)list->resource_count)
+			{
+				return 0;
+			}
+			
+			// images are drawn, gradients and patterns set as style
+			if((command.op == DISPLAYLIST_DRAW_IMAGE) != (list->resources[index].paint == NULL))
+			{
+				return 0;
+			}
+		}
+		
+		if(!displaylist_util__read(&data, end, NULL, command.count * sizeof(VGfloat)))
+		{
+			return 0;
+		}
+		
+		if(displaylist_util__has_string(command.op))
+		{
+			if(!displaylist_util__read(&data, end, NULL, DISPLAYLIST_UTIL_PAD(command.length + 1)) || data[-1] != 0)
+			{
+				return 0;
+			}
+		}
+		
+		commands++;
+	}
+	
+	return commands == list->commands;
+}
+
+/**
+ * Creates a display list from data written by displaylist_util_serialize().
+ * The gradients, patterns and images are created and owned by the list.
+ * @param data The serialized list.
+ * @param size The amount of bytes.
+ * @return The display list or NULL if the data is invalid.
+ */
+displaylist_t *displaylist_util_deserialize(const char *data, size_t size)
+{
+	const char *end = data + size;
+	displaylist_header_t header;
+	displaylist_t *list = NULL;
+	paint_t *paint = NULL;
+	image_t *image = NULL;
+	uint32_t kind = 0;
+	uint32_t count = 0;
+	VGfloat params[5];
+	VGfloat *stops = NULL;
+	VGint index = 0;
+	uint32_t i, j;
+	
+	if(!displaylist_util__read(&data, end, &header, sizeof(displaylist_header_t)) || memcmp(header.magic, "VGDL", 4) != 0 || header.version != DISPLAYLIST_UTIL_VERSION)
+	{
+		eprintf("Failed to deserialize display list: Unknown format.\n");
+		
+		return NULL;
+	}
+	
+	list = displaylist_util_create();
+	
+	if(list == NULL)
+	{
+		return NULL;
+	}
+	
+	for(i = 0; i < header.resources; i++)
+	{
+		paint = NULL;
+		image = NULL;
+		
+		if(!displaylist_util__read(&data, end, &kind, sizeof(uint32_t)))
+		{
+			break;
+		}
+		
+		if(kind == DISPLAYLIST_UTIL_IMAGE)
+		{
+			image = displaylist_util__read_image(&data, end);
+			
+			if(image == NULL)
+			{
+				break;
+			}
+		}
+		else if(kind == DISPLAYLIST_UTIL_PATTERN)
+		{
+			if(!displaylist_util__read(&data, end, &count, sizeof(uint32_t)) || (image = displaylist_util__read_image(&data, end)) == NULL)
+			{
+				break;
+			}
+			
+			paint = malloc(sizeof(paint_t));
+			paint_createPattern(paint, image, count == VG_TILE_FILL ? VG_TILE_FILL : VG_TILE_REPEAT);
+		}
+		else if(kind == DISPLAYLIST_UTIL_LINEAR_GRADIENT || kind == DISPLAYLIST_UTIL_RADIAL_GRADIENT)
+		{
+			if(!displaylist_util__read(&data, end, &count, sizeof(uint32_t)) || count % 5 != 0 || !displaylist_util__read(&data, end, params, sizeof(params)))
+			{
+				break;
+			}
+			
+			stops = (VGfloat *)data;
+			
+			// checked before multiplying, count * sizeof(VGfloat) wraps on 32 bit
+			if(count > (size_t)(end - data) / sizeof(VGfloat) || !displaylist_util__read(&data, end, NULL, count * sizeof(VGfloat) + sizeof(uint32_t)))
+			{
+				break;
+			}
+			
+			paint = malloc(sizeof(paint_t));
+			
+			if(kind == DISPLAYLIST_UTIL_LINEAR_GRADIENT)
+			{
+				paint_createLinearGradient(paint, 0, 0, 0, 0);
+				vgSetParameterfv(paint->paint, VG_PAINT_LINEAR_GRADIENT, 4, params);
+			}
+			else
+			{
+				paint_createRadialGradient(paint, 0, 0, 0, 0, 0);
+				vgSetParameterfv(paint->paint, VG_PAINT_RADIAL_GRADIENT, 5, params);
+			}
+			
+			for(j = 0; j < count; j += 5)
+			{
+				paint_addColorStop(paint, stops[j], stops[j + 1], stops[j + 2], stops[j + 3], stops[j + 4]);
+			}
+		}
+		else
+		{
+			break;
+		}
+		
+		// the index has to be known before the array is accessed, it may be moved
+		index = displaylist_util__resource(list, paint, image);
+		list->resources[index].owned = 1;
+	}
+	
+	if(i < header.resources || (size_t)(end - data) != header.size || displaylist_util__reserve(list, header.size) == NULL)
+	{
+		eprintf("Failed to deserialize display list: Invalid data.\n");
+		displaylist_util_destroy(list);
+		
+		return NULL;
+	}
+	
+	memcpy(list->data, data, header.size);
+	list->commands = header.commands;
+	
+	if(!displaylist_util__validate(list))
+	{
+		eprintf("Failed to deserialize display list: Invalid commands.\n");
+		displaylist_util_destroy(list);
+		
+		return NULL;
+	}
+	
+	return list;
+}
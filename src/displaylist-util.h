@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DISPLAYLIST_UTIL_H__
+#define __DISPLAYLIST_UTIL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <VG/openvg.h>
+
+#include "image-util.h"
+#include "canvas-paint.h"
+
+#define DISPLAYLIST_UTIL_VERSION 1
+
+typedef enum displaylist_op_t
+{
+	DISPLAYLIST_SAVE,
+	DISPLAYLIST_RESTORE,
+	DISPLAYLIST_BEGIN_PATH,
+	DISPLAYLIST_CLOSE_PATH,
+	DISPLAYLIST_MOVE_TO,
+	DISPLAYLIST_LINE_TO,
+	DISPLAYLIST_QUADRATIC_CURVE_TO,
+	DISPLAYLIST_BEZIER_CURVE_TO,
+	DISPLAYLIST_ARC,
+	DISPLAYLIST_RECT,
+	DISPLAYLIST_FILL,
+	DISPLAYLIST_STROKE,
+	DISPLAYLIST_CLIP,
+	DISPLAYLIST_FILL_RECT,
+	DISPLAYLIST_STROKE_RECT,
+	DISPLAYLIST_CLEAR_RECT,
+	DISPLAYLIST_TRANSLATE,
+	DISPLAYLIST_SCALE,
+	DISPLAYLIST_ROTATE,
+	DISPLAYLIST_TRANSFORM,
+	DISPLAYLIST_SET_TRANSFORM,
+	DISPLAYLIST_RESET_TRANSFORM,
+	DISPLAYLIST_LINE_WIDTH,
+	DISPLAYLIST_LINE_CAP,
+	DISPLAYLIST_LINE_JOIN,
+	DISPLAYLIST_MITER_LIMIT,
+	DISPLAYLIST_LINE_DASH,
+	DISPLAYLIST_LINE_DASH_OFFSET,
+	DISPLAYLIST_GLOBAL_ALPHA,
+	DISPLAYLIST_GLOBAL_COMPOSITE_OPERATION,
+	DISPLAYLIST_IMAGE_SMOOTHING,
+	DISPLAYLIST_FILL_COLOR,
+	DISPLAYLIST_STROKE_COLOR,
+	DISPLAYLIST_FILL_PAINT,
+	DISPLAYLIST_STROKE_PAINT,
+	DISPLAYLIST_FONT,
+	DISPLAYLIST_TEXT_ALIGN,
+	DISPLAYLIST_TEXT_BASELINE,
+	DISPLAYLIST_FILL_TEXT,
+	DISPLAYLIST_STROKE_TEXT,
+	DISPLAYLIST_DRAW_IMAGE,
+	DISPLAYLIST_POLYLINE, // moveTo the first point, lineTo the others
+	DISPLAYLIST_LINES, // lineTo every point, continues a split polyline
+	DISPLAYLIST_ELLIPSE,
+	DISPLAYLIST_ARC_TO,
+	DISPLAYLIST_CIRCLES, // x, y and radius of every circle
+	DISPLAYLIST_OPS
+} displaylist_op_t;
+
+// gradient, pattern or image referenced by commands
+typedef struct displaylist_resource_t
+{
+	paint_t *paint; // NULL for images
+	image_t *image; // the image, or the image of a deserialized pattern
+	int owned; // created by deserialization and destroyed with the list
+} displaylist_resource_t;
+
+typedef struct displaylist_t
+{
+	// packed commands
+	char *data;
+	size_t size;
+	size_t capacity;
+	unsigned long commands;
+	
+	displaylist_resource_t *resources;
+	VGint resource_count;
+	VGint resource_capacity;
+} displaylist_t;
+
+// a decoded command, see displaylist_util_next()
+typedef struct displaylist_item_t
+{
+	displaylist_op_t op;
+	VGint count;
+	VGfloat values[255];
+	char *text;
+	displaylist_resource_t *resource;
+} displaylist_item_t;
+
+extern displaylist_t *displaylist_util_recording;
+
+displaylist_t *displaylist_util_create(void);
+void displaylist_util_destroy(displaylist_t *list);
+void displaylist_util_begin(displaylist_t *list);
+void displaylist_util_end(void);
+void displaylist_util_record(displaylist_op_t op, VGint count, const VGfloat *values);
+void displaylist_util_record_string(displaylist_op_t op, const char *text, VGint count, const VGfloat *values);
+void displaylist_util_record_paint(displaylist_op_t op, paint_t *paint);
+void displaylist_util_record_image(image_t *image, const VGfloat *values);
+void displaylist_util_record_polyline(const VGfloat *points, VGint count, int closed);
+void displaylist_util_record_circles(const VGfloat *xs, const VGfloat *ys, const VGfloat *radii, VGint count);
+void displaylist_util_replay(displaylist_t *list, const VGfloat *transform);
+void displaylist_util_replay_offsets(displaylist_t *list, const VGfloat *transform, const uint32_t *offsets, size_t count);
+int displaylist_util_next(displaylist_t *list, size_t *offset, displaylist_item_t *item);
+char *displaylist_util_serialize(displaylist_t *list, size_t *size);
+displaylist_t *displaylist_util_deserialize(const char *data, size_t size);
+
+#endif /* __DISPLAYLIST_UTIL_H__ */
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "displaylist.h"
+#include "vgcanvas.h"
+
+extern "C" {
+	#include "log-util.h"
+}
+
+using namespace v8;
+
+namespace vgcanvas {
+	
+	static Nan::Persistent<Function> displayListConstructor;
+	
+	// object of the list being recorded, empty if nothing is recorded
+	static Nan::Persistent<Object> recordingObject;
+	
+	DisplayList::DisplayList() : list(NULL) {
+		
+	}
+	
+	DisplayList::~DisplayList() {
+		if(list) {
+			present_util_acquire();
+			displaylist_util_destroy(list);
+		}
+		
+		retained.Reset();
+	}
+	
+	void DisplayList::Init(Local<Object> exports) {
+		RegisterEntry<DisplayList::New>("DisplayList");
+		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Guard<DisplayList::New>);
+		tpl->SetClassName(Nan::New("DisplayList").ToLocalChecked());
+		
+		Local<ObjectTemplate> obj = tpl->InstanceTemplate();
+		obj->SetAccessor(Nan::New("commands").ToLocalChecked(), DisplayList::GetSize);
+		obj->SetAccessor(Nan::New("byteLength").ToLocalChecked(), DisplayList::GetSize);
+		obj->SetInternalFieldCount(1);
+		
+		RegisterEntry<DisplayList::Serialize>("DisplayList.serialize");
+		Nan::SetPrototypeMethod(tpl, "serialize", Guard<DisplayList::Serialize>);
+		
+		displayListConstructor.Reset(tpl->GetFunction());
+		exports->Set(Nan::New("DisplayList").ToLocalChecked(), tpl->GetFunction());
+		
+		SetEntry<BeginRecording>(exports, "beginRecording");
+		SetEntry<EndRecording>(exports, "endRecording");
+		SetEntry<ReplayDisplayList>(exports, "replayDisplayList");
+	}
+	
+	// new DisplayList(): an empty list, new DisplayList(buffer): a serialized list
+	void DisplayList::New(const Nan::FunctionCallbackInfo<Value> &info) {
+		if (!info.IsConstructCall()) {
+			Nan::ThrowTypeError("not called as constructor");
+			return;
+		}
+		
+		displaylist_t *list = NULL;
+		
+		if(info.Length() > 0) {
+			if(!info[0]->IsArrayBufferView()) {
+				Nan::ThrowTypeError("wrong arg");
+				return;
+			}
+			
+			// buffers can be slices of a larger pool
+			Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(info[0]);
+			char *data = static_cast<char*>(view->Buffer()->GetContents().Data()) + view->ByteOffset();
+			
+			list = displaylist_util_deserialize(data, view->ByteLength());
+			
+			if(!list) {
+				Nan::ThrowError("invalid display list");
+				return;
+			}
+		} else {
+			list = displaylist_util_create();
+			
+			if(!list) {
+				Nan::ThrowError("Failed to create display list");
+				return;
+			}
+		}
+		
+		DisplayList *obj = new DisplayList();
+		obj->list = list;
+		obj->retained.Reset(Nan::New<Array>());
+		obj->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+	}
+	
+	void DisplayList::Serialize(const Nan::FunctionCallbackInfo<Value> &info) {
+		DisplayList *obj = DisplayList::Unwrap<DisplayList>(info.This());
+		size_t size = 0;
+		char *data = displaylist_util_serialize(obj->list, &size);
+		
+		if(!data) {
+			Nan::ThrowError("Failed to serialize display list");
+			return;
+		}
+		
+		// the buffer takes the data, it is freed with free()
+		info.GetReturnValue().Set(Nan::NewBuffer(data, size).ToLocalChecked());
+	}
+	
+	void DisplayList::GetSize(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		DisplayList *obj = DisplayList::Unwrap<DisplayList>(info.Holder());
+		std::string str(*Nan::Utf8String(property));
+		
+		if(str == "commands") {
+			info.GetReturnValue().Set(Nan::New<Number>(obj->list->commands));
+		} else if(str == "byteLength") {
+			info.GetReturnValue().Set(Nan::New<Number>(obj->list->size));
+		}
+	}
+	
+	displaylist_t* DisplayList::GetList() {
+		return list;
+	}
+	
+	/**
+	 * Keeps an object alive as long as the list, the list references its
+	 * native paint or image.
+	 */
+	void DisplayList::Retain(Local<Object> obj) {
+		Local<Array> array = Nan::New(retained);
+		array->Set(array->Length(), obj);
+	}
+	
+	void BeginRecording(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!recordingObject.IsEmpty()) {
+			Nan::ThrowError("a display list is already being recorded");
+			return;
+		}
+		
+		Local<Object> obj = Nan::New(displayListConstructor)->NewInstance();
+		
+		recordingObject.Reset(obj);
+		displaylist_util_begin(DisplayList::Unwrap<DisplayList>(obj)->GetList());
+	}
+	
+	// returns the recorded list, undefined if nothing has been recorded
+	void EndRecording(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(recordingObject.IsEmpty()) {
+			return;
+		}
+		
+		args.GetReturnValue().Set(Nan::New(recordingObject));
+		ResetRecording();
+	}
+	
+	// replayDisplayList(list[, a, b, c, d, e, f])
+	void ReplayDisplayList(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsObject() || std::string(*Nan::Utf8String(Local<Object>::Cast(args[0])->GetConstructorName())) != "DisplayList") {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		Local<Object> obj = Local<Object>::Cast(args[0]);
+		displaylist_t *list = DisplayList::Unwrap<DisplayList>(obj)->GetList();
+		VGfloat transform[6];
+		
+		if(list == displaylist_util_recording) {
+			Nan::ThrowError("display list can not be replayed into itself");
+			return;
+		}
+		
+		if(args.Length() >= 7) {
+			if(!checkArgs(args, 6, 1)) {
+				return;
+			}
+			
+			for(int i = 0; i < 6; i++) {
+				transform[i] = args[i + 1]->NumberValue();
+			}
+		}
+		
+		// the recorded copy references the resources of the replayed list
+		if(!recordingObject.IsEmpty()) {
+			DisplayList::Unwrap<DisplayList>(Nan::New(recordingObject))->Retain(obj);
+		}
+		
+		displaylist_util_replay(list, args.Length() >= 7 ? transform : NULL);
+	}
+	
+	/**
+	 * Stops recording without returning the list. Called by cleanup.
+	 */
+	void ResetRecording() {
+		displaylist_util_end();
+		recordingObject.Reset();
+	}
+	
+	void Record(displaylist_op_t op, const Nan::FunctionCallbackInfo<Value>& args, int count, int offset) {
+		if(!displaylist_util_recording) {
+			return;
+		}
+		
+		VGfloat values[16];
+		
+		for(int i = 0; i < count && i < 16; i++) {
+			values[i] = args[offset + i]->NumberValue();
+		}
+		
+		displaylist_util_record(op, count < 16 ? count : 16, values);
+	}
+	
+	void Record(displaylist_op_t op, int count, const VGfloat *values) {
+		if(!displaylist_util_recording) {
+			return;
+		}
+		
+		displaylist_util_record(op, count, values);
+	}
+	
+	void Record(displaylist_op_t op, const char *text, int count, const VGfloat *values) {
+		if(!displaylist_util_recording) {
+			return;
+		}
+		
+		displaylist_util_record_string(op, text, count, values);
+	}
+	
+	void RecordPaint(displaylist_op_t op, paint_t *paint, Local<Object> owner) {
+		if(!displaylist_util_recording) {
+			return;
+		}
+		
+		VGint resources = displaylist_util_recording->resource_count;
+		displaylist_util_record_paint(op, paint);
+		
+		// only objects of new resources have to be retained
+		if(displaylist_util_recording->resource_count != resources) {
+			DisplayList::Unwrap<DisplayList>(Nan::New(recordingObject))->Retain(owner);
+		}
+	}
+	
+	void RecordImage(image_t *image, const VGfloat *values, Local<Object> owner) {
+		if(!displaylist_util_recording) {
+			return;
+		}
+		
+		VGint resources = displaylist_util_recording->resource_count;
+		displaylist_util_record_image(image, values);
+		
+		if(displaylist_util_recording->resource_count != resources) {
+			DisplayList::Unwrap<DisplayList>(Nan::New(recordingObject))->Retain(owner);
+		}
+	}
+
+}
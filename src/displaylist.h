@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __DISPLAYLIST_H__
+#define __DISPLAYLIST_H__
+
+extern "C" {
+	#include "canvas-paint.h"
+	#include "displaylist-util.h"
+}
+
+#include <nan.h>
+
+using namespace v8;
+
+namespace vgcanvas {
+	class DisplayList : public Nan::ObjectWrap {
+	public:
+		DisplayList();
+		virtual ~DisplayList();
+		
+		displaylist_t* GetList();
+		void Retain(Local<Object> obj);
+		
+		static void Init(Local<Object> exports);
+		static void New(const Nan::FunctionCallbackInfo<Value> &info);
+		static void Serialize(const Nan::FunctionCallbackInfo<Value> &info);
+		static void GetSize(Local<String> property, const PropertyCallbackInfo<Value>& info);
+		
+	private:
+		DisplayList(const DisplayList&);
+		
+		displaylist_t *list;
+		// JS objects owning the paints and images the list references
+		Nan::Persistent<Array> retained;
+	};
+	
+	void BeginRecording(const Nan::FunctionCallbackInfo<Value>& args);
+	void EndRecording(const Nan::FunctionCallbackInfo<Value>& args);
+	void ReplayDisplayList(const Nan::FunctionCallbackInfo<Value>& args);
+	void ResetRecording();
+	
+	// recording of entry point calls, nothing happens if no list is recorded
+	void Record(displaylist_op_t op, const Nan::FunctionCallbackInfo<Value>& args, int count, int offset = 0);
+	void Record(displaylist_op_t op, int count, const VGfloat *values);
+	void Record(displaylist_op_t op, const char *text, int count, const VGfloat *values);
+	void RecordPaint(displaylist_op_t op, paint_t *paint, Local<Object> owner);
+	void RecordImage(image_t *image, const VGfloat *values, Local<Object> owner);
+
+}
+
+#endif
@@ -28,14 +28,29 @@ static EGLDisplay display = NULL;
 static EGLContext context = NULL;
 static EGLSurface surface = NULL;
 static EGLConfig config = NULL;
+static EGLConfig image_config = NULL;
 
 static uint32_t screen_width = 0;
 static uint32_t screen_height = 0;
 
+// surface and context the canvas functions currently render to
+static EGLSurface target_surface = NULL;
+static EGLContext target_context = NULL;
+static int32_t target_width = 0;
+static int32_t target_height = 0;
+
+static DISPMANX_DISPLAY_HANDLE_T dispman_display = 0;
+
+typedef EGLBoolean (*egl_swap_buffers_with_damage_t)(EGLDisplay display, EGLSurface surface, EGLint *rects, EGLint n_rects);
+static egl_swap_buffers_with_damage_t swap_buffers_with_damage = NULL;
+static egl_vsync_callback_t vsync_callback = NULL;
+static void *vsync_user = NULL;
+
 void egl_init(void)
 {
 	EGLBoolean result;
 	int32_t success = 0;
+	const char *extensions = NULL;
 	static EGL_DISPMANX_WINDOW_T nativewindow;
 	
 	static const EGLint attribute_list[] = {
@@ -44,7 +59,7 @@ void egl_init(void)
 		EGL_BLUE_SIZE, 8,
 		EGL_ALPHA_SIZE, 8,
 		EGL_ALPHA_MASK_SIZE, 8,
-		EGL_SURFACE_TYPE, EGL_WINDOW_BIT & EGL_SWAP_BEHAVIOR_PRESERVED_BIT,
+		EGL_SURFACE_TYPE, EGL_WINDOW_BIT | EGL_SWAP_BEHAVIOR_PRESERVED_BIT,
 		EGL_NONE
 	};
 	
@@ -53,7 +68,6 @@ void egl_init(void)
 	VC_RECT_T dst_rect;
 	VC_RECT_T src_rect;
 	DISPMANX_ELEMENT_HANDLE_T dispman_element;
-	DISPMANX_DISPLAY_HANDLE_T dispman_display;
 	DISPMANX_UPDATE_HANDLE_T  dispman_update;
 	
 	// bcm_host_init() must be called before anything else
@@ -106,17 +120,30 @@ void egl_init(void)
 	assert(surface != EGL_NO_SURFACE);
 	
 	// connect the context to the surface
-	result = eglMakeCurrent(display, surface, surface, context);
-	assert(EGL_FALSE != result);
+	egl_set_target(surface, context, screen_width, screen_height);
 	
 	// preserve color buffer when swapping
 	eglSurfaceAttrib(display, surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED);
 	
+	// partial presentation, if the driver supports it
+	extensions = eglQueryString(display, EGL_EXTENSIONS);
+	if(extensions && strstr(extensions, "EGL_KHR_swap_buffers_with_damage"))
+	{
+		swap_buffers_with_damage = (egl_swap_buffers_with_damage_t)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+	}
+	else if(extensions && strstr(extensions, "EGL_EXT_swap_buffers_with_damage"))
+	{
+		swap_buffers_with_damage = (egl_swap_buffers_with_damage_t)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+	}
+	
 	vgLoadIdentity();
 }
 
 void egl_cleanup(void)
 {
+	egl_set_vsync_callback(NULL, NULL);
+	egl_set_target(surface, context, screen_width, screen_height);
+	
 	glClear(GL_COLOR_BUFFER_BIT);
 	eglSwapBuffers(display, surface);
 	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
@@ -124,6 +151,10 @@ void egl_cleanup(void)
 	eglDestroyContext(display, context);
 	eglTerminate(display);
 	
+	image_config = NULL;
+	target_surface = NULL;
+	target_context = NULL;
+	
 	bcm_host_deinit();
 }
 
@@ -140,12 +171,257 @@ void egl_swap_buffers(void)
 	assert(EGL_FALSE != result);
 }
 
+/**
+ * Swaps the buffers, telling the driver that only the given rectangle has
+ * changed. Falls back to a full swap without EGL_KHR_swap_buffers_with_damage.
+ * The content outside the rectangle is preserved either way.
+ *
+ * @param x The x axis of the lower left corner
+ * @param y The y axis of the lower left corner
+ * @param width The width
+ * @param height The height
+ * @return 1 if the damage has been passed to the driver, 0 for a full swap
+ */
+int egl_swap_buffers_damage(EGLint x, EGLint y, EGLint width, EGLint height)
+{
+	EGLBoolean result;
+	EGLint rect[4] = { x, y, width, height };
+	
+	if(!swap_buffers_with_damage)
+	{
+		egl_swap_buffers();
+		
+		return 0;
+	}
+	
+	result = swap_buffers_with_damage(display, surface, rect, 1);
+	assert(EGL_FALSE != result);
+	
+	return 1;
+}
+
+/**
+ * @return 1 if egl_swap_buffers_damage presents partially, 0 otherwise
+ */
+int egl_has_swap_damage(void)
+{
+	return swap_buffers_with_damage != NULL;
+}
+
+/**
+ * Makes the context and the surface of the current target current on the calling thread
+ */
+void egl_make_current(void)
+{
+	EGLBoolean result;
+	
+	result = eglMakeCurrent(display, target_surface, target_surface, target_context);
+	assert(EGL_FALSE != result);
+}
+
+/**
+ * Makes the context and the window surface current on the calling thread,
+ * regardless of the current target. Used for presenting.
+ */
+void egl_make_window_current(void)
+{
+	EGLBoolean result;
+	
+	result = eglMakeCurrent(display, surface, surface, context);
+	assert(EGL_FALSE != result);
+}
+
+/**
+ * Sets the surface the canvas functions render to and makes it current on the
+ * calling thread.
+ *
+ * @param new_surface The surface
+ * @param new_context The context bound to the surface
+ * @param width The width of the surface
+ * @param height The height of the surface
+ */
+void egl_set_target(EGLSurface new_surface, EGLContext new_context, int32_t width, int32_t height)
+{
+	target_surface = new_surface;
+	target_context = new_context;
+	target_width = width;
+	target_height = height;
+	
+	egl_make_current();
+}
+
+/**
+ * Returns the window surface and its context.
+ *
+ * @param window_surface Pointer where to write the surface to
+ * @param window_context Pointer where to write the context to
+ */
+void egl_get_window(EGLSurface *window_surface, EGLContext *window_context)
+{
+	*window_surface = surface;
+	*window_context = context;
+}
+
+/**
+ * Creates a surface rendering into an OpenVG image. The image must not be a
+ * child image and must not be used for drawing while the surface is current.
+ * The new context shares paths, paints and images with the window context,
+ * but has its own OpenVG state (matrices, stroke parameters, masking).
+ *
+ * @param image The image to render into (VG_sRGBA_8888_PRE)
+ * @param image_surface Pointer where to write the surface to
+ * @param image_context Pointer where to write the context to
+ * @return 0 on success, -1 on failure
+ */
+int egl_create_image_target(VGImage image, EGLSurface *image_surface, EGLContext *image_context)
+{
+	EGLint num_config;
+	
+	static const EGLint attribute_list[] = {
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_ALPHA_MASK_SIZE, 8,
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENVG_BIT,
+		EGL_NONE
+	};
+	
+	if(!image_config && (eglChooseConfig(display, attribute_list, &image_config, 1, &num_config) == EGL_FALSE || num_config < 1))
+	{
+		eprintf("Failed to find a configuration for offscreen surfaces.\n");
+		
+		image_config = NULL;
+		
+		return -1;
+	}
+	
+	*image_context = eglCreateContext(display, image_config, context, NULL);
+	if(*image_context == EGL_NO_CONTEXT)
+	{
+		eprintf("Failed to create offscreen context.\n");
+		
+		return -1;
+	}
+	
+	*image_surface = eglCreatePbufferFromClientBuffer(display, EGL_OPENVG_IMAGE, (EGLClientBuffer)(uintptr_t)image, image_config, NULL);
+	if(*image_surface == EGL_NO_SURFACE)
+	{
+		eprintf("Failed to create offscreen surface.\n");
+		
+		eglDestroyContext(display, *image_context);
+		*image_context = EGL_NO_CONTEXT;
+		
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * Destroys a surface created by egl_create_image_target. The surface must not
+ * be the current target.
+ *
+ * @param image_surface The surface
+ * @param image_context The context
+ */
+void egl_destroy_image_target(EGLSurface image_surface, EGLContext image_context)
+{
+	eglDestroySurface(display, image_surface);
+	eglDestroyContext(display, image_context);
+}
+
+/**
+ * Releases the context from the calling thread, so it can be made current on another thread
+ */
+void egl_release_current(void)
+{
+	EGLBoolean result;
+	
+	result = eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	assert(EGL_FALSE != result);
+}
+
+/**
+ * Called by dispmanx on every vertical sync of the display
+ */
+static void egl_vsync(DISPMANX_UPDATE_HANDLE_T update, void *arg)
+{
+	egl_vsync_callback_t callback = vsync_callback;
+	
+	if(callback)
+	{
+		callback(vsync_user);
+	}
+}
+
+/**
+ * Sets a function which is called on every vertical sync of the display.
+ * The callback is invoked on a dispmanx thread.
+ *
+ * @param callback The callback or NULL to remove the current one
+ * @param user Pointer passed to the callback
+ * @return 0 on success, -1 if the display does not report vertical syncs
+ */
+int egl_set_vsync_callback(egl_vsync_callback_t callback, void *user)
+{
+	if(!dispman_display)
+	{
+		return -1;
+	}
+	
+	if(!callback)
+	{
+		if(vsync_callback)
+		{
+			vc_dispmanx_vsync_callback(dispman_display, NULL, NULL);
+		}
+		
+		vsync_callback = NULL;
+		vsync_user = NULL;
+		
+		return 0;
+	}
+	
+	vsync_user = user;
+	vsync_callback = callback;
+	
+	if(vc_dispmanx_vsync_callback(dispman_display, egl_vsync, NULL) != 0)
+	{
+		eprintf("Failed to register vsync callback.\n");
+		
+		vsync_callback = NULL;
+		vsync_user = NULL;
+		
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * @return The width of the current target
+ */
 int32_t egl_get_width(void)
 {
-	return (int32_t)screen_width;
+	return target_width;
 }
 
+/**
+ * @return The height of the current target
+ */
 int32_t egl_get_height(void)
+{
+	return target_height;
+}
+
+int32_t egl_get_screen_width(void)
+{
+	return (int32_t)screen_width;
+}
+
+int32_t egl_get_screen_height(void)
 {
 	return (int32_t)screen_height;
 }
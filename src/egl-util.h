@@ -23,11 +23,25 @@
 #include <EGL/egl.h>
 #include <VG/openvg.h>
 
+typedef void (*egl_vsync_callback_t)(void *user);
+
 void egl_init(void);
 void egl_cleanup(void);
 EGLint egl_error(void);
 void egl_swap_buffers(void);
+int egl_swap_buffers_damage(EGLint x, EGLint y, EGLint width, EGLint height);
+int egl_has_swap_damage(void);
+void egl_make_current(void);
+void egl_make_window_current(void);
+void egl_release_current(void);
+void egl_set_target(EGLSurface surface, EGLContext context, int32_t width, int32_t height);
+void egl_get_window(EGLSurface *surface, EGLContext *context);
+int egl_create_image_target(VGImage image, EGLSurface *surface, EGLContext *context);
+void egl_destroy_image_target(EGLSurface surface, EGLContext context);
+int egl_set_vsync_callback(egl_vsync_callback_t callback, void *user);
 int32_t egl_get_width(void);
 int32_t egl_get_height(void);
+int32_t egl_get_screen_width(void);
+int32_t egl_get_screen_height(void);
 
 #endif /* __GL_UTIL_H__ */
@@ -0,0 +1,584 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-zlib.h"
+#include "encode-util.h"
+#include "pool-util.h"
+#include "log-util.h"
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+
+static const unsigned char png_signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+// strips per thread and minimum rows of a strip for parallel PNG encoding
+#define ENCODE_PNG_STRIPS 4
+#define ENCODE_PNG_STRIP_ROWS 32
+
+typedef struct encode_png_strip_t
+{
+	unsigned char *data;
+	size_t size;
+	size_t length;
+	uLong adler;
+	uLong crc;
+} encode_png_strip_t;
+
+typedef struct encode_png_job_t
+{
+	const char *src;
+	VGint width;
+	VGint height;
+	VGint strip_rows;
+	int compression;
+	int filter;
+	encode_png_strip_t *strips;
+} encode_png_job_t;
+
+/**
+ * Writes a 32 bit big endian integer
+ *
+ * @param dst Destination
+ * @param value The value
+ * @return Pointer behind the written integer
+ */
+static unsigned char *encode_write_u32(unsigned char *dst, uint32_t value)
+{
+	dst[0] = value >> 24;
+	dst[1] = value >> 16;
+	dst[2] = value >> 8;
+	dst[3] = value;
+	
+	return dst + 4;
+}
+
+/**
+ * Converts a scanline of the screen (sRGBX_8888, bottom-up) to packed RGB
+ *
+ * @param dst Destination (width * 3 bytes)
+ * @param src Raw image data of the screen
+ * @param width The width
+ * @param height The height
+ * @param row The row counted from the top
+ */
+static void encode_convert_row(unsigned char *dst, const char *src, VGint width, VGint height, VGint row)
+{
+	const unsigned char *line = (const unsigned char *)src + (size_t)(height - 1 - row) * width * 4;
+	VGint x = 0;
+	
+	for(x = 0; x < width; x++)
+	{
+		dst[x * 3 + 0] = line[x * 4 + 3];
+		dst[x * 3 + 1] = line[x * 4 + 2];
+		dst[x * 3 + 2] = line[x * 4 + 1];
+	}
+}
+
+/**
+ * Paeth predictor as specified in the PNG specification
+ */
+static unsigned char encode_paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a);
+	int pb = abs(p - b);
+	int pc = abs(p - c);
+	
+	if(pa <= pb && pa <= pc)
+	{
+		return a;
+	}
+	
+	if(pb <= pc)
+	{
+		return b;
+	}
+	
+	return c;
+}
+
+/**
+ * Filters a scanline with the given PNG filter type
+ *
+ * @param dst Destination (length bytes)
+ * @param cur The current unfiltered scanline
+ * @param prev The previous unfiltered scanline (all zero for the first row)
+ * @param length Length of a scanline in bytes
+ * @param filter Filter type (ENCODE_FILTER_NONE to ENCODE_FILTER_PAETH)
+ * @return Sum of the absolute values of the filtered bytes interpreted as signed
+ */
+static unsigned long encode_filter_row(unsigned char *dst, const unsigned char *cur, const unsigned char *prev, size_t length, int filter)
+{
+	unsigned long sum = 0;
+	size_t i = 0;
+	int a = 0;
+	int c = 0;
+	
+	for(i = 0; i < length; i++)
+	{
+		a = i >= 3 ? cur[i - 3] : 0;
+		c = i >= 3 ? prev[i - 3] : 0;
+		
+		switch(filter)
+		{
+			case ENCODE_FILTER_SUB:
+				dst[i] = cur[i] - a;
+				break;
+			case ENCODE_FILTER_UP:
+				dst[i] = cur[i] - prev[i];
+				break;
+			case ENCODE_FILTER_AVERAGE:
+				dst[i] = cur[i] - ((a + prev[i]) >> 1);
+				break;
+			case ENCODE_FILTER_PAETH:
+				dst[i] = cur[i] - encode_paeth(a, prev[i], c);
+				break;
+			default:
+				dst[i] = cur[i];
+				break;
+		}
+		
+		sum += abs((signed char)dst[i]);
+	}
+	
+	return sum;
+}
+
+/**
+ * Filters and compresses a strip of rows of a PNG. Strips are compressed as
+ * raw deflate streams which are concatenated to the zlib stream of the IDAT
+ * chunk; all but the last one end on a byte boundary (Z_SYNC_FLUSH).
+ *
+ * @param user The encode_png_job_t of the PNG
+ * @param index The index of the strip
+ */
+static void encode_png_strip(void *user, unsigned long index)
+{
+	encode_png_job_t *job = user;
+	encode_png_strip_t *strip = &job->strips[index];
+	size_t stride = (size_t)job->width * 3;
+	VGint first = index * job->strip_rows;
+	VGint last = first + job->strip_rows < job->height ? first + job->strip_rows : job->height;
+	size_t size = (stride + 1) * (last - first);
+	unsigned char *filtered = NULL;
+	unsigned char *rows = NULL;
+	unsigned char *cur = NULL;
+	unsigned char *prev = NULL;
+	unsigned char *candidate = NULL;
+	unsigned long sum = 0;
+	unsigned long best_sum = 0;
+	z_stream stream;
+	VGint y = 0;
+	int type = 0;
+	int best = 0;
+	
+	filtered = malloc(size);
+	rows = calloc(3, stride);
+	if(!filtered || !rows)
+	{
+		eprintf("Failed to allocate PNG buffers.\n");
+		
+		free(filtered);
+		free(rows);
+		
+		return;
+	}
+	
+	cur = rows;
+	prev = rows + stride;
+	candidate = rows + stride * 2;
+	
+	// the filters of the first row refer to the last row of the previous strip
+	if(first > 0)
+	{
+		encode_convert_row(prev, job->src, job->width, job->height, first - 1);
+	}
+	
+	for(y = first; y < last; y++)
+	{
+		unsigned char *line = filtered + (stride + 1) * (y - first);
+		unsigned char *swap = NULL;
+		
+		encode_convert_row(cur, job->src, job->width, job->height, y);
+		
+		if(job->filter == ENCODE_FILTER_ADAPTIVE)
+		{
+			// minimum sum of absolute differences heuristic (like libpng)
+			best = ENCODE_FILTER_NONE;
+			best_sum = encode_filter_row(line + 1, cur, prev, stride, ENCODE_FILTER_NONE);
+			
+			for(type = ENCODE_FILTER_SUB; type <= ENCODE_FILTER_PAETH; type++)
+			{
+				sum = encode_filter_row(candidate, cur, prev, stride, type);
+				if(sum < best_sum)
+				{
+					best = type;
+					best_sum = sum;
+					memcpy(line + 1, candidate, stride);
+				}
+			}
+			
+			line[0] = best;
+		}
+		else
+		{
+			line[0] = job->filter;
+			encode_filter_row(line + 1, cur, prev, stride, job->filter);
+		}
+		
+		swap = prev;
+		prev = cur;
+		cur = swap;
+	}
+	
+	free(rows);
+	
+	memset(&stream, 0, sizeof(stream));
+	if(deflateInit2(&stream, job->compression, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		eprintf("Failed to initialize deflate.\n");
+		
+		free(filtered);
+		
+		return;
+	}
+	
+	// the bound does not include the empty block of the flush
+	strip->size = deflateBound(&stream, size) + 16;
+	strip->data = malloc(strip->size);
+	if(!strip->data)
+	{
+		eprintf("Failed to allocate PNG strip.\n");
+		
+		deflateEnd(&stream);
+		free(filtered);
+		
+		return;
+	}
+	
+	stream.next_in = filtered;
+	stream.avail_in = size;
+	stream.next_out = strip->data;
+	stream.avail_out = strip->size;
+	
+	if(deflate(&stream, last == job->height ? Z_FINISH : Z_SYNC_FLUSH) != (last == job->height ? Z_STREAM_END : Z_OK) || stream.avail_in != 0)
+	{
+		eprintf("Failed to compress PNG.\n");
+		
+		free(strip->data);
+		strip->data = NULL;
+	}
+	else
+	{
+		strip->size = stream.total_out;
+		strip->adler = adler32(adler32(0, NULL, 0), filtered, size);
+		strip->crc = crc32(0, strip->data, strip->size);
+		strip->length = size;
+	}
+	
+	deflateEnd(&stream);
+	free(filtered);
+}
+
+/**
+ * Encodes the screen as 8 bit RGB PNG. Scanlines are filtered here and
+ * compressed with zlib directly, so the compression level and the filter
+ * strategy can be chosen independently. With more than one thread the image
+ * is split into strips of rows that are filtered and compressed in parallel;
+ * the strips do not share the compression window, which costs a few bytes
+ * per strip.
+ *
+ * @param src Raw image data of the screen (sRGBX_8888, bottom-up)
+ * @param width The width
+ * @param height The height
+ * @param compression zlib compression level (0 - 9, -1 for the default)
+ * @param filter Filter strategy (ENCODE_FILTER_*, -1 for adaptive)
+ * @param threads Number of threads (1 - POOL_UTIL_THREADS_MAX, 0 for one per CPU)
+ * @param data_amount Pointer where to write the size of the PNG to
+ * @return Pointer to the PNG (must be freed)
+ */
+char *encode_png(const char *src, VGint width, VGint height, int compression, int filter, int threads, size_t *data_amount)
+{
+	encode_png_job_t job;
+	unsigned char *png = NULL;
+	unsigned char *p = NULL;
+	unsigned long strips = 0;
+	unsigned long i = 0;
+	size_t idat_size = 2 + 4;
+	uLong adler = 0;
+	uLong crc = 0;
+	int level = 0;
+	
+	*data_amount = 0;
+	
+	if(compression < 0 || compression > 9)
+	{
+		compression = Z_DEFAULT_COMPRESSION;
+	}
+	
+	if(filter < 0 || filter > ENCODE_FILTER_ADAPTIVE)
+	{
+		filter = ENCODE_FILTER_ADAPTIVE;
+	}
+	
+	// a single strip for one thread, several strips per thread otherwise so
+	// threads that finish early can steal work
+	threads = pool_util_get_threads(threads);
+	job.strip_rows = height;
+	if(threads > 1)
+	{
+		job.strip_rows = (height + threads * ENCODE_PNG_STRIPS - 1) / (threads * ENCODE_PNG_STRIPS);
+		if(job.strip_rows < ENCODE_PNG_STRIP_ROWS)
+		{
+			job.strip_rows = ENCODE_PNG_STRIP_ROWS;
+		}
+	}
+	
+	strips = (height + job.strip_rows - 1) / job.strip_rows;
+	job.src = src;
+	job.width = width;
+	job.height = height;
+	job.compression = compression;
+	job.filter = filter;
+	job.strips = calloc(strips, sizeof(encode_png_strip_t));
+	if(!job.strips)
+	{
+		eprintf("Failed to allocate PNG strips.\n");
+		
+		return NULL;
+	}
+	
+	pool_util_run(strips, threads, encode_png_strip, &job);
+	
+	adler = adler32(0, NULL, 0);
+	for(i = 0; i < strips; i++)
+	{
+		if(!job.strips[i].data)
+		{
+			break;
+		}
+		
+		adler = adler32_combine(adler, job.strips[i].adler, job.strips[i].length);
+		idat_size += job.strips[i].size;
+	}
+	
+	// signature, IHDR, IDAT header and crc, IEND
+	if(i == strips)
+	{
+		png = malloc(sizeof(png_signature) + 25 + 12 + idat_size + 12);
+	}
+	
+	if(!png)
+	{
+		if(i == strips)
+		{
+			eprintf("Failed to allocate PNG.\n");
+		}
+		
+		for(i = 0; i < strips; i++)
+		{
+			free(job.strips[i].data);
+		}
+		free(job.strips);
+		
+		return NULL;
+	}
+	
+	memcpy(png, png_signature, sizeof(png_signature));
+	p = png + sizeof(png_signature);
+	
+	p = encode_write_u32(p, 13);
+	memcpy(p, "IHDR", 4);
+	encode_write_u32(p + 4, width);
+	encode_write_u32(p + 8, height);
+	p[12] = 8; // bit depth
+	p[13] = 2; // color type: RGB
+	p[14] = 0; // compression method
+	p[15] = 0; // filter method
+	p[16] = 0; // no interlace
+	encode_write_u32(p + 17, crc32(0, p, 17));
+	p += 21;
+	
+	p = encode_write_u32(p, idat_size);
+	memcpy(p, "IDAT", 4);
+	
+	// zlib header like deflateInit() writes it: 32K window, level hint
+	level = compression == Z_DEFAULT_COMPRESSION ? 2 : compression < 2 ? 0 : compression < 6 ? 1 : compression == 6 ? 2 : 3;
+	p[4] = 0x78;
+	p[5] = level << 6;
+	p[5] += 31 - (p[4] * 256 + p[5]) % 31;
+	crc = crc32(0, p, 6);
+	p += 6;
+	
+	for(i = 0; i < strips; i++)
+	{
+		memcpy(p, job.strips[i].data, job.strips[i].size);
+		crc = crc32_combine(crc, job.strips[i].crc, job.strips[i].size);
+		p += job.strips[i].size;
+		free(job.strips[i].data);
+	}
+	free(job.strips);
+	
+	p = encode_write_u32(p, adler);
+	crc = crc32(crc, p - 4, 4);
+	p = encode_write_u32(p, crc);
+	
+	p = encode_write_u32(p, 0);
+	memcpy(p, "IEND", 4);
+	encode_write_u32(p + 4, crc32(0, p, 4));
+	p += 8;
+	
+	*data_amount = p - png;
+	
+	return (char *)png;
+}
+
+/**
+ * Encodes the screen in the "Quite OK Image" format. It is lossless and
+ * encodes in a single pass without any compression library, which makes it
+ * considerably faster than PNG at a somewhat larger size.
+ *
+ * @param src Raw image data of the screen (sRGBX_8888, bottom-up)
+ * @param width The width
+ * @param height The height
+ * @param data_amount Pointer where to write the size of the image to
+ * @return Pointer to the image (must be freed)
+ */
+char *encode_qoi(const char *src, VGint width, VGint height, size_t *data_amount)
+{
+	// RGBA like the decoder, which starts with all entries (0, 0, 0, 0)
+	unsigned char index[64][4];
+	unsigned char px[4] = { 0, 0, 0, 255 };
+	unsigned char prev[4] = { 0, 0, 0, 255 };
+	const unsigned char *line = NULL;
+	unsigned char *qoi = NULL;
+	unsigned char *p = NULL;
+	int run = 0;
+	int hash = 0;
+	int vr = 0;
+	int vg = 0;
+	int vb = 0;
+	int vg_r = 0;
+	int vg_b = 0;
+	VGint x = 0;
+	VGint y = 0;
+	
+	*data_amount = 0;
+	
+	// header, worst case of 4 bytes per pixel, end marker
+	qoi = malloc(14 + (size_t)width * height * 4 + 8);
+	if(!qoi)
+	{
+		eprintf("Failed to allocate QOI image.\n");
+		
+		return NULL;
+	}
+	
+	memset(index, 0, sizeof(index));
+	
+	memcpy(qoi, "qoif", 4);
+	encode_write_u32(qoi + 4, width);
+	encode_write_u32(qoi + 8, height);
+	qoi[12] = 3; // channels: RGB
+	qoi[13] = 0; // colorspace: sRGB
+	p = qoi + 14;
+	
+	for(y = 0; y < height; y++)
+	{
+		line = (const unsigned char *)src + (size_t)(height - 1 - y) * width * 4;
+		
+		for(x = 0; x < width; x++)
+		{
+			px[0] = line[x * 4 + 3];
+			px[1] = line[x * 4 + 2];
+			px[2] = line[x * 4 + 1];
+			
+			// the implicit previous pixel of the first one is (0, 0, 0, 255)
+			if(!memcmp(px, prev, 4))
+			{
+				run++;
+				if(run == 62)
+				{
+					*p++ = QOI_OP_RUN | (run - 1);
+					run = 0;
+				}
+				
+				continue;
+			}
+			
+			if(run)
+			{
+				*p++ = QOI_OP_RUN | (run - 1);
+				run = 0;
+			}
+			
+			hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+			
+			if(!memcmp(index[hash], px, 4))
+			{
+				*p++ = QOI_OP_INDEX | hash;
+			}
+			else
+			{
+				memcpy(index[hash], px, 4);
+				
+				vr = (signed char)(px[0] - prev[0]);
+				vg = (signed char)(px[1] - prev[1]);
+				vb = (signed char)(px[2] - prev[2]);
+				vg_r = vr - vg;
+				vg_b = vb - vg;
+				
+				if(vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+				{
+					*p++ = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+				}
+				else if(vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8)
+				{
+					*p++ = QOI_OP_LUMA | (vg + 32);
+					*p++ = (vg_r + 8) << 4 | (vg_b + 8);
+				}
+				else
+				{
+					*p++ = QOI_OP_RGB;
+					*p++ = px[0];
+					*p++ = px[1];
+					*p++ = px[2];
+				}
+			}
+			
+			memcpy(prev, px, 4);
+		}
+	}
+	
+	if(run)
+	{
+		*p++ = QOI_OP_RUN | (run - 1);
+	}
+	
+	memset(p, 0, 7);
+	p[7] = 1;
+	p += 8;
+	
+	*data_amount = p - qoi;
+	
+	return (char *)qoi;
+}
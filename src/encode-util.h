@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ENCODE_UTIL_H__
+#define __ENCODE_UTIL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <VG/openvg.h>
+
+#define ENCODE_FILTER_NONE 0
+#define ENCODE_FILTER_SUB 1
+#define ENCODE_FILTER_UP 2
+#define ENCODE_FILTER_AVERAGE 3
+#define ENCODE_FILTER_PAETH 4
+#define ENCODE_FILTER_ADAPTIVE 5
+
+char *encode_png(const char *src, VGint width, VGint height, int compression, int filter, int threads, size_t *data_amount);
+char *encode_qoi(const char *src, VGint width, VGint height, size_t *data_amount);
+
+#endif /* __ENCODE_UTIL_H__ */
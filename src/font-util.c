@@ -20,20 +20,127 @@
 #include "include-openvg.h"
 #include "include-freetype.h"
 
+#include <pthread.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "log-util.h"
 #include "font-util.h"
-
-static unsigned long long int point_count = 0;
-static unsigned int char_count = 0;
+#include "memory-util.h"
 
 #define SEGMENTS_COUNT_MAX 256
 #define COORDS_COUNT_MAX 1024
 #define FONT_FLOAT_FROM_26_6(x) ((VGfloat)x / 64.0f)
 
 static FT_Library font_library = NULL;
+// guards the creation of faces, fonts can be loaded on worker threads
+static pthread_mutex_t font_library_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t font_loads_cond = PTHREAD_COND_INITIALIZER;
+static int font_loads = 0;
 static font_t *fonts = NULL;
 static int fonts_amount = 0;
 static char *font_version = NULL;
+static char *font_cache_dir = NULL;
+static font_util_cache_stats_t font_cache_stats;
+
+typedef struct font_util_outlines_t
+{
+	VGubyte *segments;
+	long segments_amount;
+	long segments_size;
+	VGfloat *coords;
+	long coords_amount;
+	long coords_size;
+} font_util_outlines_t;
+
+struct font_util_load_t
+{
+	// everything but the name and the glyph paths
+	font_t font;
+	// outlines of all characters, one after another
+	font_util_outlines_t outlines;
+	// first segment, amount of segments and first coordinate per character
+	long *ranges;
+	// the outlines point into this mapping when read from the cache
+	void *map;
+	size_t map_size;
+};
+
+/*
+ * Cache file layout, native byte order: header, characters, coordinates and
+ * segments. The file is named after the hash of the font file.
+ */
+typedef struct font_util_cache_header_t
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t font_size;
+	uint32_t characters;
+	uint64_t hash;
+	uint64_t file_size;
+	uint32_t segments;
+	uint32_t coords;
+	float ascender;
+	float descender;
+	uint32_t kerning_available;
+	uint32_t reserved;
+} font_util_cache_header_t;
+
+typedef struct font_util_cache_character_t
+{
+	uint32_t charcode;
+	uint32_t glyph_index;
+	float width;
+	float height;
+	float advance_x;
+	float bearing_x;
+	float bearing_y;
+	uint32_t segments_first;
+	uint32_t segments_amount;
+	uint32_t coords_first;
+} font_util_cache_character_t;
+
+typedef struct font_util_atlas_node_t
+{
+	VGint x;
+	VGint y;
+	VGint width;
+} font_util_atlas_node_t;
+
+typedef struct font_util_atlas_page_t
+{
+	VGImage image;
+	// top edge of the packed glyphs, sorted by x and covering the whole width
+	font_util_atlas_node_t *skyline;
+	int nodes;
+	long glyphs;
+	unsigned long last_use;
+} font_util_atlas_page_t;
+
+typedef struct font_util_atlas_glyph_t
+{
+	FT_Face face;
+	FT_UInt glyph_index;
+	FT_F26Dot6 size;
+	int page;
+	// invalid for glyphs without pixels (e.g. spaces)
+	VGImage image;
+	VGint left;
+	VGint bottom;
+	struct font_util_atlas_glyph_t *next;
+} font_util_atlas_glyph_t;
+
+static VGfloat atlas_size = 0;
+static font_util_atlas_page_t atlas_pages[FONT_UTIL_ATLAS_PAGES];
+static int atlas_pages_amount = 0;
+static font_util_atlas_glyph_t *atlas_glyphs[FONT_UTIL_ATLAS_BUCKETS];
+static unsigned long atlas_clock = 0;
+static font_util_atlas_stats_t atlas_stats;
+
+static void font_util_atlas_remove(FT_Face face, int page);
 
 // freetype errors
 #undef __FTERRORS_H__
@@ -104,12 +211,12 @@ int font_util_get(char *name)
 /**
  * Returns the font name of a given font index.
  * @param fonts_index The font index.
- * @return The font name as string. If no fonts are available an empty string is
- *         returned.
+ * @return The font name as string. If no fonts are available or no font is set
+ *         (new offscreen contexts) an empty string is returned.
  */
 char *font_util_get_name(unsigned int fonts_index)
 {
-	if(fonts == NULL)
+	if(fonts == NULL || fonts_index >= (unsigned int)fonts_amount)
 	{
 		return "";
 	}
@@ -174,6 +281,8 @@ char *font_util_version(void)
  */
 void font_util_cleanup(void)
 {
+	font_util_atlas_clear();
+	
 	if(fonts != NULL)
 	{
 		while(fonts != NULL)
@@ -182,12 +291,71 @@ void font_util_cleanup(void)
 		}
 	}
 	
+	// fonts still being parsed use the library
+	pthread_mutex_lock(&font_library_mutex);
+	
+	while(font_loads > 0)
+	{
+		pthread_cond_wait(&font_loads_cond, &font_library_mutex);
+	}
+	
 	if(font_library != NULL)
 	{
 		FT_Done_FreeType(font_library);
+		font_library = NULL;
 	}
 	
+	pthread_mutex_unlock(&font_library_mutex);
+	
 	free(font_version);
+	font_version = NULL;
+}
+
+/**
+ * Appends a segment to the outlines of a font being loaded.
+ * @param outlines The outlines.
+ * @param segment The segment type.
+ * @param data The coordinates of the segment.
+ * @param count The amount of coordinates.
+ * @return 0 on success or -1 if the outlines could not grow.
+ */
+static int font_util_outlines_append(font_util_outlines_t *outlines, VGubyte segment, const VGfloat *data, int count)
+{
+	void *grown = NULL;
+	int i = 0;
+	
+	if(outlines->segments_amount == outlines->segments_size)
+	{
+		grown = realloc(outlines->segments, (outlines->segments_size * 2 + 256) * sizeof(VGubyte));
+		if(grown == NULL)
+		{
+			return -1;
+		}
+		
+		outlines->segments = grown;
+		outlines->segments_size = outlines->segments_size * 2 + 256;
+	}
+	
+	if(outlines->coords_amount + count > outlines->coords_size)
+	{
+		grown = realloc(outlines->coords, (outlines->coords_size * 2 + 1024) * sizeof(VGfloat));
+		if(grown == NULL)
+		{
+			return -1;
+		}
+		
+		outlines->coords = grown;
+		outlines->coords_size = outlines->coords_size * 2 + 1024;
+	}
+	
+	outlines->segments[outlines->segments_amount++] = segment;
+	
+	for(i = 0; i < count; i++)
+	{
+		outlines->coords[outlines->coords_amount++] = data[i];
+	}
+	
+	return 0;
 }
 
 /**
@@ -196,17 +364,12 @@ void font_util_cleanup(void)
  */
 static int font_util_outline_decompose_move_to(const FT_Vector *to, void *user)
 {
-	VGubyte segment[1] = { VG_MOVE_TO_ABS };
 	VGfloat data[2];
 	
 	data[0] = FONT_UTIL_TO_FLOAT(to->x);
 	data[1] = FONT_UTIL_TO_FLOAT(to->y);
 	
-	vgAppendPathData(*(VGPath *)user, 1, segment, (const void *)data);
-	
-	point_count += 2;
-	
-	return 0;
+	return font_util_outlines_append((font_util_outlines_t *)user, VG_MOVE_TO_ABS, data, 2);
 }
 
 /**
@@ -215,17 +378,12 @@ static int font_util_outline_decompose_move_to(const FT_Vector *to, void *user)
  */
 static int font_util_outline_decompose_line_to(const FT_Vector *to, void *user)
 {
-	VGubyte segment[1] = { VG_LINE_TO_ABS };
 	VGfloat data[2];
 	
 	data[0] = FONT_UTIL_TO_FLOAT(to->x);
 	data[1] = FONT_UTIL_TO_FLOAT(to->y);
 	
-	vgAppendPathData(*(VGPath *)user, 1, segment, (const void *)data);
-	
-	point_count += 2;
-	
-	return 0;
+	return font_util_outlines_append((font_util_outlines_t *)user, VG_LINE_TO_ABS, data, 2);
 }
 
 /**
@@ -234,7 +392,6 @@ static int font_util_outline_decompose_line_to(const FT_Vector *to, void *user)
  */
 static int font_util_outline_decompose_conic_to(const FT_Vector *control, const FT_Vector *to, void *user)
 {
-	VGubyte segment[1] = { VG_QUAD_TO_ABS };
 	VGfloat data[4];
 	
 	data[0] = FONT_UTIL_TO_FLOAT(control->x);
@@ -242,11 +399,7 @@ static int font_util_outline_decompose_conic_to(const FT_Vector *control, const
 	data[2] = FONT_UTIL_TO_FLOAT(to->x);
 	data[3] = FONT_UTIL_TO_FLOAT(to->y);
 	
-	vgAppendPathData(*(VGPath *)user, 1, segment, (const void *)data);
-	
-	point_count += 4;
-	
-	return 0;
+	return font_util_outlines_append((font_util_outlines_t *)user, VG_QUAD_TO_ABS, data, 4);
 }
 
 
@@ -256,7 +409,6 @@ static int font_util_outline_decompose_conic_to(const FT_Vector *control, const
  */
 static int font_util_outline_decompose_cubic_to(const FT_Vector *control1, const FT_Vector *control2, const FT_Vector *to, void *user)
 {
-	VGubyte segment[1] = { VG_CUBIC_TO_ABS };
 	VGfloat data[6];
 	
 	data[0] = FONT_UTIL_TO_FLOAT(control1->x);
@@ -266,298 +418,857 @@ static int font_util_outline_decompose_cubic_to(const FT_Vector *control1, const
 	data[4] = FONT_UTIL_TO_FLOAT(to->x);
 	data[5] = FONT_UTIL_TO_FLOAT(to->y);
 	
-	vgAppendPathData(*(VGPath *)user, 1, segment, (const void *)data);
-	
-	point_count += 6;
-	
-	return 0;
+	return font_util_outlines_append((font_util_outlines_t *)user, VG_CUBIC_TO_ABS, data, 6);
 }
 
-
 /**
- * Callback function for the outline path decomposing. This function handles a
- * close path operation.
+ * Frees the outlines of a loaded font, they are either on the heap or mapped
+ * from the cache file.
+ * @param load The loaded font.
  */
-static void font_util_outline_decompose_close_path(void *user)
+static void font_util_outlines_free(font_util_load_t *load)
 {
-	VGubyte segment[1] = { VG_CLOSE_PATH };
-	VGfloat data[2];
-	
-	data[0] = 0;
-	data[1] = 0;
+	if(load->map != NULL)
+	{
+		munmap(load->map, load->map_size);
+	}
+	else
+	{
+		free(load->outlines.segments);
+		free(load->outlines.coords);
+	}
 	
-	vgAppendPathData(*(VGPath *)user, 1, segment, (const void *)data);
+	load->map = NULL;
+	load->outlines.segments = NULL;
+	load->outlines.coords = NULL;
 }
 
 /**
- * Registers a new font in the font list. This function initializes a given font
- * file, processes/converts all important informations and stores the data in
- * the VRAM or the font list.
- * @param path The path of a valid font file. (e.g. TrueType-file)
- * @param name The font name. Fonts in the font list are identified by this font
- *             name.
- * @return Returns 0 on success, else it returns -1. On error sometimes an
- *         errno is set or a error message is printed on log output.
+ * Hashes a font file with 64 bit FNV-1a, the hash identifies its cache file.
+ * Whole words are hashed instead of single bytes, byte-wise hashing would cost
+ * more than reading the cache file.
+ * @param path The path of the font file.
+ * @param hash The hash is written to this pointer.
+ * @param size The file size is written to this pointer.
+ * @return 0 on success or -1 if the file can't be read.
  */
-int font_util_new(char *path, char *name)
+static int font_util_cache_hash(const char *path, uint64_t *hash, uint64_t *size)
 {
-	int i = 0;
-	FT_Error error = 0;
-	FT_Outline_Funcs outline_functions;
-	FT_ULong charcode;
-	FT_UInt gindex;
-	VGPath glyph_path = 0;
-	
-	outline_functions.move_to = &font_util_outline_decompose_move_to;
-	outline_functions.line_to = &font_util_outline_decompose_line_to;
-	outline_functions.conic_to = &font_util_outline_decompose_conic_to;
-	outline_functions.cubic_to = &font_util_outline_decompose_cubic_to;
-	
-	outline_functions.shift = 0;
-	outline_functions.delta = 0;
-	
-	if(font_library == NULL)
+	struct stat info;
+	const unsigned char *data = NULL;
+	uint64_t value = 14695981039346656037ULL;
+	size_t i = 0;
+	int fd = 0;
+	
+	fd = open(path, O_RDONLY);
+	if(fd < 0)
 	{
 		return -1;
 	}
 	
-	fonts = realloc(fonts, (++fonts_amount) * sizeof(font_t));
-	
-	if(fonts == NULL)
+	if(fstat(fd, &info) != 0 || info.st_size == 0)
 	{
-		eprintf("%s: Failed to grow font list.\n", name);
-		
-		// errno set by realloc
+		close(fd);
 		
 		return -1;
 	}
 	
-	fonts[fonts_amount - 1].path = strdup(path);
-	fonts[fonts_amount - 1].name = strdup(name);
-	
-	// read font file
-	error = FT_New_Face(font_library, path, 0, &(fonts[fonts_amount - 1].face));
-	if(error != 0)
+	data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED)
 	{
-		eprintf("%s: Failed to load font face: %s\n", name, font_util_get_error(error));
-		
-		fonts[fonts_amount - 1].face = NULL;
-		font_util_remove(name);
-		
-		errno = EBFONT; // Bad font file format
-		
 		return -1;
 	}
 	
-	// set character size
-	error = FT_Set_Char_Size(fonts[fonts_amount - 1].face, 0, FONT_UTIL_SIZE, 96, 96);
-	if(error != 0)
+	// the mapping is page aligned
+	for(i = 0; i + sizeof(uint64_t) <= (size_t)info.st_size; i += sizeof(uint64_t))
 	{
-		eprintf("%s: Failed to set font size (char): %s\n", name, font_util_get_error(error));
-		
-		font_util_remove(name);
-		
-		return -1;
+		value = (value ^ *(const uint64_t *)(data + i)) * 1099511628211ULL;
+	}
+	
+	for(; i < (size_t)info.st_size; i++)
+	{
+		value = (value ^ data[i]) * 1099511628211ULL;
 	}
 	
-	char_count = 0;
+	munmap((void *)data, info.st_size);
 	
-	// count characters to allocate the character array
-	charcode = FT_Get_First_Char(fonts[fonts_amount - 1].face, &gindex);
-	while(gindex != 0)
+	*hash = value;
+	*size = info.st_size;
+	
+	return 0;
+}
+
+/**
+ * Returns the amount of coordinates of a segment written by the outline
+ * decomposition.
+ * @param segment The segment type.
+ * @return The amount of coordinates or -1 for any other segment.
+ */
+static int font_util_cache_segment_coords(VGubyte segment)
+{
+	switch(segment)
 	{
-		charcode = FT_Get_Next_Char(fonts[fonts_amount - 1].face, charcode, &gindex);
-		
-		char_count++;
+		case VG_CLOSE_PATH:
+			return 0;
+		case VG_MOVE_TO_ABS:
+		case VG_LINE_TO_ABS:
+			return 2;
+		case VG_QUAD_TO_ABS:
+			return 4;
+		case VG_CUBIC_TO_ABS:
+			return 6;
+		default:
+			return -1;
+	}
+}
+
+/**
+ * Maps a cache file and takes the characters and outlines from it. The file
+ * is checked completely, a damaged or outdated file is rejected.
+ * @param load The loaded font with an opened face.
+ * @param file The path of the cache file.
+ * @param hash The hash of the font file.
+ * @param size The size of the font file.
+ * @return 0 on success, -1 if there is no usable cache file.
+ */
+static int font_util_cache_read(font_util_load_t *load, const char *file, uint64_t hash, uint64_t size)
+{
+	struct stat info;
+	void *map = NULL;
+	const font_util_cache_header_t *header = NULL;
+	const font_util_cache_character_t *cached = NULL;
+	const VGfloat *coords = NULL;
+	const VGubyte *segments = NULL;
+	character_t *character = NULL;
+	uint64_t expected = 0;
+	uint64_t coords_end = 0;
+	uint32_t i = 0;
+	uint32_t j = 0;
+	int count = 0;
+	int fd = 0;
+	
+	fd = open(file, O_RDONLY);
+	if(fd < 0)
+	{
+		goto fail;
 	}
 	
-	fonts[fonts_amount - 1].characters = malloc(char_count * sizeof(character_t *));
-	fonts[fonts_amount - 1].characters_amount = char_count;
-	if(fonts[fonts_amount - 1].characters == NULL)
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(font_util_cache_header_t))
 	{
-		eprintf("%s: Failed to allocate character array\n", name);
-		
-		font_util_remove(name);
+		close(fd);
 		
-		// errno set by malloc
+		goto reject;
+	}
+	
+	map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED)
+	{
+		map = NULL;
 		
-		return -1;
+		goto reject;
 	}
 	
-	// allocate characters
-	for(i = 0; i < fonts[fonts_amount - 1].characters_amount; i++)
+	header = map;
+	if(memcmp(header->magic, "VGFC", 4) != 0 || header->version != FONT_UTIL_CACHE_VERSION || header->font_size != FONT_UTIL_SIZE || header->hash != hash || header->file_size != size)
 	{
-		fonts[fonts_amount - 1].characters[i] = malloc(sizeof(character_t));
-		if(fonts[fonts_amount - 1].characters[i] == NULL)
-		{
-			eprintf("%s: Failed to allocate glyph\n", name);
-			
-			font_util_remove(name);
-			
-			// errno set by malloc
-			
-			return -1;
-		}
+		goto reject;
 	}
 	
-	// retrieve character informations
-	fonts[fonts_amount - 1].ascender = 0;
-	fonts[fonts_amount - 1].descender = 0;
-	char_count = 0;
-	point_count = 0;
-	charcode = FT_Get_First_Char(fonts[fonts_amount - 1].face, &gindex);
-	while(gindex != 0)
+	expected = sizeof(font_util_cache_header_t) + (uint64_t)header->characters * sizeof(font_util_cache_character_t) + (uint64_t)header->coords * sizeof(VGfloat) + header->segments;
+	if(expected != (uint64_t)info.st_size)
 	{
-		error = FT_Load_Glyph(fonts[fonts_amount - 1].face, gindex, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING | FT_LOAD_IGNORE_TRANSFORM);
-		if(error != 0)
+		goto reject;
+	}
+	
+	cached = (const font_util_cache_character_t *)(header + 1);
+	coords = (const VGfloat *)(cached + header->characters);
+	segments = (const VGubyte *)(coords + header->coords);
+	
+	// every path must stay inside the file when it is handed to OpenVG
+	for(i = 0; i < header->characters; i++)
+	{
+		if((uint64_t)cached[i].segments_first + cached[i].segments_amount > header->segments)
 		{
-			eprintf("%s: Failed load glyph: %s\n", name, font_util_get_error(error));
-			
-			continue;
+			goto reject;
 		}
 		
-		// generate outline path and store it into a VGPath
-		glyph_path = vgCreatePath(VG_PATH_FORMAT_STANDARD, VG_PATH_DATATYPE_F, 1.0f, 0.0f, 0, 0, VG_PATH_CAPABILITY_ALL);
-		error = FT_Outline_Decompose(&(fonts[fonts_amount - 1].face->glyph->outline), &outline_functions, (void *)(&glyph_path));
-		if(error != 0)
+		coords_end = cached[i].coords_first;
+		for(j = 0; j < cached[i].segments_amount; j++)
 		{
-			eprintf("%s: Failed to decompose glyph outline: %s\n", name, font_util_get_error(error));
+			count = font_util_cache_segment_coords(segments[cached[i].segments_first + j]);
+			if(count < 0)
+			{
+				goto reject;
+			}
 			
-			vgDestroyPath(glyph_path);
-			
-			continue;
+			coords_end += count;
 		}
-		font_util_outline_decompose_close_path((void *)(&glyph_path));
 		
-		// save character informations
-		fonts[fonts_amount - 1].characters[char_count]->charcode = charcode;
-		fonts[fonts_amount - 1].characters[char_count]->glyph_index = gindex;
-		fonts[fonts_amount - 1].characters[char_count]->path = glyph_path;
-		fonts[fonts_amount - 1].characters[char_count]->width = FONT_UTIL_TO_FLOAT(fonts[fonts_amount - 1].face->glyph->metrics.width);
-		fonts[fonts_amount - 1].characters[char_count]->height = FONT_UTIL_TO_FLOAT(fonts[fonts_amount - 1].face->glyph->metrics.height);
-		fonts[fonts_amount - 1].characters[char_count]->advance_x = FONT_UTIL_TO_FLOAT(fonts[fonts_amount - 1].face->glyph->metrics.horiAdvance);
-		fonts[fonts_amount - 1].characters[char_count]->bearing_x = FONT_UTIL_TO_FLOAT(fonts[fonts_amount - 1].face->glyph->metrics.horiBearingX);
-		fonts[fonts_amount - 1].characters[char_count]->bearing_y = FONT_UTIL_TO_FLOAT(fonts[fonts_amount - 1].face->glyph->metrics.horiBearingY);
-		
-		if(fonts[fonts_amount - 1].characters[char_count]->bearing_y > fonts[fonts_amount - 1].ascender)
+		if(coords_end > header->coords)
 		{
-			fonts[fonts_amount - 1].ascender = fonts[fonts_amount - 1].characters[char_count]->bearing_y;
+			goto reject;
 		}
-		
-		if(fonts[fonts_amount - 1].characters[char_count]->height - fonts[fonts_amount - 1].characters[char_count]->bearing_y > fonts[fonts_amount - 1].descender)
+	}
+	
+	load->font.characters = malloc(header->characters * sizeof(character_t *));
+	load->ranges = malloc(header->characters * 3 * sizeof(long));
+	if(load->font.characters == NULL || load->ranges == NULL)
+	{
+		goto fail;
+	}
+	
+	for(i = 0; i < header->characters; i++)
+	{
+		character = malloc(sizeof(character_t));
+		if(character == NULL)
 		{
-			fonts[fonts_amount - 1].descender = fonts[fonts_amount - 1].characters[char_count]->height - fonts[fonts_amount - 1].characters[char_count]->bearing_y;
+			goto fail;
 		}
 		
-		charcode = FT_Get_Next_Char(fonts[fonts_amount - 1].face, charcode, &gindex);
+		character->charcode = cached[i].charcode;
+		character->glyph_index = cached[i].glyph_index;
+		character->path = VG_INVALID_HANDLE;
+		character->width = cached[i].width;
+		character->height = cached[i].height;
+		character->advance_x = cached[i].advance_x;
+		character->bearing_x = cached[i].bearing_x;
+		character->bearing_y = cached[i].bearing_y;
 		
-		char_count++;
+		load->ranges[i * 3] = cached[i].segments_first;
+		load->ranges[i * 3 + 1] = cached[i].segments_amount;
+		load->ranges[i * 3 + 2] = cached[i].coords_first;
+		load->font.characters[load->font.characters_amount++] = character;
 	}
 	
-	// save kerning availability
-	if(FT_HAS_KERNING(fonts[fonts_amount - 1].face))
+	load->font.ascender = header->ascender;
+	load->font.descender = header->descender;
+	load->font.kerning_available = header->kerning_available ? VG_TRUE : VG_FALSE;
+	
+	// the outlines are uploaded straight from the mapping
+	load->outlines.segments = (VGubyte *)segments;
+	load->outlines.segments_amount = header->segments;
+	load->outlines.coords = (VGfloat *)coords;
+	load->outlines.coords_amount = header->coords;
+	load->map = map;
+	load->map_size = info.st_size;
+	
+	pthread_mutex_lock(&font_library_mutex);
+	font_cache_stats.hits++;
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	return 0;
+	
+reject:
+	eprintf("%s: Ignoring outdated or damaged font cache file.\n", file);
+	
+	pthread_mutex_lock(&font_library_mutex);
+	font_cache_stats.rejected++;
+	pthread_mutex_unlock(&font_library_mutex);
+	
+fail:
+	for(i = 0; i < (uint32_t)load->font.characters_amount; i++)
 	{
-		fonts[fonts_amount - 1].kerning_available = VG_TRUE;
+		free(load->font.characters[i]);
 	}
-	else
+	
+	free(load->font.characters);
+	free(load->ranges);
+	load->font.characters = NULL;
+	load->font.characters_amount = 0;
+	load->ranges = NULL;
+	
+	if(map != NULL)
 	{
-		fonts[fonts_amount - 1].kerning_available = VG_FALSE;
+		munmap(map, info.st_size);
 	}
 	
-	return 0;
+	pthread_mutex_lock(&font_library_mutex);
+	font_cache_stats.misses++;
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	return -1;
 }
 
 /**
- * Removes a registered font from the font list.
- * @param name The name of the font.
- * @return Returns 0 on success, else it returns -1. On error sometimes an
- *          errno is set or a error message is printed on log output.
+ * Returns the cache file of a font file if the cache is enabled.
+ * @param path The path of the font file.
+ * @param hash The hash of the font file is written to this pointer.
+ * @param size The size of the font file is written to this pointer.
+ * @return The path of the cache file, freed by the caller, or NULL.
  */
-int font_util_remove(char *name)
+static char *font_util_cache_file(const char *path, uint64_t *hash, uint64_t *size)
 {
-	int i = 0;
-	int fonts_index = 0;
+	char *dir = NULL;
+	char *file = NULL;
 	
-	if(fonts == NULL)
+	pthread_mutex_lock(&font_library_mutex);
+	dir = font_cache_dir ? strdup(font_cache_dir) : NULL;
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	if(dir == NULL || font_util_cache_hash(path, hash, size) != 0)
 	{
-		return -1;
+		free(dir);
+		
+		return NULL;
 	}
 	
-	fonts_index = font_util_get(name);
+	file = malloc(strlen(dir) + 23);
+	if(file != NULL)
+	{
+		sprintf(file, "%s/%016llx.vgfc", dir, (unsigned long long)*hash);
+	}
 	
-	if(fonts_index < 0)
+	free(dir);
+	
+	return file;
+}
+
+/**
+ * Writes the characters and outlines of a freshly decomposed font to a cache
+ * file. The file is written under a temporary name and renamed, so concurrent
+ * loads never see a partial file. Errors are not fatal, the font is just
+ * decomposed again next time.
+ * @param load The loaded font.
+ * @param file The path of the cache file.
+ * @param hash The hash of the font file.
+ * @param size The size of the font file.
+ */
+static void font_util_cache_write(font_util_load_t *load, const char *file, uint64_t hash, uint64_t size)
+{
+	font_util_cache_header_t header;
+	font_util_cache_character_t cached;
+	character_t *character = NULL;
+	char *temporary = NULL;
+	FILE *stream = NULL;
+	int written = 1;
+	int fd = 0;
+	int i = 0;
+	
+	temporary = malloc(strlen(file) + 8);
+	if(temporary == NULL)
 	{
-		eprintf("Failed to find font face: %s\n", name);
-		
-		return -1;
+		return;
 	}
 	
-	free(fonts[fonts_index].path);
-	free(fonts[fonts_index].name);
+	sprintf(temporary, "%s.XXXXXX", file);
+	fd = mkstemp(temporary);
 	
-	if(fonts[fonts_index].face)
+	// mkstemp() creates private files, other users may start the same fonts
+	if(fd < 0 || fchmod(fd, 0644) != 0 || (stream = fdopen(fd, "wb")) == NULL)
 	{
-		FT_Done_Face(fonts[fonts_index].face);
+		eprintf("%s: Failed to create font cache file: %s\n", temporary, strerror(errno));
 		
-		// free characters
-		for(i = 0; i < fonts[fonts_index].characters_amount; i++)
+		if(fd >= 0)
 		{
-			vgDestroyPath(fonts[fonts_index].characters[i]->path);
-			free(fonts[fonts_index].characters[i]);
+			close(fd);
+			unlink(temporary);
 		}
-		free(fonts[fonts_index].characters);
+		
+		free(temporary);
+		
+		return;
 	}
 	
-	// realign font list
-	for(i = fonts_index; i < fonts_amount - 1; i++)
+	memset(&header, 0, sizeof(font_util_cache_header_t));
+	memcpy(header.magic, "VGFC", 4);
+	header.version = FONT_UTIL_CACHE_VERSION;
+	header.font_size = FONT_UTIL_SIZE;
+	header.characters = load->font.characters_amount;
+	header.hash = hash;
+	header.file_size = size;
+	header.segments = load->outlines.segments_amount;
+	header.coords = load->outlines.coords_amount;
+	header.ascender = load->font.ascender;
+	header.descender = load->font.descender;
+	header.kerning_available = load->font.kerning_available == VG_TRUE;
+	
+	written &= fwrite(&header, sizeof(font_util_cache_header_t), 1, stream) == 1;
+	
+	for(i = 0; i < load->font.characters_amount && written; i++)
 	{
-		fonts[i] = fonts[i + 1];
+		character = load->font.characters[i];
+		
+		cached.charcode = character->charcode;
+		cached.glyph_index = character->glyph_index;
+		cached.width = character->width;
+		cached.height = character->height;
+		cached.advance_x = character->advance_x;
+		cached.bearing_x = character->bearing_x;
+		cached.bearing_y = character->bearing_y;
+		cached.segments_first = load->ranges[i * 3];
+		cached.segments_amount = load->ranges[i * 3 + 1];
+		cached.coords_first = load->ranges[i * 3 + 2];
+		
+		written &= fwrite(&cached, sizeof(font_util_cache_character_t), 1, stream) == 1;
 	}
 	
-	if((--fonts_amount) < 1)
+	if(written && load->outlines.coords_amount > 0)
 	{
-		// font list is empty
-		free(fonts);
-		fonts = NULL;
-		
-		return 0;
+		written &= fwrite(load->outlines.coords, sizeof(VGfloat), load->outlines.coords_amount, stream) == (size_t)load->outlines.coords_amount;
 	}
 	
-	// reallocate font list to the correct
-	fonts = realloc(fonts, fonts_amount * sizeof(font_t));
-	if(fonts == NULL)
+	if(written && load->outlines.segments_amount > 0)
 	{
-		eprintf("Failed to shrink font list.\n");
+		written &= fwrite(load->outlines.segments, sizeof(VGubyte), load->outlines.segments_amount, stream) == (size_t)load->outlines.segments_amount;
+	}
+	
+	written &= fclose(stream) == 0;
+	
+	if(!written || rename(temporary, file) != 0)
+	{
+		eprintf("%s: Failed to write font cache file: %s\n", file, strerror(errno));
 		
-		// errno set by realloc
+		unlink(temporary);
+		free(temporary);
 		
-		return -1;
+		return;
 	}
 	
-	return 0;
+	free(temporary);
+	
+	pthread_mutex_lock(&font_library_mutex);
+	font_cache_stats.written++;
+	pthread_mutex_unlock(&font_library_mutex);
 }
 
 /**
- * Returns the character index of a font.
- * @param fonts_index The font index of a font.
- * @param character The searched character.
- * @return The character index or -1 if the character could not be found.
+ * Frees a loaded font that has not been added to the font list.
+ * @param load The loaded font.
  */
-int font_util_get_char_index(unsigned int fonts_index, char character)
+void font_util_load_free(font_util_load_t *load)
 {
 	int i = 0;
 	
-	if(fonts == NULL)
+	if(load == NULL)
 	{
-		return -1;
+		return;
 	}
 	
-	// loop through characters
-	for(i = 0; i < fonts[fonts_index].characters_amount; i++)
+	if(load->font.face)
 	{
-		if(fonts[fonts_index].characters[i]->charcode == character)
+		pthread_mutex_lock(&font_library_mutex);
+		
+		// faces are gone with the library
+		if(font_library != NULL)
 		{
-			return i;
+			FT_Done_Face(load->font.face);
+		}
+		
+		pthread_mutex_unlock(&font_library_mutex);
+	}
+	
+	for(i = 0; i < load->font.characters_amount; i++)
+	{
+		free(load->font.characters[i]);
+	}
+	
+	free(load->font.characters);
+	free(load->font.path);
+	free(load->ranges);
+	font_util_outlines_free(load);
+	free(load);
+}
+
+/**
+ * Parses a font file and decomposes the outlines of all glyphs into memory.
+ * No OpenVG objects are created, so this function can run on any thread. The
+ * font is usable after font_util_add().
+ * @param path The path of a valid font file. (e.g. TrueType-file)
+ * @return The loaded font or NULL on failure, errno is set then.
+ */
+font_util_load_t *font_util_load(char *path)
+{
+	font_util_load_t *load = NULL;
+	character_t *character = NULL;
+	FT_Error error = 0;
+	FT_Outline_Funcs outline_functions;
+	FT_ULong charcode;
+	FT_UInt gindex;
+	int count = 0;
+	long segments_first = 0;
+	long coords_first = 0;
+	char *cache_file = NULL;
+	uint64_t hash = 0;
+	uint64_t size = 0;
+	
+	outline_functions.move_to = &font_util_outline_decompose_move_to;
+	outline_functions.line_to = &font_util_outline_decompose_line_to;
+	outline_functions.conic_to = &font_util_outline_decompose_conic_to;
+	outline_functions.cubic_to = &font_util_outline_decompose_cubic_to;
+	
+	outline_functions.shift = 0;
+	outline_functions.delta = 0;
+	
+	load = calloc(1, sizeof(font_util_load_t));
+	if(load == NULL)
+	{
+		eprintf("%s: Failed to allocate font.\n", path);
+		
+		// errno set by calloc
+		
+		return NULL;
+	}
+	
+	load->font.path = strdup(path);
+	
+	// faces are created and destroyed under the lock, using them is not shared
+	pthread_mutex_lock(&font_library_mutex);
+	
+	if(font_library == NULL)
+	{
+		pthread_mutex_unlock(&font_library_mutex);
+		
+		free(load->font.path);
+		free(load);
+		
+		errno = ENODEV;
+		
+		return NULL;
+	}
+	
+	font_loads++;
+	error = FT_New_Face(font_library, path, 0, &(load->font.face));
+	
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	if(error != 0)
+	{
+		eprintf("%s: Failed to load font face: %s\n", path, font_util_get_error(error));
+		
+		load->font.face = NULL;
+		
+		errno = EBFONT; // Bad font file format
+		
+		goto fail;
+	}
+	
+	// set character size
+	error = FT_Set_Char_Size(load->font.face, 0, FONT_UTIL_SIZE, 96, 96);
+	if(error != 0)
+	{
+		eprintf("%s: Failed to set font size (char): %s\n", path, font_util_get_error(error));
+		
+		errno = EBFONT;
+		
+		goto fail;
+	}
+	
+	// a cache file replaces the decomposition of all glyphs
+	cache_file = font_util_cache_file(path, &hash, &size);
+	if(cache_file != NULL && font_util_cache_read(load, cache_file, hash, size) == 0)
+	{
+		goto loaded;
+	}
+	
+	// count characters to allocate the character array
+	charcode = FT_Get_First_Char(load->font.face, &gindex);
+	while(gindex != 0)
+	{
+		charcode = FT_Get_Next_Char(load->font.face, charcode, &gindex);
+		
+		count++;
+	}
+	
+	load->font.characters = malloc(count * sizeof(character_t *));
+	load->ranges = malloc(count * 3 * sizeof(long));
+	if(load->font.characters == NULL || load->ranges == NULL)
+	{
+		eprintf("%s: Failed to allocate character array\n", path);
+		
+		// errno set by malloc
+		
+		goto fail;
+	}
+	
+	// retrieve character informations
+	charcode = FT_Get_First_Char(load->font.face, &gindex);
+	for(; gindex != 0; charcode = FT_Get_Next_Char(load->font.face, charcode, &gindex))
+	{
+		error = FT_Load_Glyph(load->font.face, gindex, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING | FT_LOAD_IGNORE_TRANSFORM);
+		if(error != 0)
+		{
+			eprintf("%s: Failed load glyph: %s\n", path, font_util_get_error(error));
+			
+			continue;
+		}
+		
+		character = malloc(sizeof(character_t));
+		if(character == NULL)
+		{
+			eprintf("%s: Failed to allocate glyph\n", path);
+			
+			// errno set by malloc
+			
+			goto fail;
+		}
+		
+		// decompose the outline into the segments of a path
+		segments_first = load->outlines.segments_amount;
+		coords_first = load->outlines.coords_amount;
+		error = FT_Outline_Decompose(&(load->font.face->glyph->outline), &outline_functions, (void *)(&load->outlines));
+		if(error == 0 && font_util_outlines_append(&load->outlines, VG_CLOSE_PATH, NULL, 0) != 0)
+		{
+			error = FT_Err_Out_Of_Memory;
+		}
+		
+		if(error != 0)
+		{
+			eprintf("%s: Failed to decompose glyph outline: %s\n", path, font_util_get_error(error));
+			
+			load->outlines.segments_amount = segments_first;
+			load->outlines.coords_amount = coords_first;
+			free(character);
+			
+			continue;
+		}
+		
+		// save character informations
+		character->charcode = charcode;
+		character->glyph_index = gindex;
+		character->path = VG_INVALID_HANDLE;
+		character->width = FONT_UTIL_TO_FLOAT(load->font.face->glyph->metrics.width);
+		character->height = FONT_UTIL_TO_FLOAT(load->font.face->glyph->metrics.height);
+		character->advance_x = FONT_UTIL_TO_FLOAT(load->font.face->glyph->metrics.horiAdvance);
+		character->bearing_x = FONT_UTIL_TO_FLOAT(load->font.face->glyph->metrics.horiBearingX);
+		character->bearing_y = FONT_UTIL_TO_FLOAT(load->font.face->glyph->metrics.horiBearingY);
+		
+		if(character->bearing_y > load->font.ascender)
+		{
+			load->font.ascender = character->bearing_y;
+		}
+		
+		if(character->height - character->bearing_y > load->font.descender)
+		{
+			load->font.descender = character->height - character->bearing_y;
+		}
+		
+		load->ranges[load->font.characters_amount * 3] = segments_first;
+		load->ranges[load->font.characters_amount * 3 + 1] = load->outlines.segments_amount - segments_first;
+		load->ranges[load->font.characters_amount * 3 + 2] = coords_first;
+		load->font.characters[load->font.characters_amount++] = character;
+	}
+	
+	// save kerning availability
+	load->font.kerning_available = FT_HAS_KERNING(load->font.face) ? VG_TRUE : VG_FALSE;
+	
+	if(cache_file != NULL)
+	{
+		font_util_cache_write(load, cache_file, hash, size);
+	}
+	
+loaded:
+	free(cache_file);
+	
+	pthread_mutex_lock(&font_library_mutex);
+	font_loads--;
+	pthread_cond_signal(&font_loads_cond);
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	return load;
+	
+fail:
+	error = errno;
+	free(cache_file);
+	font_util_load_free(load);
+	
+	pthread_mutex_lock(&font_library_mutex);
+	font_loads--;
+	pthread_cond_signal(&font_loads_cond);
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	errno = error;
+	
+	return NULL;
+}
+
+/**
+ * Creates the glyph paths of a loaded font and registers it in the font list.
+ * The loaded font is freed in any case.
+ * @param load The font returned by font_util_load().
+ * @param name The font name. Fonts in the font list are identified by this font
+ *             name.
+ * @return Returns 0 on success, else it returns -1. On error sometimes an
+ *          errno is set or a error message is printed on log output.
+ */
+int font_util_add(font_util_load_t *load, char *name)
+{
+	font_t *font = NULL;
+	VGPath glyph_path = VG_INVALID_HANDLE;
+	long *range = NULL;
+	int i = 0;
+	
+	if(font_library == NULL)
+	{
+		font_util_load_free(load);
+		
+		return -1;
+	}
+	
+	font = realloc(fonts, (fonts_amount + 1) * sizeof(font_t));
+	if(font == NULL)
+	{
+		eprintf("%s: Failed to grow font list.\n", name);
+		
+		font_util_load_free(load);
+		
+		// errno set by realloc
+		
+		return -1;
+	}
+	
+	fonts = font;
+	font = &fonts[fonts_amount++];
+	*font = load->font;
+	font->name = strdup(name);
+	
+	// one upload per glyph
+	for(i = 0; i < font->characters_amount; i++)
+	{
+		range = &load->ranges[i * 3];
+		glyph_path = vgCreatePath(VG_PATH_FORMAT_STANDARD, VG_PATH_DATATYPE_F, 1.0f, 0.0f, range[1], 0, VG_PATH_CAPABILITY_ALL);
+		vgAppendPathData(glyph_path, range[1], load->outlines.segments + range[0], (const void *)(load->outlines.coords + range[2]));
+		font->characters[i]->path = glyph_path;
+	}
+	
+	// glyph paths in video memory, glyph metrics and names on the heap
+	font->memory_paths = font->characters_amount;
+	font->memory_path_bytes = load->outlines.segments_amount + load->outlines.coords_amount * sizeof(VGfloat);
+	font->memory_heap_bytes = sizeof(font_t) + font->characters_amount * (sizeof(character_t *) + sizeof(character_t)) + strlen(font->path) + strlen(name) + 2;
+	memory_util_alloc(MEMORY_UTIL_PATH, font->memory_path_bytes, font->memory_paths);
+	memory_util_alloc(MEMORY_UTIL_FONT, font->memory_heap_bytes, 1);
+	
+	free(load->ranges);
+	font_util_outlines_free(load);
+	free(load);
+	
+	return 0;
+}
+
+/**
+ * Registers a new font in the font list. This function initializes a given font
+ * file, processes/converts all important informations and stores the data in
+ * the VRAM or the font list.
+ * @param path The path of a valid font file. (e.g. TrueType-file)
+ * @param name The font name. Fonts in the font list are identified by this font
+ *             name.
+ * @return Returns 0 on success, else it returns -1. On error sometimes an
+ *          errno is set or a error message is printed on log output.
+ */
+int font_util_new(char *path, char *name)
+{
+	font_util_load_t *load = font_util_load(path);
+	
+	if(load == NULL)
+	{
+		return -1;
+	}
+	
+	return font_util_add(load, name);
+}
+
+/**
+ * Removes a registered font from the font list.
+ * @param name The name of the font.
+ * @return Returns 0 on success, else it returns -1. On error sometimes an
+ *          errno is set or a error message is printed on log output.
+ */
+int font_util_remove(char *name)
+{
+	int i = 0;
+	int fonts_index = 0;
+	
+	if(fonts == NULL)
+	{
+		return -1;
+	}
+	
+	fonts_index = font_util_get(name);
+	
+	if(fonts_index < 0)
+	{
+		eprintf("Failed to find font face: %s\n", name);
+		
+		return -1;
+	}
+	
+	free(fonts[fonts_index].path);
+	free(fonts[fonts_index].name);
+	
+	if(fonts[fonts_index].memory_heap_bytes)
+	{
+		memory_util_free(MEMORY_UTIL_PATH, fonts[fonts_index].memory_path_bytes, fonts[fonts_index].memory_paths);
+		memory_util_free(MEMORY_UTIL_FONT, fonts[fonts_index].memory_heap_bytes, 1);
+	}
+	
+	if(fonts[fonts_index].face)
+	{
+		font_util_atlas_remove(fonts[fonts_index].face, -1);
+		
+		pthread_mutex_lock(&font_library_mutex);
+		FT_Done_Face(fonts[fonts_index].face);
+		pthread_mutex_unlock(&font_library_mutex);
+		
+		// free characters
+		for(i = 0; i < fonts[fonts_index].characters_amount; i++)
+		{
+			vgDestroyPath(fonts[fonts_index].characters[i]->path);
+			free(fonts[fonts_index].characters[i]);
+		}
+		free(fonts[fonts_index].characters);
+	}
+	
+	// realign font list
+	for(i = fonts_index; i < fonts_amount - 1; i++)
+	{
+		fonts[i] = fonts[i + 1];
+	}
+	
+	if((--fonts_amount) < 1)
+	{
+		// font list is empty
+		free(fonts);
+		fonts = NULL;
+		
+		return 0;
+	}
+	
+	// reallocate font list to the correct
+	fonts = realloc(fonts, fonts_amount * sizeof(font_t));
+	if(fonts == NULL)
+	{
+		eprintf("Failed to shrink font list.\n");
+		
+		// errno set by realloc
+		
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * Returns the character index of a font.
+ * @param fonts_index The font index of a font.
+ * @param character The searched character.
+ * @return The character index or -1 if the character could not be found.
+ */
+int font_util_get_char_index(unsigned int fonts_index, char character)
+{
+	int i = 0;
+	
+	if(fonts == NULL)
+	{
+		return -1;
+	}
+	
+	// loop through characters
+	for(i = 0; i < fonts[fonts_index].characters_amount; i++)
+	{
+		if(fonts[fonts_index].characters[i]->charcode == character)
+		{
+			return i;
 		}
 	}
 	
@@ -776,3 +1487,533 @@ VGfloat font_util_get_descender(unsigned int fonts_index)
 	
 	return fonts[fonts_index].descender;
 }
+
+/**
+ * Sets the largest font size that is filled with glyph bitmaps from the atlas.
+ * Larger text is filled with the glyph outlines. 0 disables the atlas and
+ * frees it.
+ * @param size The font size in pixels.
+ */
+void font_util_atlas_set_size(VGfloat size)
+{
+	if(size <= 0)
+	{
+		font_util_atlas_clear();
+		size = 0;
+	}
+	
+	atlas_size = size;
+}
+
+/**
+ * Returns the largest font size that is filled from the atlas.
+ * @return The font size in pixels, 0 if the atlas is disabled.
+ */
+VGfloat font_util_atlas_get_size(void)
+{
+	return atlas_size;
+}
+
+/**
+ * Removes glyphs from the atlas.
+ * @param face The font face whose glyphs are removed or NULL for all faces.
+ * @param page The page whose glyphs are removed or -1 for all pages.
+ */
+static void font_util_atlas_remove(FT_Face face, int page)
+{
+	font_util_atlas_glyph_t **link = NULL;
+	font_util_atlas_glyph_t *glyph = NULL;
+	int i = 0;
+	
+	for(i = 0; i < FONT_UTIL_ATLAS_BUCKETS; i++)
+	{
+		link = &atlas_glyphs[i];
+		
+		while(*link != NULL)
+		{
+			glyph = *link;
+			
+			if((face != NULL && glyph->face != face) || (page >= 0 && glyph->page != page))
+			{
+				link = &glyph->next;
+				
+				continue;
+			}
+			
+			*link = glyph->next;
+			
+			if(glyph->image != VG_INVALID_HANDLE)
+			{
+				vgDestroyImage(glyph->image);
+				memory_util_free(MEMORY_UTIL_IMAGE, 0, 1);
+				atlas_pages[glyph->page].glyphs--;
+			}
+			
+			memory_util_free(MEMORY_UTIL_FONT, sizeof(font_util_atlas_glyph_t), 0);
+			atlas_stats.glyphs--;
+			free(glyph);
+		}
+	}
+}
+
+/**
+ * Frees all glyphs and pages of the atlas.
+ */
+void font_util_atlas_clear(void)
+{
+	int i = 0;
+	
+	font_util_atlas_remove(NULL, -1);
+	
+	for(i = 0; i < atlas_pages_amount; i++)
+	{
+		vgDestroyImage(atlas_pages[i].image);
+		free(atlas_pages[i].skyline);
+		memory_util_free(MEMORY_UTIL_IMAGE, FONT_UTIL_ATLAS_PAGE_SIZE * FONT_UTIL_ATLAS_PAGE_SIZE, 1);
+		memory_util_free(MEMORY_UTIL_FONT, (FONT_UTIL_ATLAS_PAGE_SIZE + 1) * sizeof(font_util_atlas_node_t), 0);
+	}
+	
+	atlas_pages_amount = 0;
+	atlas_stats.pages = 0;
+}
+
+/**
+ * Empties the skyline of a page.
+ * @param page The page.
+ */
+static void font_util_atlas_reset(font_util_atlas_page_t *page)
+{
+	page->skyline[0].x = 0;
+	page->skyline[0].y = 0;
+	page->skyline[0].width = FONT_UTIL_ATLAS_PAGE_SIZE;
+	page->nodes = 1;
+	page->glyphs = 0;
+}
+
+/**
+ * Creates a new atlas page.
+ * @return The page index or -1 on failure.
+ */
+static int font_util_atlas_create_page(void)
+{
+	font_util_atlas_page_t *page = &atlas_pages[atlas_pages_amount];
+	
+	page->skyline = malloc((FONT_UTIL_ATLAS_PAGE_SIZE + 1) * sizeof(font_util_atlas_node_t));
+	if(page->skyline == NULL)
+	{
+		eprintf("Failed to allocate atlas page.\n");
+		
+		return -1;
+	}
+	
+	page->image = vgCreateImage(VG_A_8, FONT_UTIL_ATLAS_PAGE_SIZE, FONT_UTIL_ATLAS_PAGE_SIZE, VG_IMAGE_QUALITY_NONANTIALIASED);
+	if(page->image == VG_INVALID_HANDLE)
+	{
+		eprintf("Failed to create atlas page image.\n");
+		
+		free(page->skyline);
+		
+		return -1;
+	}
+	
+	memory_util_alloc(MEMORY_UTIL_IMAGE, FONT_UTIL_ATLAS_PAGE_SIZE * FONT_UTIL_ATLAS_PAGE_SIZE, 1);
+	memory_util_alloc(MEMORY_UTIL_FONT, (FONT_UTIL_ATLAS_PAGE_SIZE + 1) * sizeof(font_util_atlas_node_t), 0);
+	
+	font_util_atlas_reset(page);
+	page->last_use = atlas_clock;
+	atlas_stats.pages++;
+	
+	return atlas_pages_amount++;
+}
+
+/**
+ * Returns the lowest y at which a rectangle fits on the skyline starting at a
+ * node.
+ * @param page The page.
+ * @param index The node the rectangle starts at.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @return The y coordinate or -1 if the rectangle does not fit.
+ */
+static VGint font_util_atlas_fit(font_util_atlas_page_t *page, int index, VGint width, VGint height)
+{
+	VGint y = 0;
+	VGint remaining = width;
+	
+	if(page->skyline[index].x + width > FONT_UTIL_ATLAS_PAGE_SIZE)
+	{
+		return -1;
+	}
+	
+	while(remaining > 0)
+	{
+		if(page->skyline[index].y > y)
+		{
+			y = page->skyline[index].y;
+		}
+		
+		if(y + height > FONT_UTIL_ATLAS_PAGE_SIZE)
+		{
+			return -1;
+		}
+		
+		remaining -= page->skyline[index].width;
+		index++;
+	}
+	
+	return y;
+}
+
+/**
+ * Packs a rectangle onto a page with the bottom left skyline heuristic.
+ * @param page The page.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @param x The x coordinate of the packed rectangle.
+ * @param y The y coordinate of the packed rectangle.
+ * @return 0 on success or -1 if the page is full.
+ */
+static int font_util_atlas_pack(font_util_atlas_page_t *page, VGint width, VGint height, VGint *x, VGint *y)
+{
+	int best = -1;
+	VGint best_top = FONT_UTIL_ATLAS_PAGE_SIZE + 1;
+	VGint best_width = 0;
+	VGint fit = 0;
+	VGint shrink = 0;
+	int i = 0;
+	
+	for(i = 0; i < page->nodes; i++)
+	{
+		fit = font_util_atlas_fit(page, i, width, height);
+		
+		if(fit >= 0 && (fit + height < best_top || (fit + height == best_top && page->skyline[i].width < best_width)))
+		{
+			best = i;
+			best_top = fit + height;
+			best_width = page->skyline[i].width;
+		}
+	}
+	
+	if(best < 0)
+	{
+		return -1;
+	}
+	
+	*x = page->skyline[best].x;
+	*y = best_top - height;
+	
+	// the new node covers the rectangle, the nodes below it shrink or vanish
+	memmove(&page->skyline[best + 1], &page->skyline[best], (page->nodes - best) * sizeof(font_util_atlas_node_t));
+	page->skyline[best].x = *x;
+	page->skyline[best].y = best_top;
+	page->skyline[best].width = width;
+	page->nodes++;
+	
+	i = best + 1;
+	while(i < page->nodes)
+	{
+		shrink = page->skyline[i - 1].x + page->skyline[i - 1].width - page->skyline[i].x;
+		
+		if(shrink <= 0)
+		{
+			break;
+		}
+		
+		if(page->skyline[i].width > shrink)
+		{
+			page->skyline[i].x += shrink;
+			page->skyline[i].width -= shrink;
+			
+			break;
+		}
+		
+		memmove(&page->skyline[i], &page->skyline[i + 1], (page->nodes - i - 1) * sizeof(font_util_atlas_node_t));
+		page->nodes--;
+	}
+	
+	// merge neighbours of the same height
+	i = 0;
+	while(i < page->nodes - 1)
+	{
+		if(page->skyline[i].y == page->skyline[i + 1].y)
+		{
+			page->skyline[i].width += page->skyline[i + 1].width;
+			memmove(&page->skyline[i + 1], &page->skyline[i + 2], (page->nodes - i - 2) * sizeof(font_util_atlas_node_t));
+			page->nodes--;
+		}
+		else
+		{
+			i++;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * Finds space for a glyph bitmap. Pages are added up to the maximum, then the
+ * least recently used page is cleared.
+ * @param width The width of the bitmap.
+ * @param height The height of the bitmap.
+ * @param x The x coordinate of the space.
+ * @param y The y coordinate of the space.
+ * @return The page index or -1 if the bitmap does not fit.
+ */
+static int font_util_atlas_allocate(VGint width, VGint height, VGint *x, VGint *y)
+{
+	int page = 0;
+	int i = 0;
+	
+	for(i = 0; i < atlas_pages_amount; i++)
+	{
+		if(font_util_atlas_pack(&atlas_pages[i], width, height, x, y) == 0)
+		{
+			return i;
+		}
+	}
+	
+	if(atlas_pages_amount < FONT_UTIL_ATLAS_PAGES)
+	{
+		page = font_util_atlas_create_page();
+	}
+	else
+	{
+		for(i = 1; i < atlas_pages_amount; i++)
+		{
+			if(atlas_pages[i].last_use < atlas_pages[page].last_use)
+			{
+				page = i;
+			}
+		}
+		
+		font_util_atlas_remove(NULL, page);
+		font_util_atlas_reset(&atlas_pages[page]);
+		atlas_stats.evicted++;
+	}
+	
+	if(page < 0 || font_util_atlas_pack(&atlas_pages[page], width, height, x, y) != 0)
+	{
+		return -1;
+	}
+	
+	return page;
+}
+
+/**
+ * Rasterizes a glyph with FreeType and packs it into the atlas.
+ * @param glyph The glyph, its face, glyph index and size are set.
+ * @return 0 on success or -1 on failure.
+ */
+static int font_util_atlas_render(font_util_atlas_glyph_t *glyph)
+{
+	FT_Bitmap *bitmap = NULL;
+	VGint x = 0;
+	VGint y = 0;
+	int error = 0;
+	int result = -1;
+	
+	glyph->page = -1;
+	glyph->image = VG_INVALID_HANDLE;
+	glyph->left = 0;
+	glyph->bottom = 0;
+	
+	error = FT_Set_Char_Size(glyph->face, 0, glyph->size, 96, 96);
+	if(error == 0)
+	{
+		error = FT_Load_Glyph(glyph->face, glyph->glyph_index, FT_LOAD_TARGET_LIGHT);
+	}
+	
+	if(error == 0)
+	{
+		error = FT_Render_Glyph(glyph->face->glyph, FT_RENDER_MODE_LIGHT);
+	}
+	
+	bitmap = &glyph->face->glyph->bitmap;
+	
+	if(error != 0)
+	{
+		eprintf("Failed to render glyph: %s\n", font_util_get_error(error));
+	}
+	else if(bitmap->width == 0 || bitmap->rows == 0)
+	{
+		result = 0;
+	}
+	else if(bitmap->pixel_mode == FT_PIXEL_MODE_GRAY)
+	{
+		// one pixel apart, no sampling of the neighbours
+		glyph->page = font_util_atlas_allocate(bitmap->width + 1, bitmap->rows + 1, &x, &y);
+		
+		if(glyph->page >= 0)
+		{
+			// bitmaps are stored top down, images bottom up
+			vgImageSubData(atlas_pages[glyph->page].image, bitmap->buffer + (bitmap->rows - 1) * bitmap->pitch, -bitmap->pitch, VG_A_8, x, y, bitmap->width, bitmap->rows);
+			glyph->image = vgChildImage(atlas_pages[glyph->page].image, x, y, bitmap->width, bitmap->rows);
+		}
+		
+		if(glyph->image != VG_INVALID_HANDLE)
+		{
+			glyph->left = glyph->face->glyph->bitmap_left;
+			glyph->bottom = glyph->face->glyph->bitmap_top - bitmap->rows;
+			
+			memory_util_alloc(MEMORY_UTIL_IMAGE, 0, 1);
+			atlas_pages[glyph->page].glyphs++;
+			result = 0;
+		}
+	}
+	
+	// kerning is read at the outline size
+	FT_Set_Char_Size(glyph->face, 0, FONT_UTIL_SIZE, 96, 96);
+	
+	return result;
+}
+
+/**
+ * Returns the atlas image of a glyph at a font size. The glyph is rasterized
+ * on first use.
+ * @param fonts_index The font index of a font.
+ * @param char_index The character index of a character.
+ * @param size The font size.
+ * @param image The glyph image, VG_INVALID_HANDLE if the glyph has no pixels.
+ * @param left The distance of the left edge of the image from the pen position
+ *             in pixels.
+ * @param bottom The distance of the bottom edge of the image from the baseline
+ *               in pixels, upwards.
+ * @return 0 on success or -1 if the glyph could not be rasterized.
+ */
+int font_util_atlas_get_glyph(unsigned int fonts_index, int char_index, VGfloat size, VGImage *image, VGint *left, VGint *bottom)
+{
+	font_util_atlas_glyph_t *glyph = NULL;
+	FT_Face face = NULL;
+	FT_UInt glyph_index = 0;
+	FT_F26Dot6 char_size = (FT_F26Dot6)(size * 64 + 0.5f);
+	unsigned int bucket = 0;
+	
+	if(fonts == NULL || char_index == -1 || char_size <= 0)
+	{
+		return -1;
+	}
+	
+	face = fonts[fonts_index].face;
+	glyph_index = fonts[fonts_index].characters[char_index]->glyph_index;
+	bucket = ((unsigned int)((size_t)face >> 4) * 31 + glyph_index * 131 + (unsigned int)char_size * 7) % FONT_UTIL_ATLAS_BUCKETS;
+	atlas_clock++;
+	
+	for(glyph = atlas_glyphs[bucket]; glyph != NULL; glyph = glyph->next)
+	{
+		if(glyph->face == face && glyph->glyph_index == glyph_index && glyph->size == char_size)
+		{
+			break;
+		}
+	}
+	
+	if(glyph != NULL)
+	{
+		atlas_stats.hits++;
+	}
+	else
+	{
+		atlas_stats.misses++;
+		
+		glyph = malloc(sizeof(font_util_atlas_glyph_t));
+		if(glyph == NULL)
+		{
+			eprintf("Failed to allocate atlas glyph.\n");
+			
+			return -1;
+		}
+		
+		glyph->face = face;
+		glyph->glyph_index = glyph_index;
+		glyph->size = char_size;
+		
+		if(font_util_atlas_render(glyph) != 0)
+		{
+			free(glyph);
+			
+			return -1;
+		}
+		
+		glyph->next = atlas_glyphs[bucket];
+		atlas_glyphs[bucket] = glyph;
+		memory_util_alloc(MEMORY_UTIL_FONT, sizeof(font_util_atlas_glyph_t), 0);
+		atlas_stats.glyphs++;
+	}
+	
+	if(glyph->page >= 0)
+	{
+		atlas_pages[glyph->page].last_use = atlas_clock;
+	}
+	
+	*image = glyph->image;
+	*left = glyph->left;
+	*bottom = glyph->bottom;
+	
+	return 0;
+}
+
+/**
+ * Returns the counters of the glyph atlas.
+ * @param stats The structure the counters are copied to.
+ */
+void font_util_atlas_get_stats(font_util_atlas_stats_t *stats)
+{
+	*stats = atlas_stats;
+}
+
+/**
+ * Sets the directory of the glyph outline cache. Fonts loaded afterwards are
+ * read from a cache file if there is one for the exact font file, else the
+ * cache file is written after decomposing the glyphs.
+ * @param dir The directory, it is created if missing. NULL or an empty string
+ *            disables the cache.
+ * @return 0 on success or -1 if the directory can't be used, errno is set.
+ */
+int font_util_cache_set_dir(char *dir)
+{
+	char *copy = NULL;
+	
+	if(dir != NULL && dir[0] != '\0')
+	{
+		if(mkdir(dir, 0755) != 0 && errno != EEXIST)
+		{
+			eprintf("%s: Failed to create font cache directory: %s\n", dir, strerror(errno));
+			
+			return -1;
+		}
+		
+		copy = strdup(dir);
+		if(copy == NULL)
+		{
+			// errno set by strdup
+			
+			return -1;
+		}
+	}
+	
+	pthread_mutex_lock(&font_library_mutex);
+	free(font_cache_dir);
+	font_cache_dir = copy;
+	pthread_mutex_unlock(&font_library_mutex);
+	
+	return 0;
+}
+
+/**
+ * Returns the directory of the glyph outline cache.
+ * @return The directory or NULL if the cache is disabled.
+ */
+char *font_util_cache_get_dir(void)
+{
+	return font_cache_dir;
+}
+
+/**
+ * Returns the counters of the glyph outline cache.
+ * @param stats The structure the counters are copied to.
+ */
+void font_util_cache_get_stats(font_util_cache_stats_t *stats)
+{
+	pthread_mutex_lock(&font_library_mutex);
+	*stats = font_cache_stats;
+	pthread_mutex_unlock(&font_library_mutex);
+}
@@ -46,17 +46,52 @@ typedef struct font_t
 	VGboolean kerning_available;
 	VGfloat ascender;
 	VGfloat descender;
+	long memory_paths;
+	long long memory_path_bytes;
+	long long memory_heap_bytes;
 } font_t;
 
 #define FONT_UTIL_SIZE 64 * 64 * 64
 #define FONT_UTIL_TO_FLOAT(ft_size) ((float)(ft_size) / (FONT_UTIL_SIZE))
 
+// glyph bitmaps of small text are packed into alpha images of this size
+#define FONT_UTIL_ATLAS_PAGE_SIZE 512
+// the least recently used page is cleared when all pages are full
+#define FONT_UTIL_ATLAS_PAGES 4
+#define FONT_UTIL_ATLAS_BUCKETS 1024
+
+// bumped whenever the outline cache file layout or the decomposition changes
+#define FONT_UTIL_CACHE_VERSION 1
+
+// a font parsed by font_util_load(), not yet in the font list
+typedef struct font_util_load_t font_util_load_t;
+
+typedef struct font_util_atlas_stats_t
+{
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long evicted;
+	long pages;
+	long glyphs;
+} font_util_atlas_stats_t;
+
+typedef struct font_util_cache_stats_t
+{
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long written;
+	unsigned long rejected;
+} font_util_cache_stats_t;
+
 int font_util_get(char *name);
 char *font_util_get_name(unsigned int fonts_index);
 int font_util_init(void);
 char *font_util_version(void);
 void font_util_cleanup(void);
 int font_util_new(char *path, char *name);
+font_util_load_t *font_util_load(char *path);
+int font_util_add(font_util_load_t *load, char *name);
+void font_util_load_free(font_util_load_t *load);
 int font_util_remove(char *name);
 int font_util_get_char_index(unsigned int fonts_index, char character);
 VGPath font_util_get_path(unsigned int fonts_index, int char_index);
@@ -69,5 +104,13 @@ VGboolean font_util_get_kerning_availability(unsigned int fonts_index);
 VGfloat font_util_get_kerning_x(unsigned int fonts_index, char character, char character_next);
 VGfloat font_util_get_ascender(unsigned int fonts_index);
 VGfloat font_util_get_descender(unsigned int fonts_index);
+void font_util_atlas_set_size(VGfloat size);
+VGfloat font_util_atlas_get_size(void);
+int font_util_atlas_get_glyph(unsigned int fonts_index, int char_index, VGfloat size, VGImage *image, VGint *left, VGint *bottom);
+void font_util_atlas_clear(void);
+void font_util_atlas_get_stats(font_util_atlas_stats_t *stats);
+int font_util_cache_set_dir(char *dir);
+char *font_util_cache_get_dir(void);
+void font_util_cache_get_stats(font_util_cache_stats_t *stats);
 
 #endif /* __FONT_UTIL_H__ */
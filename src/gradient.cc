@@ -31,15 +31,18 @@ namespace vgcanvas {
 	}
 	
 	Gradient::~Gradient() {
+		present_util_acquire();
 		paint_cleanup(&paint);
 	}
 	
 	void Gradient::Init(Local<Object> exports) {
-		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Gradient::New);
+		RegisterEntry<Gradient::New>("Gradient");
+		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Guard<Gradient::New>);
 		tpl->SetClassName(Nan::New("Gradient").ToLocalChecked());
 		tpl->InstanceTemplate()->SetInternalFieldCount(1);
 		
-		Nan::SetPrototypeMethod(tpl, "addColorStopRGBA", Gradient::AddColorStop);
+		RegisterEntry<Gradient::AddColorStop>("Gradient.addColorStopRGBA");
+		Nan::SetPrototypeMethod(tpl, "addColorStopRGBA", Guard<Gradient::AddColorStop>);
 		
 		constructor.Reset(tpl->GetFunction());
 		exports->Set(Nan::New("Gradient").ToLocalChecked(), tpl->GetFunction());
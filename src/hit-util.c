@@ -0,0 +1,587 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "log-util.h"
+#include "context-util.h"
+#include "path-util.h"
+#include "hit-util.h"
+
+/*
+ * Hit regions are the fill geometry of the current path at the time they are
+ * added, flattened and transformed into surface coordinates. A uniform grid
+ * over the surface lists the regions touching every cell in the order they
+ * were added, so a hit test only visits the regions of one cell from the top
+ * down. Adding or removing a region only touches its own cells; removed
+ * regions are dropped from the grid once they make up half of it. Regions are
+ * found by id through an open addressing table.
+ */
+
+#define HIT_UTIL_CELL_SIZE 32
+#define HIT_UTIL_COMPACT_MIN 64
+
+typedef struct hit_util_region_t
+{
+	char *id;
+	unsigned int hash;
+	VGFillRule fill_rule;
+	// surface bounds (min x, min y, max x, max y) and edges (x0, y0, x1, y1 each)
+	VGfloat bounds[4];
+	VGfloat *edges;
+	VGint edges_count;
+	int removed;
+} hit_util_region_t;
+
+typedef struct hit_util_cell_t
+{
+	VGint *regions;
+	VGint count;
+	VGint size;
+} hit_util_cell_t;
+
+typedef struct hit_util_t
+{
+	// regions in the order they were added, removed ones stay until the next compaction
+	hit_util_region_t *regions;
+	VGint regions_count;
+	VGint regions_size;
+	VGint removed;
+	
+	// index + 1 of the region of every id, 0 marks a free slot
+	VGint *table;
+	VGint table_size;
+	VGint table_used;
+	
+	hit_util_cell_t *cells;
+	VGint columns;
+	VGint rows;
+} hit_util_t;
+
+/**
+ * Returns the hit regions of the current context.
+ * @return The hit regions or NULL on failure.
+ */
+static hit_util_t *hit_util__get(void)
+{
+	canvas_context_t *context = context_util_get();
+	hit_util_t *hit = context->hit_regions;
+	
+	if(hit != NULL)
+	{
+		return hit;
+	}
+	
+	hit = calloc(1, sizeof(hit_util_t));
+	
+	if(hit == NULL)
+	{
+		eprintf("Failed to allocate hit regions.\n");
+		
+		return NULL;
+	}
+	
+	hit->columns = (context->surface_width + HIT_UTIL_CELL_SIZE - 1) / HIT_UTIL_CELL_SIZE;
+	hit->rows = (context->surface_height + HIT_UTIL_CELL_SIZE - 1) / HIT_UTIL_CELL_SIZE;
+	hit->columns = hit->columns < 1 ? 1 : hit->columns;
+	hit->rows = hit->rows < 1 ? 1 : hit->rows;
+	hit->cells = calloc(hit->columns * hit->rows, sizeof(hit_util_cell_t));
+	
+	if(hit->cells == NULL)
+	{
+		eprintf("Failed to allocate hit regions.\n");
+		free(hit);
+		
+		return NULL;
+	}
+	
+	context->hit_regions = hit;
+	
+	return hit;
+}
+
+/**
+ * Hashes an id (FNV-1a).
+ */
+static unsigned int hit_util__hash(const char *id)
+{
+	unsigned int hash = 2166136261u;
+	
+	while(*id != '\0')
+	{
+		hash = (hash ^ (unsigned char)*id++) * 16777619u;
+	}
+	
+	return hash;
+}
+
+/**
+ * Finds the region with an id which has not been removed.
+ * @return The index of the region or -1 if there is none.
+ */
+static VGint hit_util__find(const hit_util_t *hit, const char *id, unsigned int hash)
+{
+	const hit_util_region_t *region = NULL;
+	VGint slot = 0;
+	
+	if(hit->table_size == 0)
+	{
+		return -1;
+	}
+	
+	for(slot = hash & (hit->table_size - 1); hit->table[slot] != 0; slot = (slot + 1) & (hit->table_size - 1))
+	{
+		region = &hit->regions[hit->table[slot] - 1];
+		
+		if(!region->removed && region->hash == hash && strcmp(region->id, id) == 0)
+		{
+			return hit->table[slot] - 1;
+		}
+	}
+	
+	return -1;
+}
+
+/**
+ * Rebuilds the id table from the regions which have not been removed, with
+ * room for at least the given amount of regions.
+ * @return 0 on success, -1 on failure
+ */
+static int hit_util__rehash(hit_util_t *hit, VGint regions)
+{
+	VGint size = 64;
+	VGint *table = NULL;
+	VGint slot = 0;
+	VGint i = 0;
+	
+	while(size < regions * 2)
+	{
+		size *= 2;
+	}
+	
+	table = calloc(size, sizeof(VGint));
+	
+	if(table == NULL)
+	{
+		eprintf("Failed to allocate hit region table.\n");
+		
+		return -1;
+	}
+	
+	free(hit->table);
+	hit->table = table;
+	hit->table_size = size;
+	hit->table_used = 0;
+	
+	for(i = 0; i < hit->regions_count; i++)
+	{
+		if(hit->regions[i].removed)
+		{
+			continue;
+		}
+		
+		for(slot = hit->regions[i].hash & (size - 1); table[slot] != 0; slot = (slot + 1) & (size - 1));
+		
+		table[slot] = i + 1;
+		hit->table_used++;
+	}
+	
+	return 0;
+}
+
+/**
+ * Returns the range of cells covered by surface bounds.
+ * @return 0 if the bounds do not touch the surface, 1 otherwise
+ */
+static int hit_util__range(const hit_util_t *hit, const VGfloat *bounds, VGint *range)
+{
+	if(!(bounds[2] >= 0 && bounds[3] >= 0 && bounds[0] < hit->columns * HIT_UTIL_CELL_SIZE && bounds[1] < hit->rows * HIT_UTIL_CELL_SIZE))
+	{
+		return 0;
+	}
+	
+	range[0] = bounds[0] < 0 ? 0 : (VGint)(bounds[0] / HIT_UTIL_CELL_SIZE);
+	range[1] = bounds[1] < 0 ? 0 : (VGint)(bounds[1] / HIT_UTIL_CELL_SIZE);
+	range[2] = (VGint)(bounds[2] / HIT_UTIL_CELL_SIZE);
+	range[3] = (VGint)(bounds[3] / HIT_UTIL_CELL_SIZE);
+	range[2] = range[2] >= hit->columns ? hit->columns - 1 : range[2];
+	range[3] = range[3] >= hit->rows ? hit->rows - 1 : range[3];
+	
+	return 1;
+}
+
+/**
+ * Adds a region to the cells it touches, on top of the regions already there.
+ * @return 0 on success, -1 on failure
+ */
+static int hit_util__insert(hit_util_t *hit, VGint index)
+{
+	hit_util_cell_t *cell = NULL;
+	VGint *resized = NULL;
+	VGint range[4];
+	VGint column = 0;
+	VGint row = 0;
+	
+	if(!hit_util__range(hit, hit->regions[index].bounds, range))
+	{
+		return 0;
+	}
+	
+	for(row = range[1]; row <= range[3]; row++)
+	{
+		for(column = range[0]; column <= range[2]; column++)
+		{
+			cell = &hit->cells[row * hit->columns + column];
+			
+			if(cell->count == cell->size)
+			{
+				resized = realloc(cell->regions, (cell->size > 0 ? cell->size * 2 : 8) * sizeof(VGint));
+				
+				if(resized == NULL)
+				{
+					eprintf("Failed to allocate hit region cell.\n");
+					
+					return -1;
+				}
+				
+				cell->regions = resized;
+				cell->size = cell->size > 0 ? cell->size * 2 : 8;
+			}
+			
+			cell->regions[cell->count++] = index;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * Drops removed regions from the regions, the cells and the id table.
+ * @return 0 on success, -1 on failure
+ */
+static int hit_util__compact(hit_util_t *hit)
+{
+	VGint count = 0;
+	VGint i = 0;
+	
+	for(i = 0; i < hit->regions_count; i++)
+	{
+		if(hit->regions[i].removed)
+		{
+			free(hit->regions[i].id);
+			free(hit->regions[i].edges);
+			
+			continue;
+		}
+		
+		hit->regions[count++] = hit->regions[i];
+	}
+	
+	hit->regions_count = count;
+	hit->removed = 0;
+	
+	for(i = 0; i < hit->columns * hit->rows; i++)
+	{
+		hit->cells[i].count = 0;
+	}
+	
+	for(i = 0; i < hit->regions_count; i++)
+	{
+		if(hit_util__insert(hit, i) == -1)
+		{
+			return -1;
+		}
+	}
+	
+	return hit_util__rehash(hit, hit->regions_count);
+}
+
+/**
+ * Marks a region as removed. Its cells skip it until the next compaction.
+ */
+static void hit_util__remove(hit_util_t *hit, VGint index)
+{
+	hit_util_region_t *region = &hit->regions[index];
+	
+	region->removed = 1;
+	free(region->edges);
+	region->edges = NULL;
+	region->edges_count = 0;
+	hit->removed++;
+	
+	if(hit->removed >= HIT_UTIL_COMPACT_MIN && hit->removed * 2 >= hit->regions_count)
+	{
+		hit_util__compact(hit);
+	}
+}
+
+/**
+ * Adds the current path as hit region on top of the existing ones. It covers
+ * the area fill() would cover with the given fill rule under the current
+ * transformation. A region with the same id is replaced.
+ * @param id The id returned by hit tests of the region.
+ * @param fill_rule VG_NON_ZERO or VG_EVEN_ODD
+ * @return 0 on success, -1 on failure
+ */
+int hit_util_add(const char *id, VGFillRule fill_rule)
+{
+	hit_util_t *hit = hit_util__get();
+	hit_util_region_t *region = NULL;
+	hit_util_region_t *resized = NULL;
+	unsigned int hash = hit_util__hash(id);
+	VGint index = 0;
+	VGint slot = 0;
+	VGint i = 0;
+	
+	if(hit == NULL)
+	{
+		return -1;
+	}
+	
+	index = hit_util__find(hit, id, hash);
+	
+	if(index != -1)
+	{
+		hit_util__remove(hit, index);
+	}
+	
+	if(hit->regions_count == hit->regions_size)
+	{
+		resized = realloc(hit->regions, (hit->regions_size > 0 ? hit->regions_size * 2 : 64) * sizeof(hit_util_region_t));
+		
+		if(resized == NULL)
+		{
+			eprintf("Failed to allocate hit region.\n");
+			
+			return -1;
+		}
+		
+		hit->regions = resized;
+		hit->regions_size = hit->regions_size > 0 ? hit->regions_size * 2 : 64;
+	}
+	
+	if((hit->table_used + 1) * 2 > hit->table_size && hit_util__rehash(hit, hit->regions_count - hit->removed + 1) == -1)
+	{
+		return -1;
+	}
+	
+	region = &hit->regions[hit->regions_count];
+	memset(region, 0, sizeof(hit_util_region_t));
+	region->edges = path_util_get_fill_edges(&region->edges_count);
+	
+	// an empty path only removes the region with the id
+	if(region->edges_count == 0)
+	{
+		free(region->edges);
+		
+		return 0;
+	}
+	
+	region->id = strdup(id);
+	
+	if(region->id == NULL)
+	{
+		eprintf("Failed to allocate hit region.\n");
+		free(region->edges);
+		
+		return -1;
+	}
+	
+	region->hash = hash;
+	region->fill_rule = fill_rule;
+	region->bounds[0] = region->bounds[2] = region->edges[0];
+	region->bounds[1] = region->bounds[3] = region->edges[1];
+	
+	for(i = 0; i < region->edges_count * 4; i += 2)
+	{
+		region->bounds[0] = fminf(region->bounds[0], region->edges[i]);
+		region->bounds[1] = fminf(region->bounds[1], region->edges[i + 1]);
+		region->bounds[2] = fmaxf(region->bounds[2], region->edges[i]);
+		region->bounds[3] = fmaxf(region->bounds[3], region->edges[i + 1]);
+	}
+	
+	index = hit->regions_count++;
+	
+	for(slot = hash & (hit->table_size - 1); hit->table[slot] != 0; slot = (slot + 1) & (hit->table_size - 1));
+	
+	hit->table[slot] = index + 1;
+	hit->table_used++;
+	
+	return hit_util__insert(hit, index);
+}
+
+/**
+ * Removes the hit region with an id.
+ * @param id The id of the region.
+ */
+void hit_util_remove(const char *id)
+{
+	hit_util_t *hit = context_util_get()->hit_regions;
+	VGint index = 0;
+	
+	if(hit == NULL)
+	{
+		return;
+	}
+	
+	index = hit_util__find(hit, id, hit_util__hash(id));
+	
+	if(index != -1)
+	{
+		hit_util__remove(hit, index);
+	}
+}
+
+/**
+ * Removes all hit regions of the current context.
+ */
+void hit_util_clear(void)
+{
+	hit_util_t *hit = context_util_get()->hit_regions;
+	VGint i = 0;
+	
+	if(hit == NULL)
+	{
+		return;
+	}
+	
+	for(i = 0; i < hit->regions_count; i++)
+	{
+		free(hit->regions[i].id);
+		free(hit->regions[i].edges);
+	}
+	
+	for(i = 0; i < hit->columns * hit->rows; i++)
+	{
+		hit->cells[i].count = 0;
+	}
+	
+	hit->regions_count = 0;
+	hit->removed = 0;
+	hit->table_used = 0;
+	
+	if(hit->table != NULL)
+	{
+		memset(hit->table, 0, hit->table_size * sizeof(VGint));
+	}
+}
+
+/**
+ * Tests whether a point in surface coordinates is inside a region.
+ * @return 1 if the point is inside, 0 otherwise
+ */
+static int hit_util__inside(const hit_util_region_t *region, VGfloat x, VGfloat y)
+{
+	const VGfloat *edge = region->edges;
+	VGint winding = 0;
+	VGint i = 0;
+	
+	if(!(x >= region->bounds[0] && x <= region->bounds[2] && y >= region->bounds[1] && y <= region->bounds[3]))
+	{
+		return 0;
+	}
+	
+	// count the edges crossing a ray from the point to the right
+	for(i = 0; i < region->edges_count; i++, edge += 4)
+	{
+		if((edge[1] <= y) != (edge[3] <= y) && edge[0] + (y - edge[1]) * (edge[2] - edge[0]) / (edge[3] - edge[1]) > x)
+		{
+			winding += edge[3] > edge[1] ? 1 : -1;
+		}
+	}
+	
+	return region->fill_rule == VG_EVEN_ODD ? (winding & 1) : winding != 0;
+}
+
+/**
+ * Returns the id of the topmost hit region containing a point on the canvas.
+ * @param x The x axis of the point.
+ * @param y The y axis of the point.
+ * @return The id (valid until the region is removed) or NULL if no region
+ *         contains the point.
+ */
+const char *hit_util_test(VGfloat x, VGfloat y)
+{
+	hit_util_t *hit = context_util_get()->hit_regions;
+	const hit_util_cell_t *cell = NULL;
+	const hit_util_region_t *region = NULL;
+	VGint i = 0;
+	
+	// the surface is flipped like the points of paths
+	y = egl_get_height() - y;
+	
+	if(hit == NULL || !(x >= 0 && y >= 0 && x < hit->columns * HIT_UTIL_CELL_SIZE && y < hit->rows * HIT_UTIL_CELL_SIZE))
+	{
+		return NULL;
+	}
+	
+	cell = &hit->cells[(VGint)(y / HIT_UTIL_CELL_SIZE) * hit->columns + (VGint)(x / HIT_UTIL_CELL_SIZE)];
+	
+	for(i = cell->count - 1; i >= 0; i--)
+	{
+		region = &hit->regions[cell->regions[i]];
+		
+		if(!region->removed && hit_util__inside(region, x, y))
+		{
+			return region->id;
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * Returns the amount of hit regions of the current context.
+ */
+VGint hit_util_get_count(void)
+{
+	hit_util_t *hit = context_util_get()->hit_regions;
+	
+	return hit == NULL ? 0 : hit->regions_count - hit->removed;
+}
+
+/**
+ * Frees the hit regions of the current context.
+ */
+void hit_util_cleanup(void)
+{
+	canvas_context_t *context = context_util_get();
+	hit_util_t *hit = context->hit_regions;
+	VGint i = 0;
+	
+	if(hit == NULL)
+	{
+		return;
+	}
+	
+	hit_util_clear();
+	
+	for(i = 0; i < hit->columns * hit->rows; i++)
+	{
+		free(hit->cells[i].regions);
+	}
+	
+	free(hit->cells);
+	free(hit->table);
+	free(hit->regions);
+	free(hit);
+	
+	context->hit_regions = NULL;
+}
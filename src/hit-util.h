@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __HIT_UTIL_H__
+#define __HIT_UTIL_H__
+
+#include <VG/openvg.h>
+
+int hit_util_add(const char *id, VGFillRule fill_rule);
+void hit_util_remove(const char *id);
+void hit_util_clear(void);
+const char *hit_util_test(VGfloat x, VGfloat y);
+VGint hit_util_get_count(void);
+void hit_util_cleanup(void);
+
+#endif /* __HIT_UTIL_H__ */
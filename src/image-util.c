@@ -21,7 +21,10 @@
 #include "include-freeimage.h"
 #include "image-util.h"
 #include "log-util.h"
-#include "egl-util.h"
+#include "encode-util.h"
+#include "profile-util.h"
+#include "trace-util.h"
+#include "memory-util.h"
 
 static char encoding_table[] = { 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/' };
 static int mod_table[] = { 0, 2, 1 };
@@ -34,6 +37,7 @@ static int mod_table[] = { 0, 2, 1 };
 void image_cleanup(image_t *image)
 {
 	vgDestroyImage(image->image);
+	memory_util_free(MEMORY_UTIL_IMAGE, (long long)image->width * image->height * 4, 1);
 	free(image);
 }
 
@@ -76,15 +80,31 @@ FIBITMAP *image_load_bitmap(const char *path)
  * @param width The width
  * @param height The height
  * @param Pointer to data 
- * @return A pointer to an allocated image structure
+ * @return A pointer to an allocated image structure or NULL on failure
  */
 image_t *image_create(VGImageFormat format, VGint width, VGint height, const void *data)
 {
 	image_t *image = malloc(sizeof(image_t));
+	TRACE_DECLARE(trace_begin);
+	
+	PROFILE_ALLOC(sizeof(image_t));
+	if(image == NULL)
+	{
+		eprintf("Failed to allocate image.\n");
+		
+		// errno set by malloc
+		
+		return NULL;
+	}
+	
 	image->width = width;
 	image->height = height;
 	image->image = vgCreateImage(format, image->width, image->height, VG_IMAGE_QUALITY_BETTER);
-	vgImageSubData(image->image, data, image->width * 4, format, 0, 0, image->width, image->height);
+	memory_util_alloc(MEMORY_UTIL_IMAGE, (long long)image->width * image->height * 4, 1);
+	PROFILE_UPLOAD(image->width * image->height * 4);
+	TRACE_BEGIN(trace_begin);
+	PROFILE_CALL(PROFILE_IMAGE_SUB_DATA, vgImageSubData(image->image, data, image->width * 4, format, 0, 0, image->width, image->height));
+	TRACE_END_ARG("image", "upload", trace_begin, image->width * image->height * 4);
 	
 	return image;
 }
@@ -175,77 +195,72 @@ static char *image_base64_encode(char *start_prefix, const unsigned char *data,
 }
 
 /**
- * Returns a data-URL containing a representation of src in the format specified by the type
+ * Sets the default encoder options
  *
- * @param src Raw image data of whole screen
- * @param type Format (currently supported: image/png and image/jpeg)
- * @param encoder_options Only used for image/jpeg. Specifies the quality of the output image.
- * @return The data-URL (must be freed)
+ * @param encoder Pointer to encoder options
+ */
+void image_encoder_defaults(image_encoder_t *encoder)
+{
+	encoder->quality = -1;
+	encoder->compression = -1;
+	encoder->filter = -1;
+	encoder->threads = 1;
+}
+
+/**
+ * Encodes src as JPEG using FreeImage. The scanlines are copied directly since
+ * both OpenVG and FreeImage store images bottom-up.
+ *
+ * @param src Raw image data (sRGBX_8888)
+ * @param width The width
+ * @param height The height
+ * @param quality Quality between 0 and 1, values out of range select the default
+ * @param data_amount Pointer where to write the size of the JPEG to
+ * @return Pointer to the JPEG (must be freed)
  */
-char *image_to_data_url(char *src, const char *type, float encoder_options)
+static char *image_encode_jpeg(char *src, VGint width, VGint height, float quality, size_t *data_amount)
 {
-	unsigned int x = 0;
-	unsigned int y = 0;
-	RGBQUAD color = { 0, 0, 0, 0 };
 	FIMEMORY *memory_stream = NULL;
-	FIBITMAP *image = FreeImage_Allocate(egl_get_width(), egl_get_height(), 32, 0xFF000000, 0x00FF0000, 0x0000FF00);
-	char *data_base64 = NULL;
-	size_t data_amount = 0;
-	FREE_IMAGE_FORMAT save_format = FIF_PNG;
-	int save_flags = 0;
-	char *save_prefix = "";
+	FIBITMAP *image = FreeImage_Allocate(width, height, 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	BYTE *mem_data = NULL;
+	BYTE *line = NULL;
+	char *data_copy = NULL;
+	int save_flags = JPEG_DEFAULT;
+	VGint x = 0;
+	VGint y = 0;
+	
+	*data_amount = 0;
 	
 	if(!image)
 	{
-		eprintf("Failed to create data url.\n");
+		eprintf("Failed to allocate bitmap.\n");
 		
 		return NULL;
 	}
 	
-	for(y = 0; y < (unsigned int) egl_get_height(); y++)
+	for(y = 0; y < height; y++)
 	{
-		for(x = 0; x < (unsigned int) egl_get_width(); x++)
+		unsigned char *row = (unsigned char *)src + (size_t)y * width * 4;
+		line = FreeImage_GetScanLine(image, y);
+		
+		for(x = 0; x < width; x++)
 		{
-			color.rgbRed = src[(y * egl_get_width() + x) * 4 + 3];
-			color.rgbGreen = src[(y * egl_get_width() + x) * 4 + 2];
-			color.rgbBlue = src[(y * egl_get_width() + x) * 4 + 1];
-			color.rgbReserved = src[(y * egl_get_width() + x) * 4 + 0];
-			
-			FreeImage_SetPixelColor(image, x, y, &color);
+			line[x * 3 + FI_RGBA_RED] = row[x * 4 + 3];
+			line[x * 3 + FI_RGBA_GREEN] = row[x * 4 + 2];
+			line[x * 3 + FI_RGBA_BLUE] = row[x * 4 + 1];
 		}
 	}
 	
-	if(!strcmp(type, "image/png"))
-	{
-		save_format = FIF_PNG;
-		save_flags = PNG_DEFAULT;
-		save_prefix = "data:image/png;base64,";
-	}
-	else if(!strcmp(type, "image/jpeg"))
+	if(quality <= 1 && quality >= 0)
 	{
-		save_format = FIF_JPEG;
-		if(encoder_options <= 1 && encoder_options >= 0)
-		{
-			save_flags = encoder_options * 100;
-		}
-		else
-		{
-			save_flags = JPEG_DEFAULT;
-		}
-		save_prefix = "data:image/jpeg;base64,";
-	}
-	else
-	{
-		save_format = FIF_PNG;
-		save_flags = PNG_DEFAULT;
-		save_prefix = "data:image/png;base64,";
+		save_flags = quality * 100;
 	}
 	
 	memory_stream = FreeImage_OpenMemory(NULL, 0);
 	
-	if(!FreeImage_SaveToMemory(save_format, image, memory_stream, save_flags))
+	if(!FreeImage_SaveToMemory(FIF_JPEG, image, memory_stream, save_flags))
 	{
-		eprintf("Failed to save data url to memory.\n");
+		eprintf("Failed to save image to memory.\n");
 		
 		FreeImage_Unload(image);
 		FreeImage_CloseMemory(memory_stream);
@@ -255,133 +270,120 @@ char *image_to_data_url(char *src, const char *type, float encoder_options)
 	
 	FreeImage_Unload(image);
 	
-	BYTE *mem_data;
+	if(!FreeImage_AcquireMemory(memory_stream, &mem_data, data_amount))
+	{
+		eprintf("Failed to acquire image.\n");
+		
+		FreeImage_CloseMemory(memory_stream);
+		
+		*data_amount = 0;
+		
+		return NULL;
+	}
 	
-	if(!FreeImage_AcquireMemory(memory_stream, &mem_data, &data_amount))
+	data_copy = malloc(*data_amount);
+	if(data_copy == NULL)
 	{
-		eprintf("Failed to acquire data url.\n");
+		eprintf("Failed to acquire image.\n");
 		
 		FreeImage_CloseMemory(memory_stream);
 		
+		*data_amount = 0;
+		
 		return NULL;
 	}
 	
-	data_base64 = image_base64_encode(save_prefix, mem_data, data_amount);
+	memcpy(data_copy, mem_data, *data_amount);
 	
 	FreeImage_CloseMemory(memory_stream);
 	
-	return data_base64;
+	return data_copy;
 }
 
 /**
- * Creates a blob representing src
+ * Encodes src in the format specified by the type
  *
- * @param src Raw image data of whole screen
- * @param type Format (currently supported: image/png and image/jpeg)
- * @param encoder_options Only used for image/jpeg. Specifies the quality of the output image.
- * @param data_amount Pointer where to write the blob's size to
- * @return Pointer to blob (must be freed)
+ * @param src Raw image data (sRGBX_8888)
+ * @param width The width
+ * @param height The height
+ * @param type Format (image/png, image/jpeg or image/x-qoi). Unknown types fall back to image/png.
+ * @param encoder Encoder options
+ * @param data_amount Pointer where to write the size of the encoded image to
+ * @param mime Pointer where to write the actual MIME type to
+ * @return Pointer to the encoded image (must be freed)
  */
-char *image_to_blob(char *src, const char *type, float encoder_options, size_t *data_amount)
+static char *image_encode(char *src, VGint width, VGint height, const char *type, const image_encoder_t *encoder, size_t *data_amount, const char **mime)
 {
-	unsigned int x = 0;
-	unsigned int y = 0;
-	RGBQUAD color = { 0, 0, 0, 0 };
-	FIMEMORY *memory_stream = NULL;
-	FIBITMAP *image = FreeImage_Allocate(egl_get_width(), egl_get_height(), 32, 0xFF000000, 0x00FF0000, 0x0000FF00);
-	char *data_copy = NULL;
-	FREE_IMAGE_FORMAT save_format = FIF_PNG;
-	int save_flags = 0;
-	
-	if(/*data == NULL || */!image)
-	{
-		eprintf("Failed to create blob.\n");
-		
-		*data_amount = 0;
-		
-		return NULL;
-	}
-
-	for(y = 0; y < (unsigned int)egl_get_height(); y++)
-	{
-		for(x = 0; x < (unsigned int)egl_get_width(); x++)
-		{
-			color.rgbRed = src[(y * egl_get_width() + x) * 4 + 3];
-			color.rgbGreen = src[(y * egl_get_width() + x) * 4 + 2];
-			color.rgbBlue = src[(y * egl_get_width() + x) * 4 + 1];
-			color.rgbReserved = src[(y * egl_get_width() + x) * 4 + 0];
-			
-			FreeImage_SetPixelColor(image, x, y, &color);
-		}
-	}
-	
-	if(!strcmp(type, "image/png"))
-	{
-		save_format = FIF_PNG;
-		save_flags = PNG_DEFAULT;
-	}
-	else if(!strcmp(type, "image/jpeg"))
+	if(!strcmp(type, "image/jpeg"))
 	{
-		save_format = FIF_JPEG;
-		if(encoder_options <= 1 && encoder_options >= 0)
-		{
-			save_flags = encoder_options * 100;
-		}
-		else
-		{
-			save_flags = JPEG_DEFAULT;
-		}
+		*mime = "image/jpeg";
+		return image_encode_jpeg(src, width, height, encoder->quality, data_amount);
 	}
-	else
+	else if(!strcmp(type, "image/x-qoi"))
 	{
-		save_format = FIF_PNG;
-		save_flags = PNG_DEFAULT;
+		*mime = "image/x-qoi";
+		return encode_qoi(src, width, height, data_amount);
 	}
 	
-	memory_stream = FreeImage_OpenMemory(NULL, 0);
+	*mime = "image/png";
+	return encode_png(src, width, height, encoder->compression, encoder->filter, encoder->threads, data_amount);
+}
+
+/**
+ * Returns a data-URL containing a representation of src in the format specified by the type
+ *
+ * @param src Raw image data (sRGBX_8888)
+ * @param width The width
+ * @param height The height
+ * @param type Format (image/png, image/jpeg or image/x-qoi)
+ * @param encoder Encoder options (quality for image/jpeg, compression and filter for image/png)
+ * @return The data-URL (must be freed)
+ */
+char *image_to_data_url(char *src, VGint width, VGint height, const char *type, const image_encoder_t *encoder)
+{
+	char *data = NULL;
+	char *data_base64 = NULL;
+	char save_prefix[32];
+	const char *mime = NULL;
+	size_t data_amount = 0;
 	
-	if(!FreeImage_SaveToMemory(save_format, image, memory_stream, save_flags))
+	data = image_encode(src, width, height, type, encoder, &data_amount, &mime);
+	if(!data)
 	{
-		eprintf("Failed to save blob to memory.\n");
-		
-		FreeImage_Unload(image);
-		FreeImage_CloseMemory(memory_stream);
-		
-		*data_amount = 0;
+		eprintf("Failed to create data url.\n");
 		
 		return NULL;
 	}
 	
-	FreeImage_Unload(image);
+	snprintf(save_prefix, sizeof(save_prefix), "data:%s;base64,", mime);
 	
-	BYTE *mem_data;
+	data_base64 = image_base64_encode(save_prefix, (unsigned char *)data, data_amount);
 	
-	if(!FreeImage_AcquireMemory(memory_stream, &mem_data, data_amount))
-	{
-		eprintf("Failed to acquire blob.\n");
-		
-		FreeImage_CloseMemory(memory_stream);
-		
-		*data_amount = 0;
-		
-		return NULL;
-	}
+	free(data);
 	
-	data_copy = malloc(*data_amount);
-	if(data_copy == NULL)
+	return data_base64;
+}
+
+/**
+ * Creates a blob representing src
+ *
+ * @param src Raw image data (sRGBX_8888)
+ * @param width The width
+ * @param height The height
+ * @param type Format (image/png, image/jpeg or image/x-qoi)
+ * @param encoder Encoder options (quality for image/jpeg, compression and filter for image/png)
+ * @param data_amount Pointer where to write the blob's size to
+ * @return Pointer to blob (must be freed)
+ */
+char *image_to_blob(char *src, VGint width, VGint height, const char *type, const image_encoder_t *encoder, size_t *data_amount)
+{
+	const char *mime = NULL;
+	char *data = image_encode(src, width, height, type, encoder, data_amount, &mime);
+	
+	if(!data)
 	{
-		eprintf("Failed to acquire blob.\n");
-		
-		FreeImage_CloseMemory(memory_stream);
-		
-		*data_amount = 0;
-		
-		return NULL;
+		eprintf("Failed to create blob.\n");
 	}
 	
-	memcpy(data_copy, mem_data, *data_amount);
-	
-	FreeImage_CloseMemory(memory_stream);
-	
-	return data_copy;
+	return data;
 }
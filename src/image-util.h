@@ -22,6 +22,13 @@
 #include <VG/openvg.h>
 #include <FreeImage.h>
 
+typedef struct image_encoder_t {
+  float quality;
+  int compression;
+  int filter;
+  int threads;
+} image_encoder_t;
+
 typedef struct image_t {
   VGImage image;
   VGuint width, height;
@@ -32,7 +39,8 @@ FIBITMAP* image_load_bitmap(const char *path);
 image_t* image_create(VGImageFormat format, VGint width, VGint height, const void *data);
 void image_cleanup(image_t *image);
 void image_free_bitmap(FIBITMAP *bitmap);
-char *image_to_data_url(char *src, const char *type, float encoder_options);
-char *image_to_blob(char *src, const char *type, float encoder_options, size_t *data_amount);
+void image_encoder_defaults(image_encoder_t *encoder);
+char *image_to_data_url(char *src, VGint width, VGint height, const char *type, const image_encoder_t *encoder);
+char *image_to_blob(char *src, VGint width, VGint height, const char *type, const image_encoder_t *encoder, size_t *data_amount);
 
 #endif /* __IMAGE_UTIL_H__ */
@@ -39,6 +39,7 @@ namespace vgcanvas {
 	Image::~Image() {
 		if(GetImage()) {
 			std::cout << "Cleaning up image " << GetPath()->c_str() << "\n";
+			present_util_acquire();
 			image_cleanup(image);
 		}
 	}
@@ -53,7 +54,8 @@ namespace vgcanvas {
 		obj->SetAccessor(Nan::New("src").ToLocalChecked(), Image::GetSrc, Image::SetSrc);
 		obj->SetInternalFieldCount(1);
 		
-		Nan::SetPrototypeMethod(tpl, "setData", Image::SetData);
+		RegisterEntry<Image::SetData>("Image.setData");
+		Nan::SetPrototypeMethod(tpl, "setData", Guard<Image::SetData>);
 		
 		exports->Set(Nan::New("Image").ToLocalChecked(), tpl->GetFunction());
 	}
@@ -113,6 +115,7 @@ namespace vgcanvas {
 		
 		std::cout << "Finished loading " << data->path->c_str() << "\n";
 		
+		present_util_acquire();
 		obj->SetImage(image_create(VG_sARGB_8888,  FreeImage_GetWidth(data->bitmap),  FreeImage_GetHeight(data->bitmap), FreeImage_GetBits(data->bitmap)));
 		image_free_bitmap(data->bitmap);
 		
@@ -21,9 +21,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <assert.h>
 #include <math.h>
 #include <sys/time.h>
+#include <time.h>
 
 #endif /* __INCLUDE_CORE_H__ */
@@ -0,0 +1,596 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "log-util.h"
+#include "egl-util.h"
+#include "canvas.h"
+#include "canvas-beginPath.h"
+#include "canvas-clip.h"
+#include "canvas-save.h"
+#include "canvas-restore.h"
+#include "canvas-drawImage.h"
+#include "dirty-util.h"
+#include "memory-util.h"
+#include "context-util.h"
+#include "layer-util.h"
+
+// tolerance when comparing transformations
+#define LAYER_UTIL_EPSILON 1e-4f
+
+typedef enum layer_util_mode_t
+{
+	LAYER_UTIL_RECORD, // the enclosed calls draw into the layer
+	LAYER_UTIL_REPLAY, // the enclosed calls are skipped, the layer is composited
+	LAYER_UTIL_BYPASS  // no layer, the enclosed calls draw directly
+} layer_util_mode_t;
+
+typedef struct layer_util_layer_t
+{
+	char *key;
+	unsigned long owner;
+	canvas_context_t *context;
+	
+	// bounds in user space and path matrix of the owner when recorded
+	VGfloat x;
+	VGfloat y;
+	VGfloat width;
+	VGfloat height;
+	VGfloat matrix[9];
+	int32_t owner_height;
+	
+	// lower left corner on the owner surface when recorded
+	VGint origin_x;
+	VGint origin_y;
+	
+	int valid;
+	unsigned long used;
+	
+	struct layer_util_layer_t *next;
+} layer_util_layer_t;
+
+typedef struct layer_util_frame_t
+{
+	layer_util_mode_t mode;
+	layer_util_layer_t *layer;
+	canvas_context_t *owner;
+	
+	// translation since the layer has been recorded
+	VGfloat dx;
+	VGfloat dy;
+} layer_util_frame_t;
+
+static layer_util_layer_t *layer_util_layers = NULL;
+static layer_util_frame_t layer_util_stack[LAYER_UTIL_DEPTH];
+static int layer_util_depth = 0;
+static int layer_util_overflow = 0;
+static unsigned long layer_util_frames = 0;
+static layer_util_stats_t layer_util_stats;
+
+/**
+ * Returns the layer with the given key drawn on the given context.
+ * @param owner The id of the context.
+ * @param key The key of the layer.
+ * @return The layer or NULL if there is none.
+ */
+static layer_util_layer_t *layer_util__find(unsigned long owner, const char *key)
+{
+	layer_util_layer_t *layer = layer_util_layers;
+	
+	while(layer != NULL && (layer->owner != owner || (key != NULL && strcmp(layer->key, key) != 0)))
+	{
+		layer = layer->next;
+	}
+	
+	return layer;
+}
+
+/**
+ * Checks if two matrices have the same linear part, i.e. if they differ by a
+ * translation at most.
+ * @param a The first matrix.
+ * @param b The second matrix.
+ * @return 1 if the linear parts are equal, 0 otherwise.
+ */
+static int layer_util__same_linear(VGfloat *a, VGfloat *b)
+{
+	return fabsf(a[0] - b[0]) < LAYER_UTIL_EPSILON && fabsf(a[1] - b[1]) < LAYER_UTIL_EPSILON && fabsf(a[3] - b[3]) < LAYER_UTIL_EPSILON && fabsf(a[4] - b[4]) < LAYER_UTIL_EPSILON;
+}
+
+/**
+ * Unlinks and destroys a layer together with its surface.
+ * @param layer The layer.
+ */
+static void layer_util__destroy(layer_util_layer_t *layer)
+{
+	layer_util_layer_t **link = &layer_util_layers;
+	
+	while(*link != layer)
+	{
+		link = &(*link)->next;
+	}
+	
+	*link = layer->next;
+	
+	if(layer->context != NULL)
+	{
+		layer_util_stats.pixels -= (long long)layer->context->width * layer->context->height;
+		canvas__destroy_context(layer->context);
+	}
+	
+	memory_util_free(MEMORY_UTIL_STATE, sizeof(layer_util_layer_t) + strlen(layer->key) + 1, 1);
+	layer_util_stats.layers--;
+	
+	free(layer->key);
+	free(layer);
+}
+
+/**
+ * Ends all layers without compositing them. Layers that were recorded are
+ * drawn again the next time.
+ */
+static void layer_util__abort(void)
+{
+	int i;
+	
+	// stop all redirections first, restoring needs the owners themselves
+	for(i = 0; i < layer_util_depth; i++)
+	{
+		if(layer_util_stack[i].mode == LAYER_UTIL_RECORD)
+		{
+			layer_util_stack[i].owner->redirect = NULL;
+			layer_util_stack[i].layer->valid = 0;
+		}
+	}
+	
+	while(layer_util_overflow > 0)
+	{
+		canvas_restore();
+		layer_util_overflow--;
+	}
+	
+	while(layer_util_depth > 0)
+	{
+		layer_util_depth--;
+		
+		if(layer_util_stack[layer_util_depth].mode == LAYER_UTIL_BYPASS)
+		{
+			context_util_make_current(layer_util_stack[layer_util_depth].owner);
+			canvas_restore();
+		}
+	}
+}
+
+/**
+ * Draws the enclosed calls directly because no layer can be used. The state
+ * is still saved and restored like for a layer.
+ * @param owner The context the calls are drawn on.
+ * @return 1, the calls have to be drawn.
+ */
+static int layer_util__bypass(canvas_context_t *owner)
+{
+	layer_util_frame_t *frame = &layer_util_stack[layer_util_depth++];
+	
+	frame->mode = LAYER_UTIL_BYPASS;
+	frame->layer = NULL;
+	frame->owner = owner;
+	frame->dx = 0;
+	frame->dy = 0;
+	
+	layer_util_stats.bypassed++;
+	canvas_save();
+	
+	return 1;
+}
+
+/**
+ * Composites a layer on the current context.
+ * @param layer The layer.
+ * @param dx The horizontal translation since the layer has been recorded.
+ * @param dy The vertical translation since the layer has been recorded.
+ */
+static void layer_util__composite(layer_util_layer_t *layer, VGfloat dx, VGfloat dy)
+{
+	canvas_context_t *owner = context_util_get();
+	image_t *image = layer->context->image;
+	
+	// the origin is in surface coordinates, drawImage adds the offset
+	canvas_drawImage(image, layer->origin_x + dx - owner->offset_x, egl_get_height() - layer->origin_y - dy - image->height + owner->offset_y, image->width, image->height, 0, 0, image->width, image->height);
+	
+	layer->used = layer_util_frames;
+}
+
+/**
+ * Begins a layer on the current context. The first time (or after the layer
+ * has been invalidated), the calls until layer_util_end() are recorded into an
+ * offscreen image. Afterwards the image is composited instead as long as the
+ * transformation only differs by a translation.
+ * @param key The key of the layer, unique per context.
+ * @param x The x axis of the upper left corner of the layer bounds.
+ * @param y The y axis of the upper left corner of the layer bounds.
+ * @param width The width of the layer bounds, the whole canvas if <= 0.
+ * @param height The height of the layer bounds, the whole canvas if <= 0.
+ * @return 1 if the enclosed calls have to be drawn, 0 if they can be skipped.
+ */
+int layer_util_begin(const char *key, VGfloat x, VGfloat y, VGfloat width, VGfloat height)
+{
+	canvas_context_t *owner = context_util_get();
+	layer_util_layer_t *layer = NULL;
+	layer_util_frame_t *frame = NULL;
+	VGfloat matrix[9];
+	VGfloat matrix_fill[9];
+	VGfloat matrix_stroke[9];
+	VGfloat clear_color[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; // transparent
+	VGfloat corners[8];
+	VGfloat min_x, min_y, max_x, max_y, surface_x, surface_y, shift;
+	VGint origin_x, origin_y, layer_width, layer_height;
+	VGint mode = vgGeti(VG_MATRIX_MODE);
+	int i;
+	
+	if(layer_util_depth == LAYER_UTIL_DEPTH)
+	{
+		eprintf("Failed to begin layer \"%s\": More than %d nested layers.\n", key, LAYER_UTIL_DEPTH);
+		
+		layer_util_overflow++;
+		layer_util_stats.bypassed++;
+		canvas_save();
+		
+		return 1;
+	}
+	
+	if(width <= 0 || height <= 0)
+	{
+		x = 0;
+		y = 0;
+		width = egl_get_width();
+		height = egl_get_height();
+	}
+	
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	vgGetMatrix(matrix);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+	vgGetMatrix(matrix_fill);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
+	vgGetMatrix(matrix_stroke);
+	vgSeti(VG_MATRIX_MODE, mode);
+	
+	layer = layer_util__find(owner->id, key);
+	
+	if(layer != NULL && layer->valid && layer->owner_height == egl_get_height() && layer_util__same_linear(layer->matrix, matrix) && layer->x == x && layer->y == y && layer->width == width && layer->height == height)
+	{
+		frame = &layer_util_stack[layer_util_depth++];
+		frame->mode = LAYER_UTIL_REPLAY;
+		frame->layer = layer;
+		frame->owner = owner;
+		frame->dx = matrix[6] - layer->matrix[6];
+		frame->dy = matrix[7] - layer->matrix[7];
+		
+		layer_util_stats.hits++;
+		
+		return 0;
+	}
+	
+	// bounds on the owner surface, one pixel more for antialiasing
+	corners[0] = x;
+	corners[1] = egl_get_height() - y - height;
+	corners[2] = x + width;
+	corners[3] = corners[1];
+	corners[4] = x;
+	corners[5] = egl_get_height() - y;
+	corners[6] = x + width;
+	corners[7] = corners[5];
+	
+	min_x = max_x = matrix[0] * corners[0] + matrix[3] * corners[1] + matrix[6];
+	min_y = max_y = matrix[1] * corners[0] + matrix[4] * corners[1] + matrix[7];
+	
+	for(i = 2; i < 8; i += 2)
+	{
+		surface_x = matrix[0] * corners[i] + matrix[3] * corners[i + 1] + matrix[6];
+		surface_y = matrix[1] * corners[i] + matrix[4] * corners[i + 1] + matrix[7];
+		
+		min_x = fminf(min_x, surface_x);
+		min_y = fminf(min_y, surface_y);
+		max_x = fmaxf(max_x, surface_x);
+		max_y = fmaxf(max_y, surface_y);
+	}
+	
+	origin_x = (VGint)floorf(min_x) - 1;
+	origin_y = (VGint)floorf(min_y) - 1;
+	layer_width = (VGint)ceilf(max_x) + 1 - origin_x;
+	layer_height = (VGint)ceilf(max_y) + 1 - origin_y;
+	
+	if(layer_width > vgGeti(VG_MAX_IMAGE_WIDTH) || layer_height > vgGeti(VG_MAX_IMAGE_HEIGHT) || layer_width * layer_height > vgGeti(VG_MAX_IMAGE_PIXELS))
+	{
+		return layer_util__bypass(owner);
+	}
+	
+	if(layer == NULL)
+	{
+		layer = malloc(sizeof(layer_util_layer_t));
+		
+		if(layer == NULL)
+		{
+			eprintf("Failed to create layer \"%s\".\n", key);
+			
+			return layer_util__bypass(owner);
+		}
+		
+		layer->key = strdup(key);
+		layer->owner = owner->id;
+		layer->context = NULL;
+		layer->valid = 0;
+		layer->next = layer_util_layers;
+		layer_util_layers = layer;
+		
+		memory_util_alloc(MEMORY_UTIL_STATE, sizeof(layer_util_layer_t) + strlen(key) + 1, 1);
+		layer_util_stats.layers++;
+		layer_util_stats.misses++;
+	}
+	else if(layer->valid)
+	{
+		// explicit invalidations are counted by layer_util_invalidate()
+		if(layer->owner_height != egl_get_height() || !layer_util__same_linear(layer->matrix, matrix))
+		{
+			layer_util_stats.invalidated_transform++;
+		}
+		else
+		{
+			layer_util_stats.invalidated_bounds++;
+		}
+	}
+	
+	// the surface is reused if the size did not change
+	if(layer->context != NULL && (layer->context->width != layer_width || layer->context->height != layer_height))
+	{
+		layer_util_stats.pixels -= (long long)layer->context->width * layer->context->height;
+		canvas__destroy_context(layer->context);
+		layer->context = NULL;
+	}
+	
+	if(layer->context == NULL)
+	{
+		layer->context = canvas__create_context(layer_width, layer_height);
+		
+		if(layer->context == NULL)
+		{
+			layer->valid = 0;
+			
+			return layer_util__bypass(owner);
+		}
+		
+		layer_util_stats.pixels += (long long)layer_width * layer_height;
+	}
+	
+	layer->x = x;
+	layer->y = y;
+	layer->width = width;
+	layer->height = height;
+	memcpy(layer->matrix, matrix, sizeof(matrix));
+	layer->owner_height = egl_get_height();
+	layer->origin_x = origin_x;
+	layer->origin_y = origin_y;
+	layer->valid = 1;
+	layer->used = layer_util_frames;
+	
+	// drawImage and clearRect ignore the transformation, they are moved by
+	// the origin and the different height instead
+	layer->context->offset_x = owner->offset_x - origin_x;
+	layer->context->offset_y = owner->offset_y + layer->owner_height - layer_height - origin_y;
+	
+	// start from the state of the owner on a transparent surface
+	context_util_make_current(layer->context);
+	canvas_save_cleanup();
+	canvas_beginPath();
+	canvas_clip_set_clipping(VG_FALSE);
+	canvas__copy_state(owner);
+	
+	vgSetfv(VG_CLEAR_COLOR, 4, clear_color);
+	vgClear(0, 0, layer_width, layer_height);
+	dirty_util_invalidate();
+	
+	// the layer surface is the owner surface moved to the origin, user
+	// coordinates are flipped with the height of the layer instead
+	shift = layer->owner_height - layer_height;
+	matrix[6] += matrix[3] * shift - origin_x;
+	matrix[7] += matrix[4] * shift - origin_y;
+	matrix_fill[7] -= shift;
+	matrix_stroke[7] -= shift;
+	
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_IMAGE_USER_TO_SURFACE);
+	vgLoadMatrix(matrix);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+	vgLoadMatrix(matrix_fill);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
+	vgLoadMatrix(matrix_stroke);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	vgLoadMatrix(matrix);
+	
+	owner->redirect = layer->context;
+	
+	frame = &layer_util_stack[layer_util_depth++];
+	frame->mode = LAYER_UTIL_RECORD;
+	frame->layer = layer;
+	frame->owner = owner;
+	frame->dx = 0;
+	frame->dy = 0;
+	
+	return 1;
+}
+
+/**
+ * Ends the innermost layer and composites it on its context. The state of the
+ * context is the one before layer_util_begin().
+ */
+void layer_util_end(void)
+{
+	layer_util_frame_t *frame = NULL;
+	
+	if(layer_util_overflow > 0)
+	{
+		layer_util_overflow--;
+		canvas_restore();
+		
+		return;
+	}
+	
+	if(layer_util_depth == 0)
+	{
+		eprintf("Failed to end layer: No layer has begun.\n");
+		
+		return;
+	}
+	
+	frame = &layer_util_stack[--layer_util_depth];
+	
+	if(frame->mode == LAYER_UTIL_RECORD)
+	{
+		frame->owner->redirect = NULL;
+	}
+	
+	context_util_make_current(frame->owner);
+	
+	if(frame->mode == LAYER_UTIL_BYPASS)
+	{
+		canvas_restore();
+	}
+	else
+	{
+		layer_util__composite(frame->layer, frame->dx, frame->dy);
+	}
+}
+
+/**
+ * Invalidates layers. They are recorded again the next time they are begun.
+ * @param key The key of the layers to invalidate (on all contexts) or NULL to
+ *            invalidate all layers.
+ */
+void layer_util_invalidate(const char *key)
+{
+	layer_util_layer_t *layer = layer_util_layers;
+	
+	while(layer != NULL)
+	{
+		if(layer->valid && (key == NULL || strcmp(layer->key, key) == 0))
+		{
+			layer->valid = 0;
+			layer_util_stats.invalidated_explicit++;
+		}
+		
+		layer = layer->next;
+	}
+}
+
+/**
+ * Destroys all layers and frees their images.
+ */
+void layer_util_clear(void)
+{
+	if(layer_util_depth > 0 || layer_util_overflow > 0)
+	{
+		eprintf("Layers cleared while %d layers have not ended.\n", layer_util_depth + layer_util_overflow);
+		
+		layer_util__abort();
+	}
+	
+	while(layer_util_layers != NULL)
+	{
+		layer_util__destroy(layer_util_layers);
+	}
+}
+
+/**
+ * Advances the frame counter. Layers not composited for LAYER_UTIL_MAX_AGE
+ * frames are evicted. Must be called before presenting a frame.
+ */
+void layer_util_frame(void)
+{
+	layer_util_layer_t *layer = NULL;
+	
+	if(layer_util_depth > 0 || layer_util_overflow > 0)
+	{
+		eprintf("%d layers have not ended before the frame was presented.\n", layer_util_depth + layer_util_overflow);
+		
+		layer_util__abort();
+	}
+	
+	layer_util_frames++;
+	
+	layer = layer_util_layers;
+	while(layer != NULL)
+	{
+		if(layer_util_frames - layer->used > LAYER_UTIL_MAX_AGE)
+		{
+			// layers on the surface of this layer are destroyed with it
+			layer_util__destroy(layer);
+			layer_util_stats.evicted++;
+			layer = layer_util_layers;
+		}
+		else
+		{
+			layer = layer->next;
+		}
+	}
+}
+
+/**
+ * Destroys the layers drawn on a context. Must be called before the context
+ * is destroyed.
+ * @param context The context.
+ */
+void layer_util_remove_context(canvas_context_t *context)
+{
+	layer_util_layer_t *layer = NULL;
+	int i;
+	
+	for(i = 0; i < layer_util_depth; i++)
+	{
+		if(layer_util_stack[i].owner == context || (layer_util_stack[i].layer != NULL && layer_util_stack[i].layer->context == context))
+		{
+			layer_util__abort();
+			
+			break;
+		}
+	}
+	
+	while((layer = layer_util__find(context->id, NULL)) != NULL)
+	{
+		layer_util__destroy(layer);
+	}
+}
+
+/**
+ * Cleans up all layers and resets the statistics.
+ */
+void layer_util_cleanup(void)
+{
+	layer_util_clear();
+	
+	memset(&layer_util_stats, 0, sizeof(layer_util_stats_t));
+	layer_util_frames = 0;
+}
+
+/**
+ * Returns the layer statistics.
+ * @param stats Pointer to the statistics to fill.
+ */
+void layer_util_get_stats(layer_util_stats_t *stats)
+{
+	memcpy(stats, &layer_util_stats, sizeof(layer_util_stats_t));
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LAYER_UTIL_H__
+#define __LAYER_UTIL_H__
+
+#include <VG/openvg.h>
+
+#include "context-util.h"
+
+// maximum number of nested layers
+#define LAYER_UTIL_DEPTH 16
+// layers not composited for this many frames are evicted
+#define LAYER_UTIL_MAX_AGE 300
+
+typedef struct layer_util_stats_t
+{
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long invalidated_transform;
+	unsigned long invalidated_bounds;
+	unsigned long invalidated_explicit;
+	unsigned long evicted;
+	unsigned long bypassed;
+	long layers;
+	long long pixels;
+} layer_util_stats_t;
+
+int layer_util_begin(const char *key, VGfloat x, VGfloat y, VGfloat width, VGfloat height);
+void layer_util_end(void);
+void layer_util_invalidate(const char *key);
+void layer_util_clear(void);
+void layer_util_frame(void);
+void layer_util_remove_context(canvas_context_t *context);
+void layer_util_cleanup(void);
+void layer_util_get_stats(layer_util_stats_t *stats);
+
+#endif /* __LAYER_UTIL_H__ */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+
+#include "memory-util.h"
+
+/*
+ * Accounting of the memory held by canvas objects. OpenVG objects live in the
+ * video memory shared with the GPU, where an exhausted pool does not fail
+ * loudly but corrupts rendering. Their sizes are estimated from what is
+ * uploaded: pixels of images (4 bytes) and mask layers (1 byte), segments and
+ * coordinates of paths, color ramps of paints. Native heap held by fonts and
+ * saved states is counted separately.
+ *
+ * All functions must be called from the JS thread.
+ */
+
+static const char *memory_util_names[MEMORY_UTIL_TYPES] = {
+	"path",
+	"image",
+	"paint",
+	"mask",
+	"font",
+	"state"
+};
+
+static memory_util_usage_t memory_util_usage[MEMORY_UTIL_TYPES];
+static long long memory_util_vram = 0;
+static long long memory_util_heap = 0;
+
+static long long memory_util_limit = 0;
+static int memory_util_exceeded = 0;
+static memory_util_callback_t memory_util_callback = NULL;
+static void *memory_util_user = NULL;
+
+static int memory_util_is_vram(memory_util_type_t type)
+{
+	return type < MEMORY_UTIL_FONT;
+}
+
+/**
+ * Calls the limit callback once when the video memory exceeds the soft limit.
+ * It is armed again as soon as the usage drops below the limit.
+ */
+static void memory_util_check_limit(void)
+{
+	if(memory_util_limit <= 0)
+	{
+		return;
+	}
+	
+	if(memory_util_vram <= memory_util_limit)
+	{
+		memory_util_exceeded = 0;
+		
+		return;
+	}
+	
+	if(!memory_util_exceeded)
+	{
+		memory_util_exceeded = 1;
+		
+		if(memory_util_callback)
+		{
+			memory_util_callback(memory_util_user, memory_util_vram, memory_util_limit);
+		}
+	}
+}
+
+/**
+ * Accounts allocated memory.
+ *
+ * @param type The type of the object
+ * @param bytes The (estimated) amount of bytes
+ * @param objects The amount of created objects (0 if an existing object grows)
+ */
+void memory_util_alloc(memory_util_type_t type, long long bytes, long objects)
+{
+	memory_util_usage_t *usage = &memory_util_usage[type];
+	
+	usage->objects += objects;
+	usage->bytes += bytes;
+	
+	if(usage->bytes > usage->peak)
+	{
+		usage->peak = usage->bytes;
+	}
+	
+	if(memory_util_is_vram(type))
+	{
+		memory_util_vram += bytes;
+		
+		memory_util_check_limit();
+	}
+	else
+	{
+		memory_util_heap += bytes;
+	}
+}
+
+/**
+ * Accounts released memory. Must match a previous memory_util_alloc().
+ *
+ * @param type The type of the object
+ * @param bytes The amount of bytes
+ * @param objects The amount of destroyed objects (0 if an existing object shrinks)
+ */
+void memory_util_free(memory_util_type_t type, long long bytes, long objects)
+{
+	memory_util_usage[type].objects -= objects;
+	memory_util_usage[type].bytes -= bytes;
+	
+	if(memory_util_is_vram(type))
+	{
+		memory_util_vram -= bytes;
+		
+		memory_util_check_limit();
+	}
+	else
+	{
+		memory_util_heap -= bytes;
+	}
+}
+
+/**
+ * @return The name of the type (e.g. "path")
+ */
+const char *memory_util_get_name(memory_util_type_t type)
+{
+	return memory_util_names[type];
+}
+
+/**
+ * Copies the usage of a type.
+ *
+ * @param type The type
+ * @param usage Pointer where to write the usage to
+ */
+void memory_util_get_usage(memory_util_type_t type, memory_util_usage_t *usage)
+{
+	*usage = memory_util_usage[type];
+}
+
+/**
+ * @return The estimated video memory held by paths, images, paints and masks
+ */
+long long memory_util_get_vram(void)
+{
+	return memory_util_vram;
+}
+
+/**
+ * @return The native heap held by fonts and saved states
+ */
+long long memory_util_get_heap(void)
+{
+	return memory_util_heap;
+}
+
+/**
+ * @return The soft limit of the video memory, 0 if none is set
+ */
+long long memory_util_get_limit(void)
+{
+	return memory_util_limit;
+}
+
+/**
+ * Sets a soft limit for the video memory. The callback is called from inside
+ * the allocating function, so it must not call into the canvas.
+ *
+ * @param limit The limit in bytes, 0 to disable
+ * @param callback Called when the usage exceeds the limit
+ * @param user Pointer passed to the callback
+ */
+void memory_util_set_limit(long long limit, memory_util_callback_t callback, void *user)
+{
+	memory_util_limit = limit;
+	memory_util_callback = callback;
+	memory_util_user = user;
+	memory_util_exceeded = 0;
+	
+	memory_util_check_limit();
+}
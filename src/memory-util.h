@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MEMORY_UTIL_H__
+#define __MEMORY_UTIL_H__
+
+#include <stddef.h>
+
+// estimated driver memory of a paint object without color ramp
+#define MEMORY_UTIL_PAINT_SIZE 64
+
+typedef enum memory_util_type_t
+{
+	// video memory
+	MEMORY_UTIL_PATH,
+	MEMORY_UTIL_IMAGE,
+	MEMORY_UTIL_PAINT,
+	MEMORY_UTIL_MASK,
+	// native heap
+	MEMORY_UTIL_FONT,
+	MEMORY_UTIL_STATE,
+	MEMORY_UTIL_TYPES
+} memory_util_type_t;
+
+typedef struct memory_util_usage_t
+{
+	long objects;
+	long long bytes;
+	long long peak;
+} memory_util_usage_t;
+
+typedef void (*memory_util_callback_t)(void *user, long long bytes, long long limit);
+
+void memory_util_alloc(memory_util_type_t type, long long bytes, long objects);
+void memory_util_free(memory_util_type_t type, long long bytes, long objects);
+const char *memory_util_get_name(memory_util_type_t type);
+void memory_util_get_usage(memory_util_type_t type, memory_util_usage_t *usage);
+long long memory_util_get_vram(void);
+long long memory_util_get_heap(void);
+long long memory_util_get_limit(void);
+void memory_util_set_limit(long long limit, memory_util_callback_t callback, void *user);
+
+#endif /* __MEMORY_UTIL_H__ */
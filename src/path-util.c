@@ -0,0 +1,835 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "egl-util.h"
+#include "log-util.h"
+#include "context-util.h"
+#include "path-util.h"
+
+/*
+ * The immediate path only lives in VRAM once it is appended, so every context
+ * keeps a copy of its segments in memory. For hit testing the copy is
+ * flattened into straight edges with a tolerance of a quarter pixel under the
+ * transformation of the first test and indexed by horizontal bands of its
+ * bounding box, so a test only visits the edges crossing the band of the
+ * point. The edges are rebuilt after the path changed or when the path is
+ * zoomed in far enough that the flattening becomes visible.
+ */
+
+#define PATH_UTIL_MAX_STEPS 256
+#define PATH_UTIL_MAX_BUCKETS 4096
+
+// the edge closes an open sub-path, it is filled but not stroked
+#define PATH_UTIL_EDGE_FILL_ONLY 1
+// the edge starts or ends an open sub-path and gets a line cap
+#define PATH_UTIL_EDGE_CAP_START 2
+#define PATH_UTIL_EDGE_CAP_END 4
+
+typedef struct path_util_edge_t
+{
+	VGfloat x0;
+	VGfloat y0;
+	VGfloat x1;
+	VGfloat y1;
+	int flags;
+} path_util_edge_t;
+
+typedef struct path_util_t
+{
+	// appended segments (absolute OpenVG segment types) and their coordinates
+	VGubyte *types;
+	VGint types_count;
+	VGint types_size;
+	VGfloat *coords;
+	VGint coords_count;
+	VGint coords_size;
+	// end point of the last segment and start of the current sub-path
+	VGfloat x;
+	VGfloat y;
+	VGfloat start_x;
+	VGfloat start_y;
+	
+	// flattened edges and their bounds, valid while flat is set
+	int flat;
+	VGfloat tolerance;
+	path_util_edge_t *edges;
+	VGint edges_count;
+	VGint edges_size;
+	VGfloat min_x;
+	VGfloat min_y;
+	VGfloat max_x;
+	VGfloat max_y;
+	
+	// edges of every band, the edges of band i are bucket_edges[bucket_offsets[i]..bucket_offsets[i + 1]]
+	VGint buckets;
+	VGfloat bucket_scale;
+	VGint *bucket_offsets;
+	VGint bucket_offsets_size;
+	VGint *bucket_edges;
+	VGint bucket_edges_size;
+} path_util_t;
+
+/**
+ * Grows an array to hold at least the given amount of items.
+ * @param data The array.
+ * @param size The amount of items the array can hold.
+ * @param needed The amount of items the array has to hold.
+ * @param item The size of an item in bytes.
+ * @return 0 on success, -1 on failure
+ */
+static int path_util__reserve(void **data, VGint *size, VGint needed, size_t item)
+{
+	VGint grown = *size;
+	void *resized = NULL;
+	
+	if(needed <= *size)
+	{
+		return 0;
+	}
+	
+	if(grown < 64)
+	{
+		grown = 64;
+	}
+	
+	while(grown < needed)
+	{
+		grown *= 2;
+	}
+	
+	resized = realloc(*data, grown * item);
+	
+	if(resized == NULL)
+	{
+		eprintf("Failed to allocate path copy.\n");
+		
+		return -1;
+	}
+	
+	*data = resized;
+	*size = grown;
+	
+	return 0;
+}
+
+/**
+ * Returns the path copy of the current context.
+ * @return The path copy or NULL on failure.
+ */
+static path_util_t *path_util__get(void)
+{
+	canvas_context_t *context = context_util_get();
+	
+	if(context->path_copy == NULL)
+	{
+		context->path_copy = calloc(1, sizeof(path_util_t));
+		
+		if(context->path_copy == NULL)
+		{
+			eprintf("Failed to allocate path copy.\n");
+		}
+	}
+	
+	return context->path_copy;
+}
+
+/**
+ * Returns the amount of coordinates of a segment type.
+ * @param type The segment type.
+ * @return The amount of coordinates.
+ */
+static VGint path_util__coords(VGubyte type)
+{
+	switch(type)
+	{
+		case VG_MOVE_TO_ABS:
+		case VG_LINE_TO_ABS:
+			return 2;
+		case VG_QUAD_TO_ABS:
+			return 4;
+		case VG_CUBIC_TO_ABS:
+			return 6;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Empties the path copy of the current context, called by beginPath().
+ */
+void path_util_clear(void)
+{
+	path_util_t *path = context_util_get()->path_copy;
+	
+	if(path != NULL)
+	{
+		path->types_count = 0;
+		path->coords_count = 0;
+		path->flat = 0;
+	}
+}
+
+/**
+ * Copies segments appended to the immediate path. Must be called for every
+ * vgAppendPathData() on the immediate path.
+ * @param segments The amount of segments.
+ * @param types The absolute segment types.
+ * @param coords The coordinates of the segments (surface orientation).
+ */
+void path_util_append(VGint segments, const VGubyte *types, const VGfloat *coords)
+{
+	path_util_t *path = path_util__get();
+	VGint count = 0;
+	VGint i = 0;
+	
+	if(path == NULL)
+	{
+		return;
+	}
+	
+	for(i = 0; i < segments; i++)
+	{
+		count += path_util__coords(types[i]);
+		
+		if(types[i] == VG_CLOSE_PATH)
+		{
+			path->x = path->start_x;
+			path->y = path->start_y;
+		}
+		else if(types[i] == VG_MOVE_TO_ABS)
+		{
+			path->x = path->start_x = coords[count - 2];
+			path->y = path->start_y = coords[count - 1];
+		}
+		else
+		{
+			path->x = coords[count - 2];
+			path->y = coords[count - 1];
+		}
+	}
+	
+	if(path_util__reserve((void **)&path->types, &path->types_size, path->types_count + segments, sizeof(VGubyte)) == -1 ||
+		path_util__reserve((void **)&path->coords, &path->coords_size, path->coords_count + count, sizeof(VGfloat)) == -1)
+	{
+		return;
+	}
+	
+	memcpy(path->types + path->types_count, types, segments * sizeof(VGubyte));
+	memcpy(path->coords + path->coords_count, coords, count * sizeof(VGfloat));
+	
+	path->types_count += segments;
+	path->coords_count += count;
+	path->flat = 0;
+}
+
+/**
+ * Returns the point the next segment of the current path starts at.
+ * @param x Where to write the x axis to (surface orientation).
+ * @param y Where to write the y axis to (surface orientation).
+ * @return 0 if the path is empty, 1 otherwise
+ */
+int path_util_get_current_point(VGfloat *x, VGfloat *y)
+{
+	path_util_t *path = context_util_get()->path_copy;
+	
+	if(path == NULL || path->types_count == 0)
+	{
+		return 0;
+	}
+	
+	*x = path->x;
+	*y = path->y;
+	
+	return 1;
+}
+
+/**
+ * Adds a flattened edge.
+ * @return 0 on success, -1 on failure
+ */
+static int path_util__edge(path_util_t *path, VGfloat x0, VGfloat y0, VGfloat x1, VGfloat y1, int flags)
+{
+	path_util_edge_t *edge = NULL;
+	
+	// coordinates are not checked by moveTo() and lineTo(), non-finite edges
+	// can't be hit and would break the bounds
+	if(!isfinite(x0) || !isfinite(y0) || !isfinite(x1) || !isfinite(y1))
+	{
+		return 0;
+	}
+	
+	if(path_util__reserve((void **)&path->edges, &path->edges_size, path->edges_count + 1, sizeof(path_util_edge_t)) == -1)
+	{
+		return -1;
+	}
+	
+	edge = &path->edges[path->edges_count++];
+	edge->x0 = x0;
+	edge->y0 = y0;
+	edge->x1 = x1;
+	edge->y1 = y1;
+	edge->flags = flags;
+	
+	if(path->edges_count == 1)
+	{
+		path->min_x = path->max_x = x0;
+		path->min_y = path->max_y = y0;
+	}
+	
+	path->min_x = fminf(path->min_x, fminf(x0, x1));
+	path->min_y = fminf(path->min_y, fminf(y0, y1));
+	path->max_x = fmaxf(path->max_x, fmaxf(x0, x1));
+	path->max_y = fmaxf(path->max_y, fmaxf(y0, y1));
+	
+	return 0;
+}
+
+/**
+ * Finishes an open sub-path: it gets its caps and an edge back to its start,
+ * which is only used for filling. Closed sub-paths are finished by closePath().
+ * @param first The first edge of the sub-path.
+ * @return 0 on success, -1 on failure
+ */
+static int path_util__finish(path_util_t *path, VGint first, VGfloat x, VGfloat y, VGfloat start_x, VGfloat start_y)
+{
+	if(path->edges_count == first)
+	{
+		return 0;
+	}
+	
+	path->edges[first].flags |= PATH_UTIL_EDGE_CAP_START;
+	path->edges[path->edges_count - 1].flags |= PATH_UTIL_EDGE_CAP_END;
+	
+	if(x == start_x && y == start_y)
+	{
+		return 0;
+	}
+	
+	return path_util__edge(path, x, y, start_x, start_y, PATH_UTIL_EDGE_FILL_ONLY);
+}
+
+/**
+ * Returns the amount of steps a curve is flattened with.
+ * @param deviation The maximum deviation of the curve from a single line.
+ * @param tolerance The allowed deviation.
+ */
+static VGint path_util__steps(VGfloat deviation, VGfloat tolerance, VGint max)
+{
+	VGfloat steps = ceilf(sqrtf(deviation / tolerance));
+	
+	// NaN fails both comparisons and ends up as a single step
+	if(!(steps >= 1))
+	{
+		return 1;
+	}
+	
+	return steps > max ? max : (VGint)steps;
+}
+
+/**
+ * Returns the band of a y axis, clamped to the bands of the path. The clamping
+ * is done before the conversion, which is undefined for NaN and large values.
+ */
+static VGint path_util__bucket(const path_util_t *path, VGfloat y)
+{
+	VGfloat bucket = (y - path->min_y) * path->bucket_scale;
+	
+	// NaN fails the comparison and ends up in the first band
+	if(!(bucket > 0))
+	{
+		return 0;
+	}
+	
+	return bucket >= path->buckets - 1 ? path->buckets - 1 : (VGint)bucket;
+}
+
+/**
+ * Indexes the edges by horizontal bands of their bounds. Long edges are stored
+ * in every band they cross, the amount of bands is reduced if that would
+ * store too many of them.
+ * @return 0 on success, -1 on failure
+ */
+static int path_util__index(path_util_t *path)
+{
+	VGint buckets = path->edges_count / 2;
+	VGfloat height = path->max_y - path->min_y;
+	VGint total = 0;
+	VGint first = 0;
+	VGint last = 0;
+	VGint i = 0;
+	VGint b = 0;
+	
+	buckets = buckets < 1 ? 1 : (buckets > PATH_UTIL_MAX_BUCKETS ? PATH_UTIL_MAX_BUCKETS : buckets);
+	
+	for(;;)
+	{
+		path->buckets = buckets;
+		path->bucket_scale = height > 0 ? buckets / height : 0;
+		
+		if(path_util__reserve((void **)&path->bucket_offsets, &path->bucket_offsets_size, buckets + 1, sizeof(VGint)) == -1)
+		{
+			return -1;
+		}
+		
+		memset(path->bucket_offsets, 0, (buckets + 1) * sizeof(VGint));
+		total = 0;
+		
+		for(i = 0; i < path->edges_count; i++)
+		{
+			first = path_util__bucket(path, fminf(path->edges[i].y0, path->edges[i].y1));
+			last = path_util__bucket(path, fmaxf(path->edges[i].y0, path->edges[i].y1));
+			
+			for(b = first; b <= last; b++)
+			{
+				path->bucket_offsets[b]++;
+			}
+			
+			total += last - first + 1;
+		}
+		
+		if(buckets == 1 || total <= path->edges_count * 8)
+		{
+			break;
+		}
+		
+		buckets /= 2;
+	}
+	
+	if(path_util__reserve((void **)&path->bucket_edges, &path->bucket_edges_size, total, sizeof(VGint)) == -1)
+	{
+		return -1;
+	}
+	
+	// offsets become the end of every band and are counted down to its start while filling
+	for(b = 0, total = 0; b < buckets; b++)
+	{
+		total += path->bucket_offsets[b];
+		path->bucket_offsets[b] = total;
+	}
+	
+	path->bucket_offsets[buckets] = total;
+	
+	for(i = 0; i < path->edges_count; i++)
+	{
+		first = path_util__bucket(path, fminf(path->edges[i].y0, path->edges[i].y1));
+		last = path_util__bucket(path, fmaxf(path->edges[i].y0, path->edges[i].y1));
+		
+		for(b = first; b <= last; b++)
+		{
+			path->bucket_edges[--path->bucket_offsets[b]] = i;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * Flattens the path copy into edges and indexes them.
+ * @param tolerance The allowed deviation of curves in user units.
+ * @return 0 on success, -1 on failure
+ */
+static int path_util__flatten(path_util_t *path, VGfloat tolerance)
+{
+	const VGfloat *c = path->coords;
+	VGfloat x = 0;
+	VGfloat y = 0;
+	VGfloat start_x = 0;
+	VGfloat start_y = 0;
+	VGfloat x0 = 0;
+	VGfloat y0 = 0;
+	VGfloat px = 0;
+	VGfloat py = 0;
+	VGfloat t = 0;
+	VGfloat u = 0;
+	VGint first = 0;
+	VGint steps = 0;
+	int result = 0;
+	VGint i = 0;
+	VGint j = 0;
+	
+	path->edges_count = 0;
+	path->flat = 0;
+	
+	for(i = 0; i < path->types_count && result == 0; c += path_util__coords(path->types[i]), i++)
+	{
+		switch(path->types[i])
+		{
+			case VG_MOVE_TO_ABS:
+				result = path_util__finish(path, first, x, y, start_x, start_y);
+				first = path->edges_count;
+				start_x = x = c[0];
+				start_y = y = c[1];
+				break;
+			case VG_LINE_TO_ABS:
+				result = path_util__edge(path, x, y, c[0], c[1], 0);
+				x = c[0];
+				y = c[1];
+				break;
+			case VG_QUAD_TO_ABS:
+				x0 = x;
+				y0 = y;
+				steps = path_util__steps(hypotf(x - 2 * c[0] + c[2], y - 2 * c[1] + c[3]) / 4, tolerance, PATH_UTIL_MAX_STEPS);
+				
+				for(j = 1; j <= steps && result == 0; j++)
+				{
+					t = (VGfloat)j / steps;
+					u = 1 - t;
+					px = j == steps ? c[2] : u * u * x0 + 2 * u * t * c[0] + t * t * c[2];
+					py = j == steps ? c[3] : u * u * y0 + 2 * u * t * c[1] + t * t * c[3];
+					result = path_util__edge(path, x, y, px, py, 0);
+					x = px;
+					y = py;
+				}
+				
+				break;
+			case VG_CUBIC_TO_ABS:
+				x0 = x;
+				y0 = y;
+				steps = path_util__steps(0.75f * fmaxf(hypotf(x - 2 * c[0] + c[2], y - 2 * c[1] + c[3]), hypotf(c[0] - 2 * c[2] + c[4], c[1] - 2 * c[3] + c[5])), tolerance, PATH_UTIL_MAX_STEPS);
+				
+				for(j = 1; j <= steps && result == 0; j++)
+				{
+					t = (VGfloat)j / steps;
+					u = 1 - t;
+					px = j == steps ? c[4] : u * u * u * x0 + 3 * u * u * t * c[0] + 3 * u * t * t * c[2] + t * t * t * c[4];
+					py = j == steps ? c[5] : u * u * u * y0 + 3 * u * u * t * c[1] + 3 * u * t * t * c[3] + t * t * t * c[5];
+					result = path_util__edge(path, x, y, px, py, 0);
+					x = px;
+					y = py;
+				}
+				
+				break;
+			case VG_CLOSE_PATH:
+				result = path_util__edge(path, x, y, start_x, start_y, 0);
+				first = path->edges_count;
+				x = start_x;
+				y = start_y;
+				break;
+		}
+	}
+	
+	if(result == 0)
+	{
+		result = path_util__finish(path, first, x, y, start_x, start_y);
+	}
+	
+	if(result == 0)
+	{
+		result = path_util__index(path);
+	}
+	
+	path->flat = result == 0;
+	path->tolerance = tolerance;
+	
+	return result;
+}
+
+/**
+ * Reads the current path-user-to-surface matrix and flattens the path copy of
+ * the current context if it changed or is zoomed in too far.
+ * @param matrix Where to write the matrix to.
+ * @param det Where to write the determinant of the matrix to.
+ * @return The path copy or NULL if the path is empty, the transformation can
+ *         not be inverted or flattening failed.
+ */
+static path_util_t *path_util__flat(VGfloat *matrix, VGfloat *det)
+{
+	path_util_t *path = context_util_get()->path_copy;
+	VGfloat tolerance = 0;
+	VGint mode = 0;
+	
+	if(path == NULL || path->types_count == 0)
+	{
+		return NULL;
+	}
+	
+	mode = vgGeti(VG_MATRIX_MODE);
+	
+	if(mode != VG_MATRIX_PATH_USER_TO_SURFACE)
+	{
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+		vgGetMatrix(matrix);
+		vgSeti(VG_MATRIX_MODE, mode);
+	}
+	else
+	{
+		vgGetMatrix(matrix);
+	}
+	
+	// column major: [ sx shy w0 shx sy w1 tx ty w2 ]
+	*det = matrix[0] * matrix[4] - matrix[1] * matrix[3];
+	
+	if(!(fabsf(*det) > 0))
+	{
+		return NULL;
+	}
+	
+	// a quarter pixel on the surface
+	tolerance = 0.25f / sqrtf(fabsf(*det));
+	
+	if((!path->flat || tolerance < path->tolerance * 0.5f) && path_util__flatten(path, tolerance) == -1)
+	{
+		return NULL;
+	}
+	
+	return path;
+}
+
+/**
+ * Maps a point on the canvas into the coordinates of the immediate path with
+ * the inverse of the current transformation and flattens the path if needed.
+ * @param x The x axis of the point on the canvas, transformed in place.
+ * @param y The y axis of the point on the canvas, transformed in place.
+ * @return The path copy or NULL if the path is empty, the transformation can
+ *         not be inverted or flattening failed.
+ */
+static path_util_t *path_util__prepare(VGfloat *x, VGfloat *y)
+{
+	VGfloat matrix[9];
+	VGfloat det = 0;
+	VGfloat sx = 0;
+	VGfloat sy = 0;
+	path_util_t *path = path_util__flat(matrix, &det);
+	
+	if(path == NULL)
+	{
+		return NULL;
+	}
+	
+	// the point is flipped like the points of the path
+	sx = *x - matrix[6];
+	sy = egl_get_height() - *y - matrix[7];
+	*x = (matrix[4] * sx - matrix[3] * sy) / det;
+	*y = (matrix[0] * sy - matrix[1] * sx) / det;
+	
+	return path;
+}
+
+/**
+ * Returns the edges of the current path which matter for filling, transformed
+ * by the current transformation into surface coordinates. Horizontal edges
+ * are left out.
+ * @param count Where to write the amount of edges to.
+ * @return x0, y0, x1, y1 of every edge, to be freed by the caller. NULL if
+ *         the path is empty, the transformation can not be inverted or on
+ *         failure.
+ */
+VGfloat *path_util_get_fill_edges(VGint *count)
+{
+	VGfloat matrix[9];
+	VGfloat det = 0;
+	VGfloat *edges = NULL;
+	const path_util_edge_t *edge = NULL;
+	path_util_t *path = path_util__flat(matrix, &det);
+	VGint i = 0;
+	
+	*count = 0;
+	
+	if(path == NULL)
+	{
+		return NULL;
+	}
+	
+	edges = malloc((path->edges_count > 0 ? path->edges_count : 1) * 4 * sizeof(VGfloat));
+	
+	if(edges == NULL)
+	{
+		eprintf("Failed to allocate path edges.\n");
+		
+		return NULL;
+	}
+	
+	for(i = 0; i < path->edges_count; i++)
+	{
+		edge = &path->edges[i];
+		edges[*count * 4] = matrix[0] * edge->x0 + matrix[3] * edge->y0 + matrix[6];
+		edges[*count * 4 + 1] = matrix[1] * edge->x0 + matrix[4] * edge->y0 + matrix[7];
+		edges[*count * 4 + 2] = matrix[0] * edge->x1 + matrix[3] * edge->y1 + matrix[6];
+		edges[*count * 4 + 3] = matrix[1] * edge->x1 + matrix[4] * edge->y1 + matrix[7];
+		
+		if(edges[*count * 4 + 1] != edges[*count * 4 + 3])
+		{
+			(*count)++;
+		}
+	}
+	
+	return edges;
+}
+
+/**
+ * Tests whether a point is inside the current path. Like for fill(), every
+ * open sub-path is closed by a straight line.
+ * @param x The x axis of the point on the canvas.
+ * @param y The y axis of the point on the canvas.
+ * @param fill_rule VG_NON_ZERO or VG_EVEN_ODD
+ * @return 1 if the point is inside, 0 otherwise
+ */
+int path_util_is_point_in_path(VGfloat x, VGfloat y, VGFillRule fill_rule)
+{
+	path_util_t *path = path_util__prepare(&x, &y);
+	const path_util_edge_t *edge = NULL;
+	VGint winding = 0;
+	VGint bucket = 0;
+	VGint i = 0;
+	
+	if(path == NULL || !(x >= path->min_x && x <= path->max_x && y >= path->min_y && y <= path->max_y))
+	{
+		return 0;
+	}
+	
+	bucket = path_util__bucket(path, y);
+	
+	// count the edges crossing a ray from the point to the right
+	for(i = path->bucket_offsets[bucket]; i < path->bucket_offsets[bucket + 1]; i++)
+	{
+		edge = &path->edges[path->bucket_edges[i]];
+		
+		if((edge->y0 <= y) != (edge->y1 <= y) && edge->x0 + (y - edge->y0) * (edge->x1 - edge->x0) / (edge->y1 - edge->y0) > x)
+		{
+			winding += edge->y1 > edge->y0 ? 1 : -1;
+		}
+	}
+	
+	return fill_rule == VG_EVEN_ODD ? (winding & 1) : winding != 0;
+}
+
+/**
+ * Tests whether a point is within half the line width of an edge. Caps of open
+ * sub-paths are tested with the line cap, joins are tested as round joins.
+ * @return 1 if the point is covered by the stroke of the edge, 0 otherwise
+ */
+static int path_util__near(const path_util_edge_t *edge, VGfloat x, VGfloat y, VGfloat half_width, VGCapStyle cap)
+{
+	VGfloat dx = edge->x1 - edge->x0;
+	VGfloat dy = edge->y1 - edge->y0;
+	VGfloat rx = x - edge->x0;
+	VGfloat ry = y - edge->y0;
+	VGfloat length = dx * dx + dy * dy;
+	VGfloat t = 0;
+	
+	if(length == 0)
+	{
+		// zero length sub-paths are only drawn with round or square caps
+		if((edge->flags & PATH_UTIL_EDGE_CAP_START) && (edge->flags & PATH_UTIL_EDGE_CAP_END))
+		{
+			if(cap == VG_CAP_BUTT)
+			{
+				return 0;
+			}
+			
+			if(cap == VG_CAP_SQUARE)
+			{
+				return fabsf(rx) <= half_width && fabsf(ry) <= half_width;
+			}
+		}
+		
+		return rx * rx + ry * ry <= half_width * half_width;
+	}
+	
+	t = (rx * dx + ry * dy) / length;
+	
+	if((t < 0 && (edge->flags & PATH_UTIL_EDGE_CAP_START)) || (t > 1 && (edge->flags & PATH_UTIL_EDGE_CAP_END)))
+	{
+		if(cap == VG_CAP_BUTT)
+		{
+			return 0;
+		}
+		
+		if(cap == VG_CAP_SQUARE)
+		{
+			length = sqrtf(length);
+			
+			// distance beyond the end point and to the line through the edge
+			return (t < 0 ? -t : t - 1) * length <= half_width && fabsf(rx * dy - ry * dx) / length <= half_width;
+		}
+	}
+	
+	t = t < 0 ? 0 : (t > 1 ? 1 : t);
+	rx -= t * dx;
+	ry -= t * dy;
+	
+	return rx * rx + ry * ry <= half_width * half_width;
+}
+
+/**
+ * Tests whether a point is covered by the stroke of the current path with the
+ * current line width and line cap. Dashes are ignored and joins are tested as
+ * round joins.
+ * @param x The x axis of the point on the canvas.
+ * @param y The y axis of the point on the canvas.
+ * @return 1 if the point is inside the stroke, 0 otherwise
+ */
+int path_util_is_point_in_stroke(VGfloat x, VGfloat y)
+{
+	canvas_context_t *context = context_util_get();
+	path_util_t *path = path_util__prepare(&x, &y);
+	VGfloat half_width = context->line_width / 2;
+	// square caps reach half the line width diagonally beyond the end point
+	VGfloat reach = context->line_cap == VG_CAP_SQUARE ? half_width * (VGfloat)M_SQRT2 : half_width;
+	const path_util_edge_t *edge = NULL;
+	VGint first = 0;
+	VGint last = 0;
+	VGint i = 0;
+	
+	if(path == NULL || !(x >= path->min_x - reach && x <= path->max_x + reach && y >= path->min_y - reach && y <= path->max_y + reach))
+	{
+		return 0;
+	}
+	
+	// edges in several of the bands are tested more than once, which does not change the result
+	first = path_util__bucket(path, y - reach);
+	last = path_util__bucket(path, y + reach);
+	
+	for(i = path->bucket_offsets[first]; i < path->bucket_offsets[last + 1]; i++)
+	{
+		edge = &path->edges[path->bucket_edges[i]];
+		
+		if(!(edge->flags & PATH_UTIL_EDGE_FILL_ONLY) && path_util__near(edge, x, y, half_width, context->line_cap))
+		{
+			return 1;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * Frees the path copy of the current context.
+ */
+void path_util_cleanup(void)
+{
+	canvas_context_t *context = context_util_get();
+	path_util_t *path = context->path_copy;
+	
+	if(path == NULL)
+	{
+		return;
+	}
+	
+	free(path->types);
+	free(path->coords);
+	free(path->edges);
+	free(path->bucket_offsets);
+	free(path->bucket_edges);
+	free(path);
+	
+	context->path_copy = NULL;
+}
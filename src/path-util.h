@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PATH_UTIL_H__
+#define __PATH_UTIL_H__
+
+#include <VG/openvg.h>
+
+void path_util_clear(void);
+void path_util_append(VGint segments, const VGubyte *types, const VGfloat *coords);
+int path_util_get_current_point(VGfloat *x, VGfloat *y);
+int path_util_is_point_in_path(VGfloat x, VGfloat y, VGFillRule fill_rule);
+int path_util_is_point_in_stroke(VGfloat x, VGfloat y);
+VGfloat *path_util_get_fill_edges(VGint *count);
+void path_util_cleanup(void);
+
+#endif /* __PATH_UTIL_H__ */
@@ -29,11 +29,14 @@ namespace vgcanvas {
 	}
 	
 	Pattern::~Pattern() {
+		present_util_acquire();
 		paint_cleanup(&paint);
+		image.Reset();
 	}
 	
 	void Pattern::Init(Local<Object> exports) {
-		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Pattern::New);
+		RegisterEntry<Pattern::New>("Pattern");
+		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Guard<Pattern::New>);
 		tpl->SetClassName(Nan::New("Pattern").ToLocalChecked());
 		tpl->InstanceTemplate()->SetInternalFieldCount(1);
 		
@@ -58,6 +61,7 @@ namespace vgcanvas {
 			if(img->GetImage()) {
 				std::string mode(*Nan::Utf8String(info[1]));
 				paint_createPattern(pattern->GetPaint(), img->GetImage(), mode == "no-repeat" ? VG_TILE_FILL : VG_TILE_REPEAT);
+				pattern->image.Reset(Local<Object>::Cast(info[0]));
 			} else {
 				Nan::ThrowError("invalid image");
 				return;
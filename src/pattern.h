@@ -43,6 +43,8 @@ namespace vgcanvas {
 		Pattern(const Pattern&);
 		
 		paint_t paint;
+		// the paint draws the image of this object
+		Nan::Persistent<Object> image;
 	};
 
 }
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "include-core.h"
+#include "pool-util.h"
+#include "log-util.h"
+#include "trace-util.h"
+
+/*
+ * Worker threads for CPU work that can be split into independent tasks
+ * (binning tiles, compressing PNG strips). The tasks of a run are divided
+ * into one contiguous range per thread; a thread that has finished its own
+ * range steals the remaining tasks of the other ranges. The caller takes
+ * part as thread 0, so a run with one thread never leaves the calling thread.
+ * Only one run uses the workers at a time, concurrent runs (e.g. two encodes
+ * on the uv thread pool) are executed serially on their calling thread.
+ */
+
+typedef struct pool_util_range_t
+{
+	volatile unsigned long next;
+	unsigned long end;
+	// keeps the ranges of different threads in different cache lines
+	char padding[64 - 2 * sizeof(unsigned long)];
+} pool_util_range_t;
+
+static pthread_t workers[POOL_UTIL_THREADS_MAX];
+static int started = 0;
+static pthread_mutex_t run_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done = PTHREAD_COND_INITIALIZER;
+
+// the current run, guarded by mutex
+static unsigned long generation = 0;
+static int participants = 0;
+static int pending = 0;
+static int stopping = 0;
+static pool_util_task_t run_task = NULL;
+static void *run_user = NULL;
+static pool_util_range_t ranges[POOL_UTIL_THREADS_MAX];
+
+static pool_util_stats_t stats;
+
+/**
+ * Executes the tasks of a thread, then steals from the other threads.
+ * @param self The index of the thread in the run.
+ * @param count The number of threads of the run.
+ * @param task The task function.
+ * @param user The user pointer of the run.
+ */
+static void pool_util_work(int self, int count, pool_util_task_t task, void *user)
+{
+	unsigned long index = 0;
+	unsigned long steals = 0;
+	int victim = 0;
+	int i = 0;
+	
+	while((index = __sync_fetch_and_add(&ranges[self].next, 1)) < ranges[self].end)
+	{
+		task(user, index);
+	}
+	
+	for(i = 1; i < count; i++)
+	{
+		victim = (self + i) % count;
+		
+		while((index = __sync_fetch_and_add(&ranges[victim].next, 1)) < ranges[victim].end)
+		{
+			task(user, index);
+			steals++;
+		}
+	}
+	
+	if(steals != 0)
+	{
+		__sync_fetch_and_add(&stats.steals, steals);
+	}
+}
+
+static void *pool_util_worker(void *data)
+{
+	int self = (int)(long)data;
+	unsigned long seen = 0;
+	pool_util_task_t task = NULL;
+	void *user = NULL;
+	int count = 0;
+	
+	trace_util_set_thread_name("pool worker");
+	
+	// workers are started by a run (generation >= 1) and join it
+	pthread_mutex_lock(&mutex);
+	
+	while(1)
+	{
+		while(!stopping && (generation == seen || self >= participants))
+		{
+			seen = generation;
+			pthread_cond_wait(&cond, &mutex);
+		}
+		
+		if(stopping)
+		{
+			break;
+		}
+		
+		seen = generation;
+		task = run_task;
+		user = run_user;
+		count = participants;
+		pthread_mutex_unlock(&mutex);
+		
+		pool_util_work(self, count, task, user);
+		
+		pthread_mutex_lock(&mutex);
+		pending--;
+		if(pending == 0)
+		{
+			pthread_cond_signal(&done);
+		}
+	}
+	
+	pthread_mutex_unlock(&mutex);
+	
+	return NULL;
+}
+
+/**
+ * Resolves the number of threads of a run.
+ * @param threads Requested number of threads, 0 or less for one per CPU.
+ * @return The number of threads (1 to POOL_UTIL_THREADS_MAX).
+ */
+int pool_util_get_threads(int threads)
+{
+	long cpus = 0;
+	
+	if(threads <= 0)
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cpus > 0 ? (int)cpus : 1;
+	}
+	
+	return threads > POOL_UTIL_THREADS_MAX ? POOL_UTIL_THREADS_MAX : threads;
+}
+
+/**
+ * Executes task(user, 0) to task(user, count - 1) on up to threads threads
+ * and returns when all of them are done.
+ * @param count The number of tasks.
+ * @param threads The number of threads, 0 or less for one per CPU.
+ * @param task The task function.
+ * @param user Passed to the task function.
+ */
+void pool_util_run(unsigned long count, int threads, pool_util_task_t task, void *user)
+{
+	unsigned long index = 0;
+	int i = 0;
+	
+	threads = pool_util_get_threads(threads);
+	if((unsigned long)threads > count)
+	{
+		threads = count;
+	}
+	
+	__sync_fetch_and_add(&stats.runs, 1);
+	__sync_fetch_and_add(&stats.tasks, count);
+	
+	if(threads <= 1 || pthread_mutex_trylock(&run_mutex) != 0)
+	{
+		if(threads > 1)
+		{
+			__sync_fetch_and_add(&stats.serial, 1);
+		}
+		
+		for(index = 0; index < count; index++)
+		{
+			task(user, index);
+		}
+		
+		return;
+	}
+	
+	pthread_mutex_lock(&mutex);
+	
+	for(; started < threads - 1; started++)
+	{
+		if(pthread_create(&workers[started], NULL, pool_util_worker, (void *)(long)(started + 1)) != 0)
+		{
+			eprintf("Failed to create pool worker.\n");
+			
+			break;
+		}
+	}
+	
+	// threads without a worker leave their range to be stolen
+	for(i = 0; i < threads; i++)
+	{
+		ranges[i].next = count * i / threads;
+		ranges[i].end = count * (i + 1) / threads;
+	}
+	
+	run_task = task;
+	run_user = user;
+	participants = threads;
+	pending = (started + 1 < threads ? started + 1 : threads) - 1;
+	generation++;
+	stats.threads = threads;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	
+	pool_util_work(0, threads, task, user);
+	
+	pthread_mutex_lock(&mutex);
+	while(pending > 0)
+	{
+		pthread_cond_wait(&done, &mutex);
+	}
+	participants = 0;
+	pthread_mutex_unlock(&mutex);
+	
+	pthread_mutex_unlock(&run_mutex);
+}
+
+/**
+ * Stops the worker threads. They are started again by the next run.
+ */
+void pool_util_cleanup(void)
+{
+	int i = 0;
+	
+	pthread_mutex_lock(&run_mutex);
+	pthread_mutex_lock(&mutex);
+	stopping = 1;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	
+	for(i = 0; i < started; i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	
+	pthread_mutex_lock(&mutex);
+	started = 0;
+	stopping = 0;
+	pthread_mutex_unlock(&mutex);
+	pthread_mutex_unlock(&run_mutex);
+}
+
+/**
+ * Copies the statistics of the pool.
+ * @param destination Where to copy the statistics to.
+ */
+void pool_util_get_stats(pool_util_stats_t *destination)
+{
+	*destination = stats;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __POOL_UTIL_H__
+#define __POOL_UTIL_H__
+
+#define POOL_UTIL_THREADS_MAX 16
+
+/**
+ * Runs one task of a pool_util_run() call. Tasks of the same run are executed
+ * concurrently and must not depend on each other.
+ */
+typedef void (*pool_util_task_t)(void *user, unsigned long index);
+
+typedef struct pool_util_stats_t
+{
+	unsigned long runs;
+	unsigned long tasks;
+	unsigned long steals;
+	unsigned long serial;
+	int threads;
+} pool_util_stats_t;
+
+int pool_util_get_threads(int threads);
+void pool_util_run(unsigned long count, int threads, pool_util_task_t task, void *user);
+void pool_util_cleanup(void);
+void pool_util_get_stats(pool_util_stats_t *stats);
+
+#endif /* __POOL_UTIL_H__ */
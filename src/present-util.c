@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+
+#include "include-core.h"
+#include "include-openvg.h"
+#include "present-util.h"
+#include "egl-util.h"
+#include "log-util.h"
+#include "trace-util.h"
+
+/*
+ * The swap is done on a presentation thread so eglSwapBuffers does not block
+ * the JS thread. The EGL context can only be current on one thread at a
+ * time: present_util_swap releases it and hands it over, present_util_acquire
+ * takes it back as soon as the JS thread issues the next OpenVG call (blocking
+ * only if the swap has not finished by then). Swaps always present the window,
+ * the JS thread gets its current target (see context-util) back.
+ */
+
+static pthread_t thread;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+// guarded by mutex
+static int running = 0;
+static int requested = 0;
+static int busy = 0;
+static EGLint damage[4] = { 0, 0, 0, 0 };
+static present_util_stats_t stats;
+
+// only used on the JS thread
+static int owned = 0;
+static int threaded = 1;
+
+static double present_util_now(void)
+{
+	struct timespec time;
+	
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	
+	return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+}
+
+/**
+ * Records a swap duration (mutex must be held)
+ */
+static void present_util_record_swap(double duration)
+{
+	stats.swaps++;
+	stats.swap_last = duration;
+	stats.swap_average += (duration - stats.swap_average) / stats.swaps;
+	
+	if(duration > stats.swap_max)
+	{
+		stats.swap_max = duration;
+	}
+}
+
+static void *present_util_thread(void *arg)
+{
+	double start = 0;
+	EGLint rect[4];
+	TRACE_DECLARE(trace_begin);
+	
+	trace_util_set_thread_name("present");
+	
+	pthread_mutex_lock(&mutex);
+	
+	for(;;)
+	{
+		while(running && !requested)
+		{
+			pthread_cond_wait(&cond, &mutex);
+		}
+		
+		if(!running)
+		{
+			break;
+		}
+		
+		requested = 0;
+		memcpy(rect, damage, sizeof(rect));
+		pthread_mutex_unlock(&mutex);
+		
+		start = present_util_now();
+		TRACE_BEGIN(trace_begin);
+		
+		egl_make_window_current();
+		egl_swap_buffers_damage(rect[0], rect[1], rect[2], rect[3]);
+		egl_release_current();
+		
+		TRACE_END("present", "swap", trace_begin);
+		
+		pthread_mutex_lock(&mutex);
+		present_util_record_swap(present_util_now() - start);
+		busy = 0;
+		pthread_cond_broadcast(&cond);
+	}
+	
+	pthread_mutex_unlock(&mutex);
+	
+	return NULL;
+}
+
+/**
+ * Starts the presentation thread. The context must be current on the calling thread.
+ *
+ * @return 0 on success, -1 on failure (swaps are done synchronously then)
+ */
+int present_util_init(void)
+{
+	memset(&stats, 0, sizeof(stats));
+	
+	owned = 1;
+	running = 1;
+	requested = 0;
+	busy = 0;
+	
+	if(pthread_create(&thread, NULL, present_util_thread, NULL))
+	{
+		eprintf("Failed to create presentation thread.\n");
+		
+		running = 0;
+		
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * Waits for the last swap and stops the presentation thread. The context is
+ * current on the calling thread afterwards.
+ */
+void present_util_cleanup(void)
+{
+	if(!running)
+	{
+		return;
+	}
+	
+	present_util_acquire();
+	
+	pthread_mutex_lock(&mutex);
+	running = 0;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	
+	pthread_join(thread, NULL);
+}
+
+/**
+ * Makes sure the context is current on the JS thread. Must be called before
+ * any OpenVG call. Returns immediately unless a swap is still in progress.
+ */
+void present_util_acquire(void)
+{
+	double start = 0;
+	double duration = 0;
+	TRACE_DECLARE(trace_begin);
+	
+	if(owned || !running)
+	{
+		return;
+	}
+	
+	start = present_util_now();
+	TRACE_BEGIN(trace_begin);
+	
+	pthread_mutex_lock(&mutex);
+	while(busy)
+	{
+		pthread_cond_wait(&cond, &mutex);
+	}
+	pthread_mutex_unlock(&mutex);
+	
+	egl_make_current();
+	owned = 1;
+	
+	TRACE_END("present", "acquire", trace_begin);
+	
+	duration = present_util_now() - start;
+	
+	pthread_mutex_lock(&mutex);
+	stats.waits++;
+	stats.wait_last = duration;
+	stats.wait_average += (duration - stats.wait_average) / stats.waits;
+	if(duration > stats.wait_max)
+	{
+		stats.wait_max = duration;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Presents the current frame. With the presentation thread the function
+ * returns as soon as the swap has been queued.
+ *
+ * @param x The x axis of the lower left corner of the changed area
+ * @param y The y axis of the lower left corner of the changed area
+ * @param width The width of the changed area
+ * @param height The height of the changed area
+ * @return 1 if only the changed area is presented, 0 for a full swap
+ */
+int present_util_swap(EGLint x, EGLint y, EGLint width, EGLint height)
+{
+	double start = 0;
+	int partial = 0;
+	TRACE_DECLARE(trace_begin);
+	
+	present_util_acquire();
+	
+	if(!running || !threaded)
+	{
+		start = present_util_now();
+		TRACE_BEGIN(trace_begin);
+		partial = egl_swap_buffers_damage(x, y, width, height);
+		TRACE_END("present", "swap", trace_begin);
+		
+		pthread_mutex_lock(&mutex);
+		present_util_record_swap(present_util_now() - start);
+		pthread_mutex_unlock(&mutex);
+		
+		return partial;
+	}
+	
+	// submit the pending commands before the context changes threads
+	vgFlush();
+	egl_release_current();
+	owned = 0;
+	
+	pthread_mutex_lock(&mutex);
+	damage[0] = x;
+	damage[1] = y;
+	damage[2] = width;
+	damage[3] = height;
+	requested = 1;
+	busy = 1;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	
+	return egl_has_swap_damage();
+}
+
+/**
+ * Enables or disables the presentation thread. Without it the swap blocks the JS thread.
+ *
+ * @param value 1 to swap on the presentation thread, 0 to swap synchronously
+ */
+void present_util_set_threaded(int value)
+{
+	threaded = value ? 1 : 0;
+}
+
+/**
+ * Returns the presentation statistics. Durations are in milliseconds.
+ *
+ * @param out Pointer where to write the statistics to
+ */
+void present_util_get_stats(present_util_stats_t *out)
+{
+	pthread_mutex_lock(&mutex);
+	*out = stats;
+	pthread_mutex_unlock(&mutex);
+	
+	out->threaded = running && threaded;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PRESENT_UTIL_H__
+#define __PRESENT_UTIL_H__
+
+#include <EGL/egl.h>
+
+typedef struct present_util_stats_t
+{
+	unsigned long swaps;
+	unsigned long waits;
+	int threaded;
+	double swap_last;
+	double swap_average;
+	double swap_max;
+	double wait_last;
+	double wait_average;
+	double wait_max;
+} present_util_stats_t;
+
+int present_util_init(void);
+void present_util_cleanup(void);
+void present_util_acquire(void);
+int present_util_swap(EGLint x, EGLint y, EGLint width, EGLint height);
+void present_util_set_threaded(int threaded);
+void present_util_get_stats(present_util_stats_t *stats);
+
+#endif /* __PRESENT_UTIL_H__ */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+#include "profile-util.h"
+
+/*
+ * Counters are only touched on the JS thread. The current frame is
+ * accumulated until profile_util_frame() (called on swap) moves it to the
+ * last frame and records the frame time in the history ring.
+ */
+
+int profile_util_enabled = 0;
+
+static int profile_fences = 0;
+static const char *profile_entry_names[PROFILE_UTIL_ENTRIES];
+static int profile_entry_count = 0;
+static profile_util_frame_t profile_current;
+static profile_util_frame_t profile_last;
+static uint64_t profile_frame_start = 0;
+static double profile_history[PROFILE_UTIL_HISTORY];
+static int profile_history_index = 0;
+static int profile_history_count = 0;
+
+static const char *profile_call_names[PROFILE_CALLS] = {
+	"vgDrawPath",
+	"vgAppendPathData",
+	"vgSetParameter",
+	"vgClear",
+	"vgDrawImage",
+	"vgImageSubData",
+	"vgReadPixels",
+	"vgGetPixels"
+};
+
+/**
+ * Registers a named entry point.
+ *
+ * @param name The name (must stay valid)
+ * @return The id of the entry or -1 if there are too many entries
+ */
+int profile_util_register(const char *name)
+{
+	if(profile_entry_count >= PROFILE_UTIL_ENTRIES)
+	{
+		return -1;
+	}
+	
+	profile_entry_names[profile_entry_count] = name;
+	
+	return profile_entry_count++;
+}
+
+int profile_util_get_entry_count(void)
+{
+	return profile_entry_count;
+}
+
+const char *profile_util_get_entry_name(int id)
+{
+	return id >= 0 && id < profile_entry_count ? profile_entry_names[id] : NULL;
+}
+
+const char *profile_util_get_call_name(int call)
+{
+	return call >= 0 && call < PROFILE_CALLS ? profile_call_names[call] : NULL;
+}
+
+/**
+ * Enables or disables profiling and resets all counters.
+ *
+ * @param enabled 1 to enable profiling
+ * @param fences 1 to call vgFinish() before each measurement, so the times
+ *               include the GPU work (this serializes CPU and GPU)
+ */
+void profile_util_set_enabled(int enabled, int fences)
+{
+	memset(&profile_current, 0, sizeof(profile_current));
+	memset(&profile_last, 0, sizeof(profile_last));
+	profile_history_index = 0;
+	profile_history_count = 0;
+	profile_fences = fences;
+	profile_frame_start = profile_util_now();
+	profile_util_enabled = enabled;
+}
+
+/**
+ * @return Monotonic time in nanoseconds
+ */
+uint64_t profile_util_now(void)
+{
+	struct timespec time;
+	
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	
+	return (uint64_t)time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+static uint64_t profile_util_elapsed(uint64_t start)
+{
+	if(profile_fences)
+	{
+		vgFinish();
+	}
+	
+	return profile_util_now() - start;
+}
+
+void profile_util_end_call(int call, uint64_t start)
+{
+	profile_current.calls[call].calls++;
+	profile_current.calls[call].time += profile_util_elapsed(start);
+}
+
+void profile_util_end_entry(int id, uint64_t start)
+{
+	uint64_t elapsed = profile_util_elapsed(start);
+	
+	profile_current.entry_time += elapsed;
+	
+	if(id >= 0)
+	{
+		profile_current.entries[id].calls++;
+		profile_current.entries[id].time += elapsed;
+	}
+}
+
+void profile_util_alloc(size_t bytes)
+{
+	profile_current.allocations++;
+	profile_current.allocated_bytes += bytes;
+}
+
+void profile_util_upload(size_t bytes)
+{
+	profile_current.uploaded_bytes += bytes;
+}
+
+/**
+ * Finishes the current frame. Called on every swap.
+ */
+void profile_util_frame(void)
+{
+	uint64_t now = 0;
+	
+	if(!profile_util_enabled)
+	{
+		return;
+	}
+	
+	now = profile_util_now();
+	
+	profile_current.frame = profile_last.frame + 1;
+	profile_current.frame_time = now - profile_frame_start;
+	profile_frame_start = now;
+	
+	profile_last = profile_current;
+	memset(&profile_current, 0, sizeof(profile_current));
+	
+	profile_history[profile_history_index] = profile_last.frame_time / 1e6;
+	profile_history_index = (profile_history_index + 1) % PROFILE_UTIL_HISTORY;
+	if(profile_history_count < PROFILE_UTIL_HISTORY)
+	{
+		profile_history_count++;
+	}
+}
+
+/**
+ * @return The counters of the last finished frame
+ */
+const profile_util_frame_t *profile_util_get_frame(void)
+{
+	return &profile_last;
+}
+
+/**
+ * Copies the frame times (in ms) of the last frames, oldest first.
+ *
+ * @param times Destination
+ * @param max Size of the destination
+ * @return Number of copied frame times
+ */
+int profile_util_get_history(double *times, int max)
+{
+	int count = profile_history_count < max ? profile_history_count : max;
+	int start = profile_history_index - count;
+	int i = 0;
+	
+	if(start < 0)
+	{
+		start += PROFILE_UTIL_HISTORY;
+	}
+	
+	for(i = 0; i < count; i++)
+	{
+		times[i] = profile_history[(start + i) % PROFILE_UTIL_HISTORY];
+	}
+	
+	return count;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PROFILE_UTIL_H__
+#define __PROFILE_UTIL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROFILE_UTIL_ENTRIES 128
+#define PROFILE_UTIL_HISTORY 240
+
+typedef enum profile_util_call_t
+{
+	PROFILE_DRAW_PATH,
+	PROFILE_APPEND_PATH_DATA,
+	PROFILE_SET_PARAMETER,
+	PROFILE_CLEAR,
+	PROFILE_DRAW_IMAGE,
+	PROFILE_IMAGE_SUB_DATA,
+	PROFILE_READ_PIXELS,
+	PROFILE_GET_PIXELS,
+	PROFILE_CALLS
+} profile_util_call_t;
+
+typedef struct profile_util_timer_t
+{
+	unsigned long calls;
+	uint64_t time;
+} profile_util_timer_t;
+
+typedef struct profile_util_frame_t
+{
+	unsigned long frame;
+	uint64_t frame_time;
+	uint64_t entry_time;
+	unsigned long allocations;
+	uint64_t allocated_bytes;
+	uint64_t uploaded_bytes;
+	profile_util_timer_t entries[PROFILE_UTIL_ENTRIES];
+	profile_util_timer_t calls[PROFILE_CALLS];
+} profile_util_frame_t;
+
+extern int profile_util_enabled;
+
+/**
+ * Counts and times a driver call. Without profiling, only the call remains
+ * (plus the check of a global flag).
+ */
+#define PROFILE_CALL(call, statement) \
+	do \
+	{ \
+		if(profile_util_enabled) \
+		{ \
+			uint64_t profile_start = profile_util_now(); \
+			statement; \
+			profile_util_end_call(call, profile_start); \
+		} \
+		else \
+		{ \
+			statement; \
+		} \
+	} while(0)
+
+#define PROFILE_ALLOC(bytes) \
+	do \
+	{ \
+		if(profile_util_enabled) \
+		{ \
+			profile_util_alloc(bytes); \
+		} \
+	} while(0)
+
+#define PROFILE_UPLOAD(bytes) \
+	do \
+	{ \
+		if(profile_util_enabled) \
+		{ \
+			profile_util_upload(bytes); \
+		} \
+	} while(0)
+
+int profile_util_register(const char *name);
+int profile_util_get_entry_count(void);
+const char *profile_util_get_entry_name(int id);
+const char *profile_util_get_call_name(int call);
+void profile_util_set_enabled(int enabled, int fences);
+uint64_t profile_util_now(void);
+void profile_util_end_call(int call, uint64_t start);
+void profile_util_end_entry(int id, uint64_t start);
+void profile_util_alloc(size_t bytes);
+void profile_util_upload(size_t bytes);
+void profile_util_frame(void);
+const profile_util_frame_t *profile_util_get_frame(void);
+int profile_util_get_history(double *times, int max);
+
+#endif /* __PROFILE_UTIL_H__ */
@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "log-util.h"
+#include "readback-util.h"
+#include "profile-util.h"
+#include "trace-util.h"
+#include "memory-util.h"
+
+typedef struct readback_slot_t
+{
+	VGImage image;
+	VGint image_width;
+	VGint image_height;
+	
+	VGboolean used;
+	unsigned long sequence;
+	int age;
+	// a swap has been presented since the capture, so its commands are flushed
+	VGboolean flushed;
+	double time_requested;
+	
+	VGint width;
+	VGint height;
+	readback_util_callback_t callback;
+	void *user;
+} readback_slot_t;
+
+static readback_slot_t *readback_slots = NULL;
+static int readback_slots_amount = 0;
+static int readback_latency = READBACK_UTIL_LATENCY;
+static unsigned long readback_sequence = 0;
+static readback_util_stats_t readback_stats;
+
+/**
+ * Returns the time of the monotonic clock in milliseconds.
+ * @return The time in milliseconds.
+ */
+static double readback_util_now(void)
+{
+	struct timespec time;
+	
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	
+	return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+}
+
+/**
+ * Initializes the readback ring. The staging images of the slots are created
+ * lazily at the first readback which uses them.
+ * @param slots The amount of staging slots in the ring.
+ * @param latency The amount of buffer swaps after which a readback is
+ *                collected.
+ * @return Returns 0 on success, else it returns -1.
+ */
+int readback_util_init(int slots, int latency)
+{
+	PROFILE_ALLOC(slots * sizeof(readback_slot_t));
+	readback_slots = calloc(slots, sizeof(readback_slot_t));
+	if(readback_slots == NULL)
+	{
+		eprintf("Failed to allocate readback slots.\n");
+		
+		readback_slots_amount = 0;
+		
+		return -1;
+	}
+	
+	readback_slots_amount = slots;
+	readback_latency = latency;
+	readback_sequence = 0;
+	memset(&readback_stats, 0, sizeof(readback_util_stats_t));
+	
+	return 0;
+}
+
+/**
+ * Releases a slot and hands the collected data over to the callback.
+ * @param slot The slot.
+ * @param data The collected data or NULL if the readback has been dropped.
+ */
+static void readback_util_release(readback_slot_t *slot, char *data)
+{
+	double latency = 0;
+	
+	slot->used = VG_FALSE;
+	
+	if(data != NULL)
+	{
+		latency = readback_util_now() - slot->time_requested;
+		
+		readback_stats.collected++;
+		readback_stats.latency_last = latency;
+		readback_stats.latency_average += (latency - readback_stats.latency_average) / readback_stats.collected;
+		
+		if(latency > readback_stats.latency_max)
+		{
+			readback_stats.latency_max = latency;
+		}
+	}
+	
+	slot->callback(slot->user, data, slot->width, slot->height);
+}
+
+/**
+ * Copies the staging image of a slot into client memory and releases the slot.
+ * @param slot The slot.
+ */
+static void readback_util_collect(readback_slot_t *slot)
+{
+	char *data = malloc(slot->width * slot->height * 4);
+	TRACE_DECLARE(trace_begin);
+	
+	PROFILE_ALLOC(slot->width * slot->height * 4);
+	
+	// reading a capture which has not been flushed waits for the pending frame
+	if(!slot->flushed)
+	{
+		readback_stats.stalls++;
+	}
+	
+	if(data == NULL)
+	{
+		eprintf("Failed to allocate readback data.\n");
+	}
+	else
+	{
+		TRACE_BEGIN(trace_begin);
+		vgGetImageSubData(slot->image, data, slot->width * 4, VG_sRGBX_8888, 0, 0, slot->width, slot->height);
+		TRACE_END_ARG("readback", "collect", trace_begin, slot->width * slot->height * 4);
+	}
+	
+	readback_util_release(slot, data);
+}
+
+/**
+ * Returns the pending slot which has been requested first.
+ * @return The oldest pending slot or NULL if no readback is pending.
+ */
+static readback_slot_t *readback_util_get_oldest(void)
+{
+	readback_slot_t *oldest = NULL;
+	int i = 0;
+	
+	for(i = 0; i < readback_slots_amount; i++)
+	{
+		if(readback_slots[i].used && (oldest == NULL || readback_slots[i].sequence < oldest->sequence))
+		{
+			oldest = &readback_slots[i];
+		}
+	}
+	
+	return oldest;
+}
+
+/**
+ * Cleans up the readback ring. Pending readbacks are dropped (the callbacks
+ * receive NULL) and the staging images are destroyed.
+ */
+void readback_util_cleanup(void)
+{
+	readback_slot_t *slot = NULL;
+	int i = 0;
+	
+	while((slot = readback_util_get_oldest()) != NULL)
+	{
+		readback_util_release(slot, NULL);
+	}
+	
+	for(i = 0; i < readback_slots_amount; i++)
+	{
+		if(readback_slots[i].image != VG_INVALID_HANDLE)
+		{
+			vgDestroyImage(readback_slots[i].image);
+			memory_util_free(MEMORY_UTIL_IMAGE, (long long)readback_slots[i].image_width * readback_slots[i].image_height * 4, 1);
+		}
+	}
+	
+	free(readback_slots);
+	readback_slots = NULL;
+	readback_slots_amount = 0;
+}
+
+/**
+ * Requests a readback of a region of the surface. The pixels are copied into
+ * a staging image on the GPU immediately (which does not wait for rendering to
+ * finish) and are transferred into client memory after the configured amount
+ * of buffer swaps. If all slots are in use the readback is done synchronously
+ * which is counted as a stall.
+ * @param x The x axis of the region (surface coordinates).
+ * @param y The y axis of the region (surface coordinates).
+ * @param width The width of the region.
+ * @param height The height of the region.
+ * @param callback The callback receiving the collected data.
+ * @param user Pointer passed to the callback.
+ * @return Returns 0 on success, else it returns -1.
+ */
+int readback_util_request(VGint x, VGint y, VGint width, VGint height, readback_util_callback_t callback, void *user)
+{
+	readback_slot_t *slot = NULL;
+	char *data = NULL;
+	int i = 0;
+	TRACE_DECLARE(trace_begin);
+	
+	if(width <= 0 || height <= 0)
+	{
+		return -1;
+	}
+	
+	readback_stats.requested++;
+	
+	for(i = 0; i < readback_slots_amount; i++)
+	{
+		if(!readback_slots[i].used)
+		{
+			slot = &readback_slots[i];
+			
+			break;
+		}
+	}
+	
+	if(slot == NULL)
+	{
+		// ring is full, read back synchronously
+		readback_stats.stalls++;
+		
+		PROFILE_ALLOC(width * height * 4);
+		data = malloc(width * height * 4);
+		if(data == NULL)
+		{
+			eprintf("Failed to allocate readback data.\n");
+			
+			return -1;
+		}
+		
+		TRACE_BEGIN(trace_begin);
+		PROFILE_CALL(PROFILE_READ_PIXELS, vgReadPixels(data, width * 4, VG_sRGBX_8888, x, y, width, height));
+		TRACE_END_ARG("readback", "read", trace_begin, width * height * 4);
+		
+		callback(user, data, width, height);
+		
+		return 0;
+	}
+	
+	if(slot->image == VG_INVALID_HANDLE || slot->image_width < width || slot->image_height < height)
+	{
+		if(slot->image != VG_INVALID_HANDLE)
+		{
+			vgDestroyImage(slot->image);
+			memory_util_free(MEMORY_UTIL_IMAGE, (long long)slot->image_width * slot->image_height * 4, 1);
+		}
+		
+		slot->image = vgCreateImage(VG_sRGBX_8888, width, height, VG_IMAGE_QUALITY_NONANTIALIASED);
+		if(slot->image == VG_INVALID_HANDLE)
+		{
+			eprintf("Failed to create readback image.\n");
+			
+			return -1;
+		}
+		
+		slot->image_width = width;
+		slot->image_height = height;
+		memory_util_alloc(MEMORY_UTIL_IMAGE, (long long)width * height * 4, 1);
+	}
+	
+	TRACE_BEGIN(trace_begin);
+	PROFILE_CALL(PROFILE_GET_PIXELS, vgGetPixels(slot->image, 0, 0, x, y, width, height));
+	TRACE_END_ARG("readback", "request", trace_begin, width * height * 4);
+	
+	slot->used = VG_TRUE;
+	slot->sequence = readback_sequence++;
+	slot->age = 0;
+	slot->flushed = VG_FALSE;
+	slot->time_requested = readback_util_now();
+	slot->width = width;
+	slot->height = height;
+	slot->callback = callback;
+	slot->user = user;
+	
+	return 0;
+}
+
+/**
+ * Must be called once per buffer swap, before the frame is presented (the
+ * context is owned by the presentation thread afterwards). Ages all pending
+ * readbacks and collects the ones which are older than the configured latency.
+ */
+void readback_util_swap(void)
+{
+	readback_slot_t *slot = NULL;
+	int i = 0;
+	
+	for(i = 0; i < readback_slots_amount; i++)
+	{
+		if(readback_slots[i].used)
+		{
+			readback_slots[i].age++;
+		}
+	}
+	
+	// collect in request order
+	while((slot = readback_util_get_oldest()) != NULL && slot->age >= readback_latency)
+	{
+		readback_util_collect(slot);
+	}
+}
+
+/**
+ * Must be called after a frame has been presented. The captures pending at
+ * that point are flushed to the GPU by the swap.
+ */
+void readback_util_presented(void)
+{
+	int i = 0;
+	
+	for(i = 0; i < readback_slots_amount; i++)
+	{
+		if(readback_slots[i].used)
+		{
+			readback_slots[i].flushed = VG_TRUE;
+		}
+	}
+}
+
+/**
+ * Collects all pending readbacks regardless of their age. This is used when no
+ * further buffer swap is expected.
+ */
+void readback_util_flush(void)
+{
+	readback_slot_t *slot = NULL;
+	
+	while((slot = readback_util_get_oldest()) != NULL)
+	{
+		readback_stats.forced++;
+		
+		readback_util_collect(slot);
+	}
+}
+
+/**
+ * Sets the amount of buffer swaps after which a readback is collected.
+ * @param latency The latency in buffer swaps.
+ */
+void readback_util_set_latency(int latency)
+{
+	if(latency >= 0)
+	{
+		readback_latency = latency;
+	}
+}
+
+/**
+ * Returns the readback statistics.
+ * @param stats Pointer where the statistics are written to.
+ */
+void readback_util_get_stats(readback_util_stats_t *stats)
+{
+	int i = 0;
+	
+	*stats = readback_stats;
+	
+	stats->pending = 0;
+	stats->slots = readback_slots_amount;
+	stats->latency = readback_latency;
+	
+	for(i = 0; i < readback_slots_amount; i++)
+	{
+		if(readback_slots[i].used)
+		{
+			stats->pending++;
+		}
+	}
+}
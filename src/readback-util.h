@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __READBACK_UTIL_H__
+#define __READBACK_UTIL_H__
+
+#include <VG/openvg.h>
+
+#define READBACK_UTIL_SLOTS 3
+// the capture is presented by the first swap and rendered before the second
+#define READBACK_UTIL_LATENCY 2
+
+/**
+ * Called when a readback has been collected. The data is allocated with
+ * malloc() and must be freed by the callee. data is NULL if the readback has
+ * been dropped (e.g. at cleanup).
+ */
+typedef void (*readback_util_callback_t)(void *user, char *data, VGint width, VGint height);
+
+typedef struct readback_util_stats_t
+{
+	unsigned long requested;
+	unsigned long collected;
+	unsigned long stalls;
+	unsigned long forced;
+	int pending;
+	int slots;
+	int latency;
+	double latency_last;
+	double latency_average;
+	double latency_max;
+} readback_util_stats_t;
+
+int readback_util_init(int slots, int latency);
+void readback_util_cleanup(void);
+int readback_util_request(VGint x, VGint y, VGint width, VGint height, readback_util_callback_t callback, void *user);
+void readback_util_swap(void);
+void readback_util_presented(void);
+void readback_util_flush(void);
+void readback_util_set_latency(int latency);
+void readback_util_get_stats(readback_util_stats_t *stats);
+
+#endif /* __READBACK_UTIL_H__ */
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+extern "C" {
+	#include "egl-util.h"
+	#include "log-util.h"
+}
+
+#include <time.h>
+#include <errno.h>
+#include "scheduler.h"
+#include "vgcanvas.h"
+
+using namespace v8;
+
+namespace vgcanvas {
+	
+	static const double defaultInterval = 1000.0 / 60.0;
+	
+	static uv_async_t *async = NULL;
+	static uv_thread_t thread;
+	static uv_mutex_t mutex;
+	static uv_cond_t cond;
+	static Nan::Callback *frameCallback = NULL;
+	
+	// guarded by mutex
+	static bool running = false;
+	static bool armed = false;
+	static bool pending = false;
+	static bool vsync = false;
+	static double interval = 0;
+	static uint64_t ticks = 0;
+	static uint64_t tickTime = 0;
+	static uint64_t missed = 0;
+	
+	// only used on the JS thread
+	static uint64_t frameId = 0;
+	static uint64_t frameTime = 0;
+	
+	static uint64_t now() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
+	
+	void Scheduler::Init(Local<Object> exports) {
+		uv_mutex_init(&mutex);
+		uv_cond_init(&cond);
+		
+		exports->Set(Nan::New("requestFrame").ToLocalChecked(), Nan::New<FunctionTemplate>(Scheduler::RequestFrame)->GetFunction());
+		exports->Set(Nan::New("cancelFrame").ToLocalChecked(), Nan::New<FunctionTemplate>(Scheduler::CancelFrame)->GetFunction());
+		exports->Set(Nan::New("setFrameCallback").ToLocalChecked(), Nan::New<FunctionTemplate>(Scheduler::SetFrameCallback)->GetFunction());
+		exports->Set(Nan::New("setFrameInterval").ToLocalChecked(), Nan::New<FunctionTemplate>(Scheduler::SetFrameInterval)->GetFunction());
+		exports->Set(Nan::New("getSchedulerStats").ToLocalChecked(), Nan::New<FunctionTemplate>(Scheduler::GetStats)->GetFunction());
+	}
+	
+	void Scheduler::Start() {
+		async = new uv_async_t;
+		uv_async_init(uv_default_loop(), async, Scheduler::OnFrame);
+		
+		// the process may exit as long as no frame has been requested
+		uv_unref(reinterpret_cast<uv_handle_t*>(async));
+		
+		uv_mutex_lock(&mutex);
+		running = true;
+		armed = false;
+		pending = false;
+		vsync = interval == 0 && egl_set_vsync_callback(Scheduler::OnVsync, NULL) == 0;
+		uv_mutex_unlock(&mutex);
+		
+		uv_thread_create(&thread, Scheduler::Thread, NULL);
+	}
+	
+	void Scheduler::Stop() {
+		if(!async) {
+			return;
+		}
+		
+		egl_set_vsync_callback(NULL, NULL);
+		
+		uv_mutex_lock(&mutex);
+		running = false;
+		vsync = false;
+		uv_cond_signal(&cond);
+		uv_mutex_unlock(&mutex);
+		
+		uv_thread_join(&thread);
+		
+		uv_close(reinterpret_cast<uv_handle_t*>(async), Scheduler::OnClose);
+		async = NULL;
+	}
+	
+	void Scheduler::OnClose(uv_handle_t *handle) {
+		delete reinterpret_cast<uv_async_t*>(handle);
+	}
+	
+	/**
+	 * Called on every display refresh (vsync or interval thread). Signals the
+	 * JS thread if a frame is requested. If the previous signal has not been
+	 * handled yet, the JS thread missed this refresh.
+	 */
+	void Scheduler::Tick(uint64_t time) {
+		uv_mutex_lock(&mutex);
+		
+		ticks++;
+		tickTime = time;
+		
+		if(armed && running) {
+			if(pending) {
+				missed++;
+			} else {
+				pending = true;
+				uv_async_send(async);
+			}
+		}
+		
+		uv_mutex_unlock(&mutex);
+	}
+	
+	void Scheduler::OnVsync(void *user) {
+		Scheduler::Tick(now());
+	}
+	
+	/**
+	 * Paces frames with a fixed interval while no vsync is available or a
+	 * target interval has been set. Sleeps on an absolute deadline so the
+	 * interval does not drift, and idles while no frame is requested.
+	 */
+	void Scheduler::Thread(void *arg) {
+		struct timespec ts;
+		uint64_t next = 0;
+		uint64_t step = 0;
+		uint64_t time = 0;
+		
+		for(;;) {
+			uv_mutex_lock(&mutex);
+			
+			while(running && (vsync || !armed)) {
+				uv_cond_wait(&cond, &mutex);
+				next = 0;
+			}
+			
+			if(!running) {
+				uv_mutex_unlock(&mutex);
+				break;
+			}
+			
+			step = (interval > 0 ? interval : defaultInterval) * 1e6;
+			
+			uv_mutex_unlock(&mutex);
+			
+			time = now();
+			
+			if(next == 0) {
+				next = time;
+			}
+			
+			next += step;
+			
+			if(time > next) {
+				// the thread itself fell behind, resynchronize
+				uv_mutex_lock(&mutex);
+				missed += (time - next) / step;
+				uv_mutex_unlock(&mutex);
+				
+				next = time;
+			}
+			
+			ts.tv_sec = next / 1000000000ULL;
+			ts.tv_nsec = next % 1000000000ULL;
+			
+			while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+			
+			Scheduler::Tick(next);
+		}
+	}
+	
+	void Scheduler::OnFrame(uv_async_t *handle) {
+		Nan::HandleScope scope;
+		
+		uv_mutex_lock(&mutex);
+		bool requested = armed;
+		armed = false;
+		pending = false;
+		frameTime = tickTime;
+		uv_mutex_unlock(&mutex);
+		
+		uv_unref(reinterpret_cast<uv_handle_t*>(async));
+		
+		if(!requested || !frameCallback) {
+			return;
+		}
+		
+		frameId++;
+		
+		Local<Value> argv[] = {
+			Nan::New<Number>(frameTime / 1e6),
+			Nan::New<Number>(frameId)
+		};
+		
+		frameCallback->Call(2, argv);
+	}
+	
+	void Scheduler::RequestFrame(const Nan::FunctionCallbackInfo<Value> &info) {
+		if(!async) {
+			Nan::ThrowError("Not initialized");
+			return;
+		}
+		
+		uv_mutex_lock(&mutex);
+		armed = true;
+		uv_cond_signal(&cond);
+		uv_mutex_unlock(&mutex);
+		
+		uv_ref(reinterpret_cast<uv_handle_t*>(async));
+	}
+	
+	void Scheduler::CancelFrame(const Nan::FunctionCallbackInfo<Value> &info) {
+		if(!async) {
+			return;
+		}
+		
+		uv_mutex_lock(&mutex);
+		armed = false;
+		uv_mutex_unlock(&mutex);
+		
+		uv_unref(reinterpret_cast<uv_handle_t*>(async));
+	}
+	
+	void Scheduler::SetFrameCallback(const Nan::FunctionCallbackInfo<Value> &info) {
+		if(info.Length() != 1 || !info[0]->IsFunction()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		delete frameCallback;
+		frameCallback = new Nan::Callback(Local<Function>::Cast(info[0]));
+	}
+	
+	void Scheduler::SetFrameInterval(const Nan::FunctionCallbackInfo<Value> &info) {
+		if(!checkArgs(info, 1, 0)) {
+			return;
+		}
+		
+		double value = info[0]->NumberValue();
+		if(value < 0) {
+			value = 0;
+		}
+		
+		// vsync is only used without a target interval
+		bool useVsync = value == 0 && async && egl_set_vsync_callback(Scheduler::OnVsync, NULL) == 0;
+		if(!useVsync) {
+			egl_set_vsync_callback(NULL, NULL);
+		}
+		
+		uv_mutex_lock(&mutex);
+		interval = value;
+		vsync = useVsync;
+		uv_cond_signal(&cond);
+		uv_mutex_unlock(&mutex);
+	}
+	
+	void Scheduler::GetStats(const Nan::FunctionCallbackInfo<Value> &info) {
+		uv_mutex_lock(&mutex);
+		bool statsVsync = vsync;
+		double statsInterval = interval > 0 ? interval : defaultInterval;
+		uint64_t statsTicks = ticks;
+		uint64_t statsMissed = missed;
+		uv_mutex_unlock(&mutex);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("frameId").ToLocalChecked(), Nan::New<Number>(frameId));
+		obj->Set(Nan::New("timestamp").ToLocalChecked(), Nan::New<Number>(frameTime / 1e6));
+		obj->Set(Nan::New("missed").ToLocalChecked(), Nan::New<Number>(statsMissed));
+		obj->Set(Nan::New("ticks").ToLocalChecked(), Nan::New<Number>(statsTicks));
+		obj->Set(Nan::New("vsync").ToLocalChecked(), Nan::New<Boolean>(statsVsync));
+		obj->Set(Nan::New("interval").ToLocalChecked(), Nan::New<Number>(statsVsync ? 0 : statsInterval));
+		
+		info.GetReturnValue().Set(obj);
+	}
+}
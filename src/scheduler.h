@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <nan.h>
+
+using namespace v8;
+
+namespace vgcanvas {
+	class Scheduler {
+	public:
+		static void Init(Local<Object> exports);
+		static void Start();
+		static void Stop();
+		
+		static void RequestFrame(const Nan::FunctionCallbackInfo<Value> &info);
+		static void CancelFrame(const Nan::FunctionCallbackInfo<Value> &info);
+		static void SetFrameCallback(const Nan::FunctionCallbackInfo<Value> &info);
+		static void SetFrameInterval(const Nan::FunctionCallbackInfo<Value> &info);
+		static void GetStats(const Nan::FunctionCallbackInfo<Value> &info);
+		
+	private:
+		static void Tick(uint64_t time);
+		static void OnVsync(void *user);
+		static void OnFrame(uv_async_t *handle);
+		static void OnClose(uv_handle_t *handle);
+		static void Thread(void *arg);
+	};
+}
+
+#endif
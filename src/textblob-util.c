@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "include-core.h"
+#include "include-openvg.h"
+#include "include-freetype.h"
+
+#include "log-util.h"
+#include "font-util.h"
+#include "memory-util.h"
+#include "textblob-util.h"
+
+/**
+ * Lays out a text and copies the outlines of its glyphs into one path. The
+ * path does not depend on the font afterwards.
+ * @param text The text.
+ * @param fonts_index The font.
+ * @param size The font size.
+ * @param kerning Whether kerning is applied (if the font supports it).
+ * @param align The text alignment, applied to the path.
+ * @param baseline The text baseline, applied to the path.
+ * @return The text blob or NULL on failure.
+ */
+textblob_t *textblob_util_create(char *text, int fonts_index, VGfloat size, VGboolean kerning, canvas_text_align_t align, canvas_text_baseline_t baseline)
+{
+	textblob_t *blob = NULL;
+	VGfloat matrix[9];
+	VGint matrix_mode = 0;
+	VGfloat start_x = 0;
+	VGfloat end_x = 0;
+	VGfloat start_y = 0;
+	VGfloat end_y = 0;
+	VGfloat offset_x = 0;
+	VGfloat dx = 0;
+	VGfloat dy = 0;
+	VGPath glyph = VG_INVALID_HANDLE;
+	size_t length = 0;
+	size_t text_index = 0;
+	int char_index = 0;
+	
+	if(fonts_index < 0 || text == NULL)
+	{
+		return NULL;
+	}
+	
+	blob = malloc(sizeof(textblob_t));
+	if(blob == NULL)
+	{
+		eprintf("Failed to allocate text blob.\n");
+		
+		return NULL;
+	}
+	
+	canvas_measureText_layout(&blob->metrics, text, fonts_index, size, kerning, align, baseline);
+	
+	// extent of the glyphs relative to the pen position at the baseline
+	start_x = blob->metrics.rendering_offset_x;
+	end_x = start_x + blob->metrics.width;
+	start_y = blob->metrics.rendering_offset_y;
+	end_y = blob->metrics.height - start_y;
+	
+	// the same offsets fillText() applies
+	switch(align)
+	{
+		case CANVAS_TEXT_ALIGN_LEFT: dx = -start_x; break;
+		case CANVAS_TEXT_ALIGN_RIGHT: dx = -end_x; break;
+		case CANVAS_TEXT_ALIGN_CENTER: dx = -((end_x - start_x) * 0.5f + start_x); break;
+	}
+	
+	switch(baseline)
+	{
+		case CANVAS_TEXT_BASELINE_TOP: dy = start_y; break;
+		case CANVAS_TEXT_BASELINE_HANGING: dy = font_util_get_ascender(fonts_index) * size; break;
+		case CANVAS_TEXT_BASELINE_MIDDLE: dy = (start_y + end_y) * 0.5f; break;
+		case CANVAS_TEXT_BASELINE_ALPHABETIC: dy = 0; break;
+		case CANVAS_TEXT_BASELINE_IDEOGRAPHIC: dy = -font_util_get_descender(fonts_index) * size; break;
+		case CANVAS_TEXT_BASELINE_BOTTOM: dy = -end_y; break;
+	}
+	
+	blob->bounds[0] = dx + start_x;
+	blob->bounds[1] = dy - start_y;
+	blob->bounds[2] = dx + end_x;
+	blob->bounds[3] = dy + end_y;
+	blob->glyphs = 0;
+	
+	blob->path = vgCreatePath(VG_PATH_FORMAT_STANDARD, VG_PATH_DATATYPE_F, 1.0f, 0.0f, 0, 0, VG_PATH_CAPABILITY_TRANSFORM_TO);
+	if(blob->path == VG_INVALID_HANDLE)
+	{
+		eprintf("Failed to create text blob path.\n");
+		
+		free(blob);
+		
+		return NULL;
+	}
+	
+	matrix_mode = vgGeti(VG_MATRIX_MODE);
+	vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+	vgGetMatrix(matrix);
+	
+	length = strlen(text);
+	
+	for(text_index = 0; text_index < length; text_index++)
+	{
+		char_index = font_util_get_char_index(fonts_index, text[text_index]);
+		glyph = font_util_get_path(fonts_index, char_index);
+		
+		// glyphs are in em units with the y axis pointing up
+		if(glyph != VG_INVALID_HANDLE)
+		{
+			vgLoadIdentity();
+			vgTranslate(dx + offset_x * size, -dy);
+			vgScale(size, size);
+			vgTransformPath(blob->path, glyph);
+			blob->glyphs++;
+		}
+		
+		if(text_index < length - 1)
+		{
+			if(kerning && font_util_get_kerning_availability(fonts_index) == VG_TRUE)
+			{
+				offset_x += font_util_get_kerning_x(fonts_index, text[text_index], text[text_index + 1]);
+			}
+			
+			offset_x += font_util_get_advance_x(fonts_index, char_index);
+		}
+	}
+	
+	vgLoadMatrix(matrix);
+	vgSeti(VG_MATRIX_MODE, matrix_mode);
+	
+	blob->bytes = vgGetParameteri(blob->path, VG_PATH_NUM_SEGMENTS) + vgGetParameteri(blob->path, VG_PATH_NUM_COORDS) * sizeof(VGfloat);
+	memory_util_alloc(MEMORY_UTIL_PATH, blob->bytes, 1);
+	
+	return blob;
+}
+
+/**
+ * Destroys a text blob.
+ * @param blob The text blob.
+ */
+void textblob_util_destroy(textblob_t *blob)
+{
+	if(blob == NULL)
+	{
+		return;
+	}
+	
+	vgDestroyPath(blob->path);
+	memory_util_free(MEMORY_UTIL_PATH, blob->bytes, 1);
+	
+	free(blob);
+}
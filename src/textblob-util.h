@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEXTBLOB_UTIL_H__
+#define __TEXTBLOB_UTIL_H__
+
+#include <VG/openvg.h>
+#include "canvas-measureText.h"
+
+// a text laid out once, with the outlines of all glyphs in one path
+typedef struct textblob_t
+{
+	VGPath path; // relative to the position of the text, sized and aligned
+	VGint glyphs;
+	VGfloat bounds[4]; // left, top, right, bottom relative to the position (canvas orientation)
+	canvas_measure_text_metrics_t metrics;
+	long long bytes;
+} textblob_t;
+
+textblob_t *textblob_util_create(char *text, int fonts_index, VGfloat size, VGboolean kerning, canvas_text_align_t align, canvas_text_baseline_t baseline);
+void textblob_util_destroy(textblob_t *blob);
+
+#endif /* __TEXTBLOB_UTIL_H__ */
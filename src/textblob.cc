@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "textblob.h"
+#include "displaylist.h"
+#include "vgcanvas.h"
+
+extern "C" {
+	#include "canvas-font.h"
+	#include "canvas-kerning.h"
+	#include "canvas-textAlign.h"
+	#include "canvas-textBaseline.h"
+	#include "canvas-fillTextBlob.h"
+	#include "canvas-strokeTextBlob.h"
+	#include "include-freetype.h"
+	#include "font-util.h"
+}
+
+using namespace v8;
+
+namespace vgcanvas {
+	
+	static Nan::Persistent<Function> textBlobConstructor;
+	
+	// blobs are only created by createTextBlob()
+	static bool creating = false;
+	
+	TextBlob::TextBlob() : blob(NULL), size(0) {
+		
+	}
+	
+	TextBlob::~TextBlob() {
+		if(blob) {
+			present_util_acquire();
+			textblob_util_destroy(blob);
+		}
+	}
+	
+	void TextBlob::Init(Local<Object> exports) {
+		RegisterEntry<TextBlob::New>("TextBlob");
+		Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(Guard<TextBlob::New>);
+		tpl->SetClassName(Nan::New("TextBlob").ToLocalChecked());
+		
+		Local<ObjectTemplate> obj = tpl->InstanceTemplate();
+		obj->SetAccessor(Nan::New("text").ToLocalChecked(), TextBlob::GetProperty);
+		obj->SetAccessor(Nan::New("width").ToLocalChecked(), TextBlob::GetProperty);
+		obj->SetAccessor(Nan::New("glyphs").ToLocalChecked(), TextBlob::GetProperty);
+		obj->SetAccessor(Nan::New("metrics").ToLocalChecked(), TextBlob::GetProperty);
+		obj->SetInternalFieldCount(1);
+		
+		textBlobConstructor.Reset(tpl->GetFunction());
+		exports->Set(Nan::New("TextBlob").ToLocalChecked(), tpl->GetFunction());
+		
+		SetEntry<CreateTextBlob>(exports, "createTextBlob");
+		SetEntry<FillTextBlob>(exports, "fillTextBlob");
+		SetEntry<StrokeTextBlob>(exports, "strokeTextBlob");
+	}
+	
+	Local<Object> TextBlob::NewInstance(textblob_t *blob, const char *text, const char *font, VGfloat size, const char *align, const char *baseline) {
+		creating = true;
+		Local<Object> obj = Nan::New(textBlobConstructor)->NewInstance();
+		creating = false;
+		
+		TextBlob *wrapper = TextBlob::Unwrap<TextBlob>(obj);
+		wrapper->blob = blob;
+		wrapper->text = text;
+		wrapper->font = font;
+		wrapper->size = size;
+		wrapper->align = align;
+		wrapper->baseline = baseline;
+		
+		return obj;
+	}
+	
+	void TextBlob::New(const Nan::FunctionCallbackInfo<Value> &info) {
+		if(!info.IsConstructCall()) {
+			Nan::ThrowTypeError("not called as constructor");
+			return;
+		}
+		
+		if(!creating) {
+			Nan::ThrowTypeError("use createTextBlob()");
+			return;
+		}
+		
+		TextBlob *obj = new TextBlob();
+		obj->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+	}
+	
+	void TextBlob::GetProperty(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		TextBlob *obj = TextBlob::Unwrap<TextBlob>(info.Holder());
+		std::string str(*Nan::Utf8String(property));
+		
+		if(str == "text") {
+			info.GetReturnValue().Set(Nan::New(obj->text).ToLocalChecked());
+		} else if(str == "width") {
+			info.GetReturnValue().Set(Nan::New(obj->blob->metrics.width));
+		} else if(str == "glyphs") {
+			info.GetReturnValue().Set(Nan::New(obj->blob->glyphs));
+		} else if(str == "metrics") {
+			info.GetReturnValue().Set(NewTextMetrics(&obj->blob->metrics));
+		}
+	}
+	
+	textblob_t* TextBlob::GetBlob() {
+		return blob;
+	}
+	
+	/**
+	 * Records a draw of the blob as text with the font, alignment and baseline
+	 * of the blob. The state of the recording context stays the same.
+	 */
+	void TextBlob::Record(displaylist_op_t op, VGfloat x, VGfloat y) {
+		VGfloat position[2] = { x, y };
+		
+		vgcanvas::Record(DISPLAYLIST_SAVE, 0, NULL);
+		vgcanvas::Record(DISPLAYLIST_FONT, font.c_str(), 1, &size);
+		vgcanvas::Record(DISPLAYLIST_TEXT_ALIGN, align.c_str(), 0, NULL);
+		vgcanvas::Record(DISPLAYLIST_TEXT_BASELINE, baseline.c_str(), 0, NULL);
+		vgcanvas::Record(op, text.c_str(), 2, position);
+		vgcanvas::Record(DISPLAYLIST_RESTORE, 0, NULL);
+	}
+	
+	// createTextBlob(text, kerning): lays out the text with the current font, textAlign and textBaseline
+	void CreateTextBlob(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsString()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		int fonts_index = canvas_font_get_index();
+		
+		if(fonts_index < 0) {
+			Nan::ThrowError("no font set");
+			return;
+		}
+		
+		Nan::Utf8String text(args[0]);
+		VGboolean kerning = args.Length() > 1 && args[1]->IsBoolean() ? (args[1]->BooleanValue() ? VG_TRUE : VG_FALSE) : canvas_kerning_get();
+		textblob_t *blob = textblob_util_create(*text, fonts_index, canvas_font_get_size(), kerning, canvas_textAlign_get_internal(), canvas_textBaseline_get_internal());
+		
+		if(!blob) {
+			Nan::ThrowError("Failed to create text blob");
+			return;
+		}
+		
+		args.GetReturnValue().Set(TextBlob::NewInstance(blob, *text, font_util_get_name(fonts_index), canvas_font_get_size(), canvas_textAlign_get(), canvas_textBaseline_get()));
+	}
+	
+	static TextBlob *GetTextBlob(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!args[0]->IsObject() || std::string(*Nan::Utf8String(Local<Object>::Cast(args[0])->GetConstructorName())) != "TextBlob" || !checkArgs(args, 2, 1)) {
+			Nan::ThrowTypeError("wrong args");
+			return NULL;
+		}
+		
+		return TextBlob::Unwrap<TextBlob>(Local<Object>::Cast(args[0]));
+	}
+	
+	// fillTextBlob(blob, x, y)
+	void FillTextBlob(const Nan::FunctionCallbackInfo<Value>& args) {
+		TextBlob *obj = GetTextBlob(args);
+		
+		if(!obj) {
+			return;
+		}
+		
+		canvas_fillTextBlob(obj->GetBlob(), args[1]->NumberValue(), args[2]->NumberValue());
+		
+		if(displaylist_util_recording) {
+			obj->Record(DISPLAYLIST_FILL_TEXT, args[1]->NumberValue(), args[2]->NumberValue());
+		}
+	}
+	
+	// strokeTextBlob(blob, x, y)
+	void StrokeTextBlob(const Nan::FunctionCallbackInfo<Value>& args) {
+		TextBlob *obj = GetTextBlob(args);
+		
+		if(!obj) {
+			return;
+		}
+		
+		canvas_strokeTextBlob(obj->GetBlob(), args[1]->NumberValue(), args[2]->NumberValue());
+		
+		if(displaylist_util_recording) {
+			obj->Record(DISPLAYLIST_STROKE_TEXT, args[1]->NumberValue(), args[2]->NumberValue());
+		}
+	}
+	
+	Local<Object> NewTextMetrics(const canvas_measure_text_metrics_t *metrics) {
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("width").ToLocalChecked(), Nan::New(metrics->width));
+		obj->Set(Nan::New("actualBoundingBoxLeft").ToLocalChecked(), Nan::New(metrics->actual_bounding_box_left));
+		obj->Set(Nan::New("actualBoundingBoxRight").ToLocalChecked(), Nan::New(metrics->actual_bounding_box_right));
+		obj->Set(Nan::New("fontBoundingBoxAscent").ToLocalChecked(), Nan::New(metrics->font_bounding_box_ascent));
+		obj->Set(Nan::New("fontBoundingBoxDescent").ToLocalChecked(), Nan::New(metrics->font_bounding_box_descent));
+		obj->Set(Nan::New("actualBoundingBoxAscent").ToLocalChecked(), Nan::New(metrics->actual_bounding_box_ascent));
+		obj->Set(Nan::New("actualBoundingBoxDescent").ToLocalChecked(), Nan::New(metrics->actual_bounding_box_descent));
+		obj->Set(Nan::New("emHeightAscent").ToLocalChecked(), Nan::New(metrics->em_height_ascent));
+		obj->Set(Nan::New("emHeightDescent").ToLocalChecked(), Nan::New(metrics->em_height_descent));
+		obj->Set(Nan::New("hangingBaseline").ToLocalChecked(), Nan::New(metrics->hanging_baseline));
+		obj->Set(Nan::New("alphabeticBaseline").ToLocalChecked(), Nan::New(metrics->alphabetic_baseline));
+		obj->Set(Nan::New("ideographicBaseline").ToLocalChecked(), Nan::New(metrics->ideographic_baseline));
+		
+		return obj;
+	}
+	
+}
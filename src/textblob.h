@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEXTBLOB_H__
+#define __TEXTBLOB_H__
+
+#include <string>
+#include <nan.h>
+
+extern "C" {
+	#include "textblob-util.h"
+	#include "displaylist-util.h"
+}
+
+using namespace v8;
+
+namespace vgcanvas {
+	class TextBlob : public Nan::ObjectWrap {
+	public:
+		TextBlob();
+		virtual ~TextBlob();
+		
+		textblob_t* GetBlob();
+		void Record(displaylist_op_t op, VGfloat x, VGfloat y);
+		
+		static void Init(Local<Object> exports);
+		static Local<Object> NewInstance(textblob_t *blob, const char *text, const char *font, VGfloat size, const char *align, const char *baseline);
+		static void New(const Nan::FunctionCallbackInfo<Value> &info);
+		static void GetProperty(Local<String> property, const PropertyCallbackInfo<Value>& info);
+		
+	private:
+		TextBlob(const TextBlob&);
+		
+		textblob_t *blob;
+		// the text properties the blob was laid out with, for display lists
+		std::string text;
+		std::string font;
+		VGfloat size;
+		std::string align;
+		std::string baseline;
+	};
+	
+	void CreateTextBlob(const Nan::FunctionCallbackInfo<Value>& args);
+	void FillTextBlob(const Nan::FunctionCallbackInfo<Value>& args);
+	void StrokeTextBlob(const Nan::FunctionCallbackInfo<Value>& args);
+	
+	// the object measureText() returns
+	Local<Object> NewTextMetrics(const canvas_measure_text_metrics_t *metrics);
+
+}
+
+#endif
@@ -0,0 +1,687 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <float.h>
+
+#include "include-core.h"
+#include "include-openvg.h"
+
+#include "log-util.h"
+#include "canvas.h"
+#include "canvas-beginPath.h"
+#include "canvas-clearRect.h"
+#include "context-util.h"
+#include "displaylist-util.h"
+#include "pool-util.h"
+#include "profile-util.h"
+#include "trace-util.h"
+#include "tile-util.h"
+
+/*
+ * Renders display lists into frames of any size with an offscreen context of
+ * one tile. The commands are binned first: a pass over the list tracks the
+ * transformation and the immediate path to find the bounds of every drawing
+ * command, state commands touch every tile. Commands that build a path get
+ * the bounds of everything drawn with the path, so a tile replays a path only
+ * if it fills or strokes something there. The bins of the tiles are filled in
+ * parallel on the worker pool and keep the order of the list.
+ *
+ * The tiles are rasterized one after another since all contexts share the
+ * OpenVG context of the JS thread. The tile context reports the size of the
+ * whole frame (all coordinates are flipped with the frame height like on a
+ * surface of that size) and its offset moves the frame to the tile.
+ */
+
+// commands that do not draw or can not be bounded (text) touch every tile
+#define TILE_UTIL_INFINITE { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX }
+#define TILE_UTIL_EMPTY { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX }
+
+// a command of the list and its bounds in surface coordinates of the frame
+typedef struct tile_util_command_t
+{
+	uint32_t offset;
+	int32_t path;
+	VGfloat bounds[4];
+} tile_util_command_t;
+
+typedef struct tile_util_state_t
+{
+	VGfloat matrix[6];
+	VGfloat line_width;
+	VGfloat miter_limit;
+} tile_util_state_t;
+
+typedef struct tile_util_job_t
+{
+	tile_util_bins_t *bins;
+	tile_util_command_t *commands;
+} tile_util_job_t;
+
+static tile_util_stats_t tile_util_stats;
+
+static double tile_util_now(void)
+{
+	struct timespec time;
+	
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	
+	return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+}
+
+/**
+ * Multiplies an affine matrix (a, b, c, d, e, f like vgLoadMatrix() without
+ * the projective row) with another one from the right.
+ * @param m The matrix, overwritten with the product.
+ * @param a, b, c, d, e, f The other matrix.
+ */
+static void tile_util_multiply(VGfloat *m, VGfloat a, VGfloat b, VGfloat c, VGfloat d, VGfloat e, VGfloat f)
+{
+	VGfloat product[6];
+	
+	product[0] = m[0] * a + m[2] * b;
+	product[1] = m[1] * a + m[3] * b;
+	product[2] = m[0] * c + m[2] * d;
+	product[3] = m[1] * c + m[3] * d;
+	product[4] = m[0] * e + m[2] * f + m[4];
+	product[5] = m[1] * e + m[3] * f + m[5];
+	
+	memcpy(m, product, sizeof(product));
+}
+
+/**
+ * Extends bounds by a point in canvas coordinates.
+ * @param bounds The bounds (min x, min y, max x, max y).
+ * @param m The path matrix.
+ * @param height The height of the frame.
+ * @param x, y The point.
+ */
+static void tile_util_add(VGfloat *bounds, const VGfloat *m, VGfloat height, VGfloat x, VGfloat y)
+{
+	VGfloat sx = m[0] * x + m[2] * (height - y) + m[4];
+	VGfloat sy = m[1] * x + m[3] * (height - y) + m[5];
+	
+	bounds[0] = fminf(bounds[0], sx);
+	bounds[1] = fminf(bounds[1], sy);
+	bounds[2] = fmaxf(bounds[2], sx);
+	bounds[3] = fmaxf(bounds[3], sy);
+}
+
+static void tile_util_union(VGfloat *bounds, const VGfloat *other)
+{
+	bounds[0] = fminf(bounds[0], other[0]);
+	bounds[1] = fminf(bounds[1], other[1]);
+	bounds[2] = fmaxf(bounds[2], other[2]);
+	bounds[3] = fmaxf(bounds[3], other[3]);
+}
+
+/**
+ * Sets the bounds of a drawing command to the bounds of the path, grown by the
+ * stroke (if any) and one pixel of antialiasing.
+ */
+static void tile_util_draw(VGfloat *bounds, const VGfloat *path, const tile_util_state_t *state, int stroke)
+{
+	const VGfloat *m = state->matrix;
+	VGfloat grow = 1;
+	
+	if(path[0] > path[2])
+	{
+		return;
+	}
+	
+	if(stroke)
+	{
+		// miter joins and square caps reach furthest, the norm of the matrix
+		// is never less than its largest scale
+		grow += state->line_width / 2 * fmaxf(state->miter_limit, M_SQRT2) * sqrtf(m[0] * m[0] + m[1] * m[1] + m[2] * m[2] + m[3] * m[3]);
+	}
+	
+	bounds[0] = path[0] - grow;
+	bounds[1] = path[1] - grow;
+	bounds[2] = path[2] + grow;
+	bounds[3] = path[3] + grow;
+}
+
+/**
+ * Finds the bounds of all commands of a list. Transformations are tracked the
+ * way the canvas functions apply them to the path matrix.
+ * @param list The display list.
+ * @param height The height of the frame.
+ * @return The commands (list->commands) or NULL on failure.
+ */
+static tile_util_command_t *tile_util_measure(displaylist_t *list, VGfloat height)
+{
+	const VGfloat infinite[4] = TILE_UTIL_INFINITE;
+	const VGfloat empty[4] = TILE_UTIL_EMPTY;
+	tile_util_command_t *commands = NULL;
+	tile_util_command_t *command = NULL;
+	tile_util_state_t *stack = NULL;
+	tile_util_state_t *resized = NULL;
+	tile_util_state_t state = { { 1, 0, 0, 1, 0, 0 }, 1, 10 };
+	VGfloat (*paths)[4] = NULL;
+	VGfloat path[4] = TILE_UTIL_EMPTY;
+	VGfloat *v = NULL;
+	VGfloat *m = state.matrix;
+	displaylist_item_t item;
+	size_t offset = 0;
+	size_t next = 0;
+	unsigned long index = 0;
+	int depth = 0;
+	int capacity = 0;
+	int32_t path_count = 0;
+	int32_t current = -1;
+	int i = 0;
+	
+	commands = malloc(list->commands * sizeof(tile_util_command_t));
+	// every command starts at most one path
+	paths = malloc((list->commands + 1) * sizeof(*paths));
+	if(commands == NULL || paths == NULL)
+	{
+		eprintf("Failed to allocate tile commands.\n");
+		
+		free(commands);
+		free(paths);
+		
+		return NULL;
+	}
+	
+	v = item.values;
+	
+	for(index = 0; displaylist_util_next(list, &next, &item); index++, offset = next)
+	{
+		command = &commands[index];
+		command->offset = offset;
+		command->path = -1;
+		memcpy(command->bounds, infinite, sizeof(infinite));
+		
+		switch(item.op)
+		{
+			case DISPLAYLIST_SAVE:
+				if(depth == capacity)
+				{
+					capacity = capacity ? capacity * 2 : 16;
+					resized = realloc(stack, capacity * sizeof(tile_util_state_t));
+					if(resized == NULL)
+					{
+						eprintf("Failed to allocate tile state.\n");
+						
+						free(stack);
+						free(paths);
+						free(commands);
+						
+						return NULL;
+					}
+					stack = resized;
+				}
+				stack[depth++] = state;
+				break;
+			case DISPLAYLIST_RESTORE:
+				if(depth > 0)
+				{
+					state = stack[--depth];
+				}
+				break;
+			case DISPLAYLIST_TRANSLATE:
+				tile_util_multiply(m, 1, 0, 0, 1, v[0], -v[1]);
+				break;
+			case DISPLAYLIST_SCALE:
+				tile_util_multiply(m, v[0], 0, 0, v[1], 0, 0);
+				break;
+			case DISPLAYLIST_ROTATE:
+				tile_util_multiply(m, 1, 0, 0, 1, 0, height);
+				tile_util_multiply(m, cosf(v[0]), sinf(v[0]), -sinf(v[0]), cosf(v[0]), 0, 0);
+				tile_util_multiply(m, 1, 0, 0, 1, 0, -height);
+				break;
+			case DISPLAYLIST_TRANSFORM:
+				tile_util_multiply(m, 1, 0, 0, 1, 0, height);
+				tile_util_multiply(m, v[0], -v[1], -v[2], v[3], v[4], -v[5]);
+				tile_util_multiply(m, 1, 0, 0, 1, 0, -height);
+				break;
+			case DISPLAYLIST_SET_TRANSFORM:
+				m[0] = v[0];
+				m[1] = -v[1];
+				m[2] = -v[2];
+				m[3] = v[3];
+				m[4] = v[4];
+				m[5] = -v[5];
+				tile_util_multiply(m, 1, 0, 0, 1, 0, -height);
+				break;
+			case DISPLAYLIST_RESET_TRANSFORM:
+				m[0] = 1;
+				m[1] = 0;
+				m[2] = 0;
+				m[3] = 1;
+				m[4] = 0;
+				m[5] = 0;
+				tile_util_multiply(m, 1, 0, 0, 1, 0, -height);
+				break;
+			case DISPLAYLIST_LINE_WIDTH:
+				state.line_width = v[0];
+				break;
+			case DISPLAYLIST_MITER_LIMIT:
+				state.miter_limit = v[0];
+				break;
+			case DISPLAYLIST_BEGIN_PATH:
+			case DISPLAYLIST_FILL_RECT:
+			case DISPLAYLIST_STROKE_RECT:
+				// fillRect and strokeRect replace the immediate path as well
+				current = path_count++;
+				memcpy(paths[current], empty, sizeof(empty));
+				memcpy(path, empty, sizeof(empty));
+				memcpy(command->bounds, empty, sizeof(empty));
+				command->path = current;
+				
+				if(item.op != DISPLAYLIST_BEGIN_PATH)
+				{
+					tile_util_add(path, m, height, v[0], v[1]);
+					tile_util_add(path, m, height, v[0] + v[2], v[1]);
+					tile_util_add(path, m, height, v[0] + v[2], v[1] + v[3]);
+					tile_util_add(path, m, height, v[0], v[1] + v[3]);
+					tile_util_draw(command->bounds, path, &state, item.op == DISPLAYLIST_STROKE_RECT);
+					tile_util_union(paths[current], command->bounds);
+				}
+				break;
+			case DISPLAYLIST_CIRCLES:
+				// drawCircles() leaves an empty immediate path
+				current = -1;
+				memcpy(path, empty, sizeof(empty));
+				memcpy(command->bounds, empty, sizeof(empty));
+				
+				for(i = 0; i + 2 < item.count; i += 3)
+				{
+					if(v[i + 2] > 0)
+					{
+						tile_util_add(path, m, height, v[i] - v[i + 2], v[i + 1] - v[i + 2]);
+						tile_util_add(path, m, height, v[i] + v[i + 2], v[i + 1] - v[i + 2]);
+						tile_util_add(path, m, height, v[i] + v[i + 2], v[i + 1] + v[i + 2]);
+						tile_util_add(path, m, height, v[i] - v[i + 2], v[i + 1] + v[i + 2]);
+					}
+				}
+				
+				tile_util_draw(command->bounds, path, &state, 0);
+				memcpy(path, empty, sizeof(empty));
+				break;
+			case DISPLAYLIST_CLOSE_PATH:
+			case DISPLAYLIST_MOVE_TO:
+			case DISPLAYLIST_LINE_TO:
+			case DISPLAYLIST_QUADRATIC_CURVE_TO:
+			case DISPLAYLIST_BEZIER_CURVE_TO:
+			case DISPLAYLIST_ARC:
+			case DISPLAYLIST_ELLIPSE:
+			case DISPLAYLIST_ARC_TO:
+			case DISPLAYLIST_RECT:
+			case DISPLAYLIST_POLYLINE:
+			case DISPLAYLIST_LINES:
+				if(current == -1)
+				{
+					current = path_count++;
+					memcpy(paths[current], empty, sizeof(empty));
+				}
+				
+				memcpy(command->bounds, empty, sizeof(empty));
+				command->path = current;
+				
+				// curves stay within the hull of their control points
+				if(item.op == DISPLAYLIST_ARC)
+				{
+					tile_util_add(path, m, height, v[0] - v[2], v[1] - v[2]);
+					tile_util_add(path, m, height, v[0] + v[2], v[1] - v[2]);
+					tile_util_add(path, m, height, v[0] + v[2], v[1] + v[2]);
+					tile_util_add(path, m, height, v[0] - v[2], v[1] + v[2]);
+				}
+				else if(item.op == DISPLAYLIST_ELLIPSE)
+				{
+					// covers every rotation
+					tile_util_add(path, m, height, v[0] - fmaxf(v[2], v[3]), v[1] - fmaxf(v[2], v[3]));
+					tile_util_add(path, m, height, v[0] + fmaxf(v[2], v[3]), v[1] - fmaxf(v[2], v[3]));
+					tile_util_add(path, m, height, v[0] + fmaxf(v[2], v[3]), v[1] + fmaxf(v[2], v[3]));
+					tile_util_add(path, m, height, v[0] - fmaxf(v[2], v[3]), v[1] + fmaxf(v[2], v[3]));
+				}
+				else if(item.op == DISPLAYLIST_ARC_TO)
+				{
+					// the arc depends on the current point, which is not tracked
+					memcpy(path, infinite, sizeof(infinite));
+				}
+				else if(item.op == DISPLAYLIST_RECT)
+				{
+					tile_util_add(path, m, height, v[0], v[1]);
+					tile_util_add(path, m, height, v[0] + v[2], v[1]);
+					tile_util_add(path, m, height, v[0] + v[2], v[1] + v[3]);
+					tile_util_add(path, m, height, v[0], v[1] + v[3]);
+				}
+				else
+				{
+					for(i = 0; i + 1 < item.count; i += 2)
+					{
+						tile_util_add(path, m, height, v[i], v[i + 1]);
+					}
+				}
+				break;
+			case DISPLAYLIST_FILL:
+			case DISPLAYLIST_STROKE:
+				memcpy(command->bounds, empty, sizeof(empty));
+				tile_util_draw(command->bounds, path, &state, item.op == DISPLAYLIST_STROKE);
+				if(current != -1)
+				{
+					tile_util_union(paths[current], command->bounds);
+				}
+				break;
+			case DISPLAYLIST_CLIP:
+				// the clip applies to every tile, so does its path
+				if(current != -1)
+				{
+					memcpy(paths[current], infinite, sizeof(infinite));
+				}
+				break;
+			case DISPLAYLIST_CLEAR_RECT:
+				// clearRect and drawImage ignore the transformation
+				command->bounds[0] = v[0];
+				command->bounds[1] = height - v[1] - v[3];
+				command->bounds[2] = v[0] + v[2];
+				command->bounds[3] = height - v[1];
+				break;
+			case DISPLAYLIST_DRAW_IMAGE:
+				command->bounds[0] = v[0] - 1;
+				command->bounds[1] = height - v[1] - v[3] - 1;
+				command->bounds[2] = v[0] + v[2] + 1;
+				command->bounds[3] = height - v[1] + 1;
+				break;
+			default:
+				break;
+		}
+	}
+	
+	// commands building a path touch every tile something is drawn with it
+	for(index = 0; index < list->commands; index++)
+	{
+		if(commands[index].path != -1)
+		{
+			tile_util_union(commands[index].bounds, paths[commands[index].path]);
+		}
+	}
+	
+	free(stack);
+	free(paths);
+	
+	return commands;
+}
+
+/**
+ * Fills the bin of a tile.
+ * @param user The tile_util_job_t of the binning.
+ * @param index The index of the tile (row major).
+ */
+static void tile_util_bin_tile(void *user, unsigned long index)
+{
+	tile_util_job_t *job = user;
+	tile_util_bins_t *bins = job->bins;
+	tile_util_bin_t *bin = &bins->bins[index];
+	const VGfloat *b = NULL;
+	VGfloat x0 = (index % bins->columns) * bins->tile_size;
+	VGfloat x1 = fminf(x0 + bins->tile_size, bins->width);
+	VGfloat y1 = bins->height - (VGfloat)(index / bins->columns) * bins->tile_size;
+	VGfloat y0 = fmaxf(y1 - bins->tile_size, 0);
+	unsigned long i = 0;
+	uint32_t count = 0;
+	int pass = 0;
+	
+	// counts the commands first, then stores them
+	for(pass = 0; pass < 2; pass++)
+	{
+		count = 0;
+		
+		for(i = 0; i < bins->commands; i++)
+		{
+			b = job->commands[i].bounds;
+			
+			if(b[0] < x1 && b[2] > x0 && b[1] < y1 && b[3] > y0)
+			{
+				if(pass == 1)
+				{
+					bin->offsets[count] = job->commands[i].offset;
+				}
+				
+				count++;
+			}
+		}
+		
+		if(pass == 0)
+		{
+			bin->offsets = malloc((count ? count : 1) * sizeof(uint32_t));
+			if(bin->offsets == NULL)
+			{
+				eprintf("Failed to allocate tile bin.\n");
+				
+				return;
+			}
+		}
+	}
+	
+	bin->count = count;
+}
+
+/**
+ * Bins the commands of a display list into tiles of a frame.
+ * @param list The display list.
+ * @param width The width of the frame.
+ * @param height The height of the frame.
+ * @param tile_size The edge length of the tiles, 0 for TILE_UTIL_SIZE.
+ * @param threads The number of threads, see pool_util_run().
+ * @return The bins (free with tile_util_free()) or NULL on failure.
+ */
+tile_util_bins_t *tile_util_bin(displaylist_t *list, VGint width, VGint height, VGint tile_size, int threads)
+{
+	tile_util_bins_t *bins = NULL;
+	tile_util_job_t job;
+	VGint tile = 0;
+	
+	if(tile_size <= 0)
+	{
+		tile_size = TILE_UTIL_SIZE;
+	}
+	
+	if(width <= 0 || height <= 0)
+	{
+		eprintf("Invalid frame size: %ix%i\n", width, height);
+		
+		return NULL;
+	}
+	
+	bins = calloc(1, sizeof(tile_util_bins_t));
+	if(bins == NULL)
+	{
+		eprintf("Failed to allocate tile bins.\n");
+		
+		return NULL;
+	}
+	
+	bins->width = width;
+	bins->height = height;
+	bins->tile_size = tile_size;
+	bins->columns = (width + tile_size - 1) / tile_size;
+	bins->rows = (height + tile_size - 1) / tile_size;
+	bins->commands = list->commands;
+	bins->bins = calloc(bins->columns * bins->rows, sizeof(tile_util_bin_t));
+	
+	job.bins = bins;
+	job.commands = bins->bins ? tile_util_measure(list, height) : NULL;
+	if(job.commands == NULL)
+	{
+		tile_util_free(bins);
+		
+		return NULL;
+	}
+	
+	pool_util_run(bins->columns * bins->rows, threads, tile_util_bin_tile, &job);
+	free(job.commands);
+	
+	for(tile = 0; tile < bins->columns * bins->rows; tile++)
+	{
+		if(bins->bins[tile].offsets == NULL)
+		{
+			tile_util_free(bins);
+			
+			return NULL;
+		}
+	}
+	
+	return bins;
+}
+
+/**
+ * Frees the bins of a frame.
+ * @param bins The bins.
+ */
+void tile_util_free(tile_util_bins_t *bins)
+{
+	VGint tile = 0;
+	
+	if(bins->bins != NULL)
+	{
+		for(tile = 0; tile < bins->columns * bins->rows; tile++)
+		{
+			free(bins->bins[tile].offsets);
+		}
+	}
+	
+	free(bins->bins);
+	free(bins);
+}
+
+/**
+ * Renders a display list into a frame tile by tile. The list is replayed in
+ * the default canvas state on a cleared frame, like on a canvas of the size of
+ * the frame. Recording display lists does not record the replay.
+ * @param list The display list.
+ * @param width The width of the frame.
+ * @param height The height of the frame.
+ * @param tile_size The edge length of the tiles, 0 for TILE_UTIL_SIZE.
+ * @param threads The number of threads for binning, see pool_util_run().
+ * @return The pixels of the frame (sRGBX_8888, bottom-up like readbacks, must
+ *         be freed) or NULL on failure.
+ */
+char *tile_util_render(displaylist_t *list, VGint width, VGint height, VGint tile_size, int threads)
+{
+	canvas_context_t *previous = context_util_get();
+	canvas_context_t *context = NULL;
+	displaylist_t *recording = displaylist_util_recording;
+	tile_util_bins_t *bins = NULL;
+	tile_util_bin_t *bin = NULL;
+	char *pixels = NULL;
+	double start = tile_util_now();
+	VGfloat paint_shift = 0;
+	VGint tile_x = 0;
+	VGint tile_y = 0;
+	VGint tile_width = 0;
+	VGint tile_height = 0;
+	VGint tile = 0;
+	TRACE_DECLARE(trace_begin);
+	
+	TRACE_BEGIN(trace_begin);
+	
+	bins = tile_util_bin(list, width, height, tile_size, threads);
+	if(bins == NULL)
+	{
+		return NULL;
+	}
+	
+	tile_util_stats.bin_time = tile_util_now() - start;
+	
+	PROFILE_ALLOC((size_t)width * height * 4);
+	pixels = malloc((size_t)width * height * 4);
+	if(pixels != NULL)
+	{
+		context = canvas__create_context(bins->tile_size < width ? bins->tile_size : width, bins->tile_size < height ? bins->tile_size : height);
+	}
+	
+	if(context == NULL)
+	{
+		eprintf("Failed to create tile context.\n");
+		
+		free(pixels);
+		tile_util_free(bins);
+		
+		return NULL;
+	}
+	
+	// gradients and patterns are flipped with the height of the window
+	paint_shift = height - context_util_get_window()->height;
+	
+	displaylist_util_recording = NULL;
+	context->width = width;
+	context->height = height;
+	context_util_make_current(context);
+	
+	for(tile = 0; tile < bins->columns * bins->rows; tile++)
+	{
+		bin = &bins->bins[tile];
+		tile_x = (tile % bins->columns) * bins->tile_size;
+		tile_y = (tile / bins->columns) * bins->tile_size;
+		tile_width = width - tile_x < bins->tile_size ? width - tile_x : bins->tile_size;
+		tile_height = height - tile_y < bins->tile_size ? height - tile_y : bins->tile_size;
+		
+		// the bottom left corner of the tile is the origin of the surface
+		context->offset_x = -tile_x;
+		context->offset_y = -(height - tile_y - tile_height);
+		
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_FILL_PAINT_TO_USER);
+		vgLoadIdentity();
+		vgTranslate(0, paint_shift);
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_STROKE_PAINT_TO_USER);
+		vgLoadIdentity();
+		vgTranslate(0, paint_shift);
+		vgSeti(VG_MATRIX_MODE, VG_MATRIX_PATH_USER_TO_SURFACE);
+		vgLoadIdentity();
+		vgTranslate(context->offset_x, context->offset_y);
+		
+		canvas_beginPath();
+		canvas_clearRect(tile_x, tile_y, tile_width, tile_height);
+		displaylist_util_replay_offsets(list, NULL, bin->offsets, bin->count);
+		
+		PROFILE_CALL(PROFILE_READ_PIXELS, vgReadPixels(pixels + ((size_t)(height - tile_y - tile_height) * width + tile_x) * 4, width * 4, VG_sRGBX_8888, 0, 0, tile_width, tile_height));
+		
+		tile_util_stats.executed += bin->count;
+	}
+	
+	context->width = context->surface_width;
+	context->height = context->surface_height;
+	context->offset_x = 0;
+	context->offset_y = 0;
+	context_util_make_current(previous);
+	canvas__destroy_context(context);
+	displaylist_util_recording = recording;
+	
+	tile_util_stats.renders++;
+	tile_util_stats.tiles += bins->columns * bins->rows;
+	tile_util_stats.commands += bins->commands;
+	tile_util_stats.render_time = tile_util_now() - start - tile_util_stats.bin_time;
+	
+	tile_util_free(bins);
+	
+	TRACE_END_ARG("tile", "render", trace_begin, (long long)width * height * 4);
+	
+	return pixels;
+}
+
+/**
+ * Copies the statistics of the tiled renderer.
+ * @param stats Where to copy the statistics to.
+ */
+void tile_util_get_stats(tile_util_stats_t *stats)
+{
+	*stats = tile_util_stats;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TILE_UTIL_H__
+#define __TILE_UTIL_H__
+
+#include <stdint.h>
+#include <VG/openvg.h>
+
+#include "displaylist-util.h"
+
+// default edge length of a tile in pixels
+#define TILE_UTIL_SIZE 512
+
+// commands of a display list that touch a tile, in list order
+typedef struct tile_util_bin_t
+{
+	uint32_t *offsets;
+	uint32_t count;
+} tile_util_bin_t;
+
+typedef struct tile_util_bins_t
+{
+	VGint width;
+	VGint height;
+	VGint tile_size;
+	VGint columns;
+	VGint rows;
+	tile_util_bin_t *bins;
+	unsigned long commands;
+} tile_util_bins_t;
+
+typedef struct tile_util_stats_t
+{
+	unsigned long renders;
+	unsigned long tiles;
+	unsigned long commands;
+	unsigned long executed;
+	double bin_time;
+	double render_time;
+} tile_util_stats_t;
+
+tile_util_bins_t *tile_util_bin(displaylist_t *list, VGint width, VGint height, VGint tile_size, int threads);
+void tile_util_free(tile_util_bins_t *bins);
+char *tile_util_render(displaylist_t *list, VGint width, VGint height, VGint tile_size, int threads);
+void tile_util_get_stats(tile_util_stats_t *stats);
+
+#endif /* __TILE_UTIL_H__ */
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+
+#include "include-core.h"
+#include "trace-util.h"
+#include "log-util.h"
+
+/*
+ * Every thread writes into its own ring, so recording needs neither locks nor
+ * atomics apart from publishing the write position. A ring is allocated and
+ * registered on the first event of a thread and lives until the process
+ * exits, since libuv worker threads are never joined. When a ring is full,
+ * the oldest events are overwritten.
+ */
+
+typedef struct trace_util_event_t
+{
+	const char *category;
+	const char *name;
+	uint64_t start;
+	uint64_t duration;
+	int64_t arg;
+	char phase;
+} trace_util_event_t;
+
+typedef struct trace_util_ring_t
+{
+	trace_util_event_t events[TRACE_UTIL_RING_SIZE];
+	unsigned long head;
+	const char *name;
+	int tid;
+} trace_util_ring_t;
+
+int trace_util_enabled = 0;
+
+static __thread trace_util_ring_t *trace_ring = NULL;
+static __thread const char *trace_thread_name = NULL;
+
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static trace_util_ring_t *trace_rings[TRACE_UTIL_THREADS];
+static int trace_ring_count = 0;
+static uint64_t trace_start = 0;
+static int64_t trace_frame = 0;
+
+// events overwritten while dumping are skipped by keeping this distance to the writer
+#define TRACE_UTIL_MARGIN 256
+
+/**
+ * @return Monotonic time in nanoseconds (never 0)
+ */
+uint64_t trace_util_now(void)
+{
+	struct timespec time;
+	
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	
+	return (uint64_t)time.tv_sec * 1000000000ULL + time.tv_nsec + 1;
+}
+
+/**
+ * Returns the ring of the calling thread, registering it if necessary.
+ */
+static trace_util_ring_t *trace_util_get_ring(void)
+{
+	trace_util_ring_t *ring = NULL;
+	
+	if(trace_ring)
+	{
+		return trace_ring;
+	}
+	
+	pthread_mutex_lock(&trace_mutex);
+	
+	if(trace_ring_count < TRACE_UTIL_THREADS)
+	{
+		ring = calloc(1, sizeof(trace_util_ring_t));
+		if(ring)
+		{
+			ring->tid = trace_ring_count + 1;
+			ring->name = trace_thread_name;
+			trace_rings[trace_ring_count++] = ring;
+		}
+		else
+		{
+			eprintf("Failed to allocate trace buffer.\n");
+		}
+	}
+	
+	pthread_mutex_unlock(&trace_mutex);
+	
+	trace_ring = ring;
+	
+	return ring;
+}
+
+/**
+ * Starts recording. Events recorded before are dropped from the next dump.
+ */
+void trace_util_start(void)
+{
+	trace_start = trace_util_now();
+	trace_util_enabled = 1;
+}
+
+/**
+ * Stops recording. The recorded events remain available for trace_util_dump().
+ */
+void trace_util_stop(void)
+{
+	trace_util_enabled = 0;
+}
+
+/**
+ * Names the calling thread in the trace (e.g. "main", "present").
+ *
+ * @param name The name (must stay valid)
+ */
+void trace_util_set_thread_name(const char *name)
+{
+	trace_thread_name = name;
+	
+	if(trace_ring)
+	{
+		trace_ring->name = name;
+	}
+}
+
+static void trace_util_push(char phase, const char *category, const char *name, uint64_t start, uint64_t duration, int64_t arg)
+{
+	trace_util_ring_t *ring = trace_util_get_ring();
+	trace_util_event_t *event = NULL;
+	
+	if(!ring)
+	{
+		return;
+	}
+	
+	event = &ring->events[ring->head % TRACE_UTIL_RING_SIZE];
+	event->phase = phase;
+	event->category = category;
+	event->name = name;
+	event->start = start;
+	event->duration = duration;
+	event->arg = arg;
+	
+	// publish the event to the dumping thread
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Records a span from start until now.
+ *
+ * @param category Category (string literal)
+ * @param name Name (string literal)
+ * @param start Start time from TRACE_BEGIN
+ * @param arg Numeric argument or -1
+ */
+void trace_util_complete(const char *category, const char *name, uint64_t start, int64_t arg)
+{
+	trace_util_push('X', category, name, start, trace_util_now() - start, arg);
+}
+
+/**
+ * Records an instant event (e.g. the start of a frame).
+ */
+void trace_util_instant(const char *category, const char *name, int64_t arg)
+{
+	if(!trace_util_enabled)
+	{
+		return;
+	}
+	
+	trace_util_push('i', category, name, trace_util_now(), 0, arg);
+}
+
+/**
+ * Marks the end of a frame, so the events can be grouped by frame in the viewer.
+ */
+void trace_util_frame(void)
+{
+	trace_util_instant("frame", "frame", trace_frame++);
+}
+
+/**
+ * Appends formatted text to a growing buffer.
+ */
+static int trace_util_append(char **buffer, size_t *length, size_t *capacity, const char *format, ...)
+{
+	va_list args;
+	int written = 0;
+	char *grown = NULL;
+	
+	for(;;)
+	{
+		va_start(args, format);
+		written = vsnprintf(*buffer + *length, *capacity - *length, format, args);
+		va_end(args);
+		
+		if(written < 0)
+		{
+			return -1;
+		}
+		
+		if(*length + written < *capacity)
+		{
+			*length += written;
+			return 0;
+		}
+		
+		grown = realloc(*buffer, *capacity * 2);
+		if(!grown)
+		{
+			return -1;
+		}
+		
+		*buffer = grown;
+		*capacity *= 2;
+	}
+}
+
+/**
+ * Serializes all recorded events in the Chrome trace event format
+ * (chrome://tracing, Perfetto).
+ *
+ * @param length Pointer where to write the length of the JSON to
+ * @return The JSON (must be freed) or NULL
+ */
+char *trace_util_dump(size_t *length)
+{
+	size_t capacity = 65536;
+	char *buffer = malloc(capacity);
+	trace_util_ring_t *ring = NULL;
+	trace_util_event_t event;
+	unsigned long head = 0;
+	unsigned long index = 0;
+	int pid = getpid();
+	int count = 0;
+	int first = 1;
+	int failed = 0;
+	int i = 0;
+	
+	*length = 0;
+	
+	if(!buffer)
+	{
+		return NULL;
+	}
+	
+	buffer[0] = '\0';
+	
+	pthread_mutex_lock(&trace_mutex);
+	count = trace_ring_count;
+	pthread_mutex_unlock(&trace_mutex);
+	
+	failed |= trace_util_append(&buffer, length, &capacity, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	
+	for(i = 0; i < count && !failed; i++)
+	{
+		ring = trace_rings[i];
+		
+		failed |= trace_util_append(&buffer, length, &capacity, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+			first ? "" : ",", pid, ring->tid, ring->name ? ring->name : "thread");
+		first = 0;
+		
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		index = head > TRACE_UTIL_RING_SIZE - TRACE_UTIL_MARGIN ? head - (TRACE_UTIL_RING_SIZE - TRACE_UTIL_MARGIN) : 0;
+		
+		for(; index < head && !failed; index++)
+		{
+			event = ring->events[index % TRACE_UTIL_RING_SIZE];
+			
+			if(event.start < trace_start)
+			{
+				continue;
+			}
+			
+			failed |= trace_util_append(&buffer, length, &capacity, ",{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f",
+				event.phase, event.category, event.name, pid, ring->tid, event.start / 1e3);
+			
+			if(event.phase == 'X')
+			{
+				failed |= trace_util_append(&buffer, length, &capacity, ",\"dur\":%.3f", event.duration / 1e3);
+			}
+			else
+			{
+				failed |= trace_util_append(&buffer, length, &capacity, ",\"s\":\"p\"");
+			}
+			
+			if(event.arg >= 0)
+			{
+				failed |= trace_util_append(&buffer, length, &capacity, ",\"args\":{\"value\":%lld}", (long long)event.arg);
+			}
+			
+			failed |= trace_util_append(&buffer, length, &capacity, "}");
+		}
+	}
+	
+	failed |= trace_util_append(&buffer, length, &capacity, "]}");
+	
+	if(failed)
+	{
+		eprintf("Failed to serialize trace.\n");
+		
+		free(buffer);
+		*length = 0;
+		
+		return NULL;
+	}
+	
+	return buffer;
+}
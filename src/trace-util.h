@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Hauke Oldsen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TRACE_UTIL_H__
+#define __TRACE_UTIL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE_UTIL_RING_SIZE 16384
+#define TRACE_UTIL_THREADS 64
+
+extern int trace_util_enabled;
+
+/**
+ * Declares the start time of a span, together with the other declarations of
+ * the function.
+ */
+#define TRACE_DECLARE(start) \
+	uint64_t start = 0
+
+/**
+ * Starts a span declared with TRACE_DECLARE. The start time stays 0 if
+ * tracing is disabled.
+ */
+#define TRACE_BEGIN(start) \
+	start = trace_util_enabled ? trace_util_now() : 0
+
+/**
+ * Ends a span started with TRACE_BEGIN and records it as complete event.
+ */
+#define TRACE_END(category, name, start) \
+	do \
+	{ \
+		if(start) \
+		{ \
+			trace_util_complete(category, name, start, -1); \
+		} \
+	} while(0)
+
+/**
+ * Like TRACE_END, with an additional numeric argument (e.g. a size or an id).
+ */
+#define TRACE_END_ARG(category, name, start, arg) \
+	do \
+	{ \
+		if(start) \
+		{ \
+			trace_util_complete(category, name, start, arg); \
+		} \
+	} while(0)
+
+uint64_t trace_util_now(void);
+void trace_util_start(void);
+void trace_util_stop(void);
+void trace_util_set_thread_name(const char *name);
+void trace_util_complete(const char *category, const char *name, uint64_t start, int64_t arg);
+void trace_util_instant(const char *category, const char *name, int64_t arg);
+void trace_util_frame(void);
+char *trace_util_dump(size_t *length);
+
+#endif /* __TRACE_UTIL_H__ */
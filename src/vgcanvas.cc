@@ -23,11 +23,26 @@ extern "C" {
 	#include "font-util.h"
 	#include "log-util.h"
 	#include "image-util.h"
+	#include "readback-util.h"
+	#include "dirty-util.h"
+	#include "cull-util.h"
+	#include "path-util.h"
+	#include "hit-util.h"
+	#include "color-util.h"
+	#include "profile-util.h"
+	#include "trace-util.h"
+	#include "memory-util.h"
+	#include "layer-util.h"
+	#include "present-util.h"
+	#include "tile-util.h"
 	#include "canvas.h"
 	#include "canvas-font.h"
 	#include "canvas-paint.h"
 	#include "canvas-fillRect.h"
 	#include "canvas-arc.h"
+	#include "canvas-arcTo.h"
+	#include "canvas-ellipse.h"
+	#include "canvas-drawCircles.h"
 	#include "canvas-beginPath.h"
 	#include "canvas-bezierCurveTo.h"
 	#include "canvas-clearRect.h"
@@ -47,6 +62,8 @@ extern "C" {
 	#include "canvas-moveTo.h"
 	#include "canvas-quadraticCurveTo.h"
 	#include "canvas-rect.h"
+	#include "canvas-polyline.h"
+	#include "canvas-strokeSeries.h"
 	#include "canvas-restore.h"
 	#include "canvas-save.h"
 	#include "canvas-setLineDash.h"
@@ -73,16 +90,25 @@ extern "C" {
 #include <nan.h>
 #include <string>
 #include <map>
+#include <algorithm>
+#include <vector>
 #include <cstdio>
+#include "context.h"
+#include "displaylist.h"
 #include "gradient.h"
 #include "image.h"
 #include "pattern.h"
+#include "scheduler.h"
+#include "textblob.h"
+#include "vgcanvas.h"
 
 using namespace v8;
 
 namespace vgcanvas {
 
+	// prepared color paints, referenced from JS by their handle
 	static std::map<uint32_t, paint_t*> paintMap;
+	static uint32_t paintHandle = 0;
 	static bool initialized = false;
 
 	bool checkArgs(const Nan::FunctionCallbackInfo<Value> &args, int number, int offset) {
@@ -124,12 +150,213 @@ namespace vgcanvas {
 		}
 		
 		args.GetIsolate()->SetFatalErrorHandler(ErrorHandler);
+		trace_util_set_thread_name("main");
 		canvas__init();
+		Scheduler::Start();
 		initialized = true;
+		
+		args.GetReturnValue().Set(Context::NewWindow());
 	}
 
 	void SwapBuffers(const Nan::FunctionCallbackInfo<Value>& args) {
-		egl_swap_buffers();
+		VGint x, y, width, height;
+		
+		// open layers are dropped, unused ones evicted
+		layer_util_frame();
+		
+		// only the window is presented
+		context_util_make_current(context_util_get_window());
+		
+		readback_util_swap();
+		profile_util_frame();
+		cull_util_frame();
+		trace_util_frame();
+		
+		if(!dirty_util_get(&x, &y, &width, &height)) {
+			// nothing has been drawn, the presented frame is still up to date
+			dirty_util_skipped();
+			return;
+		}
+		
+		dirty_util_swapped(present_util_swap(x, y, width, height));
+		readback_util_presented();
+	}
+	
+	void GetDirtyRect(const Nan::FunctionCallbackInfo<Value>& args) {
+		VGint x, y, width, height;
+		
+		context_util_make_current(context_util_get_window());
+		
+		if(!dirty_util_get(&x, &y, &width, &height)) {
+			args.GetReturnValue().SetNull();
+			return;
+		}
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("x").ToLocalChecked(), Nan::New(x));
+		obj->Set(Nan::New("y").ToLocalChecked(), Nan::New(egl_get_height() - y - height));
+		obj->Set(Nan::New("width").ToLocalChecked(), Nan::New(width));
+		obj->Set(Nan::New("height").ToLocalChecked(), Nan::New(height));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void GetDirtyStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		dirty_util_stats_t stats;
+		dirty_util_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("frames").ToLocalChecked(), Nan::New<Number>(stats.frames));
+		obj->Set(Nan::New("skipped").ToLocalChecked(), Nan::New<Number>(stats.skipped));
+		obj->Set(Nan::New("partial").ToLocalChecked(), Nan::New<Number>(stats.partial));
+		obj->Set(Nan::New("coverageLast").ToLocalChecked(), Nan::New(stats.coverage_last));
+		obj->Set(Nan::New("coverageAverage").ToLocalChecked(), Nan::New(stats.coverage_average));
+		
+		args.GetReturnValue().Set(obj);
+	}
+
+	void GetCullStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		cull_util_stats_t stats;
+		cull_util_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("enabled").ToLocalChecked(), Nan::New<Boolean>(cull_util_get_enabled()));
+		obj->Set(Nan::New("frames").ToLocalChecked(), Nan::New<Number>(stats.frames));
+		obj->Set(Nan::New("draws").ToLocalChecked(), Nan::New<Number>(stats.draws));
+		obj->Set(Nan::New("culled").ToLocalChecked(), Nan::New<Number>(stats.culled));
+		obj->Set(Nan::New("drawsLast").ToLocalChecked(), Nan::New<Number>(stats.draws_last));
+		obj->Set(Nan::New("culledLast").ToLocalChecked(), Nan::New<Number>(stats.culled_last));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void SetCulling(const Nan::FunctionCallbackInfo<Value>& args) {
+		cull_util_set_enabled(args.Length() > 0 && args[0]->BooleanValue());
+	}
+	
+	void SetGlyphAtlas(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 1)) {
+			Nan::ThrowTypeError("wrong arg");
+			return;
+		}
+		
+		font_util_atlas_set_size(args[0]->NumberValue());
+	}
+	
+	void GetGlyphAtlasStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		font_util_atlas_stats_t stats;
+		font_util_atlas_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("maxSize").ToLocalChecked(), Nan::New<Number>(font_util_atlas_get_size()));
+		obj->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>(stats.hits));
+		obj->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>(stats.misses));
+		obj->Set(Nan::New("evicted").ToLocalChecked(), Nan::New<Number>(stats.evicted));
+		obj->Set(Nan::New("pages").ToLocalChecked(), Nan::New<Number>(stats.pages));
+		obj->Set(Nan::New("glyphs").ToLocalChecked(), Nan::New<Number>(stats.glyphs));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void SetFontCache(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !(args[0]->IsString() || args[0]->IsNull())) {
+			Nan::ThrowTypeError("wrong arg");
+			return;
+		}
+		
+		std::string dir = args[0]->IsString() ? *Nan::Utf8String(args[0]) : "";
+		
+		if(font_util_cache_set_dir((char *)dir.c_str()) == -1) {
+			std::string msg = "Failed to set font cache: ";
+			msg += strerror(errno);
+			Nan::ThrowError(msg.c_str());
+		}
+	}
+	
+	void GetFontCacheStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		font_util_cache_stats_t stats;
+		font_util_cache_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		if(font_util_cache_get_dir() != NULL) {
+			obj->Set(Nan::New("dir").ToLocalChecked(), Nan::New(font_util_cache_get_dir()).ToLocalChecked());
+		} else {
+			obj->Set(Nan::New("dir").ToLocalChecked(), Nan::Null());
+		}
+		obj->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>(stats.hits));
+		obj->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>(stats.misses));
+		obj->Set(Nan::New("written").ToLocalChecked(), Nan::New<Number>(stats.written));
+		obj->Set(Nan::New("rejected").ToLocalChecked(), Nan::New<Number>(stats.rejected));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void BeginLayer(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsString()) {
+			Nan::ThrowTypeError("wrong arg");
+			return;
+		}
+		
+		VGfloat x = 0, y = 0, width = 0, height = 0;
+		
+		if(args.Length() >= 5) {
+			x = args[1]->NumberValue();
+			y = args[2]->NumberValue();
+			width = args[3]->NumberValue();
+			height = args[4]->NumberValue();
+		}
+		
+		args.GetReturnValue().Set(Nan::New<Boolean>(layer_util_begin(*Nan::Utf8String(args[0]), x, y, width, height) != 0));
+	}
+	
+	void EndLayer(const Nan::FunctionCallbackInfo<Value>& args) {
+		layer_util_end();
+	}
+	
+	void InvalidateLayer(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() >= 1 && args[0]->IsString()) {
+			layer_util_invalidate(*Nan::Utf8String(args[0]));
+		} else {
+			layer_util_invalidate(NULL);
+		}
+	}
+	
+	void ClearLayers(const Nan::FunctionCallbackInfo<Value>& args) {
+		layer_util_clear();
+	}
+	
+	void GetLayerStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		layer_util_stats_t stats;
+		layer_util_get_stats(&stats);
+		
+		Local<Object> invalidated = Nan::New<Object>();
+		invalidated->Set(Nan::New("transform").ToLocalChecked(), Nan::New<Number>(stats.invalidated_transform));
+		invalidated->Set(Nan::New("bounds").ToLocalChecked(), Nan::New<Number>(stats.invalidated_bounds));
+		invalidated->Set(Nan::New("explicit").ToLocalChecked(), Nan::New<Number>(stats.invalidated_explicit));
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>(stats.hits));
+		obj->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>(stats.misses));
+		obj->Set(Nan::New("invalidated").ToLocalChecked(), invalidated);
+		obj->Set(Nan::New("evicted").ToLocalChecked(), Nan::New<Number>(stats.evicted));
+		obj->Set(Nan::New("bypassed").ToLocalChecked(), Nan::New<Number>(stats.bypassed));
+		obj->Set(Nan::New("layers").ToLocalChecked(), Nan::New<Number>(stats.layers));
+		obj->Set(Nan::New("pixels").ToLocalChecked(), Nan::New<Number>(stats.pixels));
+		
+		args.GetReturnValue().Set(obj);
+	}
+
+	static void DestroyPaint(std::map<uint32_t, paint_t*>::iterator it) {
+		canvas__release_paint(it->second);
+		paint_cleanup(it->second);
+		delete it->second;
+		paintMap.erase(it);
+	}
+
+	static void DestroyPaints() {
+		while(!paintMap.empty()) {
+			DestroyPaint(paintMap.begin());
+		}
 	}
 
 	void Cleanup(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -138,6 +365,11 @@ namespace vgcanvas {
 			return;
 		}
 		
+		Scheduler::Stop();
+		ResetRecording();
+		ResetContextBinding();
+		present_util_acquire();
+		DestroyPaints();
 		canvas__cleanup();
 		initialized = false;
 	}
@@ -148,6 +380,7 @@ namespace vgcanvas {
 		}
 
 		canvas_fillRect(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue());
+		Record(DISPLAYLIST_FILL_RECT, args, 4);
 	}
 
 	void ClearRect(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -156,6 +389,7 @@ namespace vgcanvas {
 		}
 
 		canvas_clearRect(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue());
+		Record(DISPLAYLIST_CLEAR_RECT, args, 4);
 	}
 
 	void SetFillStyle(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -180,11 +414,11 @@ namespace vgcanvas {
 	}
 
 	void GetScreenWidth(const Nan::FunctionCallbackInfo<Value>& args) {
-		args.GetReturnValue().Set(Nan::New(egl_get_width()));
+		args.GetReturnValue().Set(Nan::New(egl_get_screen_width()));
 	}
 
 	void GetScreenHeight(const Nan::FunctionCallbackInfo<Value>& args) {
-		args.GetReturnValue().Set(Nan::New(egl_get_height()));
+		args.GetReturnValue().Set(Nan::New(egl_get_screen_height()));
 	}
 
 	void SetLineWidth(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -193,6 +427,7 @@ namespace vgcanvas {
 		}
 
 		canvas_lineWidth(args[0]->NumberValue());
+		Record(DISPLAYLIST_LINE_WIDTH, args, 1);
 	}
 
 	void GetLineWidth(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -205,7 +440,9 @@ namespace vgcanvas {
 			return;
 		}
 
-		canvas_lineCap(*Nan::Utf8String(args[0]));
+		Nan::Utf8String value(args[0]);
+		canvas_lineCap(*value);
+		Record(DISPLAYLIST_LINE_CAP, *value, 0, NULL);
 	}
 
 	void GetLineCap(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -218,7 +455,9 @@ namespace vgcanvas {
 			return;
 		}
 
-		canvas_lineJoin(*Nan::Utf8String(args[0]));
+		Nan::Utf8String value(args[0]);
+		canvas_lineJoin(*value);
+		Record(DISPLAYLIST_LINE_JOIN, *value, 0, NULL);
 
 	}
 
@@ -226,72 +465,155 @@ namespace vgcanvas {
 		args.GetReturnValue().Set(Nan::New(canvas_lineJoin_get()).ToLocalChecked());
 	}
 
+	// reads a CSS color string or an [r, g, b, a] array, returns false for invalid colors
+	static bool GetColor(Local<Value> value, VGfloat color[4]) {
+		if(value->IsString()) {
+			return color_util_get(*Nan::Utf8String(value), color) != -1;
+		}
+
+		if(!value->IsArray() || Local<Array>::Cast(value)->Length() != 4) {
+			return false;
+		}
+
+		Local<Array> ar = Local<Array>::Cast(value);
+		for(int i = 0; i < 4; i++) {
+			color[i] = ar->Get(i)->NumberValue();
+		}
+
+		return true;
+	}
+
+	// returns a handle to a color paint that can be set as style without
+	// parsing or converting the color again, or null for invalid colors
+	void PreparePaint(const Nan::FunctionCallbackInfo<Value>& args) {
+		VGfloat color[4];
+
+		if(args.Length() < 1 || !GetColor(args[0], color)) {
+			args.GetReturnValue().SetNull();
+			return;
+		}
+
+		paint_t *paint = new paint_t;
+		paint_createColor(paint, color[0], color[1], color[2], color[3]);
+
+		// 0 is never used as handle
+		do {
+			paintHandle++;
+		} while(paintHandle == 0 || paintMap.count(paintHandle) != 0);
+
+		paintMap[paintHandle] = paint;
+		args.GetReturnValue().Set(Nan::New<Number>(paintHandle));
+	}
+
+	// styles still using the paint keep its color
+	void ReleasePaint(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 1)) {
+			return;
+		}
+
+		std::map<uint32_t, paint_t*>::iterator it = paintMap.find(args[0]->Uint32Value());
+		if(it == paintMap.end()) {
+			args.GetReturnValue().Set(Nan::False());
+			return;
+		}
+
+		DestroyPaint(it);
+		args.GetReturnValue().Set(Nan::True());
+	}
+
 	void SetStyle(const Nan::FunctionCallbackInfo<Value>& args) {
-		if(args.Length() != 2 || !args[0]->IsBoolean() || !args[1]->IsObject()) {
+		if(args.Length() != 2 || !args[0]->IsBoolean() || !(args[1]->IsObject() || args[1]->IsString() || args[1]->IsNumber())) {
 			Nan::ThrowTypeError("wrong arg");
 			return;
 		}
 		
 		bool stroke = Local<Boolean>::Cast(args[0])->Value();
 
-		if(args[1]->IsArray()) {
+		if(args[1]->IsString()) {
+			// CSS color, invalid colors are ignored and return false
+			VGfloat color[4];
+			if(color_util_get(*Nan::Utf8String(args[1]), color) == -1) {
+				args.GetReturnValue().Set(Nan::False());
+				return;
+			}
+
+			canvas__set_style_color(stroke, color[0], color[1], color[2], color[3]);
+			Record(stroke ? DISPLAYLIST_STROKE_COLOR : DISPLAYLIST_FILL_COLOR, 4, color);
+			args.GetReturnValue().Set(Nan::True());
+		} else if(args[1]->IsNumber()) {
+			// prepared paint, unknown handles are ignored and return false
+			std::map<uint32_t, paint_t*>::iterator it = paintMap.find(args[1]->Uint32Value());
+			if(it == paintMap.end()) {
+				args.GetReturnValue().Set(Nan::False());
+				return;
+			}
+
+			canvas__set_style_paint(stroke, it->second);
+			Record(stroke ? DISPLAYLIST_STROKE_COLOR : DISPLAYLIST_FILL_COLOR, 4, it->second->data);
+			args.GetReturnValue().Set(Nan::True());
+		} else if(args[1]->IsArray()) {
 			Local<Array> ar = Local<Array>::Cast(args[1]);
 			if(ar->Length() != 4) {
 				Nan::ThrowTypeError("wrong number of elements");
 				return;
 			}
 
-			paint_t *paint = stroke ? canvas_strokeStyle_get() : canvas_fillStyle_get();
-			if(paint->paint_type == PAINT_TYPE_COLOR) {
-				paint_setRGBA(paint, ar->Get(0)->NumberValue(), ar->Get(1)->NumberValue(),
-					ar->Get(2)->NumberValue(), ar->Get(3)->NumberValue());
-			} else {
-				// paint type is gradient
-				paint = new paint_t;
-				paint_createColor(paint, ar->Get(0)->NumberValue(), ar->Get(1)->NumberValue(),
-					ar->Get(2)->NumberValue(), ar->Get(3)->NumberValue());
-				
-				if(stroke) {
-					canvas_strokeStyle(paint);
-				} else {
-					canvas_fillStyle(paint);
-				}
-				
-			}
+			VGfloat color[4] = { (VGfloat)ar->Get(0)->NumberValue(), (VGfloat)ar->Get(1)->NumberValue(),
+				(VGfloat)ar->Get(2)->NumberValue(), (VGfloat)ar->Get(3)->NumberValue() };
+			canvas__set_style_color(stroke, color[0], color[1], color[2], color[3]);
+			Record(stroke ? DISPLAYLIST_STROKE_COLOR : DISPLAYLIST_FILL_COLOR, 4, color);
 		} else {
 			//Gradient or pattern object
-			paint_t *paint = stroke ? canvas_strokeStyle_get() : canvas_fillStyle_get();
-			if(paint->paint_type == PAINT_TYPE_COLOR) {
-				paint_cleanup(paint);
-				delete paint;
-			}
-
 			Local<Object> obj = Local<Object>::Cast(args[1]);
 			std::string constructor(*Nan::Utf8String(obj->GetConstructorName()));
+			paint_t *paint = NULL;
 
 			if(constructor == "Gradient") {
-				Gradient *gr = Gradient::Unwrap<Gradient>(obj);
-				if(stroke) {
-					canvas_strokeStyle(gr->GetPaint());
-				} else {
-					canvas_fillStyle(gr->GetPaint());
-				}
+				paint = Gradient::Unwrap<Gradient>(obj)->GetPaint();
 			} else if(constructor == "Pattern") {
-				Pattern *pattern = Pattern::Unwrap<Pattern>(obj);
-				if(stroke) {
-					canvas_strokeStyle(pattern->GetPaint());
-				} else {
-					canvas_fillStyle(pattern->GetPaint());
-				}
+				paint = Pattern::Unwrap<Pattern>(obj)->GetPaint();
 			} else {
 				Nan::ThrowTypeError("type of object is neither Gradient nor Pattern");
 				return;
 			}
 
+			canvas__set_style_paint(stroke, paint);
+			RecordPaint(stroke ? DISPLAYLIST_STROKE_PAINT : DISPLAYLIST_FILL_PAINT, paint, obj);
 		}
 
 	}
 	
+	// returns [r, g, b, a] (0..1) or null if the string is not a valid CSS color
+	void ParseColor(const Nan::FunctionCallbackInfo<Value>& args) {
+		VGfloat color[4];
+		
+		if(args.Length() < 1 || color_util_get(*Nan::Utf8String(args[0]), color) == -1) {
+			args.GetReturnValue().SetNull();
+			return;
+		}
+		
+		Local<Array> array = Nan::New<Array>(4);
+		for(int i = 0; i < 4; i++) {
+			array->Set(i, Nan::New(color[i]));
+		}
+		
+		args.GetReturnValue().Set(array);
+	}
+	
+	void GetColorStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		color_util_stats_t stats;
+		color_util_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>(stats.hits));
+		obj->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>(stats.misses));
+		obj->Set(Nan::New("invalid").ToLocalChecked(), Nan::New<Number>(stats.invalid));
+		obj->Set(Nan::New("flushes").ToLocalChecked(), Nan::New<Number>(stats.flushes));
+		obj->Set(Nan::New("entries").ToLocalChecked(), Nan::New<Number>(stats.entries));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
 	void GetStrokeStyle(const Nan::FunctionCallbackInfo<Value>& args) {
 		/*color_t color = canvas_getState()->strokeColor;
 
@@ -311,15 +633,17 @@ namespace vgcanvas {
 		}
 
 		canvas_strokeRect(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue());
-
+		Record(DISPLAYLIST_STROKE_RECT, args, 4);
 	}
 
 	void BeginPath(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_beginPath();
+		Record(DISPLAYLIST_BEGIN_PATH, 0, NULL);
 	}
 
 	void ClosePath(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_closePath();
+		Record(DISPLAYLIST_CLOSE_PATH, 0, NULL);
 	}
 
 	void MoveTo(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -328,6 +652,7 @@ namespace vgcanvas {
 		}
 
 		canvas_moveTo(args[0]->NumberValue(), args[1]->NumberValue());
+		Record(DISPLAYLIST_MOVE_TO, args, 2);
 	}
 
 	void LineTo(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -336,14 +661,17 @@ namespace vgcanvas {
 		}
 
 		canvas_lineTo(args[0]->NumberValue(), args[1]->NumberValue());
+		Record(DISPLAYLIST_LINE_TO, args, 2);
 	}
 
 	void Stroke(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_stroke();
+		Record(DISPLAYLIST_STROKE, 0, NULL);
 	}
 
 	void Fill(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_fill();
+		Record(DISPLAYLIST_FILL, 0, NULL);
 	}
 
 	void QuadraticCurveTo(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -352,6 +680,7 @@ namespace vgcanvas {
 		}
 
 		canvas_quadraticCurveTo(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue());
+		Record(DISPLAYLIST_QUADRATIC_CURVE_TO, args, 4);
 	}
 
 	void BezierCurveTo(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -360,6 +689,7 @@ namespace vgcanvas {
 		}
 
 		canvas_bezierCurveTo(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue(), args[4]->NumberValue(), args[5]->NumberValue());
+		Record(DISPLAYLIST_BEZIER_CURVE_TO, args, 6);
 	}
 
 	void Arc(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -367,12 +697,61 @@ namespace vgcanvas {
 			return;
 		}
 
+		if(args[2]->NumberValue() < 0) {
+			Nan::ThrowRangeError("The radius is negative");
+			return;
+		}
+
 		bool acw = false;
 		if(args.Length() > 5 && args[5]->IsBoolean()) {
 			acw = args[5]->BooleanValue();
 		}
 
 		canvas_arc(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue(), args[4]->NumberValue(), acw);
+		
+		if(displaylist_util_recording) {
+			VGfloat values[6] = { (VGfloat)args[0]->NumberValue(), (VGfloat)args[1]->NumberValue(), (VGfloat)args[2]->NumberValue(),
+				(VGfloat)args[3]->NumberValue(), (VGfloat)args[4]->NumberValue(), acw ? 1.0f : 0.0f };
+			Record(DISPLAYLIST_ARC, 6, values);
+		}
+	}
+
+	void Ellipse(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 7)) {
+			return;
+		}
+
+		if(args[2]->NumberValue() < 0 || args[3]->NumberValue() < 0) {
+			Nan::ThrowRangeError("The radius is negative");
+			return;
+		}
+
+		bool acw = false;
+		if(args.Length() > 7 && args[7]->IsBoolean()) {
+			acw = args[7]->BooleanValue();
+		}
+
+		canvas_ellipse(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue(), args[4]->NumberValue(), args[5]->NumberValue(), args[6]->NumberValue(), acw);
+		
+		if(displaylist_util_recording) {
+			VGfloat values[8] = { (VGfloat)args[0]->NumberValue(), (VGfloat)args[1]->NumberValue(), (VGfloat)args[2]->NumberValue(), (VGfloat)args[3]->NumberValue(),
+				(VGfloat)args[4]->NumberValue(), (VGfloat)args[5]->NumberValue(), (VGfloat)args[6]->NumberValue(), acw ? 1.0f : 0.0f };
+			Record(DISPLAYLIST_ELLIPSE, 8, values);
+		}
+	}
+
+	void ArcTo(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 5)) {
+			return;
+		}
+
+		if(args[4]->NumberValue() < 0) {
+			Nan::ThrowRangeError("The radius is negative");
+			return;
+		}
+
+		canvas_arcTo(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue(), args[4]->NumberValue());
+		Record(DISPLAYLIST_ARC_TO, args, 5);
 	}
 
 	void Rect(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -381,8 +760,150 @@ namespace vgcanvas {
 		}
 
 		canvas_rect(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue());
+		Record(DISPLAYLIST_RECT, args, 4);
 	}
 
+	// polyline(points, closed): points is a Float32Array of x, y pairs, read in place
+	void Polyline(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsFloat32Array()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		Local<Float32Array> array = Local<Float32Array>::Cast(args[0]);
+		const VGfloat *points = reinterpret_cast<const VGfloat*>(static_cast<char*>(array->Buffer()->GetContents().Data()) + array->ByteOffset());
+		VGint count = array->Length() / 2;
+		int closed = args.Length() > 1 && args[1]->BooleanValue();
+		
+		canvas_polyline(points, count, closed);
+		
+		if(displaylist_util_recording) {
+			displaylist_util_record_polyline(points, count, closed);
+		}
+	}
+	
+	// strokeSeries(xs, ys, decimate): xs and ys are Float32Arrays, returns the amount of stroked samples
+	void StrokeSeries(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 2 || !args[0]->IsFloat32Array() || !args[1]->IsFloat32Array()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		Local<Float32Array> xs = Local<Float32Array>::Cast(args[0]);
+		Local<Float32Array> ys = Local<Float32Array>::Cast(args[1]);
+		VGint count = std::min(xs->Length(), ys->Length());
+		int decimate = args.Length() < 3 || args[2]->BooleanValue();
+		const VGfloat *points = NULL;
+		
+		count = canvas_strokeSeries(
+			reinterpret_cast<const VGfloat*>(static_cast<char*>(xs->Buffer()->GetContents().Data()) + xs->ByteOffset()),
+			reinterpret_cast<const VGfloat*>(static_cast<char*>(ys->Buffer()->GetContents().Data()) + ys->ByteOffset()),
+			count, decimate, &points);
+		
+		if(count == -1) {
+			Nan::ThrowError("Failed to allocate memory");
+			return;
+		}
+		
+		// the kept samples are recorded, replaying at another scale does not decimate again
+		if(displaylist_util_recording) {
+			Record(DISPLAYLIST_BEGIN_PATH, 0, NULL);
+			displaylist_util_record_polyline(points, count, 0);
+			Record(DISPLAYLIST_STROKE, 0, NULL);
+		}
+		
+		args.GetReturnValue().Set(Nan::New(count));
+	}
+	
+	// drawCircles(xs, ys, radii): Float32Arrays of the centers and radii, read in place
+	void DrawCircles(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 3 || !args[0]->IsFloat32Array() || !args[1]->IsFloat32Array() || !args[2]->IsFloat32Array()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		Local<Float32Array> xs = Local<Float32Array>::Cast(args[0]);
+		Local<Float32Array> ys = Local<Float32Array>::Cast(args[1]);
+		Local<Float32Array> radii = Local<Float32Array>::Cast(args[2]);
+		VGint count = std::min(std::min(xs->Length(), ys->Length()), radii->Length());
+		const VGfloat *x = reinterpret_cast<const VGfloat*>(static_cast<char*>(xs->Buffer()->GetContents().Data()) + xs->ByteOffset());
+		const VGfloat *y = reinterpret_cast<const VGfloat*>(static_cast<char*>(ys->Buffer()->GetContents().Data()) + ys->ByteOffset());
+		const VGfloat *r = reinterpret_cast<const VGfloat*>(static_cast<char*>(radii->Buffer()->GetContents().Data()) + radii->ByteOffset());
+		
+		canvas_drawCircles(x, y, r, count, 1);
+		
+		if(displaylist_util_recording) {
+			displaylist_util_record_circles(x, y, r, count);
+		}
+	}
+	
+	// 'evenodd' or 'nonzero' (default)
+	VGFillRule GetFillRule(const Nan::FunctionCallbackInfo<Value>& args, int index) {
+		if(args.Length() > index && args[index]->IsString() && std::string(*Nan::Utf8String(args[index])) == "evenodd") {
+			return VG_EVEN_ODD;
+		}
+		
+		return VG_NON_ZERO;
+	}
+	
+	// isPointInPath(x, y, fillRule): tested against the copy of the current path in memory
+	void IsPointInPath(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 2)) {
+			return;
+		}
+		
+		args.GetReturnValue().Set(Nan::New<Boolean>(path_util_is_point_in_path(args[0]->NumberValue(), args[1]->NumberValue(), GetFillRule(args, 2)) != 0));
+	}
+	
+	void IsPointInStroke(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 2)) {
+			return;
+		}
+		
+		args.GetReturnValue().Set(Nan::New<Boolean>(path_util_is_point_in_stroke(args[0]->NumberValue(), args[1]->NumberValue()) != 0));
+	}
+	
+	// addHitRegion(id, fillRule): adds the current path under the current transformation
+	void AddHitRegion(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsString()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		if(hit_util_add(*Nan::Utf8String(args[0]), GetFillRule(args, 1)) == -1) {
+			Nan::ThrowError("Failed to add hit region");
+		}
+	}
+	
+	void RemoveHitRegion(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsString()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		hit_util_remove(*Nan::Utf8String(args[0]));
+	}
+	
+	void ClearHitRegions(const Nan::FunctionCallbackInfo<Value>& args) {
+		hit_util_clear();
+	}
+	
+	// hitTest(x, y): id of the topmost hit region at the point or null
+	void HitTest(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 2)) {
+			return;
+		}
+		
+		const char *id = hit_util_test(args[0]->NumberValue(), args[1]->NumberValue());
+		
+		if(id == NULL) {
+			args.GetReturnValue().SetNull();
+			return;
+		}
+		
+		args.GetReturnValue().Set(Nan::New(id).ToLocalChecked());
+	}
+	
 	void SetLineDash(const Nan::FunctionCallbackInfo<Value>& args) {
 		if(args.Length() != 1 || !args[0]->IsArray()) {
 			Nan::ThrowTypeError("wrong arg");
@@ -398,6 +919,7 @@ namespace vgcanvas {
 		}
 
 		canvas_setLineDash(ar->Length(), data);
+		Record(DISPLAYLIST_LINE_DASH, ar->Length(), data);
 		delete data;
 	}
 
@@ -420,6 +942,7 @@ namespace vgcanvas {
 		}
 
 		canvas_lineDashOffset(args[0]->NumberValue());
+		Record(DISPLAYLIST_LINE_DASH_OFFSET, args, 1);
 	}
 
 	void GetLineDashOffset(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -428,14 +951,17 @@ namespace vgcanvas {
 
 	void Clip(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_clip();
+		Record(DISPLAYLIST_CLIP, 0, NULL);
 	}
 
 	void Save(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_save();
+		Record(DISPLAYLIST_SAVE, 0, NULL);
 	}
 
 	void Restore(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_restore();
+		Record(DISPLAYLIST_RESTORE, 0, NULL);
 	}
 
 	void SetGlobalAlpha(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -444,6 +970,7 @@ namespace vgcanvas {
 		}
 
 		canvas_globalAlpha(args[0]->NumberValue());
+		Record(DISPLAYLIST_GLOBAL_ALPHA, args, 1);
 	}
 
 	void GetGlobalAlpha(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -451,7 +978,7 @@ namespace vgcanvas {
 	}
 	
 	void NewFont(const Nan::FunctionCallbackInfo<Value>& args) {
-		if(args.Length() < 2 || !args[0]->IsString(), !args[1]->IsString()) {
+		if(args.Length() < 2 || !args[0]->IsString() || !args[1]->IsString()) {
 			Nan::ThrowTypeError("wrong arg");
 			return;
 		}
@@ -463,13 +990,81 @@ namespace vgcanvas {
 		}
 	}
 	
+	struct FontData {
+		uv_work_t work;
+		std::string path;
+		std::string name;
+		font_util_load_t *load;
+		int error;
+		Nan::Callback callback;
+	};
+	
+	void FontLoad(uv_work_t *work) {
+		FontData *data = static_cast<FontData*>(work->data);
+		TRACE_DECLARE(trace_begin);
+		
+		trace_util_set_thread_name("uv worker");
+		TRACE_BEGIN(trace_begin);
+		
+		data->load = font_util_load(const_cast<char*>(data->path.c_str()));
+		data->error = data->load ? 0 : errno;
+		
+		TRACE_END_ARG("font", "load", trace_begin, 0);
+	}
+	
+	void FontLoaded(uv_work_t *work, int status) {
+		Nan::HandleScope scope;
+		FontData *data = static_cast<FontData*>(work->data);
+		Local<Value> error = Nan::Null();
+		
+		if(!data->load) {
+			std::string msg = "Failed to create font: ";
+			msg += strerror(data->error);
+			error = Nan::Error(msg.c_str());
+		} else {
+			// only the glyph paths are created on this thread
+			present_util_acquire();
+			
+			if(font_util_add(data->load, const_cast<char*>(data->name.c_str())) == -1) {
+				error = Nan::Error("Failed to create font");
+			}
+		}
+		
+		data->callback.Call(1, &error);
+		delete data;
+	}
+	
+	// loadFontAsync(path, name, callback(error)): parses the font file on the thread pool
+	void LoadFontAsync(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 3 || !args[0]->IsString() || !args[1]->IsString() || !args[2]->IsFunction()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		FontData *data = new FontData;
+		data->work.data = data;
+		data->path = *Nan::Utf8String(args[0]);
+		data->name = *Nan::Utf8String(args[1]);
+		data->load = NULL;
+		data->error = 0;
+		data->callback.SetFunction(Local<Function>::Cast(args[2]));
+		
+		uv_queue_work(uv_default_loop(), &data->work, FontLoad, FontLoaded);
+	}
+	
 	void SetFont(const Nan::FunctionCallbackInfo<Value>& args) {
 		if(!checkArgs(args, 1, 0) || !args[1]->IsString()) {
 			Nan::ThrowTypeError("wrong args");
 			return;
 		}
 		
-		canvas_font(*Nan::Utf8String(args[1]), args[0]->NumberValue());
+		Nan::Utf8String name(args[1]);
+		canvas_font(*name, args[0]->NumberValue());
+		
+		if(displaylist_util_recording) {
+			VGfloat size = args[0]->NumberValue();
+			Record(DISPLAYLIST_FONT, *name, 1, &size);
+		}
 	}
 	
 	void FillText(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -478,7 +1073,13 @@ namespace vgcanvas {
 			return;
 		}
 		
-		canvas_fillText(*Nan::Utf8String(args[0]), args[1]->NumberValue(), args[2]->NumberValue());
+		Nan::Utf8String text(args[0]);
+		canvas_fillText(*text, args[1]->NumberValue(), args[2]->NumberValue());
+		
+		if(displaylist_util_recording) {
+			VGfloat position[2] = { (VGfloat)args[1]->NumberValue(), (VGfloat)args[2]->NumberValue() };
+			Record(DISPLAYLIST_FILL_TEXT, *text, 2, position);
+		}
 	}
 	
 	void StrokeText(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -487,7 +1088,13 @@ namespace vgcanvas {
 			return;
 		}
 		
-		canvas_strokeText(*Nan::Utf8String(args[0]), args[1]->NumberValue(), args[2]->NumberValue());
+		Nan::Utf8String text(args[0]);
+		canvas_strokeText(*text, args[1]->NumberValue(), args[2]->NumberValue());
+		
+		if(displaylist_util_recording) {
+			VGfloat position[2] = { (VGfloat)args[1]->NumberValue(), (VGfloat)args[2]->NumberValue() };
+			Record(DISPLAYLIST_STROKE_TEXT, *text, 2, position);
+		}
 	}
 	
 	void DrawImage(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -496,11 +1103,34 @@ namespace vgcanvas {
 			return;
 		}
 		
-		Image *img = Image::Unwrap<Image>(Local<Object>::Cast(args[0]));
+		Local<Object> obj = Local<Object>::Cast(args[0]);
+		image_t *image = NULL;
+		
+		if(std::string(*Nan::Utf8String(obj->GetConstructorName())) == "Context") {
+			// offscreen canvas, its image can not be drawn while it is the render target
+			canvas_context_t *context = Context::Unwrap<Context>(obj)->GetContext();
+			
+			if(context && context == context_util_get()) {
+				Nan::ThrowError("canvas can not be drawn onto itself");
+				return;
+			}
+			
+			image = context ? context->image : NULL;
+		} else {
+			image = Image::Unwrap<Image>(obj)->GetImage();
+		}
 		
-		if(img->GetImage()) {
-			canvas_drawImage(img->GetImage(), args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue(), 
+		if(image) {
+			canvas_drawImage(image, args[1]->NumberValue(), args[2]->NumberValue(), args[3]->NumberValue(), 
 				args[4]->NumberValue(), args[5]->NumberValue(), args[6]->NumberValue(), args[7]->NumberValue(), args[8]->NumberValue());
+			
+			if(displaylist_util_recording) {
+				VGfloat values[8];
+				for(int i = 0; i < 8; i++) {
+					values[i] = args[i + 1]->NumberValue();
+				}
+				RecordImage(image, values, obj);
+			}
 		} else {
 			Nan::ThrowError("invalid image");
 			return;
@@ -516,6 +1146,11 @@ namespace vgcanvas {
 		}
 		
 		canvas_imageSmoothingEnabled(args[0]->BooleanValue() ? VG_TRUE : VG_FALSE);
+		
+		if(displaylist_util_recording) {
+			VGfloat enabled = args[0]->BooleanValue() ? 1.0f : 0.0f;
+			Record(DISPLAYLIST_IMAGE_SMOOTHING, 1, &enabled);
+		}
 	}
 	
 	void GetImageSmoothing(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -529,7 +1164,9 @@ namespace vgcanvas {
 			return;
 		}
 
-		canvas_globalCompositeOperation(*Nan::Utf8String(args[0]));
+		Nan::Utf8String value(args[0]);
+		canvas_globalCompositeOperation(*value);
+		Record(DISPLAYLIST_GLOBAL_COMPOSITE_OPERATION, *value, 0, NULL);
 
 	}
 
@@ -549,6 +1186,7 @@ namespace vgcanvas {
 		}
 
 		canvas_miterLimit(args[0]->NumberValue());
+		Record(DISPLAYLIST_MITER_LIMIT, args, 1);
 	}
 	
 	
@@ -558,7 +1196,9 @@ namespace vgcanvas {
 			return;
 		}
 
-		canvas_textAlign(*Nan::Utf8String(args[0]));
+		Nan::Utf8String value(args[0]);
+		canvas_textAlign(*value);
+		Record(DISPLAYLIST_TEXT_ALIGN, *value, 0, NULL);
 
 	}
 
@@ -573,7 +1213,9 @@ namespace vgcanvas {
 			return;
 		}
 
-		canvas_textBaseline(*Nan::Utf8String(args[0]));
+		Nan::Utf8String value(args[0]);
+		canvas_textBaseline(*value);
+		Record(DISPLAYLIST_TEXT_BASELINE, *value, 0, NULL);
 
 	}
 
@@ -584,6 +1226,7 @@ namespace vgcanvas {
 	
 	void ResetTransform(const Nan::FunctionCallbackInfo<Value>& args) {
 		canvas_resetTransform();
+		Record(DISPLAYLIST_RESET_TRANSFORM, 0, NULL);
 	}
 	
 	void Rotate(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -592,6 +1235,7 @@ namespace vgcanvas {
 		}
 		
 		canvas_rotate(args[0]->NumberValue());
+		Record(DISPLAYLIST_ROTATE, args, 1);
 	}
 	
 	void Scale(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -600,6 +1244,7 @@ namespace vgcanvas {
 		}
 		
 		canvas_scale(args[0]->NumberValue(), args[1]->NumberValue());
+		Record(DISPLAYLIST_SCALE, args, 2);
 	}
 	
 	void Translate(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -608,6 +1253,7 @@ namespace vgcanvas {
 		}
 		
 		canvas_translate(args[0]->NumberValue(), args[1]->NumberValue());
+		Record(DISPLAYLIST_TRANSLATE, args, 2);
 	}
 	
 	void Transform(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -617,6 +1263,7 @@ namespace vgcanvas {
 		
 		canvas_transform(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), 
 			args[3]->NumberValue(), args[4]->NumberValue(), args[5]->NumberValue());
+		Record(DISPLAYLIST_TRANSFORM, args, 6);
 	}
 	
 	void SetTransform(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -626,6 +1273,7 @@ namespace vgcanvas {
 		
 		canvas_setTransform(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue(), 
 			args[3]->NumberValue(), args[4]->NumberValue(), args[5]->NumberValue());
+		Record(DISPLAYLIST_SET_TRANSFORM, args, 6);
 	}
 	
 	
@@ -638,22 +1286,7 @@ namespace vgcanvas {
 		canvas_measure_text_metrics_t metrics;
 		canvas_measureText(&metrics, *Nan::Utf8String(args[0]));
 		
-		Local<Object> obj = Nan::New<Object>();
-  	obj->Set(Nan::New("width").ToLocalChecked(), Nan::New(metrics.width));
-		obj->Set(Nan::New("actualBoundingBoxLeft").ToLocalChecked(), Nan::New(metrics.actual_bounding_box_left));
-		obj->Set(Nan::New("actualBoundingBoxRight").ToLocalChecked(), Nan::New(metrics.actual_bounding_box_right));
-		obj->Set(Nan::New("fontBoundingBoxAscent").ToLocalChecked(), Nan::New(metrics.font_bounding_box_ascent));
-		obj->Set(Nan::New("fontBoundingBoxDescent").ToLocalChecked(), Nan::New(metrics.font_bounding_box_descent));
-		obj->Set(Nan::New("actualBoundingBoxAscent").ToLocalChecked(), Nan::New(metrics.actual_bounding_box_ascent));
-		obj->Set(Nan::New("actualBoundingBoxDescent").ToLocalChecked(), Nan::New(metrics.actual_bounding_box_descent)); 
-		obj->Set(Nan::New("emHeightAscent").ToLocalChecked(), Nan::New(metrics.em_height_ascent));
-		obj->Set(Nan::New("emHeightDescent").ToLocalChecked(), Nan::New(metrics.em_height_descent));
-		obj->Set(Nan::New("hangingBaseline").ToLocalChecked(), Nan::New(metrics.hanging_baseline));
-		obj->Set(Nan::New("alphabeticBaseline").ToLocalChecked(), Nan::New(metrics.alphabetic_baseline));
-		obj->Set(Nan::New("ideographicBaseline").ToLocalChecked(), Nan::New(metrics.ideographic_baseline));
-		
-		args.GetReturnValue().Set(obj);
-		
+		args.GetReturnValue().Set(NewTextMetrics(&metrics));
 	}
 	
 	void GetImageData(const Nan::FunctionCallbackInfo<Value>& args) {
@@ -683,13 +1316,27 @@ namespace vgcanvas {
 		char *src;
 		size_t size;
 		Nan::Callback callback;
-		float encoder;
+		image_encoder_t encoder;
+		VGint width;
+		VGint height;
 	};
 	
 	void BlobCreate(uv_work_t *work) {
 		BlobData *data = static_cast<BlobData*>(work->data);
+		TRACE_DECLARE(trace_begin);
+		
+		// dropped readback, BlobFinished reports it
+		if(!data->src) {
+			return;
+		}
 		
-		data->blob = image_to_blob(data->src, data->type.c_str(), data->encoder, &data->size);
+		trace_util_set_thread_name("uv worker");
+		TRACE_BEGIN(trace_begin);
+		
+		data->blob = image_to_blob(data->src, data->width, data->height, data->type.c_str(), &data->encoder, &data->size);
+		
+		// the trace keeps the name pointer, data is deleted before it is dumped
+		TRACE_END_ARG("encode", "toBlob", trace_begin, data->width * data->height * 4);
 
 	}
 	
@@ -697,8 +1344,10 @@ namespace vgcanvas {
 		Nan::HandleScope scope;
 		BlobData *data = static_cast<BlobData*>(work->data);
 		
+		// like the Canvas 2D API, the callback receives null if there is no blob
 		if(!data->blob) {
-			Nan::ThrowError("failed to create blob");
+			Local<Value> null = Nan::Null();
+			data->callback.Call(1, &null);
 			free(data->src);
 			delete data;
 			return;
@@ -712,36 +1361,361 @@ namespace vgcanvas {
 		delete data;
 	}
 	
+	// optional encoder arguments: quality, compression, filter, threads
+	void GetEncoder(const Nan::FunctionCallbackInfo<Value>& args, int offset, image_encoder_t *encoder) {
+		image_encoder_defaults(encoder);
+		
+		if(args.Length() > offset && args[offset]->IsNumber()) {
+			encoder->quality = args[offset]->NumberValue();
+		}
+		
+		if(args.Length() > offset + 1 && args[offset + 1]->IsNumber()) {
+			encoder->compression = args[offset + 1]->Int32Value();
+		}
+		
+		if(args.Length() > offset + 2 && args[offset + 2]->IsNumber()) {
+			encoder->filter = args[offset + 2]->Int32Value();
+		}
+		
+		if(args.Length() > offset + 3 && args[offset + 3]->IsNumber()) {
+			encoder->threads = args[offset + 3]->Int32Value();
+		}
+	}
+	
+	void BlobCaptured(void *user, char *src, VGint width, VGint height) {
+		BlobData *data = static_cast<BlobData*>(user);
+		
+		// src is NULL if the readback has been dropped or could not be
+		// allocated, the callback is still called (from the event loop, this
+		// may run inside cleanup)
+		data->blob = NULL;
+		data->src = src;
+		data->width = width;
+		data->height = height;
+		
+		uv_queue_work(uv_default_loop(), &data->work, BlobCreate, BlobFinished);
+	}
+	
 	void ToBlob(const Nan::FunctionCallbackInfo<Value>& args) {
-		if(args.Length() != 3 || !args[0]->IsFunction() || !args[1]->IsString() || !args[2]->IsNumber()) {
+		if(args.Length() < 3 || !args[0]->IsFunction() || !args[1]->IsString() || !args[2]->IsNumber()) {
 			Nan::ThrowTypeError("wrong args");
 			return;
 		}
 		
-		char *src = static_cast<char*>(malloc(egl_get_width() * egl_get_height() * 4));
-		if(!src) {
-			Nan::ThrowError("Failed to allocate memory");
+		std::string type = *Nan::Utf8String(args[1]);
+		
+		BlobData *data = new BlobData;
+		data->work.data = data;
+		data->callback.SetFunction(Local<Function>::Cast(args[0]));
+		data->type = type;
+		data->src = NULL;
+		GetEncoder(args, 2, &data->encoder);
+		
+		// optional region (x, y, width, height) in canvas coordinates
+		VGint x = 0;
+		VGint y = 0;
+		VGint width = egl_get_width();
+		VGint height = egl_get_height();
+		
+		if(args.Length() >= 10 && checkArgs(args, 4, 6)) {
+			x = std::max(0, args[6]->Int32Value());
+			y = std::max(0, args[7]->Int32Value());
+			width = std::min(egl_get_width() - x, args[8]->Int32Value());
+			height = std::min(egl_get_height() - y, args[9]->Int32Value());
+			y = egl_get_height() - y - height;
+		} else if(args.Length() >= 10) {
+			delete data;
 			return;
 		}
 		
-		vgReadPixels(src, egl_get_width() * 4, VG_sRGBX_8888, 0, 0, egl_get_width(), egl_get_height());
+		if(width <= 0 || height <= 0) {
+			delete data;
+			Nan::ThrowError("empty region");
+			return;
+		}
 		
-		std::string type = *Nan::Utf8String(args[1]);
-		float encoder = args[2]->NumberValue();
+		// the pixels are collected asynchronously by the readback ring
+		if(readback_util_request(x, y, width, height, BlobCaptured, data) == -1) {
+			delete data;
+			Nan::ThrowError("Failed to read back pixels");
+			return;
+		}
+	}
+	
+	// renders a display list tile by tile into a frame of any size and encodes it
+	void RenderDisplayList(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 10 || !args[0]->IsFunction() || !args[1]->IsString() || !args[6]->IsObject() || std::string(*Nan::Utf8String(Local<Object>::Cast(args[6])->GetConstructorName())) != "DisplayList" || !checkArgs(args, 3, 7)) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		displaylist_t *list = DisplayList::Unwrap<DisplayList>(Local<Object>::Cast(args[6]))->GetList();
+		VGint width = args[7]->Int32Value();
+		VGint height = args[8]->Int32Value();
+		VGint tile_size = args[9]->Int32Value();
+		
+		if(list == displaylist_util_recording) {
+			Nan::ThrowError("display list can not be rendered while it is recorded");
+			return;
+		}
+		
+		if(width <= 0 || height <= 0) {
+			Nan::ThrowError("empty region");
+			return;
+		}
 		
 		BlobData *data = new BlobData;
 		data->work.data = data;
 		data->callback.SetFunction(Local<Function>::Cast(args[0]));
-		data->type = type;
-		data->src = src;
-		data->encoder = encoder;
+		data->type = *Nan::Utf8String(args[1]);
+		data->src = NULL;
+		GetEncoder(args, 2, &data->encoder);
 		
-		uv_queue_work(uv_default_loop(), &data->work, BlobCreate, BlobFinished);
+		char *src = tile_util_render(list, width, height, tile_size, data->encoder.threads);
+		if(!src) {
+			delete data;
+			Nan::ThrowError("Failed to render display list");
+			return;
+		}
+		
+		BlobCaptured(data, src, width, height);
+	}
+	
+	void GetTileStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		tile_util_stats_t stats;
+		tile_util_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("renders").ToLocalChecked(), Nan::New<Number>(stats.renders));
+		obj->Set(Nan::New("tiles").ToLocalChecked(), Nan::New<Number>(stats.tiles));
+		obj->Set(Nan::New("commands").ToLocalChecked(), Nan::New<Number>(stats.commands));
+		obj->Set(Nan::New("executed").ToLocalChecked(), Nan::New<Number>(stats.executed));
+		obj->Set(Nan::New("binTime").ToLocalChecked(), Nan::New<Number>(stats.bin_time));
+		obj->Set(Nan::New("renderTime").ToLocalChecked(), Nan::New<Number>(stats.render_time));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void FlushReadback(const Nan::FunctionCallbackInfo<Value>& args) {
+		readback_util_flush();
+	}
+	
+	void SetReadbackLatency(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(!checkArgs(args, 1)) {
+			return;
+		}
+		
+		readback_util_set_latency(args[0]->NumberValue());
+	}
+	
+	void GetReadbackStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		readback_util_stats_t stats;
+		readback_util_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("slots").ToLocalChecked(), Nan::New(stats.slots));
+		obj->Set(Nan::New("latency").ToLocalChecked(), Nan::New(stats.latency));
+		obj->Set(Nan::New("pending").ToLocalChecked(), Nan::New(stats.pending));
+		obj->Set(Nan::New("requested").ToLocalChecked(), Nan::New<Number>(stats.requested));
+		obj->Set(Nan::New("collected").ToLocalChecked(), Nan::New<Number>(stats.collected));
+		obj->Set(Nan::New("stalls").ToLocalChecked(), Nan::New<Number>(stats.stalls));
+		obj->Set(Nan::New("forced").ToLocalChecked(), Nan::New<Number>(stats.forced));
+		obj->Set(Nan::New("latencyLast").ToLocalChecked(), Nan::New(stats.latency_last));
+		obj->Set(Nan::New("latencyAverage").ToLocalChecked(), Nan::New(stats.latency_average));
+		obj->Set(Nan::New("latencyMax").ToLocalChecked(), Nan::New(stats.latency_max));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void SetPresentThread(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() != 1 || !args[0]->IsBoolean()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		present_util_set_threaded(args[0]->BooleanValue());
+	}
+	
+	void GetPresentStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		present_util_stats_t stats;
+		present_util_get_stats(&stats);
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("threaded").ToLocalChecked(), Nan::New<Boolean>(stats.threaded));
+		obj->Set(Nan::New("swaps").ToLocalChecked(), Nan::New<Number>(stats.swaps));
+		obj->Set(Nan::New("swapLast").ToLocalChecked(), Nan::New(stats.swap_last));
+		obj->Set(Nan::New("swapAverage").ToLocalChecked(), Nan::New(stats.swap_average));
+		obj->Set(Nan::New("swapMax").ToLocalChecked(), Nan::New(stats.swap_max));
+		obj->Set(Nan::New("waits").ToLocalChecked(), Nan::New<Number>(stats.waits));
+		obj->Set(Nan::New("waitLast").ToLocalChecked(), Nan::New(stats.wait_last));
+		obj->Set(Nan::New("waitAverage").ToLocalChecked(), Nan::New(stats.wait_average));
+		obj->Set(Nan::New("waitMax").ToLocalChecked(), Nan::New(stats.wait_max));
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void SetProfiling(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 1 || !args[0]->IsBoolean()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		profile_util_set_enabled(args[0]->BooleanValue(), args.Length() > 1 && args[1]->BooleanValue());
+	}
+	
+	static Nan::Callback *memoryCallback = NULL;
+	static uv_async_t *memoryAsync = NULL;
+	
+	Local<Object> MemoryStats() {
+		Local<Object> types = Nan::New<Object>();
+		for(int i = 0; i < MEMORY_UTIL_TYPES; i++) {
+			memory_util_usage_t usage;
+			memory_util_get_usage(static_cast<memory_util_type_t>(i), &usage);
+			
+			Local<Object> type = Nan::New<Object>();
+			type->Set(Nan::New("objects").ToLocalChecked(), Nan::New<Number>(usage.objects));
+			type->Set(Nan::New("bytes").ToLocalChecked(), Nan::New<Number>(usage.bytes));
+			type->Set(Nan::New("peak").ToLocalChecked(), Nan::New<Number>(usage.peak));
+			types->Set(Nan::New(memory_util_get_name(static_cast<memory_util_type_t>(i))).ToLocalChecked(), type);
+		}
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("vram").ToLocalChecked(), Nan::New<Number>(memory_util_get_vram()));
+		obj->Set(Nan::New("heap").ToLocalChecked(), Nan::New<Number>(memory_util_get_heap()));
+		obj->Set(Nan::New("limit").ToLocalChecked(), Nan::New<Number>(memory_util_get_limit()));
+		obj->Set(Nan::New("types").ToLocalChecked(), types);
+		return obj;
+	}
+	
+	void GetMemoryStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		args.GetReturnValue().Set(MemoryStats());
+	}
+	
+	void OnMemoryLimit(uv_async_t *handle) {
+		Nan::HandleScope scope;
 		
+		if(!memoryCallback) {
+			return;
+		}
+		
+		Local<Value> argv[] = { MemoryStats() };
+		memoryCallback->Call(1, argv);
+	}
+	
+	// called from inside the allocating canvas function, the JS callback runs afterwards
+	void MemoryLimitExceeded(void *user, long long bytes, long long limit) {
+		uv_async_send(memoryAsync);
+	}
+	
+	void SetMemoryLimit(const Nan::FunctionCallbackInfo<Value>& args) {
+		if(args.Length() < 2 || !args[0]->IsNumber() || !args[1]->IsFunction()) {
+			Nan::ThrowTypeError("wrong args");
+			return;
+		}
+		
+		if(!memoryAsync) {
+			memoryAsync = new uv_async_t;
+			uv_async_init(uv_default_loop(), memoryAsync, OnMemoryLimit);
+			uv_unref(reinterpret_cast<uv_handle_t*>(memoryAsync));
+		}
+		
+		delete memoryCallback;
+		memoryCallback = new Nan::Callback(Local<Function>::Cast(args[1]));
+		
+		memory_util_set_limit(args[0]->NumberValue(), MemoryLimitExceeded, NULL);
+	}
+	
+	void StartTrace(const Nan::FunctionCallbackInfo<Value>& args) {
+		trace_util_start();
+	}
+	
+	void StopTrace(const Nan::FunctionCallbackInfo<Value>& args) {
+		trace_util_stop();
+	}
+	
+	void DumpTrace(const Nan::FunctionCallbackInfo<Value>& args) {
+		size_t length = 0;
+		char *json = trace_util_dump(&length);
+		if(!json) {
+			Nan::ThrowError("Failed to serialize trace");
+			return;
+		}
+		
+		args.GetReturnValue().Set(Nan::New(json, length).ToLocalChecked());
+		free(json);
+	}
+	
+	Local<Object> TimerObject(const profile_util_timer_t *timer) {
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("calls").ToLocalChecked(), Nan::New<Number>(timer->calls));
+		obj->Set(Nan::New("time").ToLocalChecked(), Nan::New<Number>(timer->time / 1e6));
+		return obj;
+	}
+	
+	void GetFrameStats(const Nan::FunctionCallbackInfo<Value>& args) {
+		const profile_util_frame_t *frame = profile_util_get_frame();
+		
+		Local<Object> entries = Nan::New<Object>();
+		for(int i = 0; i < profile_util_get_entry_count(); i++) {
+			if(frame->entries[i].calls) {
+				entries->Set(Nan::New(profile_util_get_entry_name(i)).ToLocalChecked(), TimerObject(&frame->entries[i]));
+			}
+		}
+		
+		Local<Object> calls = Nan::New<Object>();
+		for(int i = 0; i < PROFILE_CALLS; i++) {
+			calls->Set(Nan::New(profile_util_get_call_name(i)).ToLocalChecked(), TimerObject(&frame->calls[i]));
+		}
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("enabled").ToLocalChecked(), Nan::New<Boolean>(profile_util_enabled));
+		obj->Set(Nan::New("frame").ToLocalChecked(), Nan::New<Number>(frame->frame));
+		obj->Set(Nan::New("frameTime").ToLocalChecked(), Nan::New<Number>(frame->frame_time / 1e6));
+		obj->Set(Nan::New("nativeTime").ToLocalChecked(), Nan::New<Number>(frame->entry_time / 1e6));
+		obj->Set(Nan::New("allocations").ToLocalChecked(), Nan::New<Number>(frame->allocations));
+		obj->Set(Nan::New("allocatedBytes").ToLocalChecked(), Nan::New<Number>(frame->allocated_bytes));
+		obj->Set(Nan::New("uploadedBytes").ToLocalChecked(), Nan::New<Number>(frame->uploaded_bytes));
+		obj->Set(Nan::New("entries").ToLocalChecked(), entries);
+		obj->Set(Nan::New("calls").ToLocalChecked(), calls);
+		
+		args.GetReturnValue().Set(obj);
+	}
+	
+	void GetFrameHistogram(const Nan::FunctionCallbackInfo<Value>& args) {
+		double bucket = args.Length() > 0 && args[0]->IsNumber() ? args[0]->NumberValue() : 1;
+		double times[PROFILE_UTIL_HISTORY];
+		int count = profile_util_get_history(times, PROFILE_UTIL_HISTORY);
+		
+		if(bucket <= 0) {
+			bucket = 1;
+		}
+		
+		std::vector<double> sorted(times, times + count);
+		std::sort(sorted.begin(), sorted.end());
+		
+		Local<Array> buckets = Nan::New<Array>();
+		for(int i = 0; i < count; i++) {
+			uint32_t index = times[i] / bucket;
+			for(uint32_t j = buckets->Length(); j <= index; j++) {
+				buckets->Set(j, Nan::New(0));
+			}
+			buckets->Set(index, Nan::New(buckets->Get(index)->Int32Value() + 1));
+		}
+		
+		Local<Object> obj = Nan::New<Object>();
+		obj->Set(Nan::New("count").ToLocalChecked(), Nan::New(count));
+		obj->Set(Nan::New("bucket").ToLocalChecked(), Nan::New(bucket));
+		obj->Set(Nan::New("buckets").ToLocalChecked(), buckets);
+		obj->Set(Nan::New("p50").ToLocalChecked(), Nan::New(count ? sorted[count / 2] : 0));
+		obj->Set(Nan::New("p95").ToLocalChecked(), Nan::New(count ? sorted[count * 95 / 100] : 0));
+		obj->Set(Nan::New("p99").ToLocalChecked(), Nan::New(count ? sorted[count * 99 / 100] : 0));
+		obj->Set(Nan::New("max").ToLocalChecked(), Nan::New(count ? sorted[count - 1] : 0));
+		
+		args.GetReturnValue().Set(obj);
 	}
 	
 	void ToURL(const Nan::FunctionCallbackInfo<Value>& args) {
-		if(args.Length() != 2 || !args[0]->IsString() || !args[1]->IsNumber()) {
+		if(args.Length() < 2 || !args[0]->IsString() || !args[1]->IsNumber()) {
 			Nan::ThrowTypeError("wrong args");
 			return;
 		}
@@ -755,9 +1729,10 @@ namespace vgcanvas {
 		vgReadPixels(src, egl_get_width() * 4, VG_sRGBX_8888, 0, 0, egl_get_width(), egl_get_height());
 		
 		std::string type = *Nan::Utf8String(args[0]);
-		float encoder = args[1]->NumberValue();
+		image_encoder_t encoder;
+		GetEncoder(args, 1, &encoder);
 		
-		char *base64 = image_to_data_url(src, type.c_str(), encoder);
+		char *base64 = image_to_data_url(src, egl_get_width(), egl_get_height(), type.c_str(), &encoder);
 		free(src);
 		
 		if(!base64) {
@@ -770,87 +1745,137 @@ namespace vgcanvas {
 
 	void ModuleInit(Local<Object> exports) {
 		exports->Set(Nan::New("init").ToLocalChecked(), Nan::New<FunctionTemplate>(Init)->GetFunction());
-		exports->Set(Nan::New("swapBuffers").ToLocalChecked(), Nan::New<FunctionTemplate>(SwapBuffers)->GetFunction());
+		SetEntry<SwapBuffers>(exports, "swapBuffers");
+		SetEntry<GetDirtyRect>(exports, "getDirtyRect");
+		exports->Set(Nan::New("getDirtyStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetDirtyStats)->GetFunction());
+		exports->Set(Nan::New("getCullStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetCullStats)->GetFunction());
+		exports->Set(Nan::New("setCulling").ToLocalChecked(), Nan::New<FunctionTemplate>(SetCulling)->GetFunction());
+		exports->Set(Nan::New("setProfiling").ToLocalChecked(), Nan::New<FunctionTemplate>(SetProfiling)->GetFunction());
+		exports->Set(Nan::New("getFrameStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetFrameStats)->GetFunction());
+		exports->Set(Nan::New("getFrameHistogram").ToLocalChecked(), Nan::New<FunctionTemplate>(GetFrameHistogram)->GetFunction());
+		exports->Set(Nan::New("getMemoryStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetMemoryStats)->GetFunction());
+		exports->Set(Nan::New("setMemoryLimit").ToLocalChecked(), Nan::New<FunctionTemplate>(SetMemoryLimit)->GetFunction());
+		exports->Set(Nan::New("startTrace").ToLocalChecked(), Nan::New<FunctionTemplate>(StartTrace)->GetFunction());
+		exports->Set(Nan::New("stopTrace").ToLocalChecked(), Nan::New<FunctionTemplate>(StopTrace)->GetFunction());
+		exports->Set(Nan::New("dumpTrace").ToLocalChecked(), Nan::New<FunctionTemplate>(DumpTrace)->GetFunction());
 		exports->Set(Nan::New("cleanup").ToLocalChecked(), Nan::New<FunctionTemplate>(Cleanup)->GetFunction());
 
-		exports->Set(Nan::New("fillRect").ToLocalChecked(), Nan::New<FunctionTemplate>(FillRect)->GetFunction());
-		exports->Set(Nan::New("clearRect").ToLocalChecked(), Nan::New<FunctionTemplate>(ClearRect)->GetFunction());
-		exports->Set(Nan::New("strokeRect").ToLocalChecked(), Nan::New<FunctionTemplate>(StrokeRect)->GetFunction());
-
-		exports->Set(Nan::New("setStyle").ToLocalChecked(), Nan::New<FunctionTemplate>(SetStyle)->GetFunction());
-		exports->Set(Nan::New("getStyle").ToLocalChecked(), Nan::New<FunctionTemplate>(GetFillStyle)->GetFunction());
+		SetEntry<BeginLayer>(exports, "beginLayer");
+		SetEntry<EndLayer>(exports, "endLayer");
+		SetEntry<InvalidateLayer>(exports, "invalidateLayer");
+		SetEntry<ClearLayers>(exports, "clearLayers");
+		exports->Set(Nan::New("getLayerStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetLayerStats)->GetFunction());
 
-		exports->Set(Nan::New("getScreenWidth").ToLocalChecked(), Nan::New<FunctionTemplate>(GetScreenWidth)->GetFunction());
-		exports->Set(Nan::New("getScreenHeight").ToLocalChecked(), Nan::New<FunctionTemplate>(GetScreenHeight)->GetFunction());
-
-		exports->Set(Nan::New("setLineWidth").ToLocalChecked(), Nan::New<FunctionTemplate>(SetLineWidth)->GetFunction());
-		exports->Set(Nan::New("setLineCap").ToLocalChecked(), Nan::New<FunctionTemplate>(SetLineCap)->GetFunction());
-		exports->Set(Nan::New("setLineJoin").ToLocalChecked(), Nan::New<FunctionTemplate>(SetLineJoin)->GetFunction());
-		exports->Set(Nan::New("setLineDash").ToLocalChecked(), Nan::New<FunctionTemplate>(SetLineDash)->GetFunction());
-		exports->Set(Nan::New("setLineDashOffset").ToLocalChecked(), Nan::New<FunctionTemplate>(SetLineDashOffset)->GetFunction());
-
-		exports->Set(Nan::New("getLineWidth").ToLocalChecked(), Nan::New<FunctionTemplate>(GetLineWidth)->GetFunction());
-		exports->Set(Nan::New("getLineCap").ToLocalChecked(), Nan::New<FunctionTemplate>(GetLineCap)->GetFunction());
-		exports->Set(Nan::New("getLineJoin").ToLocalChecked(), Nan::New<FunctionTemplate>(GetLineJoin)->GetFunction());
-		exports->Set(Nan::New("getLineDash").ToLocalChecked(), Nan::New<FunctionTemplate>(GetLineDash)->GetFunction());
-		exports->Set(Nan::New("getLineDashOffset").ToLocalChecked(), Nan::New<FunctionTemplate>(GetLineDashOffset)->GetFunction());
+		SetEntry<SetGlyphAtlas>(exports, "setGlyphAtlas");
+		exports->Set(Nan::New("getGlyphAtlasStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetGlyphAtlasStats)->GetFunction());
+		SetEntry<SetFontCache>(exports, "setFontCache");
+		exports->Set(Nan::New("getFontCacheStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetFontCacheStats)->GetFunction());
 
-		exports->Set(Nan::New("setGlobalAlpha").ToLocalChecked(), Nan::New<FunctionTemplate>(SetGlobalAlpha)->GetFunction());
-		exports->Set(Nan::New("getGlobalAlpha").ToLocalChecked(), Nan::New<FunctionTemplate>(GetGlobalAlpha)->GetFunction());
+		SetEntry<FillRect>(exports, "fillRect");
+		SetEntry<ClearRect>(exports, "clearRect");
+		SetEntry<StrokeRect>(exports, "strokeRect");
 
-		exports->Set(Nan::New("beginPath").ToLocalChecked(), Nan::New<FunctionTemplate>(BeginPath)->GetFunction());
-		exports->Set(Nan::New("closePath").ToLocalChecked(), Nan::New<FunctionTemplate>(ClosePath)->GetFunction());
-		exports->Set(Nan::New("moveTo").ToLocalChecked(), Nan::New<FunctionTemplate>(MoveTo)->GetFunction());
-		exports->Set(Nan::New("lineTo").ToLocalChecked(), Nan::New<FunctionTemplate>(LineTo)->GetFunction());
-		exports->Set(Nan::New("stroke").ToLocalChecked(), Nan::New<FunctionTemplate>(Stroke)->GetFunction());
-		exports->Set(Nan::New("fill").ToLocalChecked(), Nan::New<FunctionTemplate>(Fill)->GetFunction());
+		SetEntry<SetStyle>(exports, "setStyle");
+		exports->Set(Nan::New("parseColor").ToLocalChecked(), Nan::New<FunctionTemplate>(ParseColor)->GetFunction());
+		exports->Set(Nan::New("getColorStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetColorStats)->GetFunction());
+		SetEntry<PreparePaint>(exports, "preparePaint");
+		SetEntry<ReleasePaint>(exports, "releasePaint");
+		SetEntry<GetFillStyle>(exports, "getStyle");
 
-		exports->Set(Nan::New("quadraticCurveTo").ToLocalChecked(), Nan::New<FunctionTemplate>(QuadraticCurveTo)->GetFunction());
-		exports->Set(Nan::New("bezierCurveTo").ToLocalChecked(), Nan::New<FunctionTemplate>(BezierCurveTo)->GetFunction());
-		exports->Set(Nan::New("arc").ToLocalChecked(), Nan::New<FunctionTemplate>(Arc)->GetFunction());
-		exports->Set(Nan::New("rect").ToLocalChecked(), Nan::New<FunctionTemplate>(Rect)->GetFunction());
-
-		exports->Set(Nan::New("clip").ToLocalChecked(), Nan::New<FunctionTemplate>(Clip)->GetFunction());
+		exports->Set(Nan::New("getScreenWidth").ToLocalChecked(), Nan::New<FunctionTemplate>(GetScreenWidth)->GetFunction());
+		exports->Set(Nan::New("getScreenHeight").ToLocalChecked(), Nan::New<FunctionTemplate>(GetScreenHeight)->GetFunction());
 
-		exports->Set(Nan::New("save").ToLocalChecked(), Nan::New<FunctionTemplate>(Save)->GetFunction());
-		exports->Set(Nan::New("restore").ToLocalChecked(), Nan::New<FunctionTemplate>(Restore)->GetFunction());
+		SetEntry<SetLineWidth>(exports, "setLineWidth");
+		SetEntry<SetLineCap>(exports, "setLineCap");
+		SetEntry<SetLineJoin>(exports, "setLineJoin");
+		SetEntry<SetLineDash>(exports, "setLineDash");
+		SetEntry<SetLineDashOffset>(exports, "setLineDashOffset");
+
+		SetEntry<GetLineWidth>(exports, "getLineWidth");
+		SetEntry<GetLineCap>(exports, "getLineCap");
+		SetEntry<GetLineJoin>(exports, "getLineJoin");
+		SetEntry<GetLineDash>(exports, "getLineDash");
+		SetEntry<GetLineDashOffset>(exports, "getLineDashOffset");
+
+		SetEntry<SetGlobalAlpha>(exports, "setGlobalAlpha");
+		SetEntry<GetGlobalAlpha>(exports, "getGlobalAlpha");
+
+		SetEntry<BeginPath>(exports, "beginPath");
+		SetEntry<ClosePath>(exports, "closePath");
+		SetEntry<MoveTo>(exports, "moveTo");
+		SetEntry<LineTo>(exports, "lineTo");
+		SetEntry<Stroke>(exports, "stroke");
+		SetEntry<Fill>(exports, "fill");
+
+		SetEntry<QuadraticCurveTo>(exports, "quadraticCurveTo");
+		SetEntry<BezierCurveTo>(exports, "bezierCurveTo");
+		SetEntry<Arc>(exports, "arc");
+		SetEntry<ArcTo>(exports, "arcTo");
+		SetEntry<Ellipse>(exports, "ellipse");
+		SetEntry<Rect>(exports, "rect");
+		SetEntry<Polyline>(exports, "polyline");
+		SetEntry<StrokeSeries>(exports, "strokeSeries");
+		SetEntry<DrawCircles>(exports, "drawCircles");
+		SetEntry<IsPointInPath>(exports, "isPointInPath");
+		SetEntry<IsPointInStroke>(exports, "isPointInStroke");
+		SetEntry<AddHitRegion>(exports, "addHitRegion");
+		SetEntry<RemoveHitRegion>(exports, "removeHitRegion");
+		SetEntry<ClearHitRegions>(exports, "clearHitRegions");
+		SetEntry<HitTest>(exports, "hitTest");
+
+		SetEntry<Clip>(exports, "clip");
+
+		SetEntry<Save>(exports, "save");
+		SetEntry<Restore>(exports, "restore");
 		
-		exports->Set(Nan::New("setFont").ToLocalChecked(), Nan::New<FunctionTemplate>(SetFont)->GetFunction());
-		exports->Set(Nan::New("loadFont").ToLocalChecked(), Nan::New<FunctionTemplate>(NewFont)->GetFunction());
-		exports->Set(Nan::New("fillText").ToLocalChecked(), Nan::New<FunctionTemplate>(FillText)->GetFunction());
-		exports->Set(Nan::New("strokeText").ToLocalChecked(), Nan::New<FunctionTemplate>(StrokeText)->GetFunction());
-		exports->Set(Nan::New("measureText").ToLocalChecked(), Nan::New<FunctionTemplate>(MeasureText)->GetFunction());
+		SetEntry<SetFont>(exports, "setFont");
+		SetEntry<NewFont>(exports, "loadFont");
+		SetEntry<LoadFontAsync>(exports, "loadFontAsync");
+		SetEntry<FillText>(exports, "fillText");
+		SetEntry<StrokeText>(exports, "strokeText");
+		SetEntry<MeasureText>(exports, "measureText");
 		
-		exports->Set(Nan::New("drawImage").ToLocalChecked(), Nan::New<FunctionTemplate>(DrawImage)->GetFunction());
-		exports->Set(Nan::New("setImageSmoothing").ToLocalChecked(), Nan::New<FunctionTemplate>(SetImageSmoothing)->GetFunction());
-		exports->Set(Nan::New("getImageSmoothing").ToLocalChecked(), Nan::New<FunctionTemplate>(GetImageSmoothing)->GetFunction());
+		SetEntry<DrawImage>(exports, "drawImage");
+		SetEntry<SetImageSmoothing>(exports, "setImageSmoothing");
+		SetEntry<GetImageSmoothing>(exports, "getImageSmoothing");
 		
-		exports->Set(Nan::New("setGlobalCompositeOperation").ToLocalChecked(), Nan::New<FunctionTemplate>(SetGlobalCompositeOperation)->GetFunction());
-		exports->Set(Nan::New("getGlobalCompositeOperation").ToLocalChecked(), Nan::New<FunctionTemplate>(GetGlobalCompositeOperation)->GetFunction());
+		SetEntry<SetGlobalCompositeOperation>(exports, "setGlobalCompositeOperation");
+		SetEntry<GetGlobalCompositeOperation>(exports, "getGlobalCompositeOperation");
 		
-		exports->Set(Nan::New("setMiterLimit").ToLocalChecked(), Nan::New<FunctionTemplate>(SetMiterLimit)->GetFunction());
-		exports->Set(Nan::New("getMiterLimit").ToLocalChecked(), Nan::New<FunctionTemplate>(GetMiterLimit)->GetFunction());
+		SetEntry<SetMiterLimit>(exports, "setMiterLimit");
+		SetEntry<GetMiterLimit>(exports, "getMiterLimit");
 		
-		exports->Set(Nan::New("setTextAlign").ToLocalChecked(), Nan::New<FunctionTemplate>(SetTextAlign)->GetFunction());
-		exports->Set(Nan::New("getTextAlign").ToLocalChecked(), Nan::New<FunctionTemplate>(GetTextAlign)->GetFunction());
-		exports->Set(Nan::New("setTextBaseline").ToLocalChecked(), Nan::New<FunctionTemplate>(SetTextBaseline)->GetFunction());
-		exports->Set(Nan::New("getTextBaseline").ToLocalChecked(), Nan::New<FunctionTemplate>(GetTextBaseline)->GetFunction());
+		SetEntry<SetTextAlign>(exports, "setTextAlign");
+		SetEntry<GetTextAlign>(exports, "getTextAlign");
+		SetEntry<SetTextBaseline>(exports, "setTextBaseline");
+		SetEntry<GetTextBaseline>(exports, "getTextBaseline");
 		
-		exports->Set(Nan::New("resetTransform").ToLocalChecked(), Nan::New<FunctionTemplate>(ResetTransform)->GetFunction());
-		exports->Set(Nan::New("scale").ToLocalChecked(), Nan::New<FunctionTemplate>(Scale)->GetFunction());
-		exports->Set(Nan::New("rotate").ToLocalChecked(), Nan::New<FunctionTemplate>(Rotate)->GetFunction());
-		exports->Set(Nan::New("translate").ToLocalChecked(), Nan::New<FunctionTemplate>(Translate)->GetFunction());
-		exports->Set(Nan::New("transform").ToLocalChecked(), Nan::New<FunctionTemplate>(Transform)->GetFunction());
-		exports->Set(Nan::New("setTransform").ToLocalChecked(), Nan::New<FunctionTemplate>(SetTransform)->GetFunction());
+		SetEntry<ResetTransform>(exports, "resetTransform");
+		SetEntry<Scale>(exports, "scale");
+		SetEntry<Rotate>(exports, "rotate");
+		SetEntry<Translate>(exports, "translate");
+		SetEntry<Transform>(exports, "transform");
+		SetEntry<SetTransform>(exports, "setTransform");
 		
-		exports->Set(Nan::New("getImageData").ToLocalChecked(), Nan::New<FunctionTemplate>(GetImageData)->GetFunction());
+		SetEntry<GetImageData>(exports, "getImageData");
 		
-		exports->Set(Nan::New("toBlob").ToLocalChecked(), Nan::New<FunctionTemplate>(ToBlob)->GetFunction());
-		exports->Set(Nan::New("toDataURL").ToLocalChecked(), Nan::New<FunctionTemplate>(ToURL)->GetFunction());
+		SetEntry<ToBlob>(exports, "toBlob");
+		SetEntry<ToURL>(exports, "toDataURL");
+		SetEntry<RenderDisplayList>(exports, "renderDisplayList");
+		exports->Set(Nan::New("getTileStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetTileStats)->GetFunction());
+		SetEntry<FlushReadback>(exports, "flushReadback");
+		exports->Set(Nan::New("setReadbackLatency").ToLocalChecked(), Nan::New<FunctionTemplate>(SetReadbackLatency)->GetFunction());
+		exports->Set(Nan::New("setPresentThread").ToLocalChecked(), Nan::New<FunctionTemplate>(SetPresentThread)->GetFunction());
+		exports->Set(Nan::New("getPresentStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetPresentStats)->GetFunction());
+		exports->Set(Nan::New("getReadbackStats").ToLocalChecked(), Nan::New<FunctionTemplate>(GetReadbackStats)->GetFunction());
 		
+		Scheduler::Init(exports);
+		Context::Init(exports);
 		Gradient::Init(exports);
 		Image::Init(exports);
 		Pattern::Init(exports);
+		DisplayList::Init(exports);
+		TextBlob::Init(exports);
 
 	}
 
@@ -22,8 +22,56 @@
 
 #include <nan.h>
 
+extern "C" {
+	#include "present-util.h"
+	#include "profile-util.h"
+}
+
 namespace vgcanvas {
 	bool checkArgs(const Nan::FunctionCallbackInfo<v8::Value> &info, int expect, int offset);
+	
+	// see context.cc
+	void BindContext(v8::Local<v8::Object> receiver);
+	void ResetContextBinding();
+	
+	typedef void (*EntryPoint)(const Nan::FunctionCallbackInfo<v8::Value>&);
+	
+	// profiling id of an entry point, -1 if it has not been registered
+	template<EntryPoint F>
+	struct EntryId {
+		static int id;
+	};
+	
+	template<EntryPoint F>
+	int EntryId<F>::id = -1;
+	
+	// takes the EGL context back from the presentation thread and makes the
+	// canvas context of the receiver current before an entry point runs
+	template<EntryPoint F>
+	void Guard(const Nan::FunctionCallbackInfo<v8::Value> &info) {
+		present_util_acquire();
+		BindContext(info.This());
+		
+		if(!profile_util_enabled) {
+			F(info);
+			return;
+		}
+		
+		uint64_t start = profile_util_now();
+		F(info);
+		profile_util_end_entry(EntryId<F>::id, start);
+	}
+	
+	template<EntryPoint F>
+	void RegisterEntry(const char *name) {
+		EntryId<F>::id = profile_util_register(name);
+	}
+	
+	template<EntryPoint F>
+	void SetEntry(v8::Local<v8::Object> target, const char *name) {
+		RegisterEntry<F>(name);
+		target->Set(Nan::New(name).ToLocalChecked(), Nan::New<v8::FunctionTemplate>(Guard<F>)->GetFunction());
+	}
 }
 
 #endif
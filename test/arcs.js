@@ -0,0 +1,75 @@
+module.exports.name = 'Arcs and circles';
+
+var dots = 10000;
+
+function scatter() {
+	var xs = new Float32Array(dots);
+	var ys = new Float32Array(dots);
+	var radii = new Float32Array(dots);
+
+	for(var i = 0; i < dots; i++) {
+		var angle = Math.random() * 2 * Math.PI;
+		var distance = Math.sqrt(-2 * Math.log(Math.random() + 1e-9)) * 60;
+		xs[i] = 1100 + Math.cos(angle) * distance;
+		ys[i] = 450 + Math.sin(angle) * distance;
+		radii[i] = 1.5 + Math.random() * 2;
+	}
+
+	return { xs: xs, ys: ys, radii: radii };
+}
+
+function time(fn) {
+	var start = process.hrtime();
+	fn();
+	var diff = process.hrtime(start);
+
+	return diff[0] * 1e3 + diff[1] / 1e6;
+}
+
+module.exports.test = function(ctx, w, h) {
+	ctx.fillText('Quarter arcs, rotated ellipses, rounded corners with arcTo and ' + dots + ' dots', 100, 80);
+
+	ctx.strokeStyle = '#000';
+	ctx.lineWidth = 3;
+
+	// clockwise and anticlockwise quarters starting at the right
+	ctx.beginPath();
+	ctx.arc(200, 200, 60, 0, Math.PI / 2);
+	ctx.stroke();
+	ctx.beginPath();
+	ctx.arc(350, 200, 60, 0, Math.PI / 2, true);
+	ctx.stroke();
+
+	ctx.fillStyle = 'rgba(30, 87, 153, 0.6)';
+	for(var i = 0; i < 6; i++) {
+		ctx.beginPath();
+		ctx.ellipse(300, 450, 120, 30, i * Math.PI / 6, 0, 2 * Math.PI);
+		ctx.fill();
+	}
+
+	// a rounded rectangle
+	ctx.beginPath();
+	ctx.moveTo(560, 150);
+	ctx.arcTo(800, 150, 800, 300, 40);
+	ctx.arcTo(800, 300, 540, 300, 40);
+	ctx.arcTo(540, 300, 540, 150, 40);
+	ctx.arcTo(540, 150, 800, 150, 40);
+	ctx.closePath();
+	ctx.stroke();
+
+	var data = scatter();
+	ctx.fillStyle = 'rgba(224, 0, 0, 0.4)';
+	var arcs = time(function() {
+		for(var i = 0; i < dots; i++) {
+			ctx.beginPath();
+			ctx.arc(data.xs[i] - 300, data.ys[i], data.radii[i], 0, 2 * Math.PI);
+			ctx.fill();
+		}
+	});
+	var circles = time(function() {
+		ctx.drawCircles(data.xs, data.ys, data.radii);
+	});
+
+	ctx.lineWidth = 1;
+	console.log('arc + fill: ' + arcs.toFixed(1) + ' ms, drawCircles: ' + circles.toFixed(1) + ' ms');
+};
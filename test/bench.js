@@ -0,0 +1,79 @@
+// Runs the native benchmark suite (build/Release/vgcanvas-bench) and prints the
+// results. Usage:
+//   node test/bench.js [-t min_time_ms] [-f filter] [--save file] [--compare file] [--threshold percent]
+// --save writes the raw JSON, --compare exits with 1 if a benchmark got slower
+// or allocates more than in the given file.
+var childProcess = require('child_process');
+var fs = require('fs');
+var path = require('path');
+
+var root = path.join(__dirname, '..');
+var binary = path.join(root, 'build', 'Release', 'vgcanvas-bench');
+var args = [];
+var save = null;
+var compare = null;
+var threshold = 10;
+
+for(var i = 2; i < process.argv.length; i++) {
+	switch(process.argv[i]) {
+		case '--save':
+			save = process.argv[++i];
+			break;
+		case '--compare':
+			compare = process.argv[++i];
+			break;
+		case '--threshold':
+			threshold = parseFloat(process.argv[++i]);
+			break;
+		default:
+			args.push(process.argv[i]);
+	}
+}
+
+function pad(str, length) {
+	str = String(str);
+	while(str.length < length) {
+		str += ' ';
+	}
+
+	return str;
+}
+
+var output = childProcess.execFileSync(binary, args, { cwd: root, encoding: 'utf8' });
+var results = JSON.parse(output);
+var baseline = {};
+var regressions = 0;
+
+if(compare) {
+	JSON.parse(fs.readFileSync(compare, 'utf8')).benchmarks.forEach(function(bench) {
+		baseline[bench.name] = bench;
+	});
+}
+
+console.log(pad('benchmark', 26) + pad('ns/op', 14) + pad('allocs/op', 11) + pad('bytes/op', 12) + pad('vg calls/op', 13) + (compare ? 'change' : ''));
+
+results.benchmarks.forEach(function(bench) {
+	var line = pad(bench.name, 26) + pad(bench.ns_per_op.toFixed(1), 14) + pad(bench.allocs_per_op.toFixed(2), 11) + pad(bench.bytes_per_op.toFixed(0), 12) + pad(bench.vg_calls_per_op.toFixed(1), 13);
+	var old = baseline[bench.name];
+
+	if(old) {
+		var change = (bench.ns_per_op / old.ns_per_op - 1) * 100;
+		line += (change >= 0 ? '+' : '') + change.toFixed(1) + '%';
+
+		if(change > threshold || bench.allocs_per_op > old.allocs_per_op) {
+			line += '  REGRESSION';
+			regressions++;
+		}
+	}
+
+	console.log(line);
+});
+
+if(save) {
+	fs.writeFileSync(save, output);
+}
+
+if(regressions) {
+	console.log(regressions + ' regression(s) above ' + threshold + '%');
+	process.exit(1);
+}
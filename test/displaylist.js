@@ -0,0 +1,37 @@
+var vgcanvas = require('../lib/canvas');
+
+module.exports.name = 'Display lists';
+
+function drawShapes(ctx) {
+	var gradient = ctx.createLinearGradient(0, 0, 150, 0);
+	gradient.addColorStop(0, '#1e5799');
+	gradient.addColorStop(1, '#f3c5bd');
+	ctx.fillStyle = gradient;
+	ctx.fillRect(0, 0, 150, 100);
+
+	ctx.strokeStyle = '#c00';
+	ctx.lineWidth = 4;
+	ctx.beginPath();
+	ctx.arc(75, 50, 40, 0, Math.PI * 2);
+	ctx.stroke();
+	ctx.fillStyle = '#000';
+	ctx.fillText('recorded', 30, 130);
+}
+
+module.exports.test = function(ctx, w, h) {
+	ctx.fillText('Recorded once, replayed with transformations and after a serialization round trip', 100, 80);
+
+	ctx.save();
+	ctx.translate(100, 100);
+	ctx.beginRecording();
+	drawShapes(ctx);
+	var list = ctx.endRecording();
+	ctx.restore();
+
+	list.replay(ctx, 1, 0, 0, 1, 250, 100);
+	list.replay(ctx, 0.5, 0, 0, 0.5, 400, 100);
+
+	var copy = vgcanvas.DisplayList.deserialize(list.serialize());
+	copy.replay(ctx, 1, 0, 0, 1, 100, 250);
+	console.log(list.commands + ' commands, ' + list.byteLength + ' bytes');
+};
@@ -0,0 +1,85 @@
+var vgcanvas = require('../lib/canvas');
+
+var canvas = new vgcanvas.Canvas();
+var ctx = canvas.getContext('2d');
+var w = canvas.width;
+var h = canvas.height;
+var runs = 5;
+
+var configs = [
+	{ type: 'image/png', encoder: { compression: 0, filter: 'none' } },
+	{ type: 'image/png', encoder: { compression: 1, filter: 'none' } },
+	{ type: 'image/png', encoder: { compression: 1, filter: 'up' } },
+	{ type: 'image/png', encoder: { compression: 1, filter: 'adaptive' } },
+	{ type: 'image/png', encoder: { compression: 6, filter: 'up' } },
+	{ type: 'image/png', encoder: { compression: 6, filter: 'paeth' } },
+	{ type: 'image/png', encoder: { compression: 6, filter: 'adaptive' } },
+	{ type: 'image/png', encoder: { compression: 9, filter: 'adaptive' } },
+	{ type: 'image/jpeg', encoder: 0.5 },
+	{ type: 'image/jpeg', encoder: 0.9 },
+	{ type: 'image/x-qoi' }
+];
+
+ctx.loadFont('./test/Lato-Regular.ttf', 'font');
+
+function draw() {
+	var gradient = ctx.createLinearGradient(0, 0, w, h);
+	gradient.addColorStop(0, '#1e5799');
+	gradient.addColorStop(1, '#f3c5bd');
+	ctx.fillStyle = gradient;
+	ctx.fillRect(0, 0, w, h);
+
+	ctx.fillStyle = '#fff';
+	ctx.font = '40px font';
+	for(var i = 0; i < 20; i++) {
+		ctx.fillText('Encoder benchmark ' + i, 20 + i * 10, 60 + i * 45);
+	}
+
+	for(var i = 0; i < 200; i++) {
+		ctx.fillStyle = 'rgba(' + (i * 7 % 255) + ', ' + (i * 13 % 255) + ', ' + (i * 29 % 255) + ', 0.6)';
+		ctx.fillRect((i * 97) % w, (i * 53) % h, 40, 40);
+	}
+}
+
+function pad(str, length) {
+	str = String(str);
+	while(str.length < length) {
+		str += ' ';
+	}
+
+	return str;
+}
+
+function run(index) {
+	if(index == configs.length) {
+		ctx.cleanup();
+		return;
+	}
+
+	var config = configs[index];
+	var times = [];
+	var size = 0;
+
+	(function next() {
+		var start = process.hrtime();
+
+		canvas.toBlob(function(blob) {
+			var diff = process.hrtime(start);
+			times.push(diff[0] * 1e3 + diff[1] / 1e6);
+			size = blob.length;
+
+			if(times.length < runs) {
+				return next();
+			}
+
+			times.sort(function(a, b) { return a - b; });
+			console.log(pad(config.type, 12) + pad(JSON.stringify(config.encoder || {}), 40) + pad(times[runs >> 1].toFixed(1) + ' ms', 12) + (size / 1024).toFixed(0) + ' KiB');
+
+			run(index + 1);
+		}, config.type, config.encoder);
+	})();
+}
+
+draw();
+console.log('Encoding ' + w + 'x' + h + ', median of ' + runs + ' runs');
+run(0);
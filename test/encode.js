@@ -0,0 +1,74 @@
+module.exports.name = 'QOI round trip';
+
+var colors = [[255, 255, 255], [0, 0, 0], [255, 0, 0], [0, 255, 0], [255, 0, 0], [0, 0, 0]];
+
+// decodes a QOI image as described on qoiformat.org, returns RGBA pixels
+function decode(data) {
+	var width = data.readUInt32BE(4);
+	var height = data.readUInt32BE(8);
+	var pixels = new Uint8Array(width * height * 4);
+	var index = new Uint8Array(64 * 4);
+	var px = [0, 0, 0, 255];
+	var p = 14;
+	var run = 0;
+
+	for(var i = 0; i < width * height; i++) {
+		if(run > 0) {
+			run--;
+		} else {
+			var b = data[p++];
+
+			if(b == 0xfe) {
+				px = [data[p], data[p + 1], data[p + 2], px[3]];
+				p += 3;
+			} else if(b == 0xff) {
+				px = [data[p], data[p + 1], data[p + 2], data[p + 3]];
+				p += 4;
+			} else if((b >> 6) == 0) {
+				px = [index[b * 4], index[b * 4 + 1], index[b * 4 + 2], index[b * 4 + 3]];
+			} else if((b >> 6) == 1) {
+				px = [(px[0] + ((b >> 4) & 3) - 2) & 255, (px[1] + ((b >> 2) & 3) - 2) & 255, (px[2] + (b & 3) - 2) & 255, px[3]];
+			} else if((b >> 6) == 2) {
+				var vg = (b & 63) - 32;
+				var b2 = data[p++];
+				px = [(px[0] + vg - 8 + (b2 >> 4)) & 255, (px[1] + vg) & 255, (px[2] + vg - 8 + (b2 & 15)) & 255, px[3]];
+			} else {
+				run = b & 63;
+			}
+		}
+
+		var hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+		for(var c = 0; c < 4; c++) {
+			index[hash * 4 + c] = px[c];
+			pixels[i * 4 + c] = px[c];
+		}
+	}
+
+	return { width: width, height: height, data: pixels };
+}
+
+module.exports.test = function(ctx, w, h) {
+	// black right after other colors hits the index slot of opaque black
+	colors.forEach(function(color, i) {
+		ctx.fillStyle = 'rgb(' + color.join(', ') + ')';
+		ctx.fillRect(100 + i * 40, 100, 40, 40);
+	});
+
+	ctx.canvas.toBlob(function(blob) {
+		var image = decode(blob);
+		var failed = 0;
+
+		colors.forEach(function(color, i) {
+			var offset = (120 * image.width + 120 + i * 40) * 4;
+			var got = Array.prototype.slice.call(image.data, offset, offset + 4);
+
+			if(got[0] != color[0] || got[1] != color[1] || got[2] != color[2] || got[3] != 255) {
+				console.error('QOI pixel ' + i + ': expected ' + color.join(',') + ',255 but got ' + got.join(','));
+				failed++;
+			}
+		});
+
+		ctx.fillStyle = failed ? '#f00' : '#000';
+		ctx.fillText(failed ? 'QOI round trip failed, see log output' : 'QOI round trip ok', 100, 180);
+	}, 'image/x-qoi');
+};
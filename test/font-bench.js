@@ -0,0 +1,70 @@
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var vgcanvas = require('../lib/canvas');
+
+var canvas = new vgcanvas.Canvas();
+var ctx = canvas.getContext('2d');
+var fonts = process.argv.length > 2 ? process.argv.slice(2) : ['./test/Lato-Regular.ttf'];
+var dir = path.join(os.tmpdir(), 'vgcanvas-font-bench');
+var runs = 5;
+var loaded = 0;
+
+function pad(str, length) {
+	str = String(str);
+	while(str.length < length) {
+		str += ' ';
+	}
+
+	return str;
+}
+
+function clear() {
+	if(!fs.existsSync(dir)) {
+		return;
+	}
+
+	fs.readdirSync(dir).forEach(function(file) {
+		fs.unlinkSync(path.join(dir, file));
+	});
+}
+
+// loads all fonts on the JS thread like a kiosk at startup, fonts can't be removed so every load gets a new name
+function load() {
+	var start = process.hrtime();
+
+	fonts.forEach(function(font) {
+		ctx.loadFont(font, 'bench-' + loaded++);
+	});
+
+	var diff = process.hrtime(start);
+	return diff[0] * 1e3 + diff[1] / 1e6;
+}
+
+function median(fn) {
+	var times = [];
+	for(var i = 0; i < runs; i++) {
+		times.push(fn());
+	}
+
+	times.sort(function(a, b) { return a - b; });
+	return times[runs >> 1];
+}
+
+console.log('Loading ' + fonts.length + ' font(s), median of ' + runs + ' runs');
+
+canvas.setFontCache(null);
+console.log(pad('no cache', 20) + median(load).toFixed(1) + ' ms');
+
+canvas.setFontCache(dir);
+console.log(pad('cache (writing)', 20) + median(function() {
+	clear();
+	return load();
+}).toFixed(1) + ' ms');
+console.log(pad('cache', 20) + median(load).toFixed(1) + ' ms');
+
+console.log(JSON.stringify(canvas.getFontCacheStats()));
+
+clear();
+canvas.setFontCache(null);
+ctx.cleanup();
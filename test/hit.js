@@ -0,0 +1,110 @@
+module.exports.name = 'Hit testing';
+
+function star(ctx, cx, cy) {
+	var points = new Float32Array(20);
+
+	for(var i = 0; i < 10; i++) {
+		var radius = i % 2 ? 60 : 150;
+		points[2 * i] = cx + radius * Math.cos(i * Math.PI / 5 - Math.PI / 2);
+		points[2 * i + 1] = cy + radius * Math.sin(i * Math.PI / 5 - Math.PI / 2);
+	}
+
+	ctx.beginPath();
+	ctx.polygon(points);
+}
+
+// tests a grid of points against the current path, the path is replaced by
+// fillRect so the results are collected before drawing them
+function grid(ctx, x, y, size, test) {
+	var hits = [];
+	var start = process.hrtime();
+
+	for(var py = y; py < y + size; py += 8) {
+		for(var px = x; px < x + size; px += 8) {
+			if(test(px, py)) {
+				hits.push(px, py);
+			}
+		}
+	}
+
+	var diff = process.hrtime(start);
+	var tests = (size / 8) * (size / 8);
+
+	return { hits: hits, time: (diff[0] * 1e9 + diff[1]) / tests };
+}
+
+function mark(ctx, hits, color) {
+	ctx.fillStyle = color;
+
+	for(var i = 0; i < hits.length; i += 2) {
+		ctx.fillRect(hits[i] - 1, hits[i + 1] - 1, 3, 3);
+	}
+}
+
+module.exports.test = function(ctx, w, h) {
+	ctx.fillText('Dots inside the star (non-zero), the circle (even-odd) and on the stroke of the curve', 100, 80);
+
+	star(ctx, 300, 350);
+	var fill = grid(ctx, 140, 190, 320, function(x, y) { return ctx.isPointInPath(x, y); });
+	ctx.strokeStyle = '#000';
+	ctx.stroke();
+	mark(ctx, fill.hits, '#1e5799');
+
+	ctx.beginPath();
+	ctx.arc(650, 350, 120, 0, 2 * Math.PI);
+	ctx.moveTo(710, 350);
+	ctx.arc(650, 350, 60, 0, 2 * Math.PI);
+	var ring = grid(ctx, 520, 220, 260, function(x, y) { return ctx.isPointInPath(x, y, 'evenodd'); });
+	ctx.stroke();
+	mark(ctx, ring.hits, '#1e5799');
+
+	ctx.lineWidth = 12;
+	ctx.lineCap = 'round';
+	ctx.beginPath();
+	ctx.moveTo(850, 450);
+	ctx.bezierCurveTo(900, 200, 1050, 500, 1100, 250);
+	var stroke = grid(ctx, 840, 200, 280, function(x, y) { return ctx.isPointInStroke(x, y); });
+	ctx.strokeStyle = 'rgba(0, 0, 0, 0.3)';
+	ctx.stroke();
+	mark(ctx, stroke.hits, '#e00');
+	ctx.lineWidth = 1;
+	ctx.lineCap = 'butt';
+
+	// hit regions of a grid of widgets, the topmost one wins
+	ctx.clearHitRegions();
+
+	for(var i = 0; i < 100; i++) {
+		ctx.fillStyle = 'hsl(' + (i * 36 % 360) + ', 60%, 70%)';
+		ctx.fillRect(100 + (i % 20) * 50, 600 + Math.floor(i / 20) * 30, 60, 20);
+		ctx.addHitRegion({ id: 'widget-' + i });
+	}
+
+	var start = process.hrtime();
+	var topmost = [ctx.hitTest(105, 605), ctx.hitTest(155, 605), ctx.hitTest(50, 50)];
+	var diff = process.hrtime(start);
+
+	console.log('hitTest: ' + topmost.join(', ') + ' (expected widget-0, widget-1, null) in ' + ((diff[0] * 1e9 + diff[1]) / 3).toFixed(0) + ' ns per test');
+	ctx.clearHitRegions();
+
+	// edges with non-finite coordinates are ignored, the rest of the path still works
+	var results = [];
+	ctx.beginPath();
+	ctx.moveTo(NaN, NaN);
+	ctx.lineTo(NaN, NaN);
+	results.push(ctx.isPointInPath(10, 10), ctx.isPointInStroke(10, 10), ctx.isPointInPath(NaN, NaN));
+	ctx.beginPath();
+	ctx.moveTo(0, 0);
+	ctx.lineTo(0, 1e39);
+	ctx.lineTo(-1e39, 100);
+	results.push(ctx.isPointInPath(10, 5), ctx.isPointInStroke(1e39, -1e39));
+	ctx.beginPath();
+	ctx.rect(200, 200, 100, 100);
+	ctx.moveTo(-1e39, 0);
+	ctx.lineTo(1e39, 1e39);
+	ctx.lineTo(NaN, 5);
+	results.push(ctx.isPointInPath(250, 250), ctx.isPointInStroke(200, 250), ctx.isPointInPath(250, -1e39));
+	ctx.beginPath();
+	console.log('non-finite coordinates: ' + results.join(', ') + ' (expected false, false, false, false, false, true, true, false)');
+
+	console.log('isPointInPath: ' + fill.time.toFixed(0) + ' ns, evenodd: ' + ring.time.toFixed(0) + ' ns, isPointInStroke: ' + stroke.time.toFixed(0) + ' ns per test (including the call from JS)');
+};
@@ -0,0 +1,29 @@
+module.exports.name = 'Layers';
+
+function drawGrid(ctx) {
+	ctx.strokeStyle = '#888';
+	ctx.lineWidth = 2;
+	ctx.beginPath();
+	for(var i = 0; i <= 10; i++) {
+		ctx.moveTo(i * 20, 0);
+		ctx.lineTo(i * 20, 200);
+		ctx.moveTo(0, i * 20);
+		ctx.lineTo(200, i * 20);
+	}
+	ctx.stroke();
+}
+
+module.exports.test = function(ctx, w, h) {
+	ctx.fillText('Grid recorded once, composited at three positions', 100, 80);
+
+	// the first layer is recorded, the translated ones reuse its image
+	for(var i = 0; i < 3; i++) {
+		ctx.save();
+		ctx.translate(100 + i * 250, 100);
+		if(ctx.beginLayer('grid', 0, 0, 200, 200)) {
+			drawGrid(ctx);
+		}
+		ctx.endLayer();
+		ctx.restore();
+	}
+};
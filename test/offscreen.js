@@ -0,0 +1,22 @@
+var vgcanvas = require('../lib/canvas');
+
+module.exports.name = 'Offscreen canvas';
+
+module.exports.test = function(ctx, w, h) {
+	var offscreen = new vgcanvas.OffscreenCanvas(200, 200);
+	var octx = offscreen.getContext('2d');
+	
+	// state of the offscreen context is independent of the screen
+	octx.fillStyle = 'rgba(0, 128, 255, 0.8)';
+	octx.fillRect(0, 0, 200, 200);
+	octx.lineWidth = 10;
+	octx.strokeStyle = '#fff';
+	octx.beginPath();
+	octx.arc(100, 100, 60, 0, Math.PI * 2);
+	octx.stroke();
+	
+	ctx.fillText('Offscreen canvas drawn three times', 100, 80);
+	ctx.drawImage(offscreen, 100, 100);
+	ctx.drawImage(offscreen, 350, 100, 100, 100);
+	ctx.drawImage(offscreen, 50, 50, 100, 100, 500, 100, 300, 150);
+};
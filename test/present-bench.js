@@ -0,0 +1,65 @@
+var vgcanvas = require('../lib/canvas');
+
+var canvas = new vgcanvas.Canvas();
+var ctx = canvas.getContext('2d');
+var w = canvas.width;
+var h = canvas.height;
+var duration = 5000;
+
+// measures how late a 1 ms timer fires while frames are rendered
+function measure(threaded, done) {
+	var lags = [];
+	var running = true;
+	var frames = 0;
+	var last = process.hrtime();
+
+	canvas.setPresentThread(threaded);
+
+	(function probe() {
+		var diff = process.hrtime(last);
+		lags.push(Math.max(0, diff[0] * 1e3 + diff[1] / 1e6 - 1));
+		last = process.hrtime();
+
+		if(running) {
+			setTimeout(probe, 1);
+		}
+	})();
+
+	canvas.requestAnimationFrame(function frame(time) {
+		ctx.clearRect(0, 0, w, h);
+		for(var i = 0; i < 100; i++) {
+			ctx.fillStyle = 'hsl(' + ((i * 3 + frames) % 360) + ', 80%, 50%)';
+			ctx.fillRect((i * 37 + frames * 2) % w, (i * 91) % h, 80, 80);
+		}
+
+		frames++;
+
+		if(running) {
+			canvas.requestAnimationFrame(frame);
+		}
+	});
+
+	setTimeout(function() {
+		running = false;
+
+		lags.sort(function(a, b) { return a - b; });
+		var sum = lags.reduce(function(a, b) { return a + b; }, 0);
+		var stats = canvas.getPresentStats();
+
+		console.log((threaded ? 'presentation thread' : 'synchronous swap   ') +
+			'  frames: ' + frames +
+			'  lag avg: ' + (sum / lags.length).toFixed(2) + ' ms' +
+			'  p99: ' + lags[Math.floor(lags.length * 0.99)].toFixed(2) + ' ms' +
+			'  max: ' + lags[lags.length - 1].toFixed(2) + ' ms' +
+			'  swap avg: ' + stats.swapAverage.toFixed(2) + ' ms' +
+			'  wait avg: ' + stats.waitAverage.toFixed(2) + ' ms');
+
+		setTimeout(done, 100);
+	}, duration);
+}
+
+measure(false, function() {
+	measure(true, function() {
+		ctx.cleanup();
+	});
+});
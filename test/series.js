@@ -0,0 +1,53 @@
+module.exports.name = 'Series decimation';
+
+var samples = 500000;
+
+function series() {
+	var xs = new Float32Array(samples);
+	var ys = new Float32Array(samples);
+
+	for(var i = 0; i < samples; i++) {
+		xs[i] = i * 800 / samples;
+		ys[i] = 100 * Math.sin(i / 5000) + (Math.random() - 0.5) * 60;
+	}
+
+	return { xs: xs, ys: ys };
+}
+
+function draw(ctx, data, decimate) {
+	var start = process.hrtime();
+	var count = ctx.strokeSeries(data.xs, data.ys, { decimate: decimate });
+	var diff = process.hrtime(start);
+
+	return { count: count, time: diff[0] * 1e3 + diff[1] / 1e6 };
+}
+
+module.exports.test = function(ctx, w, h) {
+	var data = series();
+
+	ctx.fillText('Top: all samples, bottom: min/max per pixel column, both should look the same', 100, 80);
+	ctx.strokeStyle = '#1e5799';
+	ctx.lineWidth = 1;
+
+	ctx.save();
+	ctx.translate(100, 250);
+	var all = draw(ctx, data, false);
+	ctx.restore();
+
+	ctx.save();
+	ctx.translate(100, 550);
+	var decimated = draw(ctx, data, true);
+	ctx.restore();
+
+	var top = ctx.getImageData(100, 100, 800, 300).data;
+	var bottom = ctx.getImageData(100, 400, 800, 300).data;
+	var different = 0;
+
+	for(var i = 0; i < top.length; i += 4) {
+		if(top[i] != bottom[i] || top[i + 1] != bottom[i + 1] || top[i + 2] != bottom[i + 2]) {
+			different++;
+		}
+	}
+
+	console.log('all: ' + all.count + ' samples in ' + all.time.toFixed(1) + ' ms, decimated: ' + decimated.count + ' samples in ' + decimated.time.toFixed(1) + ' ms, ' + different + ' pixels differ');
+};
@@ -1,5 +1,5 @@
 var vgcanvas = require('../lib/canvas');
-var tests = [require('./colorPaint'), require('./alpha'), require('./gradient'), require('./image'), require('./text')];
+var tests = [require('./colorPaint'), require('./alpha'), require('./gradient'), require('./image'), require('./offscreen'), require('./layers'), require('./displaylist'), require('./series'), require('./hit'), require('./arcs'), require('./text'), require('./encode')];
 require('keypress')(process.stdin);
 
 var canvas = new vgcanvas.Canvas();
@@ -55,6 +55,13 @@ process.stdin.on('keypress', function(ch, key) {
 	}
 });
 
-test();
+// the tests start once the second font has been parsed on the thread pool
+ctx.loadFont('./test/Lato-Regular.ttf', 'font-async', function(error) {
+	if(error) {
+		console.error(error);
+	}
+	
+	test();
+});
 process.stdin.setRawMode(true);
 process.stdin.resume();
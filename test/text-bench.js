@@ -0,0 +1,73 @@
+var vgcanvas = require('../lib/canvas');
+
+var canvas = new vgcanvas.Canvas();
+var ctx = canvas.getContext('2d');
+var w = canvas.width;
+var h = canvas.height;
+var runs = 7;
+var sizes = [8, 10, 12, 14, 16, 20, 24, 32, 48];
+var text = 'The quick brown fox jumps over the lazy dog 0123456789';
+
+ctx.loadFont('./test/Lato-Regular.ttf', 'font');
+
+function pad(str, length) {
+	str = String(str);
+	while(str.length < length) {
+		str += ' ';
+	}
+
+	return str;
+}
+
+// fills the screen with lines of text, getImageData waits for the GPU
+function frame(size) {
+	var start = process.hrtime();
+
+	ctx.clearRect(0, 0, w, h);
+	ctx.fillStyle = '#000';
+	ctx.font = size + 'px font';
+	for(var y = size; y < h; y += size * 1.5) {
+		ctx.fillText(text, 10, y);
+	}
+	ctx.getImageData(0, 0, 1, 1);
+
+	var diff = process.hrtime(start);
+	return diff[0] * 1e3 + diff[1] / 1e6;
+}
+
+function measure(size, atlas) {
+	var times = [];
+
+	canvas.setGlyphAtlas(atlas ? size : 0);
+
+	// the first frame rasterizes the glyphs
+	frame(size);
+	for(var i = 0; i < runs; i++) {
+		times.push(frame(size));
+	}
+
+	times.sort(function(a, b) { return a - b; });
+	return times[runs >> 1];
+}
+
+var crossover = 0;
+
+console.log('Filling ' + w + 'x' + h + ' with text, median of ' + runs + ' frames');
+console.log(pad('size', 8) + pad('paths', 12) + pad('atlas', 12) + 'speedup');
+
+sizes.forEach(function(size) {
+	var paths = measure(size, false);
+	var atlas = measure(size, true);
+
+	if(atlas < paths) {
+		crossover = size;
+	}
+
+	console.log(pad(size + 'px', 8) + pad(paths.toFixed(1) + ' ms', 12) + pad(atlas.toFixed(1) + ' ms', 12) + (paths / atlas).toFixed(2) + 'x');
+});
+
+console.log('atlas stats: ' + JSON.stringify(canvas.getGlyphAtlasStats()));
+console.log('suggested canvas.setGlyphAtlas(' + crossover + ')');
+
+canvas.setGlyphAtlas(0);
+ctx.cleanup();
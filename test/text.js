@@ -9,13 +9,25 @@ module.exports.test = function(ctx, w, h) {
 	ctx.fillText("width: " + Math.round(metrics.width) + " pixels", 100, 220);
 	ctx.fillRect(100, 230, metrics.width, 5);
 	
-	ctx.font = '50px font';
+	ctx.font = '50px font-async';
 	ctx.fillText("Larger text", 100, 300);
 	metrics = ctx.measureText("Larger text");
 	ctx.font = '10px font';
 	ctx.fillText("width: " + Math.round(metrics.width) + " pixels", 100, 340);
 	ctx.fillRect(100, 350, metrics.width, 5);
 
+	ctx.font = '30px font';
+	ctx.textAlign = 'center';
+	var blob = ctx.createTextBlob('Prepared text');
+	ctx.textAlign = 'left';
+	for(var i = 0; i < 5; i++) {
+		ctx.fillTextBlob(blob, 800, 200 + i * 40);
+	}
+	ctx.lineWidth = 1;
+	ctx.strokeTextBlob(blob, 800, 400);
+	ctx.font = '10px font';
+	ctx.fillText(blob.glyphs + ' glyphs, width: ' + Math.round(blob.width) + ' pixels', 800, 420);
+
 	var pattern = ctx.createPattern(ctx.testImg, 'repeat');
 	
 	ctx.strokeStyle = pattern;